@@ -28,6 +28,10 @@ RETRO_BEGIN_DECLS
 
 #define AUDIO_MAX_RATIO                16
 
+/* Frames taken through conversion, DSP, resampling and mixing
+ * in one go, small enough for all of it to stay in L1. */
+#define AUDIO_BLOCK_FRAMES             256
+
 #define AUDIO_MIXER_MAX_STREAMS        16
 
 #define AUDIO_MIXER_MAX_SYSTEM_STREAMS (AUDIO_MIXER_MAX_STREAMS + 5)
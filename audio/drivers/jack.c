@@ -20,9 +20,9 @@
 
 #include <jack/jack.h>
 #include <jack/types.h>
-#include <jack/ringbuffer.h>
 
 #include <boolean.h>
+#include <queues/spsc_queue.h>
 #include <rthreads/rthreads.h>
 
 #include "../../configuration.h"
@@ -35,7 +35,7 @@ typedef struct jack
 {
    jack_client_t *client;
    jack_port_t *ports[2];
-   jack_ringbuffer_t *buffer;
+   spsc_queue_t *buffer;
 #ifdef HAVE_THREADS
    scond_t *cond;
    slock_t *cond_lock;
@@ -47,16 +47,16 @@ typedef struct jack
 } jack_t;
 
 static size_t read_deinterleaved(float *dst[2], jack_nframes_t dst_offset,
-      jack_ringbuffer_data_t buf, jack_nframes_t nframes)
+      const uint8_t *buf, size_t len, jack_nframes_t nframes)
 {
    int i;
    jack_nframes_t j, frames_avail;
-   const float *src = (const float *)buf.buf;
+   const float *src = (const float *)buf;
 
    if (nframes <= 0)
       return 0;
 
-   frames_avail = FRAMES(buf.len);
+   frames_avail = FRAMES(len);
    nframes = nframes < frames_avail ? nframes : frames_avail;
 
    for (j = 0; j < nframes; j++)
@@ -71,7 +71,8 @@ static int process_cb(jack_nframes_t nframes, void *data)
    int i;
    jack_nframes_t read = 0;
    jack_t *jd = (jack_t*)data;
-   jack_ringbuffer_data_t buf[2];
+   const uint8_t *buf[2];
+   size_t len[2];
    float *dst[2];
 
    if (nframes <= 0)
@@ -85,12 +86,12 @@ static int process_cb(jack_nframes_t nframes, void *data)
    for (i = 0; i < 2; i++)
       dst[i] = (float *)jack_port_get_buffer(jd->ports[i], nframes);
 
-   jack_ringbuffer_get_read_vector(jd->buffer, buf);
+   spsc_queue_read_regions(jd->buffer, &buf[0], &len[0], &buf[1], &len[1]);
 
    for (i = 0; i < 2; i++)
-      read += read_deinterleaved(dst, read, buf[i], nframes - read);
+      read += read_deinterleaved(dst, read, buf[i], len[i], nframes - read);
 
-   jack_ringbuffer_read_advance(jd->buffer, read * sizeof(float) * 2);
+   spsc_queue_read_advance(jd->buffer, read * sizeof(float) * 2);
 
    for (; read < nframes; read++)
       for (i = 0; i < 2; i++)
@@ -213,7 +214,9 @@ static void *ja_init(const char *device,
 
    RARCH_LOG("[JACK]: Internal buffer size: %d frames.\n", (int)(bufsize / sizeof(jack_default_audio_sample_t)));
 
-   jd->buffer = jack_ringbuffer_create(bufsize);
+   /* Whole frames only, so none gets split where the buffer wraps */
+   jd->buffer = spsc_queue_new((bufsize + sizeof(float) * 2 - 1)
+         & ~(sizeof(float) * 2 - 1));
    if (!jd->buffer)
    {
       RARCH_ERR("[JACK]: Failed to create buffers.\n");
@@ -265,7 +268,7 @@ static ssize_t ja_write(void *data, const void *buf_, size_t size)
       if (jd->shutdown)
          return 0;
 
-      avail = jack_ringbuffer_write_space(jd->buffer);
+      avail = spsc_queue_write_avail(jd->buffer);
 
       to_write = size < avail ? size : avail;
       /* make sure to only write multiples of the sample size */
@@ -273,7 +276,7 @@ static ssize_t ja_write(void *data, const void *buf_, size_t size)
 
       if (to_write > 0)
       {
-         jack_ringbuffer_write(jd->buffer, buf, to_write);
+         spsc_queue_write(jd->buffer, buf, to_write);
          buf     += to_write;
          size    -= to_write;
          written += to_write;
@@ -339,7 +342,7 @@ static void ja_free(void *data)
    }
 
    if (jd->buffer)
-      jack_ringbuffer_free(jd->buffer);
+      spsc_queue_free(jd->buffer);
 
 #ifdef HAVE_THREADS
    if (jd->cond_lock)
@@ -359,7 +362,7 @@ static bool ja_use_float(void *data)
 static size_t ja_write_avail(void *data)
 {
    jack_t *jd = (jack_t*)data;
-   return jack_ringbuffer_write_space(jd->buffer);
+   return spsc_queue_write_avail(jd->buffer);
 }
 
 static size_t ja_buffer_size(void *data)
@@ -26,8 +26,14 @@
 #include <compat/posix_string.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
+#include <retro_inline.h>
+#include <compat/intrinsics.h>
 #include <features/features_cpu.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -49,6 +55,16 @@
 #include "core.h"
 #include "verbosity.h"
 
+/* Searches go through memory a word of matches at a time,
+ * skipping the words that have no match left, so that
+ * searches get quicker as they narrow down */
+#define CHEAT_SEARCH_BLOCK_ITEMS  32
+/* Up to 4 bytes per item */
+#define CHEAT_SEARCH_BLOCK_SIZE   (CHEAT_SEARCH_BLOCK_ITEMS * 4)
+/* Words with this many matches or fewer are searched
+ * item by item rather than as a whole */
+#define CHEAT_SEARCH_SPARSE_ITEMS 4
+
 /* TODO/FIXME - public global variables */
 cheat_manager_t cheat_manager_state;
 
@@ -770,6 +786,46 @@ bool cheat_manager_alloc_if_empty(void)
    return true;
 }
 
+static void cheat_manager_setup_search_meta(
+      unsigned int bitsize,
+      unsigned int *bytes_per_item,
+      unsigned int *mask,
+      unsigned int *bits);
+
+static unsigned cheat_manager_get_num_items(unsigned bits,
+      unsigned bytes_per_item)
+{
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   if (bits < 8)
+      return cheat_st->total_memory_size * (8 / bits);
+   return cheat_st->total_memory_size / bytes_per_item;
+}
+
+/* Every item of the current search size matches */
+static void cheat_manager_reset_matches(void)
+{
+   unsigned int mask           = 0;
+   unsigned int bytes_per_item = 1;
+   unsigned int bits           = 8;
+   unsigned int num_items;
+   cheat_manager_t *cheat_st   = &cheat_manager_state;
+
+   cheat_manager_setup_search_meta(cheat_st->search_bit_size,
+         &bytes_per_item, &mask, &bits);
+   num_items = cheat_manager_get_num_items(bits, bytes_per_item);
+
+   memset(cheat_st->matches, 0,
+         ((cheat_st->total_memory_size * 8 + 31) / 32) * sizeof(uint32_t));
+   memset(cheat_st->matches, 0xFF,
+         (num_items / CHEAT_SEARCH_BLOCK_ITEMS) * sizeof(uint32_t));
+   if (num_items % CHEAT_SEARCH_BLOCK_ITEMS)
+      cheat_st->matches[num_items / CHEAT_SEARCH_BLOCK_ITEMS] =
+         (1u << (num_items % CHEAT_SEARCH_BLOCK_ITEMS)) - 1;
+
+   cheat_st->num_matches = num_items;
+}
+
 int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool wraparound)
 {
    unsigned i;
@@ -891,8 +947,9 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
          cheat_st->matches = NULL;
       }
 
-      cheat_st->matches = (uint8_t*)calloc(
-            cheat_st->total_memory_size, sizeof(uint8_t));
+      /* Enough bits for 1-bit items */
+      cheat_st->matches = (uint32_t*)calloc(
+            (cheat_st->total_memory_size * 8 + 31) / 32, sizeof(uint32_t));
 
       if (!cheat_st->matches)
       {
@@ -902,7 +959,7 @@ int cheat_manager_initialize_memory(rarch_setting_t *setting, size_t idx, bool w
          return 0;
       }
 
-      memset(cheat_st->matches, 0xFF, cheat_st->total_memory_size);
+      cheat_manager_reset_matches();
 
       offset = 0;
 
@@ -993,23 +1050,398 @@ static void cheat_manager_setup_search_meta(
    }
 }
 
+/* Copies @len bytes of memory from @address on, which may
+ * span several memory buffers. What is past the end of
+ * memory is zeroed. */
+static void cheat_manager_copy_memory(uint8_t *s,
+      unsigned address, unsigned len)
+{
+   unsigned i;
+   unsigned offset           = 0;
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   for (i = 0; i < cheat_st->num_memory_buffers && len > 0; i++)
+   {
+      unsigned size = cheat_st->memory_size_list[i];
+
+      if (address < offset + size)
+      {
+         unsigned count = MIN(len, offset + size - address);
+         memcpy(s, cheat_st->memory_buf_list[i] + address - offset, count);
+         s       += count;
+         address += count;
+         len     -= count;
+      }
+
+      offset += size;
+   }
+
+   if (len > 0)
+      memset(s, 0, len);
+}
+
+static unsigned cheat_manager_get_value(const uint8_t *s,
+      unsigned bytes_per_item, bool big_endian)
+{
+   switch (bytes_per_item)
+   {
+      case 2:
+         return big_endian
+            ? ((unsigned)s[0] << 8) | s[1]
+            : s[0] | ((unsigned)s[1] << 8);
+      case 4:
+         return big_endian
+            ? ((unsigned)s[0] << 24) | ((unsigned)s[1] << 16)
+               | ((unsigned)s[2] << 8) | s[3]
+            : s[0] | ((unsigned)s[1] << 8)
+               | ((unsigned)s[2] << 16) | ((unsigned)s[3] << 24);
+      case 1:
+      default:
+         break;
+   }
+
+   return s[0];
+}
+
+static unsigned cheat_manager_get_curr_value(unsigned address,
+      unsigned bytes_per_item)
+{
+   uint8_t s[4];
+   cheat_manager_copy_memory(s, address, bytes_per_item);
+   return cheat_manager_get_value(s, bytes_per_item,
+         cheat_manager_state.big_endian);
+}
+
+/* Item @item in memory, as an address and an
+ * address mask the way cheats store them */
+static unsigned cheat_manager_get_item_address(unsigned item,
+      unsigned bits, unsigned bytes_per_item, unsigned mask,
+      unsigned *address_mask)
+{
+   if (bits < 8)
+   {
+      unsigned items_per_byte = 8 / bits;
+      *address_mask           = mask << ((item % items_per_byte) * bits);
+      return item / items_per_byte;
+   }
+
+   *address_mask = 0xFF;
+   return item * bytes_per_item;
+}
+
+static bool cheat_manager_compare(enum cheat_search_type search_type,
+      unsigned int curr_val, unsigned int prev_val)
+{
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         return (curr_val == cheat_st->search_exact_value);
+      case CHEAT_SEARCH_TYPE_LT:
+         return (curr_val < prev_val);
+      case CHEAT_SEARCH_TYPE_GT:
+         return (curr_val > prev_val);
+      case CHEAT_SEARCH_TYPE_LTE:
+         return (curr_val <= prev_val);
+      case CHEAT_SEARCH_TYPE_GTE:
+         return (curr_val >= prev_val);
+      case CHEAT_SEARCH_TYPE_EQ:
+         return (curr_val == prev_val);
+      case CHEAT_SEARCH_TYPE_NEQ:
+         return (curr_val != prev_val);
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         return (curr_val == prev_val + cheat_st->search_eqplus_value);
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         return (curr_val == prev_val - cheat_st->search_eqminus_value);
+   }
+
+   return false;
+}
+
+/* Searches the @items of a block one by one, @curr and
+ * @prev pointing to the block. Returns the items that
+ * still match. */
+static uint32_t cheat_manager_search_block(
+      enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev, uint32_t items,
+      unsigned bits, unsigned bytes_per_item, unsigned mask)
+{
+   uint32_t matches = items;
+   bool big_endian  = cheat_manager_state.big_endian;
+
+   while (items)
+   {
+      unsigned curr_val, prev_val;
+      unsigned i = compat_ctz(items);
+
+      items     &= items - 1;
+
+      if (bits < 8)
+      {
+         unsigned shift = (i * bits) & 7;
+         curr_val       = (curr[i * bits / 8] >> shift) & mask;
+         prev_val       = (prev[i * bits / 8] >> shift) & mask;
+      }
+      else
+      {
+         curr_val = cheat_manager_get_value(curr + i * bytes_per_item,
+               bytes_per_item, big_endian);
+         prev_val = cheat_manager_get_value(prev + i * bytes_per_item,
+               bytes_per_item, big_endian);
+      }
+
+      if (!cheat_manager_compare(search_type, curr_val, prev_val))
+         matches &= ~(1u << i);
+   }
+
+   return matches;
+}
+
+#if defined(__SSE2__)
+/* 8, 16 and 32-bit items are searched 16 bytes at a time.
+ * The vector functions are inlined into one function per
+ * item size, for that to be constant. SSE2 only compares
+ * signed numbers: the sign bits are flipped to compare
+ * unsigned ones. */
+static INLINE __m128i cheat_manager_set1_sse2(unsigned v, unsigned size)
+{
+   switch (size)
+   {
+      case 1:
+         return _mm_set1_epi8((char)v);
+      case 2:
+         return _mm_set1_epi16((short)v);
+      default:
+         break;
+   }
+   return _mm_set1_epi32((int)v);
+}
+
+static INLINE __m128i cheat_manager_cmpeq_sse2(__m128i a, __m128i b,
+      unsigned size)
+{
+   switch (size)
+   {
+      case 1:
+         return _mm_cmpeq_epi8(a, b);
+      case 2:
+         return _mm_cmpeq_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_cmpeq_epi32(a, b);
+}
+
+/* a > b, unsigned */
+static INLINE __m128i cheat_manager_cmpgt_sse2(__m128i a, __m128i b,
+      unsigned size)
+{
+   __m128i sign = cheat_manager_set1_sse2(1u << (size * 8 - 1), size);
+
+   a            = _mm_xor_si128(a, sign);
+   b            = _mm_xor_si128(b, sign);
+
+   switch (size)
+   {
+      case 1:
+         return _mm_cmpgt_epi8(a, b);
+      case 2:
+         return _mm_cmpgt_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_cmpgt_epi32(a, b);
+}
+
+static INLINE __m128i cheat_manager_add_sse2(__m128i a, __m128i b,
+      unsigned size)
+{
+   switch (size)
+   {
+      case 1:
+         return _mm_add_epi8(a, b);
+      case 2:
+         return _mm_add_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_add_epi32(a, b);
+}
+
+static INLINE __m128i cheat_manager_sub_sse2(__m128i a, __m128i b,
+      unsigned size)
+{
+   switch (size)
+   {
+      case 1:
+         return _mm_sub_epi8(a, b);
+      case 2:
+         return _mm_sub_epi16(a, b);
+      default:
+         break;
+   }
+   return _mm_sub_epi32(a, b);
+}
+
+static INLINE __m128i cheat_manager_bswap_sse2(__m128i x, unsigned size)
+{
+   if (size == 4)
+      x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x,
+               _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+   return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+/* Gives a lane of ones for every item that matches.
+ * Adding to or subtracting from an 8 or 16-bit value
+ * doesn't wrap around, as it does for 32-bit ones. */
+static INLINE __m128i cheat_manager_compare_sse2(
+      enum cheat_search_type search_type,
+      __m128i curr, __m128i prev, unsigned size, unsigned mask)
+{
+   cheat_manager_t *cheat_st = &cheat_manager_state;
+   const __m128i ones        = _mm_set1_epi32(-1);
+   unsigned value;
+
+   switch (search_type)
+   {
+      case CHEAT_SEARCH_TYPE_EXACT:
+         value = cheat_st->search_exact_value;
+         if (value > mask)
+            break;
+         return cheat_manager_cmpeq_sse2(curr,
+               cheat_manager_set1_sse2(value, size), size);
+      case CHEAT_SEARCH_TYPE_LT:
+         return cheat_manager_cmpgt_sse2(prev, curr, size);
+      case CHEAT_SEARCH_TYPE_GT:
+         return cheat_manager_cmpgt_sse2(curr, prev, size);
+      case CHEAT_SEARCH_TYPE_LTE:
+         return _mm_xor_si128(cheat_manager_cmpgt_sse2(curr, prev, size), ones);
+      case CHEAT_SEARCH_TYPE_GTE:
+         return _mm_xor_si128(cheat_manager_cmpgt_sse2(prev, curr, size), ones);
+      case CHEAT_SEARCH_TYPE_EQ:
+         return cheat_manager_cmpeq_sse2(curr, prev, size);
+      case CHEAT_SEARCH_TYPE_NEQ:
+         return _mm_xor_si128(cheat_manager_cmpeq_sse2(curr, prev, size), ones);
+      case CHEAT_SEARCH_TYPE_EQPLUS:
+         {
+            __m128i match;
+
+            value = cheat_st->search_eqplus_value;
+            if (value > mask)
+               break;
+            match = cheat_manager_cmpeq_sse2(curr, cheat_manager_add_sse2(
+                     prev, cheat_manager_set1_sse2(value, size), size), size);
+            if (size == 4)
+               return match;
+            return _mm_andnot_si128(cheat_manager_cmpgt_sse2(prev,
+                     cheat_manager_set1_sse2(mask - value, size), size), match);
+         }
+      case CHEAT_SEARCH_TYPE_EQMINUS:
+         {
+            __m128i match;
+
+            value = cheat_st->search_eqminus_value;
+            if (value > mask)
+               break;
+            match = cheat_manager_cmpeq_sse2(curr, cheat_manager_sub_sse2(
+                     prev, cheat_manager_set1_sse2(value, size), size), size);
+            if (size == 4)
+               return match;
+            return _mm_andnot_si128(cheat_manager_cmpgt_sse2(
+                     cheat_manager_set1_sse2(value, size), prev, size), match);
+         }
+   }
+
+   return _mm_setzero_si128();
+}
+
+static INLINE __attribute__((always_inline))
+uint32_t cheat_manager_search_block_sse2(
+      enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev, unsigned size)
+{
+   unsigned i;
+   uint32_t matches            = 0;
+   unsigned items_per_vector   = 16 / size;
+   unsigned mask               = (size == 4) ? 0xFFFFFFFF
+      : (1u << (size * 8)) - 1;
+   bool big_endian             = cheat_manager_state.big_endian;
+
+   for (i = 0; i < CHEAT_SEARCH_BLOCK_ITEMS / items_per_vector; i++)
+   {
+      uint32_t bits;
+      __m128i c = _mm_loadu_si128((const __m128i*)(curr + i * 16));
+      __m128i p = _mm_loadu_si128((const __m128i*)(prev + i * 16));
+
+      if (big_endian && size > 1)
+      {
+         c = cheat_manager_bswap_sse2(c, size);
+         p = cheat_manager_bswap_sse2(p, size);
+      }
+
+      c = cheat_manager_compare_sse2(search_type, c, p, size, mask);
+
+      switch (size)
+      {
+         case 1:
+            bits = (uint32_t)_mm_movemask_epi8(c);
+            break;
+         case 2:
+            bits = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(c, c)) & 0xFF;
+            break;
+         default:
+            bits = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(c));
+            break;
+      }
+
+      matches |= bits << (i * items_per_vector);
+   }
+
+   return matches;
+}
+
+static uint32_t cheat_manager_search_block_8_sse2(
+      enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_manager_search_block_sse2(search_type, curr, prev, 1);
+}
+
+static uint32_t cheat_manager_search_block_16_sse2(
+      enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_manager_search_block_sse2(search_type, curr, prev, 2);
+}
+
+static uint32_t cheat_manager_search_block_32_sse2(
+      enum cheat_search_type search_type,
+      const uint8_t *curr, const uint8_t *prev)
+{
+   return cheat_manager_search_block_sse2(search_type, curr, prev, 4);
+}
+#endif
+
 static int cheat_manager_search(enum cheat_search_type search_type)
 {
    char msg[100];
+   uint8_t curr_block[CHEAT_SEARCH_BLOCK_SIZE];
+   uint8_t prev_block[CHEAT_SEARCH_BLOCK_SIZE];
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char *curr         = cheat_st->curr_memory_buf;
-   unsigned char *prev         = cheat_st->prev_memory_buf;
-   unsigned int idx            = 0;
-   unsigned int curr_val       = 0;
-   unsigned int prev_val       = 0;
    unsigned int mask           = 0;
    unsigned int bytes_per_item = 1;
    unsigned int bits           = 8;
    unsigned int offset         = 0;
-   unsigned int i              = 0;
+   unsigned int buf_idx        = 0;
+   unsigned int buf_offset     = 0;
+   unsigned int num_matches    = 0;
+   unsigned int block_size;
+   unsigned int num_words;
+   unsigned int i;
    bool refresh                = false;
 
-   if (cheat_st->num_memory_buffers == 0)
+   if (cheat_st->num_memory_buffers == 0 || !cheat_st->matches)
    {
       runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_NOT_INITIALIZED), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
       return 0;
@@ -1017,98 +1449,70 @@ static int cheat_manager_search(enum cheat_search_type search_type)
 
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-   /* little endian FF000000 = 256 */
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   block_size = CHEAT_SEARCH_BLOCK_ITEMS * bits * bytes_per_item / 8;
+   num_words  = (cheat_manager_get_num_items(bits, bytes_per_item)
+         + CHEAT_SEARCH_BLOCK_ITEMS - 1) / CHEAT_SEARCH_BLOCK_ITEMS;
+
+   for (i = 0; i < num_words; i++)
    {
-      unsigned byte_part;
+      const uint8_t *curr;
+      const uint8_t *prev;
+      uint32_t items   = cheat_st->matches[i];
+      unsigned address = i * block_size;
 
-      offset = translate_address(idx, &curr);
+      if (!items)
+         continue;
 
-      switch (bytes_per_item)
+      while (address >= buf_offset + cheat_st->memory_size_list[buf_idx])
+         buf_offset   += cheat_st->memory_size_list[buf_idx++];
+
+      if (address + block_size <= buf_offset
+            + cheat_st->memory_size_list[buf_idx])
       {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256) + *(prev + idx + 1) :
-               *(prev + idx) + (*(prev + idx + 1) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            prev_val = cheat_st->big_endian ?
-               (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-               *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            prev_val = *(prev + idx);
-            break;
+         curr = cheat_st->memory_buf_list[buf_idx] + address - buf_offset;
+         prev = cheat_st->prev_memory_buf + address;
       }
-
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      else
       {
-         unsigned int curr_subval = (curr_val >> (byte_part * bits)) & mask;
-         unsigned int prev_subval = (prev_val >> (byte_part * bits)) & mask;
-         unsigned int prev_match;
-
-         if (bits < 8)
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-         else
-            prev_match = *(cheat_st->matches + idx);
+         /* The block runs into the next memory
+          * buffer, or past the end of memory */
+         unsigned len = MIN(block_size,
+               cheat_st->total_memory_size - address);
+
+         cheat_manager_copy_memory(curr_block, address, block_size);
+         memcpy(prev_block, cheat_st->prev_memory_buf + address, len);
+         memset(prev_block + len, 0, block_size - len);
+         curr = curr_block;
+         prev = prev_block;
+      }
 
-         if (prev_match > 0)
+#if defined(__SSE2__)
+      if (bits == 8 && compat_popcount(items) > CHEAT_SEARCH_SPARSE_ITEMS)
+      {
+         switch (bytes_per_item)
          {
-            bool match = false;
-            switch (search_type)
-            {
-               case CHEAT_SEARCH_TYPE_EXACT:
-                  match = (curr_subval == cheat_st->search_exact_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_LT:
-                  match = (curr_subval < prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GT:
-                  match = (curr_subval > prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_LTE:
-                  match = (curr_subval <= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_GTE:
-                  match = (curr_subval >= prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQ:
-                  match = (curr_subval == prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_NEQ:
-                  match = (curr_subval != prev_subval);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQPLUS:
-                  match = (curr_subval == prev_subval + cheat_st->search_eqplus_value);
-                  break;
-               case CHEAT_SEARCH_TYPE_EQMINUS:
-                  match = (curr_subval == prev_subval - cheat_st->search_eqminus_value);
-                  break;
-            }
-
-            if (!match)
-            {
-               if (bits < 8)
-                  *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                     ((~(mask << (byte_part * bits))) & 0xFF);
-               else
-                  memset(cheat_st->matches + idx, 0, bytes_per_item);
-               if (cheat_st->num_matches > 0)
-                  cheat_st->num_matches--;
-            }
+            case 2:
+               items &= cheat_manager_search_block_16_sse2(search_type, curr, prev);
+               break;
+            case 4:
+               items &= cheat_manager_search_block_32_sse2(search_type, curr, prev);
+               break;
+            case 1:
+            default:
+               items &= cheat_manager_search_block_8_sse2(search_type, curr, prev);
+               break;
          }
       }
+      else
+#endif
+         items = cheat_manager_search_block(search_type, curr, prev, items,
+               bits, bytes_per_item, mask);
+
+      cheat_st->matches[i] = items;
+      num_matches         += compat_popcount(items);
    }
 
-   offset = 0;
+   cheat_st->num_matches = num_matches;
 
    for (i = 0; i < cheat_st->num_memory_buffers; i++)
    {
@@ -1202,16 +1606,12 @@ int cheat_manager_add_matches(const char *path,
 {
    char msg[100];
    bool                refresh = false;
-   unsigned          byte_part = 0;
    unsigned            int idx = 0;
    unsigned           int mask = 0;
    unsigned int bytes_per_item = 1;
    unsigned           int bits = 8;
-   unsigned       int curr_val = 0;
-   unsigned      int num_added = 0;
-   unsigned         int offset = 0;
+   unsigned      int num_words = 0;
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char         *curr = cheat_st->curr_memory_buf;
 
    if (cheat_st->num_matches + cheat_st->size > 100)
    {
@@ -1220,60 +1620,30 @@ int cheat_manager_add_matches(const char *path,
    }
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
-   for (idx = 0; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
+   if (cheat_st->matches)
+      num_words = (cheat_manager_get_num_items(bits, bytes_per_item)
+            + CHEAT_SEARCH_BLOCK_ITEMS - 1) / CHEAT_SEARCH_BLOCK_ITEMS;
+
+   for (idx = 0; idx < num_words; idx++)
    {
-      offset = translate_address(idx, &curr);
+      uint32_t items = cheat_st->matches[idx];
 
-      switch (bytes_per_item)
-      {
-         case 2:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-            break;
-         case 4:
-            curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-            break;
-         case 1:
-         default:
-            curr_val = *(curr - offset + idx);
-            break;
-      }
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+      while (items)
       {
-         unsigned int prev_match;
+         unsigned address_mask;
+         unsigned address = cheat_manager_get_item_address(
+               idx * CHEAT_SEARCH_BLOCK_ITEMS + compat_ctz(items),
+               bits, bytes_per_item, mask, &address_mask);
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, (mask << (byte_part * bits)),
-                        cheat_st->big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                  return 0;
-               }
-               num_added++;
-            }
-         }
-         else
+         items &= items - 1;
+
+         if (!cheat_manager_add_new_code(cheat_st->search_bit_size,
+                  address, address_mask, cheat_st->big_endian,
+                  cheat_manager_get_curr_value(address, bytes_per_item)))
          {
-            prev_match = *(cheat_st->matches + idx);
-            if (prev_match)
-            {
-               if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, 0xFF,
-                        cheat_st->big_endian, curr_val))
-               {
-                  runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                  return 0;
-               }
-               num_added++;
-            }
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADDED_MATCHES_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            return 0;
          }
-
       }
    }
 
@@ -1577,17 +1947,12 @@ void cheat_manager_apply_retro_cheats(void)
 void cheat_manager_match_action(enum cheat_match_action_type match_action, unsigned int target_match_idx, unsigned int *address, unsigned int *address_mask,
       unsigned int *prev_value, unsigned int *curr_value)
 {
-   unsigned int byte_part;
    unsigned int idx;
-   unsigned int start_idx;
+   unsigned int num_words;
    unsigned int           mask = 0;
    unsigned int bytes_per_item = 1;
    unsigned int           bits = 8;
-   unsigned int       curr_val = 0;
-   unsigned int       prev_val = 0;
-   unsigned int         offset = 0;
    cheat_manager_t   *cheat_st = &cheat_manager_state;
-   unsigned char         *curr = cheat_st->curr_memory_buf;
    unsigned char         *prev = cheat_st->prev_memory_buf;
    unsigned int curr_match_idx = 0;
 
@@ -1600,137 +1965,75 @@ void cheat_manager_match_action(enum cheat_match_action_type match_action, unsig
    cheat_manager_setup_search_meta(cheat_st->search_bit_size, &bytes_per_item, &mask, &bits);
 
    if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      start_idx = *address;
-   else
-      start_idx = 0;
-
-   for (idx = start_idx; idx < cheat_st->total_memory_size; idx = idx + bytes_per_item)
    {
-      offset = translate_address(idx, &curr);
-
-      switch (bytes_per_item)
+      if (*address < cheat_st->total_memory_size)
       {
-      case 2:
-         curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256) + *(curr + idx + 1 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256);
-         if (prev)
-            prev_val = cheat_st->big_endian ?
-                  (*(prev + idx) * 256) + *(prev + idx + 1) :
-                  *(prev + idx) + (*(prev + idx + 1) * 256);
-         break;
-      case 4:
-         curr_val = cheat_st->big_endian ?
-               (*(curr + idx - offset) * 256 * 256 * 256) + (*(curr + idx + 1 - offset) * 256 * 256) + (*(curr + idx + 2 - offset) * 256) + *(curr + idx + 3 - offset) :
-               *(curr + idx - offset) + (*(curr + idx + 1 - offset) * 256) + (*(curr + idx + 2 - offset) * 256 * 256) + (*(curr + idx + 3 - offset) * 256 * 256 * 256);
-         if (prev)
-            prev_val = cheat_st->big_endian ?
-                  (*(prev + idx) * 256 * 256 * 256) + (*(prev + idx + 1) * 256 * 256) + (*(prev + idx + 2) * 256) + *(prev + idx + 3) :
-                  *(prev + idx) + (*(prev + idx + 1) * 256) + (*(prev + idx + 2) * 256 * 256) + (*(prev + idx + 3) * 256 * 256 * 256);
-         break;
-      case 1:
-      default:
-         curr_val = *(curr + idx - offset);
-         if (prev)
-            prev_val = *(prev + idx);
-         break;
+         *curr_value = cheat_manager_get_curr_value(*address, bytes_per_item);
+         *prev_value = 0;
+         if (prev && *address + bytes_per_item <= cheat_st->total_memory_size)
+            *prev_value = cheat_manager_get_value(prev + *address,
+                  bytes_per_item, cheat_st->big_endian);
       }
+      return;
+   }
 
-      if (match_action == CHEAT_MATCH_ACTION_TYPE_BROWSE)
-      {
-         *curr_value = curr_val;
-         *prev_value = prev_val;
-         return;
-      }
+   if (!prev || !cheat_st->matches)
+      return;
 
-      if (!prev)
-         return;
+   num_words = (cheat_manager_get_num_items(bits, bytes_per_item)
+         + CHEAT_SEARCH_BLOCK_ITEMS - 1) / CHEAT_SEARCH_BLOCK_ITEMS;
 
-      for (byte_part = 0; byte_part < 8 / bits; byte_part++)
+   for (idx = 0; idx < num_words; idx++)
+   {
+      unsigned item;
+      unsigned item_address;
+      unsigned item_address_mask;
+      unsigned curr_val;
+      uint32_t items = cheat_st->matches[idx];
+      unsigned count = compat_popcount(items);
+
+      /* Whole words of matches are skipped */
+      if (curr_match_idx + count <= target_match_idx)
       {
-         unsigned int prev_match;
+         curr_match_idx += count;
+         continue;
+      }
 
-         if (bits < 8)
-         {
-            prev_match = *(cheat_st->matches + idx) & (mask << (byte_part * bits));
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                  case CHEAT_MATCH_ACTION_TYPE_BROWSE:
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_VIEW:
-                     *address = idx;
-                     *address_mask = (mask << (byte_part * bits));
-                     *curr_value = curr_val;
-                     *prev_value = prev_val;
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_COPY:
-                     if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, (mask << (byte_part * bits)),
-                           cheat_st->big_endian, curr_val))
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     else
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_DELETE:
-                     if (bits < 8)
-                        *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                              ((~(mask << (byte_part * bits))) & 0xFF);
-                     else
-                        memset(cheat_st->matches + idx, 0, bytes_per_item);
-                     if (cheat_st->num_matches > 0)
-                        cheat_st->num_matches--;
-                     runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  }
-                  return;
-               }
-               curr_match_idx++;
-            }
-         }
-         else
-         {
-            prev_match = *(cheat_st->matches + idx);
-            if (prev_match)
-            {
-               if (target_match_idx == curr_match_idx)
-               {
-                  switch (match_action)
-                  {
-                  case CHEAT_MATCH_ACTION_TYPE_BROWSE:
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_VIEW:
-                     *address = idx;
-                     *address_mask = 0xFF;
-                     *curr_value = curr_val;
-                     *prev_value = prev_val;
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_COPY:
-                     if (!cheat_manager_add_new_code(cheat_st->search_bit_size, idx, 0xFF,
-                           cheat_st->big_endian, curr_val))
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     else
-                        runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  case CHEAT_MATCH_ACTION_TYPE_DELETE:
-                     if (bits < 8)
-                        *(cheat_st->matches + idx) = *(cheat_st->matches + idx) &
-                              ((~(mask << (byte_part * bits))) & 0xFF);
-                     else
-                        memset(cheat_st->matches + idx, 0, bytes_per_item);
-                     if (cheat_st->num_matches > 0)
-                        cheat_st->num_matches--;
-                     runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
-                     return;
-                  }
-               }
+      for (; curr_match_idx < target_match_idx; curr_match_idx++)
+         items &= items - 1;
 
-               curr_match_idx++;
-            }
-         }
+      item         = compat_ctz(items);
+      item_address = cheat_manager_get_item_address(
+            idx * CHEAT_SEARCH_BLOCK_ITEMS + item,
+            bits, bytes_per_item, mask, &item_address_mask);
+      curr_val     = cheat_manager_get_curr_value(item_address, bytes_per_item);
+
+      switch (match_action)
+      {
+         case CHEAT_MATCH_ACTION_TYPE_VIEW:
+            *address      = item_address;
+            *address_mask = item_address_mask;
+            *curr_value   = curr_val;
+            *prev_value   = cheat_manager_get_value(prev + item_address,
+                  bytes_per_item, cheat_st->big_endian);
+            break;
+         case CHEAT_MATCH_ACTION_TYPE_COPY:
+            if (!cheat_manager_add_new_code(cheat_st->search_bit_size, item_address, item_address_mask,
+                     cheat_st->big_endian, curr_val))
+               runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_FAIL), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            else
+               runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_ADD_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            break;
+         case CHEAT_MATCH_ACTION_TYPE_DELETE:
+            cheat_st->matches[idx] &= ~(1u << item);
+            if (cheat_st->num_matches > 0)
+               cheat_st->num_matches--;
+            runloop_msg_queue_push(msg_hash_to_str(MSG_CHEAT_SEARCH_DELETE_MATCH_SUCCESS), 1, 180, true, NULL, MESSAGE_QUEUE_ICON_DEFAULT, MESSAGE_QUEUE_CATEGORY_INFO);
+            break;
+         default:
+            break;
       }
+      return;
    }
 }
 
@@ -161,7 +161,10 @@ struct cheat_manager
    struct item_cheat *cheats;
    uint8_t *curr_memory_buf;
    uint8_t *prev_memory_buf;
-   uint8_t *matches;
+   /* One bit per item still matching the search, items
+    * being as big as the search size; see
+    * cheat_manager_setup_search_meta() */
+   uint32_t *matches;
    uint8_t **memory_buf_list;
    unsigned *memory_size_list;
    unsigned int delete_state;
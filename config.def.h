@@ -1026,6 +1026,19 @@ static const bool audio_enable_menu_bgm    = false;
 /* The amount of MB to increase/decrease the rewind_buffer_size when it is changed via the UI. */
 #define DEFAULT_REWIND_BUFFER_SIZE_STEP 10 /* 10MB */
 
+/* Frames that drop out of the rewind buffer get compressed
+ * into a second buffer of this size, instead of being lost.
+ * 0 disables it. */
+#define DEFAULT_REWIND_COLD_BUFFER_SIZE 0
+
+/* Keep the compressed rewind buffer in a memory mapped scratch
+ * file in the cache directory rather than in RAM. */
+#define DEFAULT_REWIND_COLD_BUFFER_TO_DISK false
+
+/* Hash the savestate in pages and only diff the pages
+ * that changed since the previous rewind frame. */
+#define DEFAULT_REWIND_DIRTY_PAGES false
+
 /* How many frames to rewind at a time. */
 #define DEFAULT_REWIND_GRANULARITY 1
 
@@ -1071,6 +1084,11 @@ static const unsigned netplay_delay_frames = 16;
 
 static const int netplay_check_frames = 600;
 
+/* Longest a netplay replay may take each frame, in milliseconds.
+ * Replays that would take longer are spread over several frames.
+ * 0 disables the limit. */
+#define DEFAULT_NETPLAY_REPLAY_BUDGET 0
+
 static const bool netplay_use_mitm_server = false;
 
 #define DEFAULT_NETPLAY_MITM_SERVER "nyc"
@@ -1201,6 +1219,15 @@ static const int default_content_favorites_size = 200;
 
 #define DEFAULT_SCAN_WITHOUT_CORE_MATCH false
 
+/* Remember checksums and database matches of scanned
+ * files, so rescans skip files that didn't change */
+#define DEFAULT_SCAN_CACHE_ENABLE true
+
+/* Number of files read and hashed at the same time
+ * while scanning content. 0 picks one per CPU core,
+ * up to 4; 1 scans one file at a time. */
+#define DEFAULT_SCAN_THREADS 0
+
 #ifdef __WINRT__
 /* Be paranoid about WinRT file I/O performance, and leave this disabled by
  * default */
@@ -88,6 +88,7 @@ typedef struct settings
    {
       size_t placeholder;
       size_t rewind_buffer_size;
+      size_t rewind_cold_buffer_size;
    } sizes;
 
    video_viewport_t video_viewport_custom; /* int alignment */
@@ -168,11 +169,13 @@ typedef struct settings
       unsigned netplay_port;
       unsigned netplay_input_latency_frames_min;
       unsigned netplay_input_latency_frames_range;
+      unsigned netplay_replay_budget;
       unsigned netplay_share_digital;
       unsigned netplay_share_analog;
       unsigned bundle_assets_extract_version_current;
       unsigned bundle_assets_extract_last_version;
       unsigned content_history_size;
+      unsigned scan_threads;
       unsigned frontend_log_level;
       unsigned libretro_log_level;
       unsigned rewind_granularity;
@@ -769,6 +772,8 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_cold_buffer_to_disk;
+      bool rewind_dirty_pages;
       bool vrr_runloop_enable;
       bool apply_cheats_after_toggle;
       bool apply_cheats_after_load;
@@ -846,6 +851,7 @@ typedef struct settings
       bool log_to_file_timestamp;
 
       bool scan_without_core_match;
+      bool scan_cache_enable;
 
       bool ai_service_enable;
       bool ai_service_pause;
@@ -21,15 +21,26 @@
 #include <file/config_file.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
-#include <streams/interface_stream.h>
-#include <formats/rjson.h>
 #include <lists/dir_list.h>
 #include <file/archive_file.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifdef HAVE_MMAP
+#include <memmap.h>
+#ifdef HAVE_MMAN
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#endif
+
 #include "retroarch.h"
 #include "verbosity.h"
 
@@ -48,392 +59,70 @@
 /* Core Info Cache START */
 /*************************/
 
-#define CORE_INFO_CACHE_DEFAULT_CAPACITY 8
+/* The info cache is a flat binary file, memory-mapped
+ * where possible:
+ *
+ *   "RCIC" | version | entry count | entries
+ *
+ * Each entry holds its size, its flags, its 'hot' strings
+ * (identity, extensions, databases, required hw api) and
+ * then a size-prefixed 'cold' block (authors, permissions,
+ * licenses, categories, notes, description, firmware).
+ * Strings are stored as a length, the characters and a
+ * terminating NUL - a length of CORE_INFO_CACHE_NULL_STRING
+ * marks a NULL string.
+ *
+ * Only the hot strings are decoded when the cache is read.
+ * Cold blocks stay in the cache file until an entry is
+ * looked up (see core_info_resolve_cold_fields()), which
+ * most entries never are. */
 
-/* TODO/FIXME: Apparently rzip compression is an issue on UWP */
-#if defined(HAVE_ZLIB) && !(defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP)
-#define CORE_INFO_CACHE_COMPRESS
-#endif
+#define CORE_INFO_CACHE_MAGIC       "RCIC"
+#define CORE_INFO_CACHE_VERSION     1
+#define CORE_INFO_CACHE_NULL_STRING 0xFFFFFFFF
+
+#define CORE_INFO_CACHE_FLAG_HAS_INFO                      (1 << 0)
+#define CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME              (1 << 1)
+#define CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER (1 << 2)
+#define CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL               (1 << 3)
+
+struct core_info_cache_file
+{
+   uint8_t *data;
+   size_t size;
+   bool mapped;
+};
+
+typedef struct core_info_cache_file core_info_cache_file_t;
 
 typedef struct
 {
    core_info_t *items;
+   core_info_cache_file_t *file;
    size_t length;
-   size_t capacity;
    bool refresh;
 } core_info_cache_list_t;
 
 typedef struct
 {
-   core_info_t *core_info;
-   core_info_cache_list_t *core_info_cache_list;
-   char **current_string_val;
-   struct string_list **current_string_list_val;
-   uint32_t *current_entry_uint_val;
-   bool *current_entry_bool_val;
-   unsigned array_depth;
-   unsigned object_depth;
-   bool to_core_file_id;
-   bool to_firmware;
-} CCJSONContext;
+   const uint8_t *data;
+   const uint8_t *end;
+} core_info_cache_reader_t;
+
+typedef struct
+{
+   uint8_t *data;
+   size_t size;
+   size_t capacity;
+   bool error;
+} core_info_cache_writer_t;
 
 /* Forward declarations */
 static void core_info_free(core_info_t* info);
 static uint32_t core_info_hash_string(const char *str);
-static core_info_cache_list_t *core_info_cache_list_new(void);
-static void core_info_cache_add(core_info_cache_list_t *list, core_info_t *info,
-      bool transfer);
-
-/* JSON Handlers START */
-
-static bool CCJSONObjectMemberHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_string_list_val = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-      pCtx->to_core_file_id         = false;
-      pCtx->to_firmware             = false;
-
-      switch (pValue[0])
-      {
-         case 'a':
-            if (string_is_equal(pValue,      "authors"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->authors;
-               pCtx->current_string_list_val = &pCtx->core_info->authors_list;
-            }
-            break;
-         case 'c':
-            if (string_is_equal(pValue,      "categories"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->categories;
-               pCtx->current_string_list_val = &pCtx->core_info->categories_list;
-            }
-            else if (string_is_equal(pValue, "core_name"))
-               pCtx->current_string_val      = &pCtx->core_info->core_name;
-            else if (string_is_equal(pValue, "core_file_id"))
-               pCtx->to_core_file_id         = true;
-            break;
-         case 'd':
-            if (string_is_equal(pValue,      "display_name"))
-               pCtx->current_string_val      = &pCtx->core_info->display_name;
-            else if (string_is_equal(pValue, "display_version"))
-               pCtx->current_string_val      = &pCtx->core_info->display_version;
-            else if (string_is_equal(pValue, "databases"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->databases;
-               pCtx->current_string_list_val = &pCtx->core_info->databases_list;
-            }
-            else if (string_is_equal(pValue, "description"))
-               pCtx->current_string_val      = &pCtx->core_info->description;
-            else if (string_is_equal(pValue, "database_match_archive_member"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->database_match_archive_member;
-            break;
-         case 'f':
-            if (string_is_equal(pValue,      "firmware"))
-               pCtx->to_firmware             = true;
-            break;
-         case 'h':
-            if (string_is_equal(pValue,      "has_info"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->has_info;
-            break;
-         case 'l':
-            if (string_is_equal(pValue,      "licenses"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->licenses;
-               pCtx->current_string_list_val = &pCtx->core_info->licenses_list;
-            }
-            else if (string_is_equal(pValue, "is_experimental"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->is_experimental;
-            break;
-         case 'n':
-            if (string_is_equal(pValue,      "notes"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->notes;
-               pCtx->current_string_list_val = &pCtx->core_info->note_list;
-            }
-            break;
-         case 'p':
-            if (string_is_equal(pValue,      "path"))
-               pCtx->current_string_val      = &pCtx->core_info->path;
-            else if (string_is_equal(pValue, "permissions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->permissions;
-               pCtx->current_string_list_val = &pCtx->core_info->permissions_list;
-            }
-            break;
-         case 'r':
-            if (string_is_equal(pValue,      "required_hw_api"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->required_hw_api;
-               pCtx->current_string_list_val = &pCtx->core_info->required_hw_api_list;
-            }
-            break;
-         case 's':
-            if (string_is_equal(pValue,      "system_manufacturer"))
-               pCtx->current_string_val      = &pCtx->core_info->system_manufacturer;
-            else if (string_is_equal(pValue, "systemname"))
-               pCtx->current_string_val      = &pCtx->core_info->systemname;
-            else if (string_is_equal(pValue, "system_id"))
-               pCtx->current_string_val      = &pCtx->core_info->system_id;
-            else if (string_is_equal(pValue, "supported_extensions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->supported_extensions;
-               pCtx->current_string_list_val = &pCtx->core_info->supported_extensions_list;
-            }
-            else if (string_is_equal(pValue, "supports_no_game"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->supports_no_game;
-            break;
-      }
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 1) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-
-      if (pCtx->to_core_file_id)
-      {
-         if (string_is_equal(pValue,         "str"))
-            pCtx->current_string_val         = &pCtx->core_info->core_file_id.str;
-         else if (string_is_equal(pValue,    "hash"))
-            pCtx->current_entry_uint_val     = &pCtx->core_info->core_file_id.hash;
-      }
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 2) && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-
-      if (pCtx->to_firmware && (pCtx->core_info->firmware_count > 0))
-      {
-         size_t firmware_idx = pCtx->core_info->firmware_count - 1;
-
-         if (string_is_equal(pValue,         "path"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].path;
-         else if (string_is_equal(pValue,    "desc"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].desc;
-         else if (string_is_equal(pValue,    "optional"))
-            pCtx->current_entry_bool_val     = &pCtx->core_info->firmware[firmware_idx].optional;
-      }
-   }
-
-   return true;
-}
-
-static bool CCJSONStringHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (pCtx->current_string_val && length && !string_is_empty(pValue))
-   {
-      if (*pCtx->current_string_val)
-         free(*pCtx->current_string_val);
-      *pCtx->current_string_val = strdup(pValue);
-
-      if (pCtx->current_string_list_val)
-      {
-         if (*pCtx->current_string_list_val)
-            string_list_free(*pCtx->current_string_list_val);
-         *pCtx->current_string_list_val = string_split(*pCtx->current_string_val, "|");
-      }
-   }
-
-   pCtx->current_string_val      = NULL;
-   pCtx->current_string_list_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONNumberHandler(void *context, const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (pCtx->current_entry_uint_val)
-      *pCtx->current_entry_uint_val = string_to_unsigned(pValue);
-
-   pCtx->current_entry_uint_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONBoolHandler(void *context, bool value)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if (pCtx->current_entry_bool_val)
-      *pCtx->current_entry_bool_val = value;
-
-   pCtx->current_entry_bool_val = NULL;
-
-   return true;
-}
-
-static bool CCJSONStartObjectHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   pCtx->object_depth++;
-
-   if ((pCtx->object_depth == 1) && (pCtx->array_depth == 0))
-   {
-      if (pCtx->core_info_cache_list)
-         return false;
-
-      pCtx->core_info_cache_list = core_info_cache_list_new();
-      if (!pCtx->core_info_cache_list)
-         return false;
-   }
-   else if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1))
-   {
-      if (pCtx->core_info)
-      {
-         core_info_free(pCtx->core_info);
-         free(pCtx->core_info);
-         pCtx->core_info = NULL;
-      }
-
-      pCtx->core_info = (core_info_t*)calloc(1, sizeof(core_info_t));
-      if (!pCtx->core_info)
-         return false;
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 2))
-   {
-      if (pCtx->to_firmware)
-      {
-         size_t new_idx                     = pCtx->core_info->firmware_count;
-         core_info_firmware_t *firmware_tmp = (core_info_firmware_t*)
-               realloc(pCtx->core_info->firmware,
-                     (pCtx->core_info->firmware_count + 1) * sizeof(core_info_firmware_t));
 
-         if (!firmware_tmp)
-            return false;
-
-         firmware_tmp[new_idx].path     = NULL;
-         firmware_tmp[new_idx].desc     = NULL;
-         firmware_tmp[new_idx].missing  = false;
-         firmware_tmp[new_idx].optional = false;
-
-         pCtx->core_info->firmware      = firmware_tmp;
-         pCtx->core_info->firmware_count++;
-      }
-   }
-
-   return true;
-}
-
-static bool CCJSONEndObjectHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 1) && pCtx->core_info)
-   {
-      core_info_cache_add(pCtx->core_info_cache_list, pCtx->core_info, true);
-      free(pCtx->core_info);
-      pCtx->core_info = NULL;
-   }
-   else if ((pCtx->object_depth == 3) && (pCtx->array_depth == 1))
-      pCtx->to_core_file_id = false;
-
-   retro_assert(pCtx->object_depth > 0);
-   pCtx->object_depth--;
-
-   return true;
-}
-
-static bool CCJSONStartArrayHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-   pCtx->array_depth++;
-   return true;
-}
-
-static bool CCJSONEndArrayHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 2))
-      pCtx->to_firmware = false;
-
-   retro_assert(pCtx->array_depth > 0);
-   pCtx->array_depth--;
-
-   return true;
-}
-
-/* JSON Handlers END */
-
-/* Note: 'dst' must be zero initialised, or memory
- * leaks will occur */
-static void core_info_copy(core_info_t *src, core_info_t *dst)
-{
-   dst->path                      = src->path                 ? strdup(src->path)                 : NULL;
-   dst->display_name              = src->display_name         ? strdup(src->display_name)         : NULL;
-   dst->display_version           = src->display_version      ? strdup(src->display_version)      : NULL;
-   dst->core_name                 = src->core_name            ? strdup(src->core_name)            : NULL;
-   dst->system_manufacturer       = src->system_manufacturer  ? strdup(src->system_manufacturer)  : NULL;
-   dst->systemname                = src->systemname           ? strdup(src->systemname)           : NULL;
-   dst->system_id                 = src->system_id            ? strdup(src->system_id)            : NULL;
-   dst->supported_extensions      = src->supported_extensions ? strdup(src->supported_extensions) : NULL;
-   dst->authors                   = src->authors              ? strdup(src->authors)              : NULL;
-   dst->permissions               = src->permissions          ? strdup(src->permissions)          : NULL;
-   dst->licenses                  = src->licenses             ? strdup(src->licenses)             : NULL;
-   dst->categories                = src->categories           ? strdup(src->categories)           : NULL;
-   dst->databases                 = src->databases            ? strdup(src->databases)            : NULL;
-   dst->notes                     = src->notes                ? strdup(src->notes)                : NULL;
-   dst->required_hw_api           = src->required_hw_api      ? strdup(src->required_hw_api)      : NULL;
-   dst->description               = src->description          ? strdup(src->description)          : NULL;
-
-   dst->categories_list           = src->categories_list           ? string_list_clone(src->categories_list)           : NULL;
-   dst->databases_list            = src->databases_list            ? string_list_clone(src->databases_list)            : NULL;
-   dst->note_list                 = src->note_list                 ? string_list_clone(src->note_list)                 : NULL;
-   dst->supported_extensions_list = src->supported_extensions_list ? string_list_clone(src->supported_extensions_list) : NULL;
-   dst->authors_list              = src->authors_list              ? string_list_clone(src->authors_list)              : NULL;
-   dst->permissions_list          = src->permissions_list          ? string_list_clone(src->permissions_list)          : NULL;
-   dst->licenses_list             = src->licenses_list             ? string_list_clone(src->licenses_list)             : NULL;
-   dst->required_hw_api_list      = src->required_hw_api_list      ? string_list_clone(src->required_hw_api_list)      : NULL;
-
-   if (src->firmware_count > 0)
-   {
-      dst->firmware = (core_info_firmware_t*)calloc(src->firmware_count,
-            sizeof(core_info_firmware_t));
-
-      if (dst->firmware)
-      {
-         size_t i;
-
-         dst->firmware_count = src->firmware_count;
-
-         for (i = 0; i < src->firmware_count; i++)
-         {
-            dst->firmware[i].path     = src->firmware[i].path ? strdup(src->firmware[i].path) : NULL;
-            dst->firmware[i].desc     = src->firmware[i].desc ? strdup(src->firmware[i].desc) : NULL;
-            dst->firmware[i].missing  = src->firmware[i].missing;
-            dst->firmware[i].optional = src->firmware[i].optional;
-         }
-      }
-      else
-         dst->firmware_count = 0;
-   }
-
-   dst->core_file_id.str  = src->core_file_id.str ? strdup(src->core_file_id.str) : NULL;
-   dst->core_file_id.hash = src->core_file_id.hash;
-
-   dst->has_info                      = src->has_info;
-   dst->supports_no_game              = src->supports_no_game;
-   dst->database_match_archive_member = src->database_match_archive_member;
-   dst->is_experimental               = src->is_experimental;
-   dst->is_locked                     = src->is_locked;
-   dst->is_installed                  = src->is_installed;
-}
-
-/* Like core_info_copy, but transfers 'ownership'
- * of internal objects/data structures from 'src'
- * to 'dst' */
+/* Transfers 'ownership' of internal objects/data
+ * structures from 'src' to 'dst' */
 static void core_info_transfer(core_info_t *src, core_info_t *dst)
 {
    dst->path                      = src->path;
@@ -513,6 +202,9 @@ static void core_info_transfer(core_info_t *src, core_info_t *dst)
    src->firmware                  = NULL;
    src->firmware_count            = 0;
 
+   dst->cold_fields               = src->cold_fields;
+   src->cold_fields               = NULL;
+
    dst->core_file_id.str          = src->core_file_id.str;
    src->core_file_id.str          = NULL;
    dst->core_file_id.hash         = src->core_file_id.hash;
@@ -525,6 +217,110 @@ static void core_info_transfer(core_info_t *src, core_info_t *dst)
    dst->is_installed                  = src->is_installed;
 }
 
+static core_info_cache_file_t *core_info_cache_file_open(const char *path)
+{
+   core_info_cache_file_t *file = (core_info_cache_file_t*)
+         calloc(1, sizeof(*file));
+   void *buf                    = NULL;
+   int64_t len                  = 0;
+
+   if (!file)
+      return NULL;
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   {
+      struct stat st;
+      int fd = open(path, O_RDONLY);
+
+      if (fd >= 0)
+      {
+         if (     (fstat(fd, &st) == 0)
+               && (st.st_size > 0))
+         {
+            void *map = mmap(NULL, (size_t)st.st_size, PROT_READ,
+                  MAP_PRIVATE, fd, 0);
+
+            if (map != MAP_FAILED)
+            {
+               file->data   = (uint8_t*)map;
+               file->size   = (size_t)st.st_size;
+               file->mapped = true;
+            }
+         }
+
+         close(fd);
+      }
+
+      if (file->mapped)
+         return file;
+   }
+#endif
+
+   if (     !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len)
+         || (len <= 0))
+   {
+      free(buf);
+      free(file);
+      return NULL;
+   }
+
+   file->data = (uint8_t*)buf;
+   file->size = (size_t)len;
+   return file;
+}
+
+static void core_info_cache_file_free(core_info_cache_file_t *file)
+{
+   if (!file)
+      return;
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   if (file->mapped)
+      munmap(file->data, file->size);
+   else
+#endif
+      free(file->data);
+
+   free(file);
+}
+
+static bool core_info_cache_read_uint(core_info_cache_reader_t *reader,
+      uint32_t *value)
+{
+   if ((size_t)(reader->end - reader->data) < sizeof(*value))
+      return false;
+
+   memcpy(value, reader->data, sizeof(*value));
+   reader->data += sizeof(*value);
+   return true;
+}
+
+static bool core_info_cache_read_string(core_info_cache_reader_t *reader,
+      char **str)
+{
+   uint32_t len;
+
+   *str = NULL;
+
+   if (!core_info_cache_read_uint(reader, &len))
+      return false;
+
+   if (len == CORE_INFO_CACHE_NULL_STRING)
+      return true;
+
+   /* Strings carry their NUL, so that they
+    * can be copied as they are */
+   if (     ((size_t)(reader->end - reader->data) <= len)
+         || (reader->data[len] != '\0')
+         || !(*str = (char*)malloc(len + 1)))
+      return false;
+
+   memcpy(*str, reader->data, len + 1);
+   reader->data += len + 1;
+   return true;
+}
+
 static void core_info_cache_list_free(core_info_cache_list_t *core_info_cache_list)
 {
    size_t i;
@@ -538,32 +334,14 @@ static void core_info_cache_list_free(core_info_cache_list_t *core_info_cache_li
       core_info_free(info);
    }
 
+   core_info_cache_file_free(core_info_cache_list->file);
    free(core_info_cache_list->items);
    free(core_info_cache_list);
 }
 
 static core_info_cache_list_t *core_info_cache_list_new(void)
 {
-   core_info_cache_list_t *core_info_cache_list = NULL;
-
-   core_info_cache_list = (core_info_cache_list_t *)malloc(sizeof(*core_info_cache_list));
-   if (!core_info_cache_list)
-      return NULL;
-
-   core_info_cache_list->length = 0;
-   core_info_cache_list->items  = (core_info_t *)calloc(CORE_INFO_CACHE_DEFAULT_CAPACITY,
-         sizeof(core_info_t));
-
-   if (!core_info_cache_list->items)
-   {
-      core_info_cache_list_free(core_info_cache_list);
-      return NULL;
-   }
-
-   core_info_cache_list->capacity = CORE_INFO_CACHE_DEFAULT_CAPACITY;
-   core_info_cache_list->refresh  = false;
-
-   return core_info_cache_list;
+   return (core_info_cache_list_t *)calloc(1, sizeof(core_info_cache_list_t));
 }
 
 static core_info_t *core_info_cache_find(core_info_cache_list_t *list, char *core_file_id)
@@ -595,50 +373,78 @@ static core_info_t *core_info_cache_find(core_info_cache_list_t *list, char *cor
    return NULL;
 }
 
-static void core_info_cache_add(core_info_cache_list_t *list, core_info_t *info,
-      bool transfer)
+/* Decodes the hot part of a cache entry, leaving
+ * the cold block in place */
+static bool core_info_cache_read_entry(core_info_cache_reader_t *reader,
+      core_info_t *info)
 {
-   core_info_t *info_cache = NULL;
+   core_info_cache_reader_t entry;
+   uint32_t size;
+   uint32_t flags;
+   uint32_t cold_size;
 
-   if (!list ||
-       !info ||
-       (info->core_file_id.hash == 0) ||
-       string_is_empty(info->core_file_id.str))
-      return;
+   if (!core_info_cache_read_uint(reader, &size) ||
+       ((size_t)(reader->end - reader->data) < size))
+      return false;
 
-   if (list->length >= list->capacity)
-   {
-      size_t prev_capacity   = list->capacity;
-      core_info_t *items_tmp = (core_info_t*)realloc(list->items,
-            (list->capacity << 1) * sizeof(core_info_t));
+   entry.data    = reader->data;
+   entry.end     = reader->data + size;
+   reader->data += size;
+
+   if (!core_info_cache_read_uint(&entry, &flags) ||
+       !core_info_cache_read_string(&entry, &info->core_file_id.str) ||
+       !core_info_cache_read_string(&entry, &info->path) ||
+       !core_info_cache_read_string(&entry, &info->display_name) ||
+       !core_info_cache_read_string(&entry, &info->display_version) ||
+       !core_info_cache_read_string(&entry, &info->core_name) ||
+       !core_info_cache_read_string(&entry, &info->system_manufacturer) ||
+       !core_info_cache_read_string(&entry, &info->systemname) ||
+       !core_info_cache_read_string(&entry, &info->system_id) ||
+       !core_info_cache_read_string(&entry, &info->supported_extensions) ||
+       !core_info_cache_read_string(&entry, &info->databases) ||
+       !core_info_cache_read_string(&entry, &info->required_hw_api))
+      return false;
 
-      if (!items_tmp)
-         return;
+   if (string_is_empty(info->core_file_id.str))
+      return false;
 
-      list->capacity = list->capacity << 1;
-      list->items    = items_tmp;
+   /* The cold block is the rest of the entry */
+   info->cold_fields = entry.data;
 
-      memset(&list->items[prev_capacity], 0,
-            (list->capacity - prev_capacity) * sizeof(core_info_t));
-   }
+   if (!core_info_cache_read_uint(&entry, &cold_size) ||
+       ((size_t)(entry.end - entry.data) != cold_size))
+      return false;
 
-   info_cache = (core_info_t*)&list->items[list->length];
+   info->core_file_id.hash = core_info_hash_string(info->core_file_id.str);
 
-   if (transfer)
-      core_info_transfer(info, info_cache);
-   else
-      core_info_copy(info, info_cache);
+   if (info->supported_extensions)
+      info->supported_extensions_list =
+            string_split(info->supported_extensions, "|");
 
-   list->length++;
+   if (info->databases)
+      info->databases_list =
+            string_split(info->databases, "|");
+
+   if (info->required_hw_api)
+      info->required_hw_api_list =
+            string_split(info->required_hw_api, "|");
+
+   info->has_info                      = (flags & CORE_INFO_CACHE_FLAG_HAS_INFO) != 0;
+   info->supports_no_game              = (flags & CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME) != 0;
+   info->database_match_archive_member = (flags & CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER) != 0;
+   info->is_experimental               = (flags & CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL) != 0;
+
+   return true;
 }
 
 static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
 {
-   intfstream_t *file                           = NULL;
-   rjson_t *parser                              = NULL;
-   CCJSONContext context                        = {0};
+   core_info_cache_reader_t reader;
+   uint32_t version;
+   uint32_t count;
    core_info_cache_list_t *core_info_cache_list = NULL;
    char file_path[PATH_MAX_LENGTH];
+   size_t i;
 
    /* Check whether a 'force refresh' file
     * is present */
@@ -653,6 +459,10 @@ static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
    if (path_is_valid(file_path))
       return core_info_cache_list_new();
 
+   core_info_cache_list = core_info_cache_list_new();
+   if (!core_info_cache_list)
+      return NULL;
+
    /* Open info cache file */
    file_path[0] = '\0';
 
@@ -662,411 +472,331 @@ static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
       fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
             sizeof(file_path));
 
-#if defined(HAVE_ZLIB)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+   core_info_cache_list->file = core_info_cache_file_open(file_path);
 
-   if (!file)
-      return core_info_cache_list_new();
+   if (!core_info_cache_list->file)
+      return core_info_cache_list;
+
+   reader.data = core_info_cache_list->file->data;
+   reader.end  = reader.data + core_info_cache_list->file->size;
 
-   /* Parse info cache file */
-   parser = rjson_open_stream(file);
-   if (!parser)
+   if (((size_t)(reader.end - reader.data) < STRLEN_CONST(CORE_INFO_CACHE_MAGIC)) ||
+       memcmp(reader.data, CORE_INFO_CACHE_MAGIC,
+            STRLEN_CONST(CORE_INFO_CACHE_MAGIC)))
+      goto error;
+
+   reader.data += STRLEN_CONST(CORE_INFO_CACHE_MAGIC);
+
+   if (!core_info_cache_read_uint(&reader, &version) ||
+       (version != CORE_INFO_CACHE_VERSION) ||
+       !core_info_cache_read_uint(&reader, &count) ||
+       /* Each entry takes at least one size field */
+       (count > (size_t)(reader.end - reader.data) / sizeof(uint32_t)))
+      goto error;
+
+   if (count > 0)
    {
-      RARCH_ERR("[Core Info] Failed to create JSON parser\n");
-      goto end;
+      core_info_cache_list->items = (core_info_t*)calloc(count,
+            sizeof(core_info_t));
+
+      if (!core_info_cache_list->items)
+         goto error;
    }
 
-   rjson_set_options(parser,
-           RJSON_OPTION_ALLOW_UTF8BOM
-         | RJSON_OPTION_ALLOW_COMMENTS
-         | RJSON_OPTION_ALLOW_UNESCAPED_CONTROL_CHARACTERS
-         | RJSON_OPTION_REPLACE_INVALID_ENCODING);
-
-   if (rjson_parse(parser, &context,
-         CCJSONObjectMemberHandler,
-         CCJSONStringHandler,
-         CCJSONNumberHandler,
-         CCJSONStartObjectHandler,
-         CCJSONEndObjectHandler,
-         CCJSONStartArrayHandler,
-         CCJSONEndArrayHandler,
-         CCJSONBoolHandler,
-         NULL) /* Unused null handler */
-         != RJSON_DONE)
+   for (i = 0; i < count; i++)
    {
-      RARCH_WARN("[Core Info] Error parsing chunk:\n---snip---\n%.*s\n---snip---\n",
-            rjson_get_source_context_len(parser),
-            rjson_get_source_context_buf(parser));
-      RARCH_WARN("[Core Info] Error: Invalid JSON at line %d, column %d - %s.\n",
-            (int)rjson_get_source_line(parser),
-            (int)rjson_get_source_column(parser),
-            (*rjson_get_error(parser) ? rjson_get_error(parser) : "format error"));
-
-      /* Info cache is corrupt - discard it */
-      core_info_cache_list_free(context.core_info_cache_list);
-      core_info_cache_list = core_info_cache_list_new();
+      core_info_cache_list->length++;
+
+      if (!core_info_cache_read_entry(&reader,
+               &core_info_cache_list->items[i]))
+         goto error;
    }
-   else
-      core_info_cache_list = context.core_info_cache_list;
 
-   rjson_free(parser);
+   return core_info_cache_list;
+
+error:
+   /* Info cache is outdated or corrupt - discard it */
+   RARCH_WARN("[Core Info] Discarding invalid cache file: %s\n", file_path);
+   core_info_cache_list_free(core_info_cache_list);
+   return core_info_cache_list_new();
+}
+
+/* Decodes the cold fields of a core read from the
+ * info cache, if that hasn't happened yet.
+ * Must be called with the list's cold_lock held */
+static void core_info_decode_cold_fields(core_info_t *info)
+{
+   core_info_cache_reader_t reader;
+   uint32_t size;
+   uint32_t firmware_count;
+   uint32_t i;
+
+   if (!info->cold_fields)
+      return;
 
-   /* Clean up leftovers in the event of
-    * a parsing error */
-   if (context.core_info)
+   /* Block size was checked when reading the entry */
+   memcpy(&size, info->cold_fields, sizeof(size));
+   reader.data       = info->cold_fields + sizeof(size);
+   reader.end        = reader.data + size;
+   info->cold_fields = NULL;
+
+   if (!core_info_cache_read_string(&reader, &info->authors) ||
+       !core_info_cache_read_string(&reader, &info->permissions) ||
+       !core_info_cache_read_string(&reader, &info->licenses) ||
+       !core_info_cache_read_string(&reader, &info->categories) ||
+       !core_info_cache_read_string(&reader, &info->notes) ||
+       !core_info_cache_read_string(&reader, &info->description))
+      goto end;
+
+   /* Firmware entries take at least three fields */
+   if (!core_info_cache_read_uint(&reader, &firmware_count) ||
+       (firmware_count == 0) ||
+       (firmware_count > (size_t)(reader.end - reader.data) /
+            (3 * sizeof(uint32_t))) ||
+       !(info->firmware = (core_info_firmware_t*)calloc(firmware_count,
+            sizeof(core_info_firmware_t))))
+      goto end;
+
+   for (i = 0; i < firmware_count; i++)
    {
-      core_info_free(context.core_info);
-      free(context.core_info);
+      core_info_firmware_t *firmware = &info->firmware[info->firmware_count];
+      uint32_t optional;
+
+      info->firmware_count++;
+
+      if (!core_info_cache_read_string(&reader, &firmware->path) ||
+          !core_info_cache_read_string(&reader, &firmware->desc) ||
+          !core_info_cache_read_uint(&reader, &optional))
+         break;
+
+      firmware->optional = (optional != 0);
    }
 
 end:
-   intfstream_close(file);
-   free(file);
+   if (info->authors)
+      info->authors_list     = string_split(info->authors, "|");
 
-   return core_info_cache_list;
+   if (info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+
+   if (info->licenses)
+      info->licenses_list    = string_split(info->licenses, "|");
+
+   if (info->categories)
+      info->categories_list  = string_split(info->categories, "|");
+
+   if (info->notes)
+      info->note_list        = string_split(info->notes, "|");
+}
+
+/* Entries are shared with task threads (playlist
+ * and core backup tasks look cores up too), so the
+ * check and the decode both happen under the lock */
+static void core_info_resolve_cold_fields(core_info_list_t *list,
+      core_info_t *info)
+{
+#ifdef HAVE_THREADS
+   slock_lock(list->cold_lock);
+#endif
+   core_info_decode_cold_fields(info);
+#ifdef HAVE_THREADS
+   slock_unlock(list->cold_lock);
+#endif
+}
+
+static void core_info_cache_write_data(core_info_cache_writer_t *writer,
+      const void *data, size_t len)
+{
+   if (writer->error)
+      return;
+
+   if (writer->size + len > writer->capacity)
+   {
+      size_t capacity = writer->capacity ? writer->capacity : 4096;
+      uint8_t *tmp    = NULL;
+
+      while (writer->size + len > capacity)
+         capacity <<= 1;
+
+      if (!(tmp = (uint8_t*)realloc(writer->data, capacity)))
+      {
+         writer->error = true;
+         return;
+      }
+
+      writer->data     = tmp;
+      writer->capacity = capacity;
+   }
+
+   memcpy(writer->data + writer->size, data, len);
+   writer->size += len;
+}
+
+static void core_info_cache_write_uint(core_info_cache_writer_t *writer,
+      uint32_t value)
+{
+   core_info_cache_write_data(writer, &value, sizeof(value));
 }
 
-static void core_info_cache_write(core_info_cache_list_t *list, const char *info_dir)
+static void core_info_cache_write_string(core_info_cache_writer_t *writer,
+      const char *str)
 {
-   intfstream_t *file    = NULL;
-   rjsonwriter_t *writer = NULL;
+   if (!str)
+   {
+      core_info_cache_write_uint(writer, CORE_INFO_CACHE_NULL_STRING);
+      return;
+   }
+
+   core_info_cache_write_uint(writer, (uint32_t)strlen(str));
+   core_info_cache_write_data(writer, str, strlen(str) + 1);
+}
+
+/* Sizes are written as placeholders at first,
+ * and filled in once everything they cover is */
+static void core_info_cache_write_size(core_info_cache_writer_t *writer,
+      size_t offset)
+{
+   uint32_t size = (uint32_t)(writer->size - offset - sizeof(uint32_t));
+
+   if (!writer->error)
+      memcpy(writer->data + offset, &size, sizeof(size));
+}
+
+static void core_info_cache_write_entry(core_info_cache_writer_t *writer,
+      const core_info_t *info)
+{
+   size_t entry_offset = writer->size;
+   size_t cold_offset;
+   uint32_t flags      = 0;
+   size_t i;
+
+   if (info->has_info)
+      flags |= CORE_INFO_CACHE_FLAG_HAS_INFO;
+   if (info->supports_no_game)
+      flags |= CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME;
+   if (info->database_match_archive_member)
+      flags |= CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER;
+   if (info->is_experimental)
+      flags |= CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL;
+
+   core_info_cache_write_uint(writer, 0);
+   core_info_cache_write_uint(writer, flags);
+   core_info_cache_write_string(writer, info->core_file_id.str);
+   core_info_cache_write_string(writer, info->path);
+   core_info_cache_write_string(writer, info->display_name);
+   core_info_cache_write_string(writer, info->display_version);
+   core_info_cache_write_string(writer, info->core_name);
+   core_info_cache_write_string(writer, info->system_manufacturer);
+   core_info_cache_write_string(writer, info->systemname);
+   core_info_cache_write_string(writer, info->system_id);
+   core_info_cache_write_string(writer, info->supported_extensions);
+   core_info_cache_write_string(writer, info->databases);
+   core_info_cache_write_string(writer, info->required_hw_api);
+
+   /* A cold block nobody has looked at yet is
+    * still valid, and is copied over as it is */
+   if (info->cold_fields)
+   {
+      uint32_t cold_size;
+      memcpy(&cold_size, info->cold_fields, sizeof(cold_size));
+      core_info_cache_write_data(writer, info->cold_fields,
+            sizeof(cold_size) + cold_size);
+   }
+   else
+   {
+      cold_offset = writer->size;
+
+      core_info_cache_write_uint(writer, 0);
+      core_info_cache_write_string(writer, info->authors);
+      core_info_cache_write_string(writer, info->permissions);
+      core_info_cache_write_string(writer, info->licenses);
+      core_info_cache_write_string(writer, info->categories);
+      core_info_cache_write_string(writer, info->notes);
+      core_info_cache_write_string(writer, info->description);
+      core_info_cache_write_uint(writer, (uint32_t)info->firmware_count);
+
+      for (i = 0; i < info->firmware_count; i++)
+      {
+         core_info_cache_write_string(writer, info->firmware[i].path);
+         core_info_cache_write_string(writer, info->firmware[i].desc);
+         core_info_cache_write_uint(writer, info->firmware[i].optional ? 1 : 0);
+      }
+
+      core_info_cache_write_size(writer, cold_offset);
+   }
+
+   core_info_cache_write_size(writer, entry_offset);
+}
+
+static void core_info_cache_write(core_info_list_t *list, const char *info_dir)
+{
+   core_info_cache_writer_t writer = {0};
    char file_path[PATH_MAX_LENGTH];
-   size_t i, j;
+   char tmp_path[PATH_MAX_LENGTH];
+   uint32_t count                  = 0;
+   size_t i;
 
    file_path[0] = '\0';
 
    if (!list)
       return;
 
-   /* Open info cache file */
+   core_info_cache_write_data(&writer, CORE_INFO_CACHE_MAGIC,
+         STRLEN_CONST(CORE_INFO_CACHE_MAGIC));
+   core_info_cache_write_uint(&writer, CORE_INFO_CACHE_VERSION);
+   core_info_cache_write_uint(&writer, 0);
+
+   for (i = 0; i < list->count; i++)
+   {
+      const core_info_t *info = &list->list[i];
+
+      if (string_is_empty(info->core_file_id.str))
+         continue;
+
+      core_info_cache_write_entry(&writer, info);
+      count++;
+   }
+
+   if (writer.error)
+   {
+      RARCH_ERR("[Core Info] Failed to allocate core info cache\n");
+      goto end;
+   }
+
+   memcpy(writer.data + STRLEN_CONST(CORE_INFO_CACHE_MAGIC)
+         + sizeof(uint32_t), &count, sizeof(count));
+
    if (string_is_empty(info_dir))
       strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
    else
       fill_pathname_join(file_path, info_dir, FILE_PATH_CORE_INFO_CACHE,
             sizeof(file_path));
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+   /* The current cache file may be mapped (here, or by
+    * another instance), so it is replaced rather than
+    * written over */
+   strlcpy(tmp_path, file_path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
 
-   if (!file)
+   if (!filestream_write_file(tmp_path, writer.data, (int64_t)writer.size))
    {
       RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
-      return;
-   }
-
-   /* Write info cache */
-   writer = rjsonwriter_open_stream(file);
-   if (!writer)
-   {
-      RARCH_ERR("[Core Info] Failed to create JSON writer\n");
       goto end;
    }
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   /* When compressing info cache, human readability
-    * is not a factor - can skip all indentation
-    * and new line characters */
-   rjsonwriter_set_options(writer, RJSONWRITER_OPTION_SKIP_WHITESPACE);
-#endif
-
-   rjsonwriter_add_start_object(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "version");
-   rjsonwriter_add_colon(writer);
-   rjsonwriter_add_space(writer);
-   rjsonwriter_add_string(writer, "1.0");
-   rjsonwriter_add_comma(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "items");
-   rjsonwriter_add_colon(writer);
-   rjsonwriter_add_space(writer);
-   rjsonwriter_add_start_array(writer);
-   rjsonwriter_add_newline(writer);
-
-   for (i = 0; i < list->length; i++)
+   if (filestream_rename(tmp_path, file_path) != 0)
    {
-      core_info_t* info = &list->items[i];
-
-      if (!info || !info->is_installed)
-         continue;
-
-      if (i > 0)
-      {
-         rjsonwriter_add_comma(writer);
-         rjsonwriter_add_newline(writer);
-      }
+      /* Renaming over an existing file fails on Windows */
+      filestream_delete(file_path);
 
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_add_start_object(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "path");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->path);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_name");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->display_name);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_version");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->display_version);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_name");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->core_name);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_manufacturer");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->system_manufacturer);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "systemname");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->systemname);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_id");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->system_id);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supported_extensions");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->supported_extensions);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "authors");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->authors);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "permissions");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->permissions);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "licenses");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->licenses);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "categories");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->categories);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "databases");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->databases);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "notes");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->notes);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "required_hw_api");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->required_hw_api);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "description");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->description);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      if (info->firmware_count > 0)
+      if (filestream_rename(tmp_path, file_path) != 0)
       {
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "firmware");
-         rjsonwriter_add_colon(writer);
-         rjsonwriter_add_space(writer);
-         rjsonwriter_add_start_array(writer);
-         rjsonwriter_add_newline(writer);
-
-         for (j = 0; j < info->firmware_count; j++)
-         {
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_add_start_object(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "path");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_string(writer, info->firmware[j].path);
-            rjsonwriter_add_comma(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "desc");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_string(writer, info->firmware[j].desc);
-            rjsonwriter_add_comma(writer);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "optional");
-            rjsonwriter_add_colon(writer);
-            rjsonwriter_add_space(writer);
-            rjsonwriter_add_bool(writer, info->firmware[j].optional);
-            rjsonwriter_add_newline(writer);
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_add_end_object(writer);
-
-            if (j < info->firmware_count - 1)
-               rjsonwriter_add_comma(writer);
-
-            rjsonwriter_add_newline(writer);
-         }
-
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_end_array(writer);
-         rjsonwriter_add_comma(writer);
-         rjsonwriter_add_newline(writer);
+         RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
+         filestream_delete(tmp_path);
+         goto end;
       }
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_file_id");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_start_object(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "str");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_string(writer, info->core_file_id.str);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "hash");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_unsigned(writer, info->core_file_id.hash);
-      rjsonwriter_add_newline(writer);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_end_object(writer);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "firmware_count");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_unsigned(writer, info->firmware_count);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "has_info");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->has_info);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supports_no_game");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->supports_no_game);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "database_match_archive_member");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->database_match_archive_member);
-      rjsonwriter_add_comma(writer);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "is_experimental");
-      rjsonwriter_add_colon(writer);
-      rjsonwriter_add_space(writer);
-      rjsonwriter_add_bool(writer, info->is_experimental);
-      rjsonwriter_add_newline(writer);
-
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_add_end_object(writer);
    }
 
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_end_array(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_add_end_object(writer);
-   rjsonwriter_add_newline(writer);
-   rjsonwriter_free(writer);
-
    RARCH_LOG("[Core Info] Wrote to cache file: %s\n", file_path);
 
    /* Remove 'force refresh' file, if required */
@@ -1082,10 +812,7 @@ static void core_info_cache_write(core_info_cache_list_t *list, const char *info
       filestream_delete(file_path);
 
 end:
-   intfstream_close(file);
-   free(file);
-
-   list->refresh = false;
+   free(writer.data);
 }
 
 static void core_info_check_uninstalled(core_info_cache_list_t *list)
@@ -1423,7 +1150,10 @@ static core_info_t *core_info_find_internal(
 
       if ((info->core_file_id.hash == hash) &&
           string_is_equal(info->core_file_id.str, core_file_id))
+      {
+         core_info_resolve_cold_fields(list, info);
          return info;
+      }
    }
 
    return NULL;
@@ -1463,18 +1193,12 @@ static void core_info_resolve_firmware(
       entry = config_get_entry(conf, path_key);
 
       if (entry && !string_is_empty(entry->value))
-      {
-         firmware[i].path = entry->value;
-         entry->value     = NULL;
-      }
+         firmware[i].path = strdup(entry->value);
 
       entry = config_get_entry(conf, desc_key);
 
       if (entry && !string_is_empty(entry->value))
-      {
-         firmware[i].desc = entry->value;
-         entry->value     = NULL;
-      }
+         firmware[i].desc = strdup(entry->value);
 
       if (config_get_bool(conf, opt_key , &tmp_bool))
          firmware[i].optional = tmp_bool;
@@ -1514,57 +1238,38 @@ static void core_info_parse_config_file(
    entry = config_get_entry(conf, "display_name");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->display_name = entry->value;
-      entry->value       = NULL;
-   }
+      info->display_name = strdup(entry->value);
 
    entry = config_get_entry(conf, "display_version");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->display_version = entry->value;
-      entry->value          = NULL;
-   }
+      info->display_version = strdup(entry->value);
 
    entry = config_get_entry(conf, "corename");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->core_name = entry->value;
-      entry->value    = NULL;
-   }
+      info->core_name = strdup(entry->value);
 
    entry = config_get_entry(conf, "systemname");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->systemname = entry->value;
-      entry->value     = NULL;
-   }
+      info->systemname = strdup(entry->value);
 
    entry = config_get_entry(conf, "systemid");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->system_id = entry->value;
-      entry->value    = NULL;
-   }
+      info->system_id = strdup(entry->value);
 
    entry = config_get_entry(conf, "manufacturer");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->system_manufacturer = entry->value;
-      entry->value              = NULL;
-   }
+      info->system_manufacturer = strdup(entry->value);
 
    entry = config_get_entry(conf, "supported_extensions");
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->supported_extensions      = entry->value;
-      entry->value                    = NULL;
+      info->supported_extensions      = strdup(entry->value);
 
       info->supported_extensions_list =
             string_split(info->supported_extensions, "|");
@@ -1574,8 +1279,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->authors      = entry->value;
-      entry->value       = NULL;
+      info->authors      = strdup(entry->value);
 
       info->authors_list =
             string_split(info->authors, "|");
@@ -1585,8 +1289,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->permissions      = entry->value;
-      entry->value           = NULL;
+      info->permissions      = strdup(entry->value);
 
       info->permissions_list =
             string_split(info->permissions, "|");
@@ -1596,8 +1299,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->licenses      = entry->value;
-      entry->value        = NULL;
+      info->licenses      = strdup(entry->value);
 
       info->licenses_list =
             string_split(info->licenses, "|");
@@ -1607,8 +1309,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->categories      = entry->value;
-      entry->value          = NULL;
+      info->categories      = strdup(entry->value);
 
       info->categories_list =
             string_split(info->categories, "|");
@@ -1618,8 +1319,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->databases      = entry->value;
-      entry->value         = NULL;
+      info->databases      = strdup(entry->value);
 
       info->databases_list =
             string_split(info->databases, "|");
@@ -1629,8 +1329,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->notes     = entry->value;
-      entry->value    = NULL;
+      info->notes     = strdup(entry->value);
 
       info->note_list =
             string_split(info->notes, "|");
@@ -1640,8 +1339,7 @@ static void core_info_parse_config_file(
 
    if (entry && !string_is_empty(entry->value))
    {
-      info->required_hw_api      = entry->value;
-      entry->value               = NULL;
+      info->required_hw_api      = strdup(entry->value);
 
       info->required_hw_api_list =
             string_split(info->required_hw_api, "|");
@@ -1650,10 +1348,7 @@ static void core_info_parse_config_file(
    entry = config_get_entry(conf, "description");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->description = entry->value;
-      entry->value      = NULL;
-   }
+      info->description = strdup(entry->value);
 
    if (config_get_bool(conf, "supports_no_game",
             &tmp_bool))
@@ -1765,6 +1460,11 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       core_info_free(info);
    }
 
+   core_info_cache_file_free(core_info_list->cache);
+#ifdef HAVE_THREADS
+   if (core_info_list->cold_lock)
+      slock_free(core_info_list->cold_lock);
+#endif
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -1793,10 +1493,20 @@ static core_info_list_t *core_info_list_new(const char *path,
       goto error;
 
    core_info_list->list       = NULL;
+   core_info_list->cache      = NULL;
+   core_info_list->cold_lock  = NULL;
    core_info_list->count      = 0;
    core_info_list->info_count = 0;
    core_info_list->all_ext    = NULL;
 
+#ifdef HAVE_THREADS
+   if (!(core_info_list->cold_lock = slock_new()))
+   {
+      core_info_list_free(core_info_list);
+      goto error;
+   }
+#endif
+
    core_info = (core_info_t*)calloc(path_list->core_list->size,
          sizeof(*core_info));
 
@@ -1846,7 +1556,7 @@ static core_info_list_t *core_info_list_new(const char *path,
 
          if (info_cache)
          {
-            core_info_copy(info_cache, info);
+            core_info_transfer(info_cache, info);
             /* Core lock status is 'dynamic', and
              * cannot be cached */
             info->is_locked = core_info_path_is_locked(path_list->lock_list,
@@ -1889,13 +1599,9 @@ static core_info_list_t *core_info_list_new(const char *path,
 
       /* If info cache is enabled and we reach this
        * point, current core is uncached
-       * > Add it to the list, and trigger a cache
-       *   refresh */
+       * > Trigger a cache refresh */
       if (core_info_cache_list)
-      {
-         core_info_cache_add(core_info_cache_list, info, false);
          core_info_cache_list->refresh = true;
-      }
    }
 
    core_info_list_resolve_all_extensions(core_info_list);
@@ -1911,8 +1617,12 @@ static core_info_list_t *core_info_list_new(const char *path,
       core_info_check_uninstalled(core_info_cache_list);
 
       if (core_info_cache_list->refresh)
-         core_info_cache_write(core_info_cache_list, info_dir);
+         core_info_cache_write(core_info_list, info_dir);
 
+      /* Cores taken from the cache still point
+       * into it for their cold fields */
+      core_info_list->cache      = core_info_cache_list->file;
+      core_info_cache_list->file = NULL;
       core_info_cache_list_free(core_info_cache_list);
    }
 
@@ -2079,6 +1789,7 @@ bool core_info_init_current_core(void)
    current->licenses_list                 = NULL;
    current->required_hw_api_list          = NULL;
    current->firmware                      = NULL;
+   current->cold_fields                   = NULL;
    current->core_file_id.str              = NULL;
    current->core_file_id.hash             = 0;
 
@@ -2194,6 +1905,7 @@ core_info_t *core_info_get(core_info_list_t *list, size_t i)
    if (!info || !info->path)
       return NULL;
 
+   core_info_resolve_cold_fields(list, info);
    return info;
 }
 
@@ -2413,28 +2125,19 @@ core_updater_info_t *core_info_get_core_updater_info(const char *info_path)
    entry                     = config_get_entry(conf, "display_name");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->display_name     = entry->value;
-      entry->value           = NULL;
-   }
+      info->display_name     = strdup(entry->value);
 
    /* > description */
    entry                     = config_get_entry(conf, "description");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->description      = entry->value;
-      entry->value           = NULL;
-   }
+      info->description      = strdup(entry->value);
 
    /* > licenses */
    entry                     = config_get_entry(conf, "license");
 
    if (entry && !string_is_empty(entry->value))
-   {
-      info->licenses         = entry->value;
-      entry->value           = NULL;
-   }
+      info->licenses         = strdup(entry->value);
 
    /* Clean up */
    config_file_free(conf);
@@ -82,6 +82,11 @@ typedef struct
    struct string_list *licenses_list;
    struct string_list *required_hw_api_list;
    core_info_firmware_t *firmware;
+   /* Authors, permissions, licenses, categories, notes,
+    * description and firmware of a core read from the
+    * info cache are only decoded from here when the core
+    * is looked up. NULL once they have been. */
+   const uint8_t *cold_fields;
    core_file_id_t core_file_id; /* ptr alignment */
    size_t firmware_count;
    bool has_info;
@@ -105,6 +110,10 @@ typedef struct
 typedef struct
 {
    core_info_t *list;
+   struct core_info_cache_file *cache;
+   /* Held while an entry's cold fields are decoded,
+    * since lookups can come from task threads */
+   struct slock *cold_lock;
    char *all_ext;
    size_t count;
    size_t info_count;
@@ -159,6 +168,9 @@ void core_info_deinit_list(void);
 bool core_info_init_list(const char *path_info, const char *dir_cores,
       const char *exts, bool show_hidden_files, bool enable_cache);
 
+/* Entries of the list only have their cold fields
+ * (see core_info_t) once they have been looked up
+ * with core_info_find() or core_info_get() */
 bool core_info_get_list(core_info_list_t **core);
 
 /* Returns number of installed cores */
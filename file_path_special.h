@@ -113,6 +113,7 @@ RETRO_BEGIN_DECLS
 #endif
 #define FILE_PATH_CORE_INFO_CACHE "core_info.cache"
 #define FILE_PATH_CORE_INFO_CACHE_REFRESH "core_info.refresh"
+#define FILE_PATH_CONTENT_SCAN_CACHE "content_scan.cache"
 
 enum application_special_type
 {
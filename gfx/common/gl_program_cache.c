@@ -0,0 +1,431 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <lrc_hash.h>
+
+#include "gl_program_cache.h"
+#include "../../configuration.h"
+#include "../../verbosity.h"
+
+#define GL_PROGRAM_CACHE_DIR     "glprogram"
+#define GL_PROGRAM_CACHE_EXT     "bin"
+#define GL_PROGRAM_CACHE_MAGIC   0x504c4752 /* "RGLP" */
+#define GL_PROGRAM_CACHE_VERSION 1
+
+/* How stale the last use of an entry may get before a
+ * hit writes the new time back */
+#define GL_PROGRAM_CACHE_TOUCH_INTERVAL (24 * 60 * 60)
+
+/* GLES2 only has program binaries as an extension */
+#if defined(HAVE_PSGL)
+#elif defined(HAVE_OPENGLES2)
+#if defined(GL_OES_get_program_binary)
+#define GL_PROGRAM_CACHE_SUPPORTED
+#define GL_PROGRAM_CACHE_GET_BINARY glGetProgramBinaryOES
+#define GL_PROGRAM_CACHE_BINARY     glProgramBinaryOES
+#define GL_PROGRAM_CACHE_LENGTH     GL_PROGRAM_BINARY_LENGTH_OES
+#define GL_PROGRAM_CACHE_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS_OES
+#endif
+#elif defined(GL_NUM_PROGRAM_BINARY_FORMATS)
+#define GL_PROGRAM_CACHE_SUPPORTED
+#define GL_PROGRAM_CACHE_GET_BINARY glGetProgramBinary
+#define GL_PROGRAM_CACHE_BINARY     glProgramBinary
+#define GL_PROGRAM_CACHE_LENGTH     GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_CACHE_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS
+#endif
+
+struct gl_program_cache_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint64_t last_used;
+   uint32_t format;
+   uint32_t length;
+};
+
+struct gl_program_cache_entry
+{
+   const char *path;
+   uint64_t last_used;
+   uint64_t size;
+};
+
+/* Size of the entries in the directory the cache was last
+ * used with. It is scanned for once, then kept up to date
+ * by stores, so that a store only goes through the whole
+ * directory when the cache may actually be full. */
+static char gl_program_cache_size_dir[PATH_MAX_LENGTH];
+static uint64_t gl_program_cache_size;
+
+static bool gl_program_cache_dir(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+   const char *dir      = settings->paths.directory_cache;
+
+   if (string_is_empty(dir))
+      return false;
+
+   fill_pathname_join(s, dir, GL_PROGRAM_CACHE_DIR, len);
+   return true;
+}
+
+static bool gl_program_cache_path(char *s, size_t len, const char *key)
+{
+   char dir[PATH_MAX_LENGTH];
+   char name[GL_PROGRAM_CACHE_KEY_SIZE + sizeof("." GL_PROGRAM_CACHE_EXT)];
+
+   if (!gl_program_cache_dir(dir, sizeof(dir)))
+      return false;
+
+   strlcpy(name, key, sizeof(name));
+   strlcat(name, "." GL_PROGRAM_CACHE_EXT, sizeof(name));
+   fill_pathname_join(s, dir, name, len);
+   return true;
+}
+
+static bool gl_program_cache_supported(void)
+{
+#ifdef GL_PROGRAM_CACHE_SUPPORTED
+   GLint formats = 0;
+
+#if defined(HAVE_OPENGLES2) || !defined(HAVE_OPENGLES3)
+   /* Loaded at runtime, may well be missing */
+   if (!GL_PROGRAM_CACHE_GET_BINARY || !GL_PROGRAM_CACHE_BINARY)
+      return false;
+#endif
+
+   glGetIntegerv(GL_PROGRAM_CACHE_FORMATS, &formats);
+
+   if (formats > 0)
+      return true;
+
+   /* Older contexts don't know about the enum at all */
+   glGetError();
+#endif
+   return false;
+}
+
+static bool gl_program_cache_read_header(RFILE *file,
+      struct gl_program_cache_header *header)
+{
+   return filestream_read(file, header, sizeof(*header))
+            == (int64_t)sizeof(*header)
+         && header->magic   == GL_PROGRAM_CACHE_MAGIC
+         && header->version == GL_PROGRAM_CACHE_VERSION;
+}
+
+static int gl_program_cache_entry_older(const void *a, const void *b)
+{
+   const struct gl_program_cache_entry *entry_a =
+      (const struct gl_program_cache_entry*)a;
+   const struct gl_program_cache_entry *entry_b =
+      (const struct gl_program_cache_entry*)b;
+
+   if (entry_a->last_used < entry_b->last_used)
+      return -1;
+   return entry_a->last_used > entry_b->last_used;
+}
+
+/* Measures the cache, and deletes the entries used longest
+ * ago until it is well under its limit again if it is past
+ * it, so that it isn't trimmed on every store once full. */
+static void gl_program_cache_evict(const char *dir)
+{
+   size_t i;
+   size_t count                          = 0;
+   uint64_t total                        = 0;
+   struct gl_program_cache_entry *entries = NULL;
+   struct string_list *list              = dir_list_new(dir,
+         GL_PROGRAM_CACHE_EXT, false, false, false, false);
+
+   if (!list)
+      return;
+
+   if (!(entries = (struct gl_program_cache_entry*)
+            calloc(list->size + 1, sizeof(*entries))))
+      goto end;
+
+   for (i = 0; i < list->size; i++)
+   {
+      struct gl_program_cache_header header;
+      RFILE *file = filestream_open(list->elems[i].data,
+            RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (!file)
+         continue;
+
+      entries[count].path      = list->elems[i].data;
+      entries[count].size      = (uint64_t)filestream_get_size(file);
+      /* Entries we can't read go first */
+      entries[count].last_used = gl_program_cache_read_header(file, &header)
+         ? header.last_used : 0;
+      filestream_close(file);
+
+      total                   += entries[count++].size;
+   }
+
+   strlcpy(gl_program_cache_size_dir, dir,
+         sizeof(gl_program_cache_size_dir));
+   gl_program_cache_size = total;
+
+   if (total <= GL_PROGRAM_CACHE_MAX_SIZE)
+      goto end;
+
+   qsort(entries, count, sizeof(*entries), gl_program_cache_entry_older);
+
+   for (i = 0; i < count && total > GL_PROGRAM_CACHE_MAX_SIZE / 4 * 3; i++)
+   {
+      if (filestream_delete(entries[i].path) == 0)
+         total -= entries[i].size;
+   }
+
+   gl_program_cache_size = total;
+
+   RARCH_LOG("[GL]: Evicted %u programs from the program cache.\n",
+         (unsigned)i);
+
+end:
+   free(entries);
+   string_list_free(list);
+}
+
+bool gl_program_cache_key(char *key, const char **sources, size_t count)
+{
+   size_t i;
+   size_t len;
+   char *buf;
+   char *s;
+   char version[32];
+   const char *driver[3];
+   size_t total = 0;
+
+   if (!gl_program_cache_supported())
+      return false;
+
+   driver[0]    = (const char*)glGetString(GL_VENDOR);
+   driver[1]    = (const char*)glGetString(GL_RENDERER);
+   driver[2]    = (const char*)glGetString(GL_VERSION);
+
+   if (!driver[0] || !driver[1] || !driver[2])
+      return false;
+
+   snprintf(version, sizeof(version), "glprogram-%d",
+         GL_PROGRAM_CACHE_VERSION);
+
+   /* Everything is hashed with its terminator, so that
+    * moving text from one source to the next changes the
+    * key; missing sources are hashed as empty strings. */
+   total += strlen(version) + 1;
+   for (i = 0; i < ARRAY_SIZE(driver); i++)
+      total += strlen(driver[i]) + 1;
+   for (i = 0; i < count; i++)
+      total += (sources[i] ? strlen(sources[i]) : 0) + 1;
+
+   if (!(buf = (char*)malloc(total)))
+      return false;
+
+   s   = buf;
+   len = strlen(version) + 1;
+   memcpy(s, version, len);
+   s  += len;
+
+   for (i = 0; i < ARRAY_SIZE(driver); i++)
+   {
+      len = strlen(driver[i]) + 1;
+      memcpy(s, driver[i], len);
+      s  += len;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      const char *source = sources[i] ? sources[i] : "";
+      len = strlen(source) + 1;
+      memcpy(s, source, len);
+      s  += len;
+   }
+
+   sha256_hash(key, (const uint8_t*)buf, total);
+   free(buf);
+   return true;
+}
+
+GLuint gl_program_cache_load(const char *key)
+{
+#ifdef GL_PROGRAM_CACHE_SUPPORTED
+   char path[PATH_MAX_LENGTH];
+   struct gl_program_cache_header header;
+   GLint status  = GL_FALSE;
+   GLuint prog   = 0;
+   int64_t len   = 0;
+   void *buf     = NULL;
+
+   if (     !gl_program_cache_path(path, sizeof(path), key)
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &len))
+      return 0;
+
+   if ((size_t)len < sizeof(header))
+      goto error;
+
+   memcpy(&header, buf, sizeof(header));
+
+   if (     header.magic   != GL_PROGRAM_CACHE_MAGIC
+         || header.version != GL_PROGRAM_CACHE_VERSION
+         || header.length  != (uint64_t)len - sizeof(header))
+      goto error;
+
+   if (!(prog = glCreateProgram()))
+   {
+      free(buf);
+      return 0;
+   }
+
+   GL_PROGRAM_CACHE_BINARY(prog, (GLenum)header.format,
+         (const uint8_t*)buf + sizeof(header), (GLsizei)header.length);
+   glGetProgramiv(prog, GL_LINK_STATUS, &status);
+
+   if (status != GL_TRUE)
+   {
+      glDeleteProgram(prog);
+      goto error;
+   }
+
+   free(buf);
+
+   /* Keep the entry from being evicted, without rewriting
+    * it on every single load */
+   if ((uint64_t)time(NULL) > header.last_used
+         + GL_PROGRAM_CACHE_TOUCH_INTERVAL)
+   {
+      RFILE *file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ_WRITE
+            | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+            RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (file)
+      {
+         header.last_used = (uint64_t)time(NULL);
+         if (filestream_seek(file, offsetof(struct gl_program_cache_header,
+                     last_used), RETRO_VFS_SEEK_POSITION_START) == 0)
+            filestream_write(file, &header.last_used,
+                  sizeof(header.last_used));
+         filestream_close(file);
+      }
+   }
+
+   return prog;
+
+error:
+   /* Most likely a driver update that kept the version
+    * string; the program gets built and stored again */
+   RARCH_WARN("[GL]: Discarding cached program \"%s\".\n", path);
+   free(buf);
+   filestream_delete(path);
+#endif
+   return 0;
+}
+
+void gl_program_cache_prepare(GLuint prog)
+{
+#if defined(GL_PROGRAM_BINARY_RETRIEVABLE_HINT) && !defined(HAVE_OPENGLES2)
+#if !defined(HAVE_OPENGLES3)
+   if (!glProgramParameteri)
+      return;
+#endif
+   glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+}
+
+void gl_program_cache_store(const char *key, GLuint prog)
+{
+#ifdef GL_PROGRAM_CACHE_SUPPORTED
+   char dir[PATH_MAX_LENGTH];
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   struct gl_program_cache_header header;
+   GLint len      = 0;
+   GLsizei length = 0;
+   GLenum format  = 0;
+   uint8_t *buf   = NULL;
+
+   if (     !gl_program_cache_dir(dir, sizeof(dir))
+         || !gl_program_cache_path(path, sizeof(path), key))
+      return;
+
+   glGetProgramiv(prog, GL_PROGRAM_CACHE_LENGTH, &len);
+
+   if (len <= 0 || !(buf = (uint8_t*)malloc(sizeof(header) + len)))
+      return;
+
+   GL_PROGRAM_CACHE_GET_BINARY(prog, len, &length, &format,
+         buf + sizeof(header));
+
+   if (length <= 0 || length > len)
+      goto end;
+
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      goto end;
+
+   if (!string_is_equal(dir, gl_program_cache_size_dir))
+      gl_program_cache_evict(dir);
+
+   header.magic     = GL_PROGRAM_CACHE_MAGIC;
+   header.version   = GL_PROGRAM_CACHE_VERSION;
+   header.last_used = (uint64_t)time(NULL);
+   header.format    = (uint32_t)format;
+   header.length    = (uint32_t)length;
+   memcpy(buf, &header, sizeof(header));
+
+   /* A half written entry would be taken for one the driver
+    * rejects and deleted by gl_program_cache_load(), so
+    * entries only ever appear under their name complete */
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, buf, sizeof(header) + length))
+      goto error;
+
+   if (filestream_rename(tmp_path, path) != 0)
+   {
+      /* Renaming over an existing file fails on Windows */
+      filestream_delete(path);
+
+      if (filestream_rename(tmp_path, path) != 0)
+      {
+         filestream_delete(tmp_path);
+         goto error;
+      }
+   }
+
+   gl_program_cache_size += sizeof(header) + length;
+   if (gl_program_cache_size > GL_PROGRAM_CACHE_MAX_SIZE)
+      gl_program_cache_evict(dir);
+   goto end;
+
+error:
+   RARCH_WARN("[GL]: Could not write cached program \"%s\".\n", path);
+end:
+   free(buf);
+#endif
+}
@@ -0,0 +1,77 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GL_PROGRAM_CACHE_H
+#define __GL_PROGRAM_CACHE_H
+
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+#ifdef HAVE_CONFIG_H
+#include "../../config.h"
+#endif
+
+#include <glsym/glsym.h>
+
+RETRO_BEGIN_DECLS
+
+/* Linked GL programs, kept on disk as program binaries so
+ * that presets don't have to be compiled and linked again
+ * on every launch.
+ *
+ * Programs are keyed by their sources and the GL vendor,
+ * renderer and version, since binaries are only good for
+ * the driver that made them. A binary the driver rejects
+ * anyway (e.g. after an update that kept the version
+ * string) is deleted and the program is built as usual.
+ * Once the cache grows past GL_PROGRAM_CACHE_MAX_SIZE,
+ * the programs used longest ago are deleted. */
+
+#define GL_PROGRAM_CACHE_KEY_SIZE 65
+#define GL_PROGRAM_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+/**
+ * gl_program_cache_key:
+ * @key                : Key, GL_PROGRAM_CACHE_KEY_SIZE bytes.
+ * @sources            : Shader sources making up the program.
+ *                       NULL entries are allowed.
+ * @count              : Number of sources.
+ *
+ * Gets the key of a program for the current context.
+ *
+ * Returns: false if programs of the current context
+ * can't be cached, in which case @key is left alone.
+ **/
+bool gl_program_cache_key(char *key, const char **sources, size_t count);
+
+/**
+ * gl_program_cache_load:
+ * @key                : Key of the program.
+ *
+ * Creates a program from the binary stored under @key.
+ *
+ * Returns: the linked program, 0 if there is none.
+ **/
+GLuint gl_program_cache_load(const char *key);
+
+/* Call on a program to be stored before linking it */
+void gl_program_cache_prepare(GLuint prog);
+
+void gl_program_cache_store(const char *key, GLuint prog);
+
+RETRO_END_DECLS
+
+#endif
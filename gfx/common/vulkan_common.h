@@ -362,6 +362,7 @@ typedef struct vk
       VkDescriptorSetLayout set_layout;
       VkPipelineLayout layout;
       VkPipelineCache cache;
+      size_t cache_size; /* Data size last loaded or saved */
    } pipelines;
 
    struct
@@ -19,6 +19,8 @@
 #include <string.h>
 
 #include <compat/strl.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
 #include <formats/image.h>
@@ -27,6 +29,7 @@
 #include <retro_math.h>
 #include <retro_assert.h>
 #include <string/stdstring.h>
+#include <streams/file_stream.h>
 #include <libretro.h>
 
 #ifdef HAVE_CONFIG_H
@@ -55,6 +58,21 @@
 
 #include "../video_coord_array.h"
 
+/* Pipeline cache kept in the cache directory across sessions */
+#define VULKAN_PIPELINE_CACHE_FILE  "vulkan_pipeline_cache.bin"
+#define VULKAN_PIPELINE_CACHE_MAGIC 0x43505652 /* "RVPC" */
+
+/* Saved ahead of vkGetPipelineCacheData(), so that a
+ * cache is only used with the GPU and driver that made it */
+struct vulkan_pipeline_cache_header
+{
+   uint32_t magic;
+   uint32_t vendor_id;
+   uint32_t device_id;
+   uint32_t driver_version;
+   uint8_t uuid[VK_UUID_SIZE];
+};
+
 static void vulkan_set_viewport(void *data, unsigned viewport_width,
       unsigned viewport_height, bool force_full, bool allow_rotate);
 static bool vulkan_is_mapped_swapchain_texture_ptr(const vk_t* vk,
@@ -805,6 +823,7 @@ static bool vulkan_init_default_filter_chain(vk_t *vk)
 static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
 {
    struct vulkan_filter_chain_create_info info;
+   retro_time_t start;
 
    info.device                = vk->context->device;
    info.gpu                   = vk->context->gpu;
@@ -821,6 +840,7 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
    info.swapchain.render_pass = vk->render_pass;
    info.swapchain.num_indices = vk->context->num_swapchain_images;
 
+   start                      = cpu_features_get_time_usec();
    vk->filter_chain           = vulkan_filter_chain_create_from_preset(
          &info, shader_path,
          vk->video.smooth
@@ -833,6 +853,9 @@ static bool vulkan_init_filter_chain_preset(vk_t *vk, const char *shader_path)
       return false;
    }
 
+   RARCH_LOG("[Vulkan]: Created preset in %.1f ms.\n",
+         (cpu_features_get_time_usec() - start) / 1000.0);
+
    return true;
 }
 
@@ -874,10 +897,155 @@ static void vulkan_init_resources(vk_t *vk)
    vulkan_init_command_buffers(vk);
 }
 
+static bool vulkan_pipeline_cache_path(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+   const char *dir      = settings->paths.directory_cache;
+
+   if (string_is_empty(dir))
+      return false;
+
+   fill_pathname_join(s, dir, VULKAN_PIPELINE_CACHE_FILE, len);
+   return true;
+}
+
+static void vulkan_pipeline_cache_header_init(vk_t *vk,
+      struct vulkan_pipeline_cache_header *header)
+{
+   const VkPhysicalDeviceProperties *props = &vk->context->gpu_properties;
+
+   header->magic          = VULKAN_PIPELINE_CACHE_MAGIC;
+   header->vendor_id      = props->vendorID;
+   header->device_id      = props->deviceID;
+   header->driver_version = props->driverVersion;
+   memcpy(header->uuid, props->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+/* Reads the pipeline cache saved by an earlier session,
+ * if it was made by this GPU and driver */
+static void *vulkan_pipeline_cache_load(vk_t *vk, size_t *len)
+{
+   char path[PATH_MAX_LENGTH];
+   struct vulkan_pipeline_cache_header header;
+   struct vulkan_pipeline_cache_header expected;
+   uint32_t vk_header[4];
+   int64_t size    = 0;
+   void *buf       = NULL;
+   uint8_t *data   = NULL;
+
+   if (     !vulkan_pipeline_cache_path(path, sizeof(path))
+         || !path_is_valid(path)
+         || !filestream_read_file(path, &buf, &size))
+      return NULL;
+
+   vulkan_pipeline_cache_header_init(vk, &expected);
+
+   /* Ours, then the one of VK_PIPELINE_CACHE_HEADER_VERSION_ONE */
+   if ((uint64_t)size < sizeof(header) + sizeof(vk_header) + VK_UUID_SIZE)
+      goto corrupt;
+
+   data = (uint8_t*)buf + sizeof(header);
+   memcpy(&header, buf, sizeof(header));
+   memcpy(vk_header, data, sizeof(vk_header));
+
+   if (     header.magic != VULKAN_PIPELINE_CACHE_MAGIC
+         || vk_header[0] < sizeof(vk_header) + VK_UUID_SIZE
+         || vk_header[0] > (uint64_t)size - sizeof(header))
+      goto corrupt;
+
+   if (     memcmp(&header, &expected, sizeof(header))
+         || vk_header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+         || vk_header[2] != expected.vendor_id
+         || vk_header[3] != expected.device_id
+         || memcmp(data + sizeof(vk_header), expected.uuid, VK_UUID_SIZE))
+   {
+      RARCH_WARN("[Vulkan]: Ignoring pipeline cache \"%s\" of another GPU or driver.\n",
+            path);
+      free(buf);
+      return NULL;
+   }
+
+   *len = (size_t)size - sizeof(header);
+   memmove(buf, data, *len);
+   return buf;
+
+corrupt:
+   RARCH_WARN("[Vulkan]: Ignoring truncated or corrupt pipeline cache \"%s\".\n",
+         path);
+   free(buf);
+   return NULL;
+}
+
+/* Writes the pipeline cache out, unless it holds no more
+ * than what was last loaded or saved */
+static void vulkan_pipeline_cache_save(vk_t *vk)
+{
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   struct vulkan_pipeline_cache_header header;
+   size_t len   = 0;
+   uint8_t *buf = NULL;
+
+   if (     vk->pipelines.cache == VK_NULL_HANDLE
+         || !vulkan_pipeline_cache_path(path, sizeof(path)))
+      return;
+
+   /* Pipelines are only ever added, so an unchanged
+    * size means there is nothing new to keep */
+   if (     vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &len, NULL) != VK_SUCCESS
+         || len == 0
+         || len == vk->pipelines.cache_size)
+      return;
+
+   if (!(buf = (uint8_t*)malloc(sizeof(header) + len)))
+      return;
+
+   vulkan_pipeline_cache_header_init(vk, &header);
+   memcpy(buf, &header, sizeof(header));
+
+   if (vkGetPipelineCacheData(vk->context->device,
+            vk->pipelines.cache, &len, buf + sizeof(header)) != VK_SUCCESS)
+      goto end;
+
+   /* Written next to the old one and renamed over it, so
+    * that a crash halfway through never leaves a torn file */
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, buf, sizeof(header) + len))
+      goto error;
+
+   if (filestream_rename(tmp_path, path) != 0)
+   {
+      /* Renaming over an existing file fails on Windows */
+      filestream_delete(path);
+
+      if (filestream_rename(tmp_path, path) != 0)
+      {
+         filestream_delete(tmp_path);
+         goto error;
+      }
+   }
+
+   vk->pipelines.cache_size = len;
+   RARCH_LOG("[Vulkan]: Saved pipeline cache (%u bytes).\n",
+         (unsigned)len);
+   goto end;
+
+error:
+   RARCH_WARN("[Vulkan]: Could not save pipeline cache to \"%s\".\n",
+         path);
+end:
+   free(buf);
+}
+
 static void vulkan_init_static_resources(vk_t *vk)
 {
    unsigned i;
    uint32_t blank[4 * 4];
+   size_t cache_len                  = 0;
+   void *cache_data                  = NULL;
    VkCommandPoolCreateInfo pool_info = {
       VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
 
@@ -890,8 +1058,32 @@ static void vulkan_init_static_resources(vk_t *vk)
    if (!vk->context)
       return;
 
-   vkCreatePipelineCache(vk->context->device,
-         &cache, NULL, &vk->pipelines.cache);
+   /* Pipelines built in earlier sessions needn't be built again */
+   vk->pipelines.cache_size = 0;
+   if ((cache_data = vulkan_pipeline_cache_load(vk, &cache_len)))
+   {
+      cache.initialDataSize = cache_len;
+      cache.pInitialData    = cache_data;
+   }
+
+   if (     vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache) != VK_SUCCESS
+         && cache_data)
+   {
+      /* Start over with an empty cache */
+      cache.initialDataSize = 0;
+      cache.pInitialData    = NULL;
+      vkCreatePipelineCache(vk->context->device,
+            &cache, NULL, &vk->pipelines.cache);
+   }
+   else if (cache_data)
+   {
+      vk->pipelines.cache_size = cache_len;
+      RARCH_LOG("[Vulkan]: Loaded pipeline cache (%u bytes).\n",
+            (unsigned)cache_len);
+   }
+
+   free(cache_data);
 
    pool_info.queueFamilyIndex = vk->context->graphics_queue_index;
 
@@ -909,6 +1101,7 @@ static void vulkan_init_static_resources(vk_t *vk)
 static void vulkan_deinit_static_resources(vk_t *vk)
 {
    unsigned i;
+   vulkan_pipeline_cache_save(vk);
    vkDestroyPipelineCache(vk->context->device,
          vk->pipelines.cache, NULL);
    vulkan_destroy_texture(
@@ -1437,6 +1630,11 @@ static bool vulkan_set_shader(void *data,
       return false;
    }
 
+   /* Keep the pipelines of the new preset in case RetroArch
+    * doesn't exit cleanly - this is skipped when the preset
+    * built nothing that wasn't cached already */
+   vulkan_pipeline_cache_save(vk);
+
    return true;
 }
 
@@ -45,26 +45,36 @@ struct SlangProcess
       TBuiltInResource Resources;
 };
 
-/* We don't use glslang from multiple threads, but to be sure.
- * Initializing TLS and freeing it for glslang works around 
+/* Initializing TLS and freeing it for glslang works around 
  * a really bizarre issue where the TLS key is suddenly 
  * corrupted *somehow*.
+ *
+ * Passes of a preset get compiled from several threads at
+ * once, which glslang is fine with as long as the process
+ * is only initialized and finalized while nothing else is
+ * compiling, so it stays initialized while anyone is.
  */
 static std::mutex glslang_global_lock;
+static unsigned glslang_process_users = 0;
 
-struct SlangProcessHolder
+void glslang::acquire_process()
 {
-   SlangProcessHolder()
-   {
-      glslang_global_lock.lock();
+   std::lock_guard<std::mutex> holder(glslang_global_lock);
+   if (glslang_process_users++ == 0)
       InitializeProcess();
-   }
+}
 
-   ~SlangProcessHolder()
-   {
+void glslang::release_process()
+{
+   std::lock_guard<std::mutex> holder(glslang_global_lock);
+   if (--glslang_process_users == 0)
       FinalizeProcess();
-      glslang_global_lock.unlock();
-   }
+}
+
+struct SlangProcessHolder
+{
+   SlangProcessHolder()  { acquire_process(); }
+   ~SlangProcessHolder() { release_process(); }
 };
 
 SlangProcess::SlangProcess()
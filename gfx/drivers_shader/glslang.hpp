@@ -18,6 +18,11 @@ namespace glslang
     };
 
     bool compile_spirv(const std::string &source, Stage stage, std::vector<uint32_t> *spirv);
+
+    /* Keep glslang initialized in between compiles, so that
+     * a batch of them doesn't set it up again for each one. */
+    void acquire_process();
+    void release_process();
 }
 
 #endif
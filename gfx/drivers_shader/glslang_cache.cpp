@@ -0,0 +1,309 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <retro_miscellaneous.h>
+#include <lrc_hash.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "glslang_cache.h"
+#include "../../configuration.h"
+#include "../../verbosity.h"
+
+#define GLSLANG_CACHE_DIR     "slang"
+#define GLSLANG_CACHE_EXT     "spv"
+#define GLSLANG_CACHE_MAGIC   0x56505352 /* "RSPV" */
+#define GLSLANG_SPIRV_MAGIC   0x07230203
+
+/* Bump whenever the compiler or the way stages are built
+ * changes what SPIR-V the same source turns into */
+#define GLSLANG_CACHE_VERSION 1
+
+/* How stale the last use of an entry may get before a
+ * hit writes the new time back */
+#define GLSLANG_CACHE_TOUCH_INTERVAL (24 * 60 * 60)
+
+struct glslang_cache_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint64_t last_used;
+   uint32_t vertex_words;
+   uint32_t fragment_words;
+};
+
+struct glslang_cache_entry
+{
+   std::string path;
+   uint64_t last_used;
+   uint64_t size;
+};
+
+/* Size of the entries in the directory the cache was last
+ * used with. It is scanned for once, then kept up to date
+ * by stores, so that a store only goes through the whole
+ * directory when the cache may actually be full. */
+static char glslang_cache_size_dir[PATH_MAX_LENGTH];
+static uint64_t glslang_cache_size;
+
+static bool glslang_cache_entry_older(const glslang_cache_entry &a,
+      const glslang_cache_entry &b)
+{
+   return a.last_used < b.last_used;
+}
+
+static bool glslang_cache_read_header(RFILE *file,
+      struct glslang_cache_header *header)
+{
+   return filestream_read(file, header, sizeof(*header))
+            == (int64_t)sizeof(*header)
+         && header->magic   == GLSLANG_CACHE_MAGIC
+         && header->version == GLSLANG_CACHE_VERSION;
+}
+
+static void glslang_cache_entry_path(char *s, size_t len,
+      const char *dir, const char *key)
+{
+   char name[GLSLANG_CACHE_KEY_SIZE + sizeof("." GLSLANG_CACHE_EXT)];
+   strlcpy(name, key, sizeof(name));
+   strlcat(name, "." GLSLANG_CACHE_EXT, sizeof(name));
+   fill_pathname_join(s, dir, name, len);
+}
+
+bool glslang_cache_dir(char *s, size_t len)
+{
+   settings_t *settings = config_get_ptr();
+   const char *dir      = settings->paths.directory_cache;
+
+   if (string_is_empty(dir))
+      return false;
+
+   fill_pathname_join(s, dir, GLSLANG_CACHE_DIR, len);
+   return true;
+}
+
+void glslang_cache_key(const struct string_list *lines, char *key)
+{
+   size_t i;
+   char version[32];
+   std::string source;
+
+   snprintf(version, sizeof(version), "slang-spirv-%d\n",
+         GLSLANG_CACHE_VERSION);
+   source.append(version);
+
+   for (i = 0; i < lines->size; i++)
+   {
+      source.append(lines->elems[i].data);
+      source.append("\n");
+   }
+
+   sha256_hash(key, (const uint8_t*)source.data(), source.size());
+}
+
+bool glslang_cache_load(const char *dir, const char *key,
+      glslang_output *output)
+{
+   char path[PATH_MAX_LENGTH];
+   struct glslang_cache_header header;
+   int64_t vertex_size;
+   int64_t fragment_size;
+   RFILE *file = NULL;
+
+   glslang_cache_entry_path(path, sizeof(path), dir, key);
+
+   if (!(file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   if (!glslang_cache_read_header(file, &header))
+      goto error;
+
+   vertex_size   = (int64_t)header.vertex_words   * sizeof(uint32_t);
+   fragment_size = (int64_t)header.fragment_words * sizeof(uint32_t);
+
+   if (     !header.vertex_words
+         || !header.fragment_words
+         || filestream_get_size(file)
+            != (int64_t)sizeof(header) + vertex_size + fragment_size)
+      goto error;
+
+   output->vertex.resize(header.vertex_words);
+   output->fragment.resize(header.fragment_words);
+
+   if (     filestream_read(file, output->vertex.data(), vertex_size)
+            != vertex_size
+         || filestream_read(file, output->fragment.data(), fragment_size)
+            != fragment_size
+         || output->vertex[0]   != GLSLANG_SPIRV_MAGIC
+         || output->fragment[0] != GLSLANG_SPIRV_MAGIC)
+      goto error;
+
+   filestream_close(file);
+
+   /* Keep the entry from being evicted, without rewriting
+    * it on every single load */
+   if ((uint64_t)time(NULL) > header.last_used + GLSLANG_CACHE_TOUCH_INTERVAL)
+   {
+      if ((file = filestream_open(path, RETRO_VFS_FILE_ACCESS_READ_WRITE
+                  | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+                  RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      {
+         header.last_used = (uint64_t)time(NULL);
+         if (filestream_seek(file, offsetof(struct glslang_cache_header,
+                     last_used), RETRO_VFS_SEEK_POSITION_START) == 0)
+            filestream_write(file, &header.last_used,
+                  sizeof(header.last_used));
+         filestream_close(file);
+      }
+   }
+
+   return true;
+
+error:
+   filestream_close(file);
+   output->vertex.clear();
+   output->fragment.clear();
+   RARCH_WARN("[slang]: Discarding invalid cache entry \"%s\".\n", path);
+   filestream_delete(path);
+   return false;
+}
+
+/* Measures the cache, and deletes the entries used longest
+ * ago until it is well under its limit again if it is past
+ * it, so that it isn't trimmed on every store once full. */
+static void glslang_cache_evict(const char *dir)
+{
+   size_t i;
+   uint64_t total = 0;
+   std::vector<glslang_cache_entry> entries;
+   struct string_list *list = dir_list_new(dir, GLSLANG_CACHE_EXT,
+         false, false, false, false);
+
+   if (!list)
+      return;
+
+   for (i = 0; i < list->size; i++)
+   {
+      struct glslang_cache_header header;
+      glslang_cache_entry entry;
+      RFILE *file = filestream_open(list->elems[i].data,
+            RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+      if (!file)
+         continue;
+
+      entry.path      = list->elems[i].data;
+      entry.size      = (uint64_t)filestream_get_size(file);
+      /* Entries we can't read go first */
+      entry.last_used = glslang_cache_read_header(file, &header)
+         ? header.last_used : 0;
+      filestream_close(file);
+
+      total          += entry.size;
+      entries.push_back(entry);
+   }
+
+   string_list_free(list);
+
+   strlcpy(glslang_cache_size_dir, dir, sizeof(glslang_cache_size_dir));
+   glslang_cache_size = total;
+
+   if (total <= GLSLANG_CACHE_MAX_SIZE)
+      return;
+
+   std::sort(entries.begin(), entries.end(), glslang_cache_entry_older);
+
+   for (i = 0; i < entries.size()
+         && total > GLSLANG_CACHE_MAX_SIZE / 4 * 3; i++)
+   {
+      if (filestream_delete(entries[i].path.c_str()) == 0)
+         total -= entries[i].size;
+   }
+
+   glslang_cache_size = total;
+
+   RARCH_LOG("[slang]: Evicted %u entries from the shader cache.\n",
+         (unsigned)i);
+}
+
+void glslang_cache_store(const char *dir, const char *key,
+      const glslang_output *output)
+{
+   char path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   struct glslang_cache_header header;
+   size_t vertex_size   = output->vertex.size()   * sizeof(uint32_t);
+   size_t fragment_size = output->fragment.size() * sizeof(uint32_t);
+   std::vector<uint8_t> buf(sizeof(header) + vertex_size + fragment_size);
+
+   if (!path_is_directory(dir) && !path_mkdir(dir))
+      return;
+
+   if (!string_is_equal(dir, glslang_cache_size_dir))
+      glslang_cache_evict(dir);
+
+   header.magic          = GLSLANG_CACHE_MAGIC;
+   header.version        = GLSLANG_CACHE_VERSION;
+   header.last_used      = (uint64_t)time(NULL);
+   header.vertex_words   = (uint32_t)output->vertex.size();
+   header.fragment_words = (uint32_t)output->fragment.size();
+
+   memcpy(buf.data(), &header, sizeof(header));
+   memcpy(buf.data() + sizeof(header), output->vertex.data(), vertex_size);
+   memcpy(buf.data() + sizeof(header) + vertex_size,
+         output->fragment.data(), fragment_size);
+
+   glslang_cache_entry_path(path, sizeof(path), dir, key);
+
+   /* A half written entry would be taken for a corrupt
+    * one and deleted by glslang_cache_load(), so entries
+    * only ever appear under their name complete */
+   strlcpy(tmp_path, path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   if (!filestream_write_file(tmp_path, buf.data(), buf.size()))
+      goto error;
+
+   if (filestream_rename(tmp_path, path) != 0)
+   {
+      /* Renaming over an existing file fails on Windows */
+      filestream_delete(path);
+
+      if (filestream_rename(tmp_path, path) != 0)
+      {
+         filestream_delete(tmp_path);
+         goto error;
+      }
+   }
+
+   glslang_cache_size += buf.size();
+   if (glslang_cache_size > GLSLANG_CACHE_MAX_SIZE)
+      glslang_cache_evict(dir);
+   return;
+
+error:
+   RARCH_WARN("[slang]: Could not write cache entry \"%s\".\n", path);
+}
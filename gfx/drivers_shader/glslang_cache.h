@@ -0,0 +1,54 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GLSLANG_CACHE_HPP
+#define GLSLANG_CACHE_HPP
+
+#include <lists/string_list.h>
+
+#include "glslang_util.h"
+#include "glslang_util_cxx.h"
+
+/* SPIR-V of slang shaders, kept on disk so that shaders
+ * already compiled once needn't be compiled again.
+ *
+ * Entries are named after a hash of the shader source
+ * with its includes, so editing a shader or anything it
+ * includes makes a new entry. Once the cache grows past
+ * GLSLANG_CACHE_MAX_SIZE, the entries used longest ago
+ * are deleted. */
+
+#define GLSLANG_CACHE_KEY_SIZE 65
+#define GLSLANG_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+/* Gets the directory of the cache, false if there is
+ * no cache directory to keep it in */
+bool glslang_cache_dir(char *s, size_t len);
+
+/* Gets the key of the shader made of @lines, as read
+ * by glslang_read_shader_file() */
+void glslang_cache_key(const struct string_list *lines, char *key);
+
+/* Reads the SPIR-V of both stages into @output */
+bool glslang_cache_load(const char *dir, const char *key,
+      glslang_output *output);
+
+/* Writes the SPIR-V of both stages as the entry for @key,
+ * evicting old entries if that takes the cache past its
+ * limit. Not thread safe - stores must all be made from
+ * one thread at a time. */
+void glslang_cache_store(const char *dir, const char *key,
+      const glslang_output *output);
+
+#endif
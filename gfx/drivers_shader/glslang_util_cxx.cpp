@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <memory>
 #include <algorithm>
 
 #include <retro_miscellaneous.h>
@@ -23,15 +24,21 @@
 #include <file/config_file.h>
 #include <streams/file_stream.h>
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "glslang_util.h"
 #include "glslang_util_cxx.h"
 #if defined(HAVE_GLSLANG)
 #include "glslang.hpp"
+#include "glslang_cache.h"
 #endif
 #include "../../verbosity.h"
 
@@ -218,22 +225,42 @@ bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta)
    return true;
 }
 
-bool glslang_compile_shader(const char *shader_path, glslang_output *output)
-{
 #if defined(HAVE_GLSLANG)
+/* Loads the shader from the cache in @cache_dir if it is
+ * there, and compiles it otherwise. @cache_key is set to
+ * the key of a freshly compiled shader, for the caller
+ * to store it under, and left empty otherwise. */
+static bool glslang_load_or_compile_shader(const char *shader_path,
+      glslang_output *output, const char *cache_dir, char *cache_key)
+{
    struct string_list lines;
-   
+
+   cache_key[0] = '\0';
+
    if (!string_list_initialize(&lines))
       return false;
 
-   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
-
    if (!glslang_read_shader_file(shader_path, &lines, true))
       goto error;
    output->meta = glslang_meta{};
    if (!glslang_parse_meta(&lines, &output->meta))
       goto error;
 
+   if (cache_dir)
+   {
+      glslang_cache_key(&lines, cache_key);
+      if (glslang_cache_load(cache_dir, cache_key, output))
+      {
+         RARCH_LOG("[slang]: Loaded shader \"%s\" from cache.\n",
+               shader_path);
+         cache_key[0] = '\0';
+         string_list_deinitialize(&lines);
+         return true;
+      }
+   }
+
+   RARCH_LOG("[slang]: Compiling shader \"%s\".\n", shader_path);
+
    if (!glslang::compile_spirv(build_stage_source(&lines, "vertex"),
             glslang::StageVertex, &output->vertex))
    {
@@ -253,8 +280,175 @@ bool glslang_compile_shader(const char *shader_path, glslang_output *output)
    return true;
 
 error:
+   cache_key[0] = '\0';
    string_list_deinitialize(&lines);
+   return false;
+}
 #endif
 
+bool glslang_compile_shader(const char *shader_path, glslang_output *output)
+{
+#if defined(HAVE_GLSLANG)
+   char cache_dir[PATH_MAX_LENGTH];
+   char cache_key[GLSLANG_CACHE_KEY_SIZE];
+   bool cache = glslang_cache_dir(cache_dir, sizeof(cache_dir));
+
+   if (!glslang_load_or_compile_shader(shader_path, output,
+            cache ? cache_dir : NULL, cache_key))
+      return false;
+
+   if (!string_is_empty(cache_key))
+      glslang_cache_store(cache_dir, cache_key, output);
+
+   return true;
+#else
    return false;
+#endif
+}
+
+struct glslang_compile_job
+{
+#ifdef HAVE_THREADS
+   slock_t *lock;
+#endif
+   const char * const *paths;
+   glslang_output *outputs;
+   bool *compiled;
+   const char *cache_dir;
+   /* GLSLANG_CACHE_KEY_SIZE bytes per shader */
+   char *cache_keys;
+   unsigned count;
+   unsigned next;
+};
+
+static void glslang_compile_worker(void *data)
+{
+   glslang_compile_job *job = (glslang_compile_job*)data;
+
+   for (;;)
+   {
+      unsigned i;
+
+#ifdef HAVE_THREADS
+      slock_lock(job->lock);
+#endif
+      i = job->next++;
+#ifdef HAVE_THREADS
+      slock_unlock(job->lock);
+#endif
+
+      if (i >= job->count)
+         break;
+
+#if defined(HAVE_GLSLANG)
+      /* Stores are left to the calling thread - the
+       * cache isn't safe to write from several at once */
+      job->compiled[i] = glslang_load_or_compile_shader(job->paths[i],
+            &job->outputs[i], job->cache_dir,
+            job->cache_keys + i * GLSLANG_CACHE_KEY_SIZE);
+#else
+      job->compiled[i] = glslang_compile_shader(job->paths[i],
+            &job->outputs[i]);
+#endif
+   }
+}
+
+bool glslang_compile_shaders(const char * const *paths,
+      glslang_output *outputs, unsigned count,
+      unsigned threads, unsigned *failed)
+{
+   unsigned i;
+   glslang_compile_job job;
+   std::unique_ptr<bool[]> compiled(new bool[count]());
+#if defined(HAVE_GLSLANG)
+   char cache_dir[PATH_MAX_LENGTH];
+   std::unique_ptr<char[]> cache_keys(
+         new char[count * GLSLANG_CACHE_KEY_SIZE]());
+#endif
+#ifdef HAVE_THREADS
+   std::vector<sthread_t*> workers;
+#endif
+
+   if (!threads)
+      threads         = cpu_features_get_core_amount();
+   if (threads > count)
+      threads         = count;
+
+   job.paths          = paths;
+   job.outputs        = outputs;
+   job.compiled       = compiled.get();
+   job.cache_dir      = NULL;
+   job.cache_keys     = NULL;
+   job.count          = count;
+   job.next           = 0;
+
+#if defined(HAVE_GLSLANG)
+   if (glslang_cache_dir(cache_dir, sizeof(cache_dir)))
+      job.cache_dir   = cache_dir;
+   job.cache_keys     = cache_keys.get();
+
+   glslang::acquire_process();
+#endif
+
+#ifdef HAVE_THREADS
+   job.lock           = threads > 1 ? slock_new() : NULL;
+
+   if (job.lock)
+   {
+      /* The calling thread compiles too */
+      for (i = 1; i < threads; i++)
+      {
+         sthread_t *worker = sthread_create(glslang_compile_worker, &job);
+         if (!worker)
+            break;
+         workers.push_back(worker);
+      }
+
+      RARCH_LOG("[slang]: Compiling %u shaders on %u threads.\n",
+            count, (unsigned)workers.size() + 1);
+   }
+#endif
+
+   glslang_compile_worker(&job);
+
+#ifdef HAVE_THREADS
+   for (i = 0; i < workers.size(); i++)
+      sthread_join(workers[i]);
+   if (job.lock)
+      slock_free(job.lock);
+#endif
+
+#if defined(HAVE_GLSLANG)
+   glslang::release_process();
+
+   for (i = 0; i < count; i++)
+   {
+      unsigned j;
+      const char *key = job.cache_keys + i * GLSLANG_CACHE_KEY_SIZE;
+
+      if (string_is_empty(key))
+         continue;
+
+      /* Passes running the same shader compiled it once each */
+      for (j = 0; j < i; j++)
+         if (string_is_equal(key,
+                  job.cache_keys + j * GLSLANG_CACHE_KEY_SIZE))
+            break;
+
+      if (j == i)
+         glslang_cache_store(job.cache_dir, key, &outputs[i]);
+   }
+#endif
+
+   for (i = 0; i < count; i++)
+   {
+      if (!compiled[i])
+      {
+         if (failed)
+            *failed = i;
+         return false;
+      }
+   }
+
+   return true;
 }
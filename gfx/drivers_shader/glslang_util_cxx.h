@@ -55,6 +55,14 @@ struct glslang_output
 
 bool glslang_compile_shader(const char *shader_path, glslang_output *output);
 
+/* Compiles the @count shaders at @paths into @outputs,
+ * spread over up to @threads threads (0 picks one per core).
+ * On failure, @failed is set to the first shader which
+ * didn't compile. */
+bool glslang_compile_shaders(const char * const *paths,
+      glslang_output *outputs, unsigned count,
+      unsigned threads, unsigned *failed);
+
 /* Helpers for internal use. */
 bool glslang_parse_meta(const struct string_list *lines, glslang_meta *meta);
 
@@ -33,6 +33,7 @@
 #include "spirv_glsl.hpp"
 
 #include "../common/gl_core_common.h"
+#include "../common/gl_program_cache.h"
 
 #include "../../verbosity.h"
 #include "../../msg_hash.h"
@@ -163,57 +164,72 @@ GLuint gl_core_cross_compile_program(
 
       auto vertex_source = vertex_compiler.compile();
       auto fragment_source = fragment_compiler.compile();
-      GLuint vertex_shader = gl_core_compile_shader(GL_VERTEX_SHADER, vertex_source.c_str());
-      GLuint fragment_shader = gl_core_compile_shader(GL_FRAGMENT_SHADER, fragment_source.c_str());
+      const char *sources[2] = { vertex_source.c_str(), fragment_source.c_str() };
+      char cache_key[GL_PROGRAM_CACHE_KEY_SIZE];
+      bool cache             = gl_program_cache_key(cache_key, sources, 2);
 
-#if 0
-      RARCH_LOG("[GLCore]: Vertex shader:\n========\n%s\n=======\n", vertex_source.c_str());
-      RARCH_LOG("[GLCore]: Fragment shader:\n========\n%s\n=======\n", fragment_source.c_str());
-#endif
+      if (cache)
+         program = gl_program_cache_load(cache_key);
 
-      if (!vertex_shader || !fragment_shader)
+      if (!program)
       {
-         RARCH_ERR("[GLCore]: One or more shaders failed to compile.\n");
-         if (vertex_shader)
-            glDeleteShader(vertex_shader);
-         if (fragment_shader)
-            glDeleteShader(fragment_shader);
-         return 0;
-      }
+         GLuint vertex_shader = gl_core_compile_shader(GL_VERTEX_SHADER, vertex_source.c_str());
+         GLuint fragment_shader = gl_core_compile_shader(GL_FRAGMENT_SHADER, fragment_source.c_str());
 
-      program = glCreateProgram();
-      glAttachShader(program, vertex_shader);
-      glAttachShader(program, fragment_shader);
-      for (auto &res : vertex_resources.stage_inputs)
-      {
-         char loc_buf[64];
-         uint32_t _loc = vertex_compiler.get_decoration(res.id, spv::DecorationLocation);
-         snprintf(loc_buf, sizeof(loc_buf), "RARCH_ATTRIBUTE_%d", _loc);
-         glBindAttribLocation(program, _loc, loc_buf);
-      }
-      glLinkProgram(program);
-      glDeleteShader(vertex_shader);
-      glDeleteShader(fragment_shader);
+#if 0
+         RARCH_LOG("[GLCore]: Vertex shader:\n========\n%s\n=======\n", vertex_source.c_str());
+         RARCH_LOG("[GLCore]: Fragment shader:\n========\n%s\n=======\n", fragment_source.c_str());
+#endif
 
-      GLint status;
-      glGetProgramiv(program, GL_LINK_STATUS, &status);
-      if (!status)
-      {
-         GLint length;
-         glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
-         if (length > 0)
+         if (!vertex_shader || !fragment_shader)
          {
-            char *info_log = (char*)malloc(length);
+            RARCH_ERR("[GLCore]: One or more shaders failed to compile.\n");
+            if (vertex_shader)
+               glDeleteShader(vertex_shader);
+            if (fragment_shader)
+               glDeleteShader(fragment_shader);
+            return 0;
+         }
 
-            if (info_log)
+         program = glCreateProgram();
+         glAttachShader(program, vertex_shader);
+         glAttachShader(program, fragment_shader);
+         for (auto &res : vertex_resources.stage_inputs)
+         {
+            char loc_buf[64];
+            uint32_t _loc = vertex_compiler.get_decoration(res.id, spv::DecorationLocation);
+            snprintf(loc_buf, sizeof(loc_buf), "RARCH_ATTRIBUTE_%d", _loc);
+            glBindAttribLocation(program, _loc, loc_buf);
+         }
+         if (cache)
+            gl_program_cache_prepare(program);
+         glLinkProgram(program);
+         glDeleteShader(vertex_shader);
+         glDeleteShader(fragment_shader);
+
+         GLint status;
+         glGetProgramiv(program, GL_LINK_STATUS, &status);
+         if (!status)
+         {
+            GLint length;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+            if (length > 0)
             {
-               glGetProgramInfoLog(program, length, &length, info_log);
-               RARCH_ERR("[GLCore]: Failed to link program: %s\n", info_log);
-               free(info_log);
-               glDeleteProgram(program);
-               return 0;
+               char *info_log = (char*)malloc(length);
+
+               if (info_log)
+               {
+                  glGetProgramInfoLog(program, length, &length, info_log);
+                  RARCH_ERR("[GLCore]: Failed to link program: %s\n", info_log);
+                  free(info_log);
+                  glDeleteProgram(program);
+                  return 0;
+               }
             }
          }
+
+         if (cache && status)
+            gl_program_cache_store(cache_key, program);
       }
 
       glUseProgram(program);
@@ -2218,9 +2234,26 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   /* Compile all passes up front, spread over several threads,
+    * the GL objects get created further below */
+   std::vector<glslang_output> outputs(shader->passes);
+   std::vector<const char*> paths(shader->passes);
+   unsigned failed = 0;
+
+   for (i = 0; i < shader->passes; i++)
+      paths[i] = shader->pass[i].source.path;
+
+   if (!glslang_compile_shaders(paths.data(), outputs.data(),
+            shader->passes, 0, &failed))
+   {
+      RARCH_ERR("[GLCore]: Failed to compile shader: \"%s\".\n",
+            paths[failed]);
+      return nullptr;
+   }
+
    for (i = 0; i < shader->passes; i++)
    {
-      glslang_output output;
+      glslang_output &output             = outputs[i];
       struct gl_core_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2236,13 +2269,6 @@ gl_core_filter_chain_t *gl_core_filter_chain_create_from_preset(
       pass_info.address       = GLSLANG_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
-      {
-         RARCH_ERR("[GLCore]: Failed to compile shader: \"%s\".\n",
-               pass->source.path);
-         return nullptr;
-      }
-
       for (auto &meta_param : output.meta.parameters)
       {
          if (shader->num_parameters >= GFX_MAX_PARAMETERS)
@@ -31,6 +31,7 @@
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
 #include <gfx/gl_capabilities.h>
 #include "../common/gl_common.h"
+#include "../common/gl_program_cache.h"
 #endif
 
 #include "shader_glsl.h"
@@ -276,13 +277,11 @@ static void gl_glsl_print_linker_log(GLuint obj)
    free(info_log);
 }
 
-static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
-      GLuint shader,
+/* Fills in the 4 sources making up a shader stage */
+static void gl_glsl_shader_sources(glsl_shader_data_t *glsl,
+      const char **source, char *version, size_t version_len,
       const char *define, const char *program)
 {
-   GLint status;
-   const char *source[4];
-   char version[32];
    const char *existing_version = strstr(program, "#version");
 
    version[0]                   = '\0';
@@ -300,7 +299,7 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
          version_no = 300;
       }
 #endif
-      snprintf(version, sizeof(version), "#version %u%s\n", version_no, version_extra);
+      snprintf(version, version_len, "#version %u%s\n", version_no, version_extra);
       RARCH_LOG("[GLSL]: Using GLSL version %u%s.\n", version_no, version_extra);
    }
    else if (glsl_core)
@@ -324,7 +323,7 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
             break;
       }
 
-      snprintf(version, sizeof(version), "#version %u\n", version_no);
+      snprintf(version, version_len, "#version %u\n", version_no);
       RARCH_LOG("[GLSL]: Using GLSL version %u.\n", version_no);
    }
 
@@ -332,8 +331,13 @@ static bool gl_glsl_compile_shader(glsl_shader_data_t *glsl,
    source[1] = define;
    source[2] = glsl->alias_define;
    source[3] = program;
+}
+
+static bool gl_glsl_compile_shader(GLuint shader, const char **source)
+{
+   GLint status;
 
-   glShaderSource(shader, ARRAY_SIZE(source), source, NULL);
+   glShaderSource(shader, 4, source, NULL);
    glCompileShader(shader);
 
    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
@@ -364,63 +368,90 @@ static bool gl_glsl_compile_program(
       void *program_data,
       struct shader_program_info *program_info)
 {
+   char vertex_version[32];
+   char fragment_version[32];
+   char cache_key[GL_PROGRAM_CACHE_KEY_SIZE];
+   const char *source[8]    = {NULL};
+   bool cache               = false;
+   GLuint prog              = 0;
    glsl_shader_data_t *glsl = (glsl_shader_data_t*)data;
    struct shader_program_glsl_data *program = (struct shader_program_glsl_data*)program_data;
-   GLuint prog = glCreateProgram();
 
    if (!program)
       program = &glsl->prg[idx];
 
-   if (!prog)
-      goto error;
-
    if (program_info->vertex)
+      gl_glsl_shader_sources(glsl, &source[0],
+            vertex_version, sizeof(vertex_version),
+            "#define VERTEX\n#define PARAMETER_UNIFORM\n", program_info->vertex);
+
+   if (program_info->fragment)
+      gl_glsl_shader_sources(glsl, &source[4],
+            fragment_version, sizeof(fragment_version),
+            "#define FRAGMENT\n#define PARAMETER_UNIFORM\n", program_info->fragment);
+
+   if (program_info->vertex || program_info->fragment)
+      cache = gl_program_cache_key(cache_key, source, ARRAY_SIZE(source));
+
+   if (cache && (prog = gl_program_cache_load(cache_key)))
+      RARCH_LOG("[GLSL]: Loaded GLSL program #%u from cache.\n", idx);
+   else
    {
-      RARCH_LOG("[GLSL]: Found GLSL vertex shader.\n");
-      program->vprg = glCreateShader(GL_VERTEX_SHADER);
+      if (!(prog = glCreateProgram()))
+         goto error;
 
-      if (!gl_glsl_compile_shader(
-               glsl,
-               program->vprg,
-               "#define VERTEX\n#define PARAMETER_UNIFORM\n", program_info->vertex))
+      if (program_info->vertex)
       {
-         RARCH_ERR("Failed to compile vertex shader #%u\n", idx);
-         goto error;
-      }
+         RARCH_LOG("[GLSL]: Found GLSL vertex shader.\n");
+         program->vprg = glCreateShader(GL_VERTEX_SHADER);
 
-      glAttachShader(prog, program->vprg);
-   }
+         if (!gl_glsl_compile_shader(program->vprg, &source[0]))
+         {
+            RARCH_ERR("Failed to compile vertex shader #%u\n", idx);
+            goto error;
+         }
 
-   if (program_info->fragment)
-   {
-      RARCH_LOG("[GLSL]: Found GLSL fragment shader.\n");
-      program->fprg = glCreateShader(GL_FRAGMENT_SHADER);
-      if (!gl_glsl_compile_shader(glsl, program->fprg,
-               "#define FRAGMENT\n#define PARAMETER_UNIFORM\n", program_info->fragment))
+         glAttachShader(prog, program->vprg);
+      }
+
+      if (program_info->fragment)
       {
-         RARCH_ERR("Failed to compile fragment shader #%u\n", idx);
-         goto error;
+         RARCH_LOG("[GLSL]: Found GLSL fragment shader.\n");
+         program->fprg = glCreateShader(GL_FRAGMENT_SHADER);
+         if (!gl_glsl_compile_shader(program->fprg, &source[4]))
+         {
+            RARCH_ERR("Failed to compile fragment shader #%u\n", idx);
+            goto error;
+         }
+
+         glAttachShader(prog, program->fprg);
       }
 
-      glAttachShader(prog, program->fprg);
+      if (program_info->vertex || program_info->fragment)
+      {
+         RARCH_LOG("[GLSL]: Linking GLSL program.\n");
+         if (cache)
+            gl_program_cache_prepare(prog);
+         if (!gl_glsl_link_program(prog))
+            goto error;
+
+         /* Clean up dead memory. We're not going to relink the program.
+          * Detaching first seems to kill some mobile drivers
+          * (according to the intertubes anyways). */
+         if (program->vprg)
+            glDeleteShader(program->vprg);
+         if (program->fprg)
+            glDeleteShader(program->fprg);
+         program->vprg = 0;
+         program->fprg = 0;
+
+         if (cache)
+            gl_program_cache_store(cache_key, prog);
+      }
    }
 
    if (program_info->vertex || program_info->fragment)
    {
-      RARCH_LOG("[GLSL]: Linking GLSL program.\n");
-      if (!gl_glsl_link_program(prog))
-         goto error;
-
-      /* Clean up dead memory. We're not going to relink the program.
-       * Detaching first seems to kill some mobile drivers
-       * (according to the intertubes anyways). */
-      if (program->vprg)
-         glDeleteShader(program->vprg);
-      if (program->fprg)
-         glDeleteShader(program->fprg);
-      program->vprg = 0;
-      program->fprg = 0;
-
       glUseProgram(prog);
 #if defined(VITA)
       glUniform1i(gl_glsl_get_uniform(glsl, prog, "vTexture"), 0);
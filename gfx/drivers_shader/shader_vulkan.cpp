@@ -2577,6 +2577,9 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
 {
    unsigned i;
    std::unique_ptr<video_shader> shader{ new video_shader() };
+   std::vector<glslang_output> outputs;
+   std::vector<const char*> paths;
+   unsigned failed = 0;
 
    if (!shader)
       return nullptr;
@@ -2597,9 +2600,25 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
 
    shader->num_parameters = 0;
 
+   /* Compile all passes up front, spread over several threads,
+    * the Vulkan objects get created further below */
+   outputs.resize(shader->passes);
+   paths.resize(shader->passes);
+
    for (i = 0; i < shader->passes; i++)
+      paths[i] = shader->pass[i].source.path;
+
+   if (!glslang_compile_shaders(paths.data(), outputs.data(),
+            shader->passes, 0, &failed))
    {
-      glslang_output output;
+      RARCH_ERR("[Vulkan]: Failed to compile shader: \"%s\".\n",
+            paths[failed]);
+      goto error;
+   }
+
+   for (i = 0; i < shader->passes; i++)
+   {
+      glslang_output &output             = outputs[i];
       struct vulkan_filter_chain_pass_info pass_info;
       const video_shader_pass *pass      = &shader->pass[i];
       const video_shader_pass *next_pass =
@@ -2615,13 +2634,6 @@ vulkan_filter_chain_t *vulkan_filter_chain_create_from_preset(
       pass_info.address       = GLSLANG_FILTER_CHAIN_ADDRESS_REPEAT;
       pass_info.max_levels    = 0;
 
-      if (!glslang_compile_shader(pass->source.path, &output))
-      {
-         RARCH_ERR("[Vulkan]: Failed to compile shader: \"%s\".\n",
-               pass->source.path);
-         goto error;
-      }
-
       for (auto &meta_param : output.meta.parameters)
       {
          if (shader->num_parameters >= GFX_MAX_PARAMETERS)
@@ -28,6 +28,10 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "../frontend/frontend_driver.h"
 #include "../dynamic.h"
 #include "../performance_counters.h"
@@ -60,47 +64,58 @@ struct rarch_softfilter
    unsigned threads;
 
 #ifdef HAVE_THREADS
+   /* Workers for all packets but the first, which we run ourselves.
+    * They stay up for the lifetime of the filter and meet us at a
+    * barrier once per frame. */
    struct filter_thread_data *thread_data;
+   slock_t *lock;
+   scond_t *cond_start;
+   scond_t *cond_done;
+   /* Bumped for every frame the workers have to process */
+   unsigned generation;
+   /* Workers yet to finish the current frame */
+   unsigned pending;
+   bool die;
 #endif
 };
 
 #ifdef HAVE_THREADS
-#include <rthreads/rthreads.h>
-
 struct filter_thread_data
 {
    sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
-   slock_t *lock;
-   void *userdata;
-   bool die;
-   bool done;
+   rarch_softfilter_t *filt;
+   unsigned index;
 };
 
 static void filter_thread_loop(void *data)
 {
    struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   rarch_softfilter_t *filt       = thr->filt;
+   unsigned generation            = 0;
 
    for (;;)
    {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
+      const struct softfilter_work_packet *packet = NULL;
+
+      slock_lock(filt->lock);
+      while (filt->generation == generation && !filt->die)
+         scond_wait(filt->cond_start, filt->lock);
+      if (filt->die)
+      {
+         slock_unlock(filt->lock);
          break;
+      }
+      generation = filt->generation;
+      slock_unlock(filt->lock);
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+      packet = &filt->packets[thr->index];
+      if (packet->work)
+         packet->work(filt->impl_data, packet->thread_data);
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+      slock_lock(filt->lock);
+      if (--filt->pending == 0)
+         scond_signal(filt->cond_done);
+      slock_unlock(filt->lock);
    }
 }
 #endif
@@ -240,23 +255,22 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
+      filt->lock       = slock_new();
+      filt->cond_start = scond_new();
+      filt->cond_done  = scond_new();
+      if (!filt->lock || !filt->cond_start || !filt->cond_done)
+         return false;
+
       filt->thread_data = (struct filter_thread_data*)
          calloc(threads, sizeof(*filt->thread_data));
       if (!filt->thread_data)
          return false;
 
-      for (i = 0; i < threads; i++)
+      for (i = 1; i < threads; i++)
       {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
-
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
+         filt->thread_data[i].filt   = filt;
+         filt->thread_data[i].index  = i;
+         filt->thread_data[i].thread = sthread_create(
                filter_thread_loop, &filt->thread_data[i]);
          if (!filt->thread_data[i].thread)
             return false;
@@ -495,28 +509,30 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
       if (filt->plugs[i].lib)
          dylib_close(filt->plugs[i].lib);
    }
-   free(filt->plugs);
 #endif
+   free(filt->plugs);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (filt->thread_data)
    {
-      for (i = 0; i < filt->threads; i++)
+      slock_lock(filt->lock);
+      filt->die = true;
+      scond_broadcast(filt->cond_start);
+      slock_unlock(filt->lock);
+
+      for (i = 1; i < filt->threads; i++)
       {
-         if (!&filt->thread_data[i])
-            continue;
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
+         if (filt->thread_data[i].thread)
+            sthread_join(filt->thread_data[i].thread);
       }
       free(filt->thread_data);
    }
+   if (filt->lock)
+      slock_free(filt->lock);
+   if (filt->cond_start)
+      scond_free(filt->cond_start);
+   if (filt->cond_done)
+      scond_free(filt->cond_done);
 #endif
 
    if (filt->conf)
@@ -564,30 +580,20 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
 #ifdef HAVE_THREADS
    if (filt->threads > 1)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
-
-      /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      /* Release the workers, do our share and wait for theirs */
+      slock_lock(filt->lock);
+      filt->pending = filt->threads - 1;
+      filt->generation++;
+      scond_broadcast(filt->cond_start);
+      slock_unlock(filt->lock);
+
+      if (filt->packets[0].work)
+         filt->packets[0].work(filt->impl_data, filt->packets[0].thread_data);
+
+      slock_lock(filt->lock);
+      while (filt->pending)
+         scond_wait(filt->cond_done, filt->lock);
+      slock_unlock(filt->lock);
       return;
    }
 #endif
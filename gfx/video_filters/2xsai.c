@@ -18,6 +18,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TWOXSAI_HAVE_SSE2
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation twoxsai_get_implementation
 #define softfilter_thread_data twoxsai_softfilter_thread_data
@@ -35,8 +40,10 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
-   int first;
-   int last;
+   /* Rows of the image above and below the slice, which the
+    * worker reads for neighbours but does not write */
+   unsigned rows_above;
+   unsigned rows_below;
 };
 
 struct filter_data
@@ -44,6 +51,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_work_t work;
 };
 
 static unsigned twoxsai_generic_input_fmts(void)
@@ -62,30 +70,6 @@ static unsigned twoxsai_generic_threads(void *data)
    return filt->threads;
 }
 
-static void *twoxsai_generic_create(const struct softfilter_config *config,
-      unsigned in_fmt, unsigned out_fmt,
-      unsigned max_width, unsigned max_height,
-      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
-{
-   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-
-   (void)simd;
-   (void)config;
-   (void)userdata;
-   if (!filt)
-      return NULL;
-   filt->workers = (struct softfilter_thread_data*)
-      calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
-   filt->in_fmt  = in_fmt;
-   if (!filt->workers)
-   {
-      free(filt);
-      return NULL;
-   }
-   return filt;
-}
-
 static void twoxsai_generic_output(void *data,
       unsigned *out_width, unsigned *out_height,
       unsigned width, unsigned height)
@@ -118,23 +102,23 @@ static void twoxsai_generic_destroy(void *data)
 
 #define twoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define twoxsai_declare_variables(typename_t, in, nextline) \
+#define twoxsai_declare_variables(typename_t, prev, in, next, next2, xl, x, xr, xr2) \
          typename_t product, product1, product2; \
-         typename_t colorI = *(in - nextline - 1); \
-         typename_t colorE = *(in - nextline + 0); \
-         typename_t colorF = *(in - nextline + 1); \
-         typename_t colorJ = *(in - nextline + 2); \
-         typename_t colorG = *(in - 1); \
-         typename_t colorA = *(in + 0); \
-         typename_t colorB = *(in + 1); \
-         typename_t colorK = *(in + 2); \
-         typename_t colorH = *(in + nextline - 1); \
-         typename_t colorC = *(in + nextline + 0); \
-         typename_t colorD = *(in + nextline + 1); \
-         typename_t colorL = *(in + nextline + 2); \
-         typename_t colorM = *(in + nextline + nextline - 1); \
-         typename_t colorN = *(in + nextline + nextline + 0); \
-         typename_t colorO = *(in + nextline + nextline + 1);
+         typename_t colorI = prev[xl]; \
+         typename_t colorE = prev[x]; \
+         typename_t colorF = prev[xr]; \
+         typename_t colorJ = prev[xr2]; \
+         typename_t colorG = in[xl]; \
+         typename_t colorA = in[x]; \
+         typename_t colorB = in[xr]; \
+         typename_t colorK = in[xr2]; \
+         typename_t colorH = next[xl]; \
+         typename_t colorC = next[x]; \
+         typename_t colorD = next[xr]; \
+         typename_t colorL = next[xr2]; \
+         typename_t colorM = next2[xl]; \
+         typename_t colorN = next2[x]; \
+         typename_t colorO = next2[xr];
 
 #ifndef twoxsai_function
 #define twoxsai_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -220,71 +204,56 @@ static void twoxsai_generic_destroy(void *data)
          out[1] = product; \
          out[dst_stride] = product1; \
          out[dst_stride + 1] = product2; \
-         ++in; \
          out += 2
 #endif
 
-static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
-      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
-{
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+/* Sets up the lines around row y of a slice, clamped to the image */
+#define twoxsai_lines(thr, typename_t, y, src_stride, prev, in, next, next2) \
+   const typename_t *in    = (const typename_t*)(thr)->in_data + (y) * (src_stride); \
+   const typename_t *prev  = ((y) > 0 || (thr)->rows_above) ? in - (src_stride) : in; \
+   const typename_t *next  = ((y) + 1 < (thr)->height + (thr)->rows_below) ? in + (src_stride) : in; \
+   const typename_t *next2 = ((y) + 2 < (thr)->height + (thr)->rows_below) ? next + (src_stride) : next
+
+/* Neighbours past the left and right of the image are clamped to it */
+#define twoxsai_columns(x, width, xl, xr, xr2) \
+   unsigned xl  = (x) > 0 ? (x) - 1 : 0; \
+   unsigned xr  = (x) + 1 < (width) ? (x) + 1 : (x); \
+   unsigned xr2 = (x) + 2 < (width) ? (x) + 2 : xr
+
+/*
+ * Map of the pixels:           I|E F|J
+ *                              G|A B|K
+ *                              H|C D|L
+ *                              M|N O|P
+ */
 
-   for (; height; height--)
+static void twoxsai_line_xrgb8888(const uint32_t *prev, const uint32_t *in,
+      const uint32_t *next, const uint32_t *next2,
+      uint32_t *out, unsigned dst_stride,
+      unsigned x, unsigned x_end, unsigned width)
+{
+   for (out += 2 * x; x < x_end; x++)
    {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
-
-      for (finish = width; finish; finish -= 1)
-      {
-         twoxsai_declare_variables(uint32_t, in, nextline);
-
-         /*
-          * Map of the pixels:           I|E F|J
-          *                              G|A B|K
-          *                              H|C D|L
-          *                              M|N O|P
-          */
-
-         twoxsai_function(twoxsai_result, twoxsai_interpolate_xrgb8888,
-               twoxsai_interpolate2_xrgb8888);
-      }
-
-      src += src_stride;
-      dst += 2 * dst_stride;
+      twoxsai_columns(x, width, xl, xr, xr2);
+      twoxsai_declare_variables(uint32_t, prev, in, next, next2, xl, x, xr, xr2);
+
+      twoxsai_function(twoxsai_result, twoxsai_interpolate_xrgb8888,
+            twoxsai_interpolate2_xrgb8888);
    }
 }
 
-static void twoxsai_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
-      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+static void twoxsai_line_rgb565(const uint16_t *prev, const uint16_t *in,
+      const uint16_t *next, const uint16_t *next2,
+      uint16_t *out, unsigned dst_stride,
+      unsigned x, unsigned x_end, unsigned width)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
-
-   for (; height; height--)
+   for (out += 2 * x; x < x_end; x++)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
-
-      for (finish = width; finish; finish -= 1)
-      {
-         twoxsai_declare_variables(uint16_t, in, nextline);
-
-         /*
-          * Map of the pixels:           I|E F|J
-          *                              G|A B|K
-          *                              H|C D|L
-          *                              M|N O|P
-          */
-
-         twoxsai_function(twoxsai_result, twoxsai_interpolate_rgb565,
-               twoxsai_interpolate2_rgb565);
-      }
-
-      src += src_stride;
-      dst += 2 * dst_stride;
+      twoxsai_columns(x, width, xl, xr, xr2);
+      twoxsai_declare_variables(uint16_t, prev, in, next, next2, xl, x, xr, xr2);
+
+      twoxsai_function(twoxsai_result, twoxsai_interpolate_rgb565,
+            twoxsai_interpolate2_rgb565);
    }
 }
 
@@ -292,32 +261,262 @@ static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
-   uint16_t *input = (uint16_t*)thr->in_data;
-   uint16_t *output = (uint16_t*)thr->out_data;
-   unsigned width = thr->width;
-   unsigned height = thr->height;
-
-   twoxsai_generic_rgb565(width, height,
-         thr->first, thr->last, input,
-         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
-         output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+   size_t src_stride   = thr->in_pitch / SOFTFILTER_BPP_RGB565;
+   unsigned dst_stride = (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565);
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      uint16_t *out = (uint16_t*)thr->out_data + 2 * y * dst_stride;
+      twoxsai_lines(thr, uint16_t, y, src_stride, prev, in, next, next2);
+
+      twoxsai_line_rgb565(prev, in, next, next2, out, dst_stride,
+            0, thr->width, thr->width);
+   }
 }
 
 static void twoxsai_work_cb_xrgb8888(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
-   uint32_t *input = (uint32_t*)thr->in_data;
-   uint32_t *output = (uint32_t*)thr->out_data;
-   unsigned width = thr->width;
-   unsigned height = thr->height;
-
-   twoxsai_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
-         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
-         output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
+   size_t src_stride   = thr->in_pitch / SOFTFILTER_BPP_XRGB8888;
+   unsigned dst_stride = (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888);
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      uint32_t *out = (uint32_t*)thr->out_data + 2 * y * dst_stride;
+      twoxsai_lines(thr, uint32_t, y, src_stride, prev, in, next, next2);
+
+      twoxsai_line_xrgb8888(prev, in, next, next2, out, dst_stride,
+            0, thr->width, thr->width);
+   }
+}
+
+#if defined(TWOXSAI_HAVE_SSE2)
+/* The same as twoxsai_function on all lanes at once, for the pixels
+ * whose neighbours are all inside the line. Every branch is worked
+ * out and the products are picked by the comparison masks; the
+ * interpolations are the scalar ones with the masks held in
+ * mask_hi1/mask_lo1 and mask_hi2/mask_lo2.
+ *
+ * When A == B == C == D, interpolating any of them gives A back, so
+ * that case needs no lanes of its own. twoxsai_result comes out as
+ * the difference of the two "both equal" masks, which are -1 where
+ * set. */
+#define twoxsai_eq_sse2(bits, a, b) _mm_cmpeq_epi##bits(a, b)
+
+#define twoxsai_interpolate_sse2(bits, A, B) \
+   _mm_add_epi##bits(_mm_add_epi##bits( \
+      _mm_srli_epi##bits(_mm_and_si128(A, mask_hi1), 1), \
+      _mm_srli_epi##bits(_mm_and_si128(B, mask_hi1), 1)), \
+      _mm_and_si128(_mm_and_si128(A, B), mask_lo1))
+
+#define twoxsai_interpolate2_sse2(bits, A, B, C, D) \
+   _mm_add_epi##bits(_mm_add_epi##bits( \
+      _mm_add_epi##bits(_mm_srli_epi##bits(_mm_and_si128(A, mask_hi2), 2), \
+         _mm_srli_epi##bits(_mm_and_si128(B, mask_hi2), 2)), \
+      _mm_add_epi##bits(_mm_srli_epi##bits(_mm_and_si128(C, mask_hi2), 2), \
+         _mm_srli_epi##bits(_mm_and_si128(D, mask_hi2), 2))), \
+      _mm_and_si128(_mm_srli_epi##bits(_mm_add_epi##bits( \
+         _mm_add_epi##bits(_mm_and_si128(A, mask_lo2), _mm_and_si128(B, mask_lo2)), \
+         _mm_add_epi##bits(_mm_and_si128(C, mask_lo2), _mm_and_si128(D, mask_lo2))), 2), \
+         mask_lo2))
+
+#define twoxsai_result_sse2(bits, A, B, C, D) \
+   _mm_sub_epi##bits( \
+      _mm_and_si128(twoxsai_eq_sse2(bits, A, C), twoxsai_eq_sse2(bits, A, D)), \
+      _mm_and_si128(twoxsai_eq_sse2(bits, B, C), twoxsai_eq_sse2(bits, B, D)))
+
+#define twoxsai_select_sse2(mask, a, b) \
+   _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b))
+
+#define twoxsai_pixels_sse2(typename_t, bits, lanes) \
+   for (; x + lanes + 1 < width; x += lanes) \
+   { \
+      __m128i colorI = _mm_loadu_si128((const __m128i*)(prev + x - 1)); \
+      __m128i colorE = _mm_loadu_si128((const __m128i*)(prev + x)); \
+      __m128i colorF = _mm_loadu_si128((const __m128i*)(prev + x + 1)); \
+      __m128i colorJ = _mm_loadu_si128((const __m128i*)(prev + x + 2)); \
+      __m128i colorG = _mm_loadu_si128((const __m128i*)(in + x - 1)); \
+      __m128i colorA = _mm_loadu_si128((const __m128i*)(in + x)); \
+      __m128i colorB = _mm_loadu_si128((const __m128i*)(in + x + 1)); \
+      __m128i colorK = _mm_loadu_si128((const __m128i*)(in + x + 2)); \
+      __m128i colorH = _mm_loadu_si128((const __m128i*)(next + x - 1)); \
+      __m128i colorC = _mm_loadu_si128((const __m128i*)(next + x)); \
+      __m128i colorD = _mm_loadu_si128((const __m128i*)(next + x + 1)); \
+      __m128i colorL = _mm_loadu_si128((const __m128i*)(next + x + 2)); \
+      __m128i colorM = _mm_loadu_si128((const __m128i*)(next2 + x - 1)); \
+      __m128i colorN = _mm_loadu_si128((const __m128i*)(next2 + x)); \
+      __m128i colorO = _mm_loadu_si128((const __m128i*)(next2 + x + 1)); \
+      __m128i eqAB   = twoxsai_eq_sse2(bits, colorA, colorB); \
+      __m128i eqAC   = twoxsai_eq_sse2(bits, colorA, colorC); \
+      __m128i eqAD   = twoxsai_eq_sse2(bits, colorA, colorD); \
+      __m128i eqAF   = twoxsai_eq_sse2(bits, colorA, colorF); \
+      __m128i eqAH   = twoxsai_eq_sse2(bits, colorA, colorH); \
+      __m128i eqAI   = twoxsai_eq_sse2(bits, colorA, colorI); \
+      __m128i eqBC   = twoxsai_eq_sse2(bits, colorB, colorC); \
+      __m128i eqBE   = twoxsai_eq_sse2(bits, colorB, colorE); \
+      __m128i eqCD   = twoxsai_eq_sse2(bits, colorC, colorD); \
+      __m128i eqCG   = twoxsai_eq_sse2(bits, colorC, colorG); \
+      /* The four cases of twoxsai_function */ \
+      __m128i case1  = _mm_andnot_si128(eqBC, eqAD); \
+      __m128i case2  = _mm_andnot_si128(eqAD, eqBC); \
+      __m128i case3  = _mm_and_si128(eqAD, eqBC); \
+      __m128i case4  = _mm_andnot_si128(_mm_or_si128(eqAD, eqBC), \
+            _mm_cmpeq_epi8(eqAD, eqAD)); \
+      /* A == C && A == F && B != E && B == J, and its likes */ \
+      __m128i keepA  = _mm_andnot_si128(eqBE, _mm_and_si128( \
+               _mm_and_si128(eqAC, eqAF), twoxsai_eq_sse2(bits, colorB, colorJ))); \
+      __m128i keepB  = _mm_andnot_si128(eqAF, _mm_and_si128( \
+               _mm_and_si128(eqBE, twoxsai_eq_sse2(bits, colorB, colorD)), eqAI)); \
+      __m128i keepA1 = _mm_andnot_si128(eqCG, _mm_and_si128( \
+               _mm_and_si128(eqAB, eqAH), twoxsai_eq_sse2(bits, colorC, colorM))); \
+      __m128i keepC1 = _mm_andnot_si128(eqAH, _mm_and_si128( \
+               _mm_and_si128(eqCG, eqCD), eqAI)); \
+      __m128i selA   = _mm_or_si128( \
+            _mm_and_si128(case1, _mm_or_si128(keepA, _mm_and_si128( \
+                     twoxsai_eq_sse2(bits, colorA, colorE), \
+                     twoxsai_eq_sse2(bits, colorB, colorL)))), \
+            _mm_and_si128(case4, keepA)); \
+      __m128i selB   = _mm_or_si128( \
+            _mm_and_si128(case2, _mm_or_si128(keepB, _mm_and_si128( \
+                     twoxsai_eq_sse2(bits, colorB, colorF), eqAH))), \
+            _mm_and_si128(case4, _mm_andnot_si128(keepA, keepB))); \
+      __m128i selA1  = _mm_or_si128( \
+            _mm_and_si128(case1, _mm_or_si128(keepA1, _mm_and_si128( \
+                     twoxsai_eq_sse2(bits, colorA, colorG), \
+                     twoxsai_eq_sse2(bits, colorC, colorO)))), \
+            _mm_and_si128(case4, keepA1)); \
+      __m128i selC1  = _mm_or_si128( \
+            _mm_and_si128(case2, _mm_or_si128(keepC1, _mm_and_si128( \
+                     twoxsai_eq_sse2(bits, colorC, colorH), eqAF))), \
+            _mm_and_si128(case4, _mm_andnot_si128(keepA1, keepC1))); \
+      __m128i r      = _mm_add_epi##bits( \
+            _mm_add_epi##bits( \
+               twoxsai_result_sse2(bits, colorA, colorB, colorG, colorE), \
+               twoxsai_result_sse2(bits, colorB, colorA, colorK, colorF)), \
+            _mm_add_epi##bits( \
+               twoxsai_result_sse2(bits, colorB, colorA, colorH, colorN), \
+               twoxsai_result_sse2(bits, colorA, colorB, colorL, colorO))); \
+      __m128i zero   = _mm_setzero_si128(); \
+      __m128i selA2  = _mm_or_si128(case1, \
+            _mm_and_si128(case3, _mm_cmpgt_epi##bits(r, zero))); \
+      __m128i selB2  = _mm_or_si128(case2, \
+            _mm_and_si128(case3, _mm_cmplt_epi##bits(r, zero))); \
+      __m128i product  = twoxsai_select_sse2(selA, colorA, \
+            twoxsai_select_sse2(selB, colorB, \
+               twoxsai_interpolate_sse2(bits, colorA, colorB))); \
+      __m128i product1 = twoxsai_select_sse2(selA1, colorA, \
+            twoxsai_select_sse2(selC1, colorC, \
+               twoxsai_interpolate_sse2(bits, colorA, colorC))); \
+      __m128i product2 = twoxsai_select_sse2(selA2, colorA, \
+            twoxsai_select_sse2(selB2, colorB, \
+               twoxsai_interpolate2_sse2(bits, colorA, colorB, colorC, colorD))); \
+      typename_t *out = out0 + 2 * x; \
+      _mm_storeu_si128((__m128i*)out, \
+            _mm_unpacklo_epi##bits(colorA, product)); \
+      _mm_storeu_si128((__m128i*)(out + lanes), \
+            _mm_unpackhi_epi##bits(colorA, product)); \
+      _mm_storeu_si128((__m128i*)(out + dst_stride), \
+            _mm_unpacklo_epi##bits(product1, product2)); \
+      _mm_storeu_si128((__m128i*)(out + dst_stride + lanes), \
+            _mm_unpackhi_epi##bits(product1, product2)); \
+   }
+
+static void twoxsai_work_cb_rgb565_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+   size_t src_stride   = thr->in_pitch / SOFTFILTER_BPP_RGB565;
+   unsigned dst_stride = (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565);
+   unsigned width      = thr->width;
+   __m128i mask_hi1    = _mm_set1_epi16((short)0xF7DE);
+   __m128i mask_lo1    = _mm_set1_epi16(0x0821);
+   __m128i mask_hi2    = _mm_set1_epi16((short)0xE79C);
+   __m128i mask_lo2    = _mm_set1_epi16(0x1863);
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      unsigned x     = width ? 1 : 0;
+      uint16_t *out0 = (uint16_t*)thr->out_data + 2 * y * dst_stride;
+      twoxsai_lines(thr, uint16_t, y, src_stride, prev, in, next, next2);
+
+      twoxsai_line_rgb565(prev, in, next, next2, out0, dst_stride,
+            0, x, width);
+      twoxsai_pixels_sse2(uint16_t, 16, 8);
+      twoxsai_line_rgb565(prev, in, next, next2, out0, dst_stride,
+            x, width, width);
+   }
+}
+
+static void twoxsai_work_cb_xrgb8888_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+   size_t src_stride   = thr->in_pitch / SOFTFILTER_BPP_XRGB8888;
+   unsigned dst_stride = (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888);
+   unsigned width      = thr->width;
+   __m128i mask_hi1    = _mm_set1_epi32((int)0xFEFEFEFE);
+   __m128i mask_lo1    = _mm_set1_epi32(0x01010101);
+   __m128i mask_hi2    = _mm_set1_epi32((int)0xFCFCFCFC);
+   __m128i mask_lo2    = _mm_set1_epi32(0x03030303);
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      unsigned x     = width ? 1 : 0;
+      uint32_t *out0 = (uint32_t*)thr->out_data + 2 * y * dst_stride;
+      twoxsai_lines(thr, uint32_t, y, src_stride, prev, in, next, next2);
+
+      twoxsai_line_xrgb8888(prev, in, next, next2, out0, dst_stride,
+            0, x, width);
+      twoxsai_pixels_sse2(uint32_t, 32, 4);
+      twoxsai_line_xrgb8888(prev, in, next, next2, out0, dst_stride,
+            x, width, width);
+   }
+}
+#endif
+
+static void *twoxsai_generic_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
+
+   (void)config;
+   (void)userdata;
+   if (!filt)
+      return NULL;
+   filt->workers = (struct softfilter_thread_data*)
+      calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
+   filt->in_fmt  = in_fmt;
+   if (!filt->workers)
+   {
+      free(filt);
+      return NULL;
+   }
+
+   if (in_fmt == SOFTFILTER_FMT_RGB565)
+   {
+      filt->work = twoxsai_work_cb_rgb565;
+#if defined(TWOXSAI_HAVE_SSE2)
+      if (simd & SOFTFILTER_SIMD_SSE2)
+         filt->work = twoxsai_work_cb_rgb565_sse2;
+#endif
+   }
+   else if (in_fmt == SOFTFILTER_FMT_XRGB8888)
+   {
+      filt->work = twoxsai_work_cb_xrgb8888;
+#if defined(TWOXSAI_HAVE_SSE2)
+      if (simd & SOFTFILTER_SIMD_SSE2)
+         filt->work = twoxsai_work_cb_xrgb8888_sse2;
+#endif
+   }
+   return filt;
 }
 
 static void twoxsai_generic_packets(void *data,
@@ -347,17 +546,10 @@ static void twoxsai_generic_packets(void *data,
       /* Workers need to know if they can access pixels
        * outside their given buffer.
        */
-      thr->first = y_start;
-      thr->last = y_end == height;
-
-      if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-         packets[i].work = twoxsai_work_cb_rgb565;
-#if 0
-      else if (filt->in_fmt == SOFTFILTER_FMT_RGB4444)
-         packets[i].work = twoxsai_work_cb_rgb4444;
-#endif
-      else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-         packets[i].work = twoxsai_work_cb_xrgb8888;
+      thr->rows_above = y_start;
+      thr->rows_below = height - y_end;
+
+      packets[i].work = filt->work;
       packets[i].thread_data = thr;
    }
 }
@@ -17,6 +17,11 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LQ2X_HAVE_SSE2
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation lq2x_get_implementation
 #define softfilter_thread_data lq2x_softfilter_thread_data
@@ -34,8 +39,10 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
-   int first;
-   int last;
+   /* Rows of the image above and below the slice, which the
+    * worker reads for neighbours but does not write */
+   unsigned rows_above;
+   unsigned rows_below;
 };
 
 struct filter_data
@@ -43,6 +50,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_work_t work;
 };
 
 static unsigned lq2x_generic_input_fmts(void)
@@ -61,29 +69,6 @@ static unsigned lq2x_generic_threads(void *data)
    return filt->threads;
 }
 
-static void *lq2x_generic_create(const struct softfilter_config *config,
-      unsigned in_fmt, unsigned out_fmt,
-      unsigned max_width, unsigned max_height,
-      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
-{
-   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
-   (void)config;
-   (void)userdata;
-   if (!filt)
-      return NULL;
-   filt->workers = (struct softfilter_thread_data*)
-      calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
-   filt->in_fmt  = in_fmt;
-   if (!filt->workers)
-   {
-      free(filt);
-      return NULL;
-   }
-   return filt;
-}
-
 static void lq2x_generic_output(void *data,
       unsigned *out_width, unsigned *out_height,
       unsigned width, unsigned height)
@@ -103,126 +88,262 @@ static void lq2x_generic_destroy(void *data)
    free(filt);
 }
 
-static void lq2x_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
-      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+/* Expands pixels [x, x_end) of a line. Neighbours past the edges
+ * of the image are taken to be the centre pixel. */
+static void lq2x_line_rgb565(const uint16_t *above,
+      const uint16_t *src, const uint16_t *below,
+      uint16_t *out0, uint16_t *out1,
+      unsigned x, unsigned x_end, unsigned width)
 {
-   unsigned x, y;
-   uint16_t *out0 = (uint16_t*)dst;
-   uint16_t *out1 = (uint16_t*)(dst + dst_stride);
-
-   for (y = 0; y < height; y++)
+   for (; x < x_end; x++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for (x = 0; x < width; x++)
+      uint16_t A = above[x];
+      uint16_t B = (x > 0) ? src[x - 1] : src[x];
+      uint16_t C = src[x];
+      uint16_t D = (x < width - 1) ? src[x + 1] : src[x];
+      uint16_t E = below[x];
+      uint16_t c = C;
+
+      if (A != E && B != D)
       {
-         uint16_t A = *(src - prevline);
-         uint16_t B = (x > 0) ? *(src - 1) : *src;
-         uint16_t C = *src;
-         uint16_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint16_t E = *(src++ + nextline);
-         uint16_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out0++ = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out1++ = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-            *out1++ = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
+         out0[2 * x]     = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
+         out0[2 * x + 1] = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
+         out1[2 * x]     = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
+         out1[2 * x + 1] = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
+      }
+      else
+      {
+         out0[2 * x]     = c;
+         out0[2 * x + 1] = c;
+         out1[2 * x]     = c;
+         out1[2 * x + 1] = c;
       }
-
-      src  += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
    }
 }
 
-static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
-      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+static void lq2x_line_xrgb8888(const uint32_t *above,
+      const uint32_t *src, const uint32_t *below,
+      uint32_t *out0, uint32_t *out1,
+      unsigned x, unsigned x_end, unsigned width)
 {
-   unsigned x, y;
-   uint32_t *out0 = (uint32_t*)dst;
-   uint32_t *out1 = (uint32_t*)(dst + dst_stride);
-
-   for (y = 0; y < height; y++)
+   for (; x < x_end; x++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for (x = 0; x < width; x++)
+      uint32_t A = above[x];
+      uint32_t B = (x > 0) ? src[x - 1] : src[x];
+      uint32_t C = src[x];
+      uint32_t D = (x < width - 1) ? src[x + 1] : src[x];
+      uint32_t E = below[x];
+      uint32_t c = C;
+
+      if (A != E && B != D)
       {
-         uint32_t A = *(src - prevline);
-         uint32_t B = (x > 0) ? *(src - 1) : *src;
-         uint32_t C = *src;
-         uint32_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint32_t E = *(src++ + nextline);
-         uint32_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out0++ = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out1++ = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-            *out1++ = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
+         out0[2 * x]     = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
+         out0[2 * x + 1] = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
+         out1[2 * x]     = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
+         out1[2 * x + 1] = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
+      }
+      else
+      {
+         out0[2 * x]     = c;
+         out0[2 * x + 1] = c;
+         out1[2 * x]     = c;
+         out1[2 * x + 1] = c;
       }
-
-      src += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
    }
 }
 
+/* Sets up the lines around row y of a slice, clamped to the image */
+#define lq2x_lines(thr, typename_t, y, src_stride, above, src, below) \
+   const typename_t *src   = (const typename_t*)(thr)->in_data + (y) * (src_stride); \
+   const typename_t *above = ((y) > 0 || (thr)->rows_above) ? src - (src_stride) : src; \
+   const typename_t *below = ((y) + 1 < (thr)->height || (thr)->rows_below) ? src + (src_stride) : src
+
 static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
-   uint16_t *input = (uint16_t*)thr->in_data;
-   uint16_t *output = (uint16_t*)thr->out_data;
-   unsigned width = thr->width;
-   unsigned height = thr->height;
-
-   lq2x_generic_rgb565(width, height,
-         thr->first, thr->last, input,
-         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
-         output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
+   size_t src_stride = thr->in_pitch / SOFTFILTER_BPP_RGB565;
+   size_t dst_stride = thr->out_pitch / SOFTFILTER_BPP_RGB565;
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      uint16_t *out0 = (uint16_t*)thr->out_data + 2 * y * dst_stride;
+      lq2x_lines(thr, uint16_t, y, src_stride, above, src, below);
+
+      lq2x_line_rgb565(above, src, below, out0, out0 + dst_stride,
+            0, thr->width, thr->width);
+   }
 }
 
 static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr =
       (struct softfilter_thread_data*)thread_data;
-   uint32_t *input = (uint32_t*)thr->in_data;
-   uint32_t *output = (uint32_t*)thr->out_data;
-   unsigned width = thr->width;
-   unsigned height = thr->height;
+   size_t src_stride = thr->in_pitch / SOFTFILTER_BPP_XRGB8888;
+   size_t dst_stride = thr->out_pitch / SOFTFILTER_BPP_XRGB8888;
+   unsigned y;
 
    (void)data;
 
-   lq2x_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
-         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
-         output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
+   for (y = 0; y < thr->height; y++)
+   {
+      uint32_t *out0 = (uint32_t*)thr->out_data + 2 * y * dst_stride;
+      lq2x_lines(thr, uint32_t, y, src_stride, above, src, below);
+
+      lq2x_line_xrgb8888(above, src, below, out0, out0 + dst_stride,
+            0, thr->width, thr->width);
+   }
+}
+
+#if defined(LQ2X_HAVE_SSE2)
+/* The vector kernels do the pixels whose left and right neighbours
+ * are all inside the line, and leave the edges to the above.
+ *
+ * The RGB565 blend is worked out as (C & A) + (((C ^ A) & ~mask) >> 1),
+ * which is the same as the scalar one but does not overflow 16 bits. */
+static void lq2x_work_cb_rgb565_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+   size_t src_stride = thr->in_pitch / SOFTFILTER_BPP_RGB565;
+   size_t dst_stride = thr->out_pitch / SOFTFILTER_BPP_RGB565;
+   unsigned width    = thr->width;
+   __m128i mask      = _mm_set1_epi16((short)0xF7DE);
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      unsigned x     = width ? 1 : 0;
+      uint16_t *out0 = (uint16_t*)thr->out_data + 2 * y * dst_stride;
+      uint16_t *out1 = out0 + dst_stride;
+      lq2x_lines(thr, uint16_t, y, src_stride, above, src, below);
+
+      lq2x_line_rgb565(above, src, below, out0, out1, 0, x, width);
+
+      for (; x + 8 < width; x += 8)
+      {
+         __m128i A    = _mm_loadu_si128((const __m128i*)(above + x));
+         __m128i B    = _mm_loadu_si128((const __m128i*)(src + x - 1));
+         __m128i C    = _mm_loadu_si128((const __m128i*)(src + x));
+         __m128i D    = _mm_loadu_si128((const __m128i*)(src + x + 1));
+         __m128i E    = _mm_loadu_si128((const __m128i*)(below + x));
+         __m128i CA   = _mm_add_epi16(_mm_and_si128(C, A),
+               _mm_srli_epi16(_mm_and_si128(_mm_xor_si128(C, A), mask), 1));
+         __m128i CE   = _mm_add_epi16(_mm_and_si128(C, E),
+               _mm_srli_epi16(_mm_and_si128(_mm_xor_si128(C, E), mask), 1));
+         /* Lanes where A != E && B != D */
+         __m128i flat = _mm_or_si128(_mm_cmpeq_epi16(A, E),
+               _mm_cmpeq_epi16(B, D));
+         __m128i mAB  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(A, B));
+         __m128i mAD  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(A, D));
+         __m128i mEB  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(E, B));
+         __m128i mED  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(E, D));
+         __m128i p0   = _mm_or_si128(_mm_and_si128(mAB, CA), _mm_andnot_si128(mAB, C));
+         __m128i p1   = _mm_or_si128(_mm_and_si128(mAD, CA), _mm_andnot_si128(mAD, C));
+         __m128i p2   = _mm_or_si128(_mm_and_si128(mEB, CE), _mm_andnot_si128(mEB, C));
+         __m128i p3   = _mm_or_si128(_mm_and_si128(mED, CE), _mm_andnot_si128(mED, C));
+
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x),     _mm_unpacklo_epi16(p0, p1));
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x + 8), _mm_unpackhi_epi16(p0, p1));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x),     _mm_unpacklo_epi16(p2, p3));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x + 8), _mm_unpackhi_epi16(p2, p3));
+      }
+
+      lq2x_line_rgb565(above, src, below, out0, out1, x, width, width);
+   }
+}
+
+static void lq2x_work_cb_xrgb8888_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+   size_t src_stride = thr->in_pitch / SOFTFILTER_BPP_XRGB8888;
+   size_t dst_stride = thr->out_pitch / SOFTFILTER_BPP_XRGB8888;
+   unsigned width    = thr->width;
+   __m128i mask      = _mm_set1_epi32(0x0421);
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      unsigned x     = width ? 1 : 0;
+      uint32_t *out0 = (uint32_t*)thr->out_data + 2 * y * dst_stride;
+      uint32_t *out1 = out0 + dst_stride;
+      lq2x_lines(thr, uint32_t, y, src_stride, above, src, below);
+
+      lq2x_line_xrgb8888(above, src, below, out0, out1, 0, x, width);
+
+      for (; x + 4 < width; x += 4)
+      {
+         __m128i A    = _mm_loadu_si128((const __m128i*)(above + x));
+         __m128i B    = _mm_loadu_si128((const __m128i*)(src + x - 1));
+         __m128i C    = _mm_loadu_si128((const __m128i*)(src + x));
+         __m128i D    = _mm_loadu_si128((const __m128i*)(src + x + 1));
+         __m128i E    = _mm_loadu_si128((const __m128i*)(below + x));
+         __m128i CA   = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(C, A),
+                  _mm_and_si128(_mm_xor_si128(C, A), mask)), 1);
+         __m128i CE   = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(C, E),
+                  _mm_and_si128(_mm_xor_si128(C, E), mask)), 1);
+         /* Lanes where A != E && B != D */
+         __m128i flat = _mm_or_si128(_mm_cmpeq_epi32(A, E),
+               _mm_cmpeq_epi32(B, D));
+         __m128i mAB  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(A, B));
+         __m128i mAD  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(A, D));
+         __m128i mEB  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(E, B));
+         __m128i mED  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(E, D));
+         __m128i p0   = _mm_or_si128(_mm_and_si128(mAB, CA), _mm_andnot_si128(mAB, C));
+         __m128i p1   = _mm_or_si128(_mm_and_si128(mAD, CA), _mm_andnot_si128(mAD, C));
+         __m128i p2   = _mm_or_si128(_mm_and_si128(mEB, CE), _mm_andnot_si128(mEB, C));
+         __m128i p3   = _mm_or_si128(_mm_and_si128(mED, CE), _mm_andnot_si128(mED, C));
+
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x),     _mm_unpacklo_epi32(p0, p1));
+         _mm_storeu_si128((__m128i*)(out0 + 2 * x + 4), _mm_unpackhi_epi32(p0, p1));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x),     _mm_unpacklo_epi32(p2, p3));
+         _mm_storeu_si128((__m128i*)(out1 + 2 * x + 4), _mm_unpackhi_epi32(p2, p3));
+      }
+
+      lq2x_line_xrgb8888(above, src, below, out0, out1, x, width, width);
+   }
+}
+#endif
+
+static void *lq2x_generic_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
+   (void)config;
+   (void)userdata;
+   if (!filt)
+      return NULL;
+   filt->workers = (struct softfilter_thread_data*)
+      calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
+   filt->in_fmt  = in_fmt;
+   if (!filt->workers)
+   {
+      free(filt);
+      return NULL;
+   }
+
+   if (in_fmt == SOFTFILTER_FMT_RGB565)
+   {
+      filt->work = lq2x_work_cb_rgb565;
+#if defined(LQ2X_HAVE_SSE2)
+      if (simd & SOFTFILTER_SIMD_SSE2)
+         filt->work = lq2x_work_cb_rgb565_sse2;
+#endif
+   }
+   else if (in_fmt == SOFTFILTER_FMT_XRGB8888)
+   {
+      filt->work = lq2x_work_cb_xrgb8888;
+#if defined(LQ2X_HAVE_SSE2)
+      if (simd & SOFTFILTER_SIMD_SSE2)
+         filt->work = lq2x_work_cb_xrgb8888_sse2;
+#endif
+   }
+   return filt;
 }
 
 static void lq2x_generic_packets(void *data,
@@ -249,17 +370,10 @@ static void lq2x_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels
        * outside their given buffer. */
-      thr->first = y_start;
-      thr->last = y_end == height;
-
-      if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
-         packets[i].work = lq2x_work_cb_rgb565;
-#if 0
-      else if (filt->in_fmt == SOFTFILTER_FMT_RGB4444)
-         packets[i].work = lq2x_work_cb_rgb4444;
-#endif
-      else if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
-         packets[i].work = lq2x_work_cb_xrgb8888;
+      thr->rows_above = y_start;
+      thr->rows_below = height - y_end;
+
+      packets[i].work = filt->work;
       packets[i].thread_data = thr;
    }
 }
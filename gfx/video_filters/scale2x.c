@@ -20,6 +20,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SCALE2X_HAVE_SSE2
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation scale2x_get_implementation
 #define softfilter_thread_data scale2x_softfilter_thread_data
@@ -35,8 +40,10 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
-   int first;
-   int last;
+   /* Rows of the image above and below the slice, which the
+    * worker reads for neighbours but does not write */
+   unsigned rows_above;
+   unsigned rows_below;
 };
 
 struct filter_data
@@ -44,6 +51,7 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   softfilter_work_t work;
 };
 
 static unsigned scale2x_generic_input_fmts(void)
@@ -62,31 +70,6 @@ static unsigned scale2x_generic_threads(void *data)
    return filt->threads;
 }
 
-static void *scale2x_generic_create(const struct softfilter_config *config,
-      unsigned in_fmt, unsigned out_fmt,
-      unsigned max_width, unsigned max_height,
-      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
-{
-   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
-   (void)config;
-   (void)userdata;
-
-   if (!filt) {
-      return NULL;
-   }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
-   filt->in_fmt  = in_fmt;
-   if (!filt->workers) {
-      free(filt);
-      return NULL;
-   }
-   return filt;
-}
-
 static void scale2x_generic_output(void *data,
       unsigned *out_width, unsigned *out_height,
       unsigned width, unsigned height)
@@ -105,100 +88,248 @@ static void scale2x_generic_destroy(void *data)
    free(filt);
 }
 
+/* Expands pixels [x, x_end) of a line. Neighbours past the edges
+ * of the image are taken to be the centre pixel. */
+static void scale2x_line_xrgb8888(const uint32_t *above,
+      const uint32_t *input, const uint32_t *below,
+      uint32_t *output0, uint32_t *output1,
+      unsigned x, unsigned x_end, unsigned width)
+{
+   for (; x < x_end; x++)
+   {
+      /* Get sample points */
+      uint32_t A = above[x];
+      uint32_t B = (x > 0) ? input[x - 1] : input[x];
+      uint32_t C = input[x];
+      uint32_t D = (x < width - 1) ? input[x + 1] : input[x];
+      uint32_t E = below[x];
+
+      /* Apply pixel expansion algorithm */
+      if (A != E && B != D)
+      {
+         output0[2 * x]     = (A == B ? A : C);
+         output0[2 * x + 1] = (A == D ? A : C);
+         output1[2 * x]     = (E == B ? E : C);
+         output1[2 * x + 1] = (E == D ? E : C);
+      }
+      else
+      {
+         output0[2 * x]     = C;
+         output0[2 * x + 1] = C;
+         output1[2 * x]     = C;
+         output1[2 * x + 1] = C;
+      }
+   }
+}
+
+static void scale2x_line_rgb565(const uint16_t *above,
+      const uint16_t *input, const uint16_t *below,
+      uint16_t *output0, uint16_t *output1,
+      unsigned x, unsigned x_end, unsigned width)
+{
+   for (; x < x_end; x++)
+   {
+      /* Get sample points */
+      uint16_t A = above[x];
+      uint16_t B = (x > 0) ? input[x - 1] : input[x];
+      uint16_t C = input[x];
+      uint16_t D = (x < width - 1) ? input[x + 1] : input[x];
+      uint16_t E = below[x];
+
+      /* Apply pixel expansion algorithm */
+      if (A != E && B != D)
+      {
+         output0[2 * x]     = (A == B ? A : C);
+         output0[2 * x + 1] = (A == D ? A : C);
+         output1[2 * x]     = (E == B ? E : C);
+         output1[2 * x + 1] = (E == D ? E : C);
+      }
+      else
+      {
+         output0[2 * x]     = C;
+         output0[2 * x + 1] = C;
+         output1[2 * x]     = C;
+         output1[2 * x + 1] = C;
+      }
+   }
+}
+
+/* Sets up the lines around row y of a slice, clamped to the image */
+#define scale2x_lines(thr, typename_t, y, in_stride, above, input, below) \
+   const typename_t *input = (const typename_t*)(thr)->in_data + (y) * (in_stride); \
+   const typename_t *above = ((y) > 0 || (thr)->rows_above) ? input - (in_stride) : input; \
+   const typename_t *below = ((y) + 1 < (thr)->height || (thr)->rows_below) ? input + (in_stride) : input
+
 static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
-   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
-   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
-   const uint32_t *input              = (const uint32_t*)thr->in_data;
-   uint32_t *output0                  = (uint32_t*)thr->out_data;
-   uint32_t *output1                  = (uint32_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   size_t in_stride                   = thr->in_pitch >> 2;
+   size_t out_stride                  = thr->out_pitch >> 2;
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      uint32_t *output0 = (uint32_t*)thr->out_data + 2 * y * out_stride;
+      scale2x_lines(thr, uint32_t, y, in_stride, above, input, below);
+
+      scale2x_line_xrgb8888(above, input, below, output0,
+            output0 + out_stride, 0, thr->width, thr->width);
+   }
+}
+
+static void scale2x_work_cb_rgb565(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   size_t in_stride                   = thr->in_pitch >> 1;
+   size_t out_stride                  = thr->out_pitch >> 1;
+   unsigned y;
+
+   for (y = 0; y < thr->height; y++)
+   {
+      uint16_t *output0 = (uint16_t*)thr->out_data + 2 * y * out_stride;
+      scale2x_lines(thr, uint16_t, y, in_stride, above, input, below);
+
+      scale2x_line_rgb565(above, input, below, output0,
+            output0 + out_stride, 0, thr->width, thr->width);
+   }
+}
+
+#if defined(SCALE2X_HAVE_SSE2)
+/* The vector kernels do the pixels whose left and right neighbours
+ * are all inside the line, and leave the edges to the above. */
+static void scale2x_work_cb_xrgb8888_sse2(void *data, void *thread_data)
+{
+   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
+   size_t in_stride                   = thr->in_pitch >> 2;
+   size_t out_stride                  = thr->out_pitch >> 2;
+   unsigned width                     = thr->width;
+   unsigned y;
 
    for (y = 0; y < thr->height; y++)
    {
-      /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
+      unsigned x        = width ? 1 : 0;
+      uint32_t *output0 = (uint32_t*)thr->out_data + 2 * y * out_stride;
+      uint32_t *output1 = output0 + out_stride;
+      scale2x_lines(thr, uint32_t, y, in_stride, above, input, below);
 
-      for (x = 0; x < thr->width; x++)
+      scale2x_line_xrgb8888(above, input, below, output0, output1,
+            0, x, width);
+
+      for (; x + 4 < width; x += 4)
       {
-         /* Get sample points */
-         uint32_t A = *(input - line_prev);
-         uint32_t B = (x > 0) ? *(input - 1) : *input;
-         uint32_t C = *input;
-         uint32_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint32_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
+         __m128i A    = _mm_loadu_si128((const __m128i*)(above + x));
+         __m128i B    = _mm_loadu_si128((const __m128i*)(input + x - 1));
+         __m128i C    = _mm_loadu_si128((const __m128i*)(input + x));
+         __m128i D    = _mm_loadu_si128((const __m128i*)(input + x + 1));
+         __m128i E    = _mm_loadu_si128((const __m128i*)(below + x));
+         /* Lanes where A != E && B != D */
+         __m128i flat = _mm_or_si128(_mm_cmpeq_epi32(A, E),
+               _mm_cmpeq_epi32(B, D));
+         __m128i mAB  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(A, B));
+         __m128i mAD  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(A, D));
+         __m128i mEB  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(E, B));
+         __m128i mED  = _mm_andnot_si128(flat, _mm_cmpeq_epi32(E, D));
+         __m128i p0   = _mm_or_si128(_mm_and_si128(mAB, A), _mm_andnot_si128(mAB, C));
+         __m128i p1   = _mm_or_si128(_mm_and_si128(mAD, A), _mm_andnot_si128(mAD, C));
+         __m128i p2   = _mm_or_si128(_mm_and_si128(mEB, E), _mm_andnot_si128(mEB, C));
+         __m128i p3   = _mm_or_si128(_mm_and_si128(mED, E), _mm_andnot_si128(mED, C));
+
+         _mm_storeu_si128((__m128i*)(output0 + 2 * x),     _mm_unpacklo_epi32(p0, p1));
+         _mm_storeu_si128((__m128i*)(output0 + 2 * x + 4), _mm_unpackhi_epi32(p0, p1));
+         _mm_storeu_si128((__m128i*)(output1 + 2 * x),     _mm_unpacklo_epi32(p2, p3));
+         _mm_storeu_si128((__m128i*)(output1 + 2 * x + 4), _mm_unpackhi_epi32(p2, p3));
       }
 
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      scale2x_line_xrgb8888(above, input, below, output0, output1,
+            x, width, width);
    }
 }
 
-static void scale2x_work_cb_rgb565(void *data, void *thread_data)
+static void scale2x_work_cb_rgb565_sse2(void *data, void *thread_data)
 {
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
-   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
-   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
-   const uint16_t *input              = (const uint16_t*)thr->in_data;
-   uint16_t *output0                  = (uint16_t*)thr->out_data;
-   uint16_t *output1                  = (uint16_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   size_t in_stride                   = thr->in_pitch >> 1;
+   size_t out_stride                  = thr->out_pitch >> 1;
+   unsigned width                     = thr->width;
+   unsigned y;
 
    for (y = 0; y < thr->height; y++)
    {
-      /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
+      unsigned x        = width ? 1 : 0;
+      uint16_t *output0 = (uint16_t*)thr->out_data + 2 * y * out_stride;
+      uint16_t *output1 = output0 + out_stride;
+      scale2x_lines(thr, uint16_t, y, in_stride, above, input, below);
 
-      for (x = 0; x < thr->width; x++)
+      scale2x_line_rgb565(above, input, below, output0, output1,
+            0, x, width);
+
+      for (; x + 8 < width; x += 8)
       {
-         /* Get sample points */
-         uint16_t A = *(input - line_prev);
-         uint16_t B = (x > 0) ? *(input - 1) : *input;
-         uint16_t C = *input;
-         uint16_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint16_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
+         __m128i A    = _mm_loadu_si128((const __m128i*)(above + x));
+         __m128i B    = _mm_loadu_si128((const __m128i*)(input + x - 1));
+         __m128i C    = _mm_loadu_si128((const __m128i*)(input + x));
+         __m128i D    = _mm_loadu_si128((const __m128i*)(input + x + 1));
+         __m128i E    = _mm_loadu_si128((const __m128i*)(below + x));
+         __m128i flat = _mm_or_si128(_mm_cmpeq_epi16(A, E),
+               _mm_cmpeq_epi16(B, D));
+         __m128i mAB  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(A, B));
+         __m128i mAD  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(A, D));
+         __m128i mEB  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(E, B));
+         __m128i mED  = _mm_andnot_si128(flat, _mm_cmpeq_epi16(E, D));
+         __m128i p0   = _mm_or_si128(_mm_and_si128(mAB, A), _mm_andnot_si128(mAB, C));
+         __m128i p1   = _mm_or_si128(_mm_and_si128(mAD, A), _mm_andnot_si128(mAD, C));
+         __m128i p2   = _mm_or_si128(_mm_and_si128(mEB, E), _mm_andnot_si128(mEB, C));
+         __m128i p3   = _mm_or_si128(_mm_and_si128(mED, E), _mm_andnot_si128(mED, C));
+
+         _mm_storeu_si128((__m128i*)(output0 + 2 * x),     _mm_unpacklo_epi16(p0, p1));
+         _mm_storeu_si128((__m128i*)(output0 + 2 * x + 8), _mm_unpackhi_epi16(p0, p1));
+         _mm_storeu_si128((__m128i*)(output1 + 2 * x),     _mm_unpacklo_epi16(p2, p3));
+         _mm_storeu_si128((__m128i*)(output1 + 2 * x + 8), _mm_unpackhi_epi16(p2, p3));
       }
 
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      scale2x_line_rgb565(above, input, below, output0, output1,
+            x, width, width);
+   }
+}
+#endif
+
+static void *scale2x_generic_create(const struct softfilter_config *config,
+      unsigned in_fmt, unsigned out_fmt,
+      unsigned max_width, unsigned max_height,
+      unsigned threads, softfilter_simd_mask_t simd, void *userdata)
+{
+   struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
+   (void)config;
+   (void)userdata;
+
+   if (!filt) {
+      return NULL;
+   }
+   filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
+   filt->in_fmt  = in_fmt;
+   if (!filt->workers) {
+      free(filt);
+      return NULL;
    }
+
+   if (in_fmt == SOFTFILTER_FMT_XRGB8888)
+   {
+      filt->work = scale2x_work_cb_xrgb8888;
+#if defined(SCALE2X_HAVE_SSE2)
+      if (simd & SOFTFILTER_SIMD_SSE2)
+         filt->work = scale2x_work_cb_xrgb8888_sse2;
+#endif
+   }
+   else if (in_fmt == SOFTFILTER_FMT_RGB565)
+   {
+      filt->work = scale2x_work_cb_rgb565;
+#if defined(SCALE2X_HAVE_SSE2)
+      if (simd & SOFTFILTER_SIMD_SSE2)
+         filt->work = scale2x_work_cb_rgb565_sse2;
+#endif
+   }
+   return filt;
 }
 
 static void scale2x_generic_packets(void *data,
@@ -206,27 +337,27 @@ static void scale2x_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code. This only
-    * makes the tiniest performance difference, but
-    * every little helps when running on an o3DS... */
    struct filter_data *filt = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data = (uint8_t*)output;
-   thr->in_data = (const uint8_t*)input;
-   thr->out_pitch = output_stride;
-   thr->in_pitch = input_stride;
-   thr->width = width;
-   thr->height = height;
-
-   if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888) {
-      packets[0].work = scale2x_work_cb_xrgb8888;
-   } else if (filt->in_fmt == SOFTFILTER_FMT_RGB565) {
-      packets[0].work = scale2x_work_cb_rgb565;
+   unsigned i;
+
+   for (i = 0; i < filt->threads; i++)
+   {
+      struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start = (height * i) / filt->threads;
+      unsigned y_end   = (height * (i + 1)) / filt->threads;
+
+      thr->out_data   = (uint8_t*)output + y_start * 2 * output_stride;
+      thr->in_data    = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch  = output_stride;
+      thr->in_pitch   = input_stride;
+      thr->width      = width;
+      thr->height     = y_end - y_start;
+      thr->rows_above = y_start;
+      thr->rows_below = height - y_end;
+
+      packets[i].work        = filt->work;
+      packets[i].thread_data = thr;
    }
-   packets[0].thread_data = thr;
 }
 
 static const struct softfilter_implementation scale2x_generic = {
@@ -36,8 +36,10 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
-   int first;
-   int last;
+   /* Rows of the image above and below the slice, which the
+    * worker reads for neighbours but does not write */
+   unsigned rows_above;
+   unsigned rows_below;
 };
 
 struct filter_data
@@ -77,7 +79,7 @@ static void *supertwoxsai_generic_create(const struct softfilter_config *config,
    (void)userdata;
 
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
 
    if (!filt->workers)
@@ -117,24 +119,24 @@ static void supertwoxsai_generic_destroy(void *data)
 #define supertwoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)))
 
 #ifndef supertwoxsai_declare_variables
-#define supertwoxsai_declare_variables(typename_t, in, nextline) \
+#define supertwoxsai_declare_variables(typename_t, prev, in, next, next2, xl, x, xr, xr2) \
          typename_t product1a, product1b, product2a, product2b; \
-         const typename_t colorB0 = *(in - nextline - 1); \
-         const typename_t colorB1 = *(in - nextline + 0); \
-         const typename_t colorB2 = *(in - nextline + 1); \
-         const typename_t colorB3 = *(in - nextline + 2); \
-         const typename_t color4  = *(in - 1); \
-         const typename_t color5  = *(in + 0); \
-         const typename_t color6  = *(in + 1); \
-         const typename_t colorS2 = *(in + 2); \
-         const typename_t color1  = *(in + nextline - 1); \
-         const typename_t color2  = *(in + nextline + 0); \
-         const typename_t color3  = *(in + nextline + 1); \
-         const typename_t colorS1 = *(in + nextline + 2); \
-         const typename_t colorA0 = *(in + nextline + nextline - 1); \
-         const typename_t colorA1 = *(in + nextline + nextline + 0); \
-         const typename_t colorA2 = *(in + nextline + nextline + 1); \
-         const typename_t colorA3 = *(in + nextline + nextline + 2)
+         const typename_t colorB0 = prev[xl]; \
+         const typename_t colorB1 = prev[x]; \
+         const typename_t colorB2 = prev[xr]; \
+         const typename_t colorB3 = prev[xr2]; \
+         const typename_t color4  = in[xl]; \
+         const typename_t color5  = in[x]; \
+         const typename_t color6  = in[xr]; \
+         const typename_t colorS2 = in[xr2]; \
+         const typename_t color1  = next[xl]; \
+         const typename_t color2  = next[x]; \
+         const typename_t color3  = next[xr]; \
+         const typename_t colorS1 = next[xr2]; \
+         const typename_t colorA0 = next2[xl]; \
+         const typename_t colorA1 = next2[x]; \
+         const typename_t colorA2 = next2[xr]; \
+         const typename_t colorA3 = next2[xr2]
 #endif
 
 #ifndef supertwoxsai_function
@@ -196,25 +198,30 @@ static void supertwoxsai_generic_destroy(void *data)
          out[1] = product1b; \
          out[dst_stride] = product2a; \
          out[dst_stride + 1] = product2b; \
-         ++in; \
          out += 2
 #endif
 
 static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      unsigned rows_above, unsigned rows_below, const uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint32_t *in  = (uint32_t*)src;
-      uint32_t *out = (uint32_t*)dst;
-
-      for (finish = width; finish; finish -= 1)
+      /* Neighbours past the edges of the image are clamped to it */
+      const uint32_t *in    = src + y * src_stride;
+      const uint32_t *prev  = (y > 0 || rows_above) ? in - src_stride : in;
+      const uint32_t *next  = (y + 1 < height + rows_below) ? in + src_stride : in;
+      const uint32_t *next2 = (y + 2 < height + rows_below) ? next + src_stride : next;
+      uint32_t *out         = dst + 2 * y * dst_stride;
+
+      for (x = 0; x < width; x++)
       {
-         supertwoxsai_declare_variables(uint32_t, in, nextline);
+         unsigned xl  = x > 0 ? x - 1 : 0;
+         unsigned xr  = x + 1 < width ? x + 1 : x;
+         unsigned xr2 = x + 2 < width ? x + 2 : xr;
+         supertwoxsai_declare_variables(uint32_t, prev, in, next, next2, xl, x, xr, xr2);
 
          //---------------------------    B1 B2
          //                             4  5  6 S2
@@ -224,27 +231,30 @@ static void supertwoxsai_generic_xrgb8888(unsigned width, unsigned height,
 
          supertwoxsai_function(supertwoxsai_result, supertwoxsai_interpolate_xrgb8888, supertwoxsai_interpolate2_xrgb8888);
       }
-
-      src += src_stride;
-      dst += 2 * dst_stride;
    }
 }
 
 static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      unsigned rows_above, unsigned rows_below, const uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
-   unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
+   unsigned x, y;
 
-   for (; height; height--)
+   for (y = 0; y < height; y++)
    {
-      uint16_t *in  = (uint16_t*)src;
-      uint16_t *out = (uint16_t*)dst;
-
-      for (finish = width; finish; finish -= 1)
+      /* Neighbours past the edges of the image are clamped to it */
+      const uint16_t *in    = src + y * src_stride;
+      const uint16_t *prev  = (y > 0 || rows_above) ? in - src_stride : in;
+      const uint16_t *next  = (y + 1 < height + rows_below) ? in + src_stride : in;
+      const uint16_t *next2 = (y + 2 < height + rows_below) ? next + src_stride : next;
+      uint16_t *out         = dst + 2 * y * dst_stride;
+
+      for (x = 0; x < width; x++)
       {
-         supertwoxsai_declare_variables(uint16_t, in, nextline);
+         unsigned xl  = x > 0 ? x - 1 : 0;
+         unsigned xr  = x + 1 < width ? x + 1 : x;
+         unsigned xr2 = x + 2 < width ? x + 2 : xr;
+         supertwoxsai_declare_variables(uint16_t, prev, in, next, next2, xl, x, xr, xr2);
 
          //---------------------------    B1 B2
          //                             4  5  6 S2
@@ -254,9 +264,6 @@ static void supertwoxsai_generic_rgb565(unsigned width, unsigned height,
 
          supertwoxsai_function(supertwoxsai_result, supertwoxsai_interpolate_rgb565, supertwoxsai_interpolate2_rgb565);
       }
-
-      src += src_stride;
-      dst += 2 * dst_stride;
    }
 }
 
@@ -269,7 +276,7 @@ static void supertwoxsai_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supertwoxsai_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+         thr->rows_above, thr->rows_below, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
         output,
         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -284,7 +291,7 @@ static void supertwoxsai_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supertwoxsai_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+         thr->rows_above, thr->rows_below, input,
             (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
             output,
             (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -312,8 +319,8 @@ static void supertwoxsai_generic_packets(void *data,
       thr->height = y_end - y_start;
 
       // Workers need to know if they can access pixels outside their given buffer.
-      thr->first = y_start;
-      thr->last = y_end == height;
+      thr->rows_above = y_start;
+      thr->rows_below = height - y_end;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = supertwoxsai_work_cb_rgb565;
@@ -498,6 +498,7 @@ VIDEO DRIVER
 
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGL_CORE)
 #include "../libretro-common/gfx/gl_capabilities.c"
+#include "../gfx/common/gl_program_cache.c"
 
 #ifndef HAVE_PSGL
 #include "../libretro-common/glsym/rglgen.c"
@@ -828,6 +829,7 @@ INPUT (HID)
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -1259,6 +1261,7 @@ THREAD
 #endif
 
 #include "../libretro-common/rthreads/rthreads.c"
+#include "../libretro-common/rthreads/tpool.c"
 #include "../gfx/video_thread_wrapper.c"
 #include "../audio/audio_thread_wrapper.c"
 #endif
@@ -1272,6 +1275,7 @@ NETPLAY
 #ifdef HAVE_NETWORKING
 #include "../network/netplay/netplay_handshake.c"
 #include "../network/netplay/netplay_io.c"
+#include "../network/netplay/netplay_latency.c"
 #include "../network/netplay/netplay_discovery.c"
 #include "../network/netplay/netplay_room_parse.c"
 #include "../libretro-common/net/net_compat.c"
@@ -1530,7 +1534,6 @@ XML
  LIBRETRODB
 ============================================================ */
 #ifdef HAVE_LIBRETRODB
-#include "../libretro-db/bintree.c"
 #include "../libretro-db/libretrodb.c"
 #include "../libretro-db/rmsgpack.c"
 #include "../libretro-db/rmsgpack_dom.c"
@@ -1654,6 +1657,11 @@ MANUAL CONTENT SCAN
 ============================================================ */
 #include "../manual_content_scan.c"
 
+/*============================================================
+CONTENT SCAN CACHE
+============================================================ */
+#include "../scan_cache.c"
+
 /*============================================================
 DISK CONTROL INTERFACE
 ============================================================ */
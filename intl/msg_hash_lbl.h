@@ -1862,6 +1862,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_RANGE,
    "netplay_input_latency_frames_range"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_NETPLAY_REPLAY_BUDGET,
+   "netplay_replay_budget"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_NETPLAY_DISCONNECT,
    "menu_netplay_disconnect"
@@ -2634,6 +2638,18 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE,
+   "rewind_cold_buffer_size"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_COLD_BUFFER_TO_DISK,
+   "rewind_cold_buffer_to_disk"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_DIRTY_PAGES,
+   "rewind_dirty_pages"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_SETTINGS,
    "rewind_settings"
@@ -4698,6 +4714,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,
    "scan_without_core_match"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCAN_THREADS,
+   "scan_threads"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCAN_CACHE_ENABLE,
+   "scan_cache_enable"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_XMB_ANIMATION_HORIZONTAL_HIGHLIGHT,
    "xmb_menu_animation_horizontal_highlight"
@@ -1496,6 +1496,15 @@ int msg_hash_get_help_us_enum(enum msg_hash_enums msg, char *s, size_t len)
                              "the rewind buffer size value via this \n"
                              "UI it will change by this amount.\n");
             break;
+        case MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE:
+            snprintf(s, len,
+                     "Compressed rewind buffer size (MB).\n"
+                             " \n"
+                             " Rewind history that no longer fits in \n"
+                             "the rewind buffer is compressed and kept \n"
+                             "here instead of being discarded. \n"
+                             "Set to 0 to disable.\n");
+            break;
         case MENU_ENUM_LABEL_SCREENSHOT:
             snprintf(s, len,
                      "Take screenshot.");
@@ -1792,6 +1801,16 @@ int msg_hash_get_help_us_enum(enum msg_hash_enums msg, char *s, size_t len)
                      "makes netplay less CPU-intensive, but at \n"
                      "the price of unpredictable input lag. \n");
             break;
+        case MENU_ENUM_LABEL_NETPLAY_REPLAY_BUDGET:
+            snprintf(s, len,
+                     "The longest time (ms) netplay may spend \n"
+                     "each frame replaying frames after input \n"
+                     "arrived late. \n"
+                     "\n"
+                     "Replays that would take longer are spread \n"
+                     "over several frames rather than stalling \n"
+                     "one. Set to 0 to disable the limit. \n");
+            break;
         case MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL:
             snprintf(s, len,
                      "When hosting, attempt to listen for\n"
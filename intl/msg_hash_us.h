@@ -3294,6 +3294,30 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_COLD_BUFFER_SIZE,
+   "Compressed Rewind Buffer Size (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_COLD_BUFFER_SIZE,
+   "The amount of memory (in MB) to reserve for older rewind history that no longer fits in the rewind buffer. It is stored compressed, so it holds several times as much history as the rewind buffer would. 0 disables it."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_COLD_BUFFER_TO_DISK,
+   "Store Compressed Rewind Buffer on Disk"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_COLD_BUFFER_TO_DISK,
+   "Keep the compressed rewind buffer in a scratch file in the cache directory instead of in RAM."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_DIRTY_PAGES,
+   "Skip Unchanged Savestate Pages"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_DIRTY_PAGES,
+   "Hash the savestate page by page and only compare the pages that changed since the previous frame. Lowers the rewind cost of cores with large savestates that change little per frame."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -5111,6 +5135,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_NETPLAY_INPUT_LATENCY_FRAMES_RANGE,
    "The range of frames of input latency that may be used to hide network latency. Reduces jitter and makes netplay less CPU-intensive, at the expense of unpredictable input lag."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_NETPLAY_REPLAY_BUDGET,
+   "Replay Time Budget (ms)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_NETPLAY_REPLAY_BUDGET,
+   "The longest netplay may spend each frame replaying frames after late input. Longer replays are spread over several frames instead of stalling one. 0 disables the limit."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_NETPLAY_NAT_TRAVERSAL,
    "Netplay NAT Traversal"
@@ -5357,6 +5389,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SCAN_WITHOUT_CORE_MATCH,
    "Allow content to be scanned and added to a playlist without a core installed that supports it."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCAN_THREADS,
+   "Scan Threads"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCAN_THREADS,
+   "Number of files read and checksummed at the same time when scanning content. 0 picks one per CPU core, up to 4. 1 scans one file at a time."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCAN_CACHE_ENABLE,
+   "Incremental Rescan"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCAN_CACHE_ENABLE,
+   "Remember the checksums and database matches of scanned files. Rescanning a directory only reads files that were added or modified since."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PLAYLIST_MANAGER_LIST,
    "Manage Playlists"
@@ -39,7 +39,20 @@
 #include <xmmintrin.h>
 #endif
 
-#if defined(__AVX__)
+/* The AVX2/FMA kernels are built regardless of the target
+ * the rest of the file is compiled for, and only picked at
+ * runtime if the CPU has them. */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && _MSC_VER >= 1700
+#define SINC_HAVE_AVX2
+#define SINC_TARGET_AVX2
+#endif
+#endif
+
+#if defined(__AVX__) || defined(SINC_HAVE_AVX2)
 #include <immintrin.h>
 #endif
 
@@ -315,6 +328,185 @@ static void resampler_sinc_process_avx(void *re_, struct resampler_data *data)
 }
 #endif
 
+#if defined(SINC_HAVE_AVX2)
+/* Adds up the eight lanes of each sum and stores left and right
+ * next to each other. */
+static SINC_TARGET_AVX2 INLINE void resampler_sinc_store_avx2(
+      float *output, __m256 sum_l, __m256 sum_r)
+{
+   /* l01 l23 r01 r23 | l45 l67 r45 r67 */
+   __m256 sum   = _mm256_hadd_ps(sum_l, sum_r);
+   __m128 res   = _mm_add_ps(_mm256_castps256_ps128(sum),
+         _mm256_extractf128_ps(sum, 1));
+   /* l r l r */
+   res          = _mm_hadd_ps(res, res);
+   _mm_storel_pi((__m64*)output, res);
+}
+
+static SINC_TARGET_AVX2 void resampler_sinc_process_avx2_kaiser(
+      void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+            resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+            resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         while (resamp->time < phases)
+         {
+            unsigned i;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+
+            const float *phase_table = resamp->phase_table + phase * taps * 2;
+            const float *delta_table = phase_table + taps;
+            __m256 delta             = _mm256_set1_ps((float)
+                  (resamp->time & resamp->subphase_mask) * resamp->subphase_mod);
+
+            /* Two sums per channel, so one FMA
+             * doesn't have to wait for the last. */
+            __m256 sum_l             = _mm256_setzero_ps();
+            __m256 sum_r             = _mm256_setzero_ps();
+            __m256 sum_l2            = _mm256_setzero_ps();
+            __m256 sum_r2            = _mm256_setzero_ps();
+
+            for (i = 0; i + 16 <= taps; i += 16)
+            {
+               __m256 sinc   = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i), delta,
+                     _mm256_load_ps(phase_table + i));
+               __m256 sinc2  = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i + 8), delta,
+                     _mm256_load_ps(phase_table + i + 8));
+
+               sum_l         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+               sum_l2        = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_l + i + 8), sinc2, sum_l2);
+               sum_r2        = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_r + i + 8), sinc2, sum_r2);
+            }
+
+            if (i < taps)
+            {
+               __m256 sinc   = _mm256_fmadd_ps(
+                     _mm256_load_ps(delta_table + i), delta,
+                     _mm256_load_ps(phase_table + i));
+
+               sum_l         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+
+            resampler_sinc_store_avx2(output,
+                  _mm256_add_ps(sum_l, sum_l2),
+                  _mm256_add_ps(sum_r, sum_r2));
+
+            output += 2;
+            out_frames++;
+            resamp->time += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static SINC_TARGET_AVX2 void resampler_sinc_process_avx2(
+      void *re_, struct resampler_data *data)
+{
+   rarch_sinc_resampler_t *resamp = (rarch_sinc_resampler_t*)re_;
+   unsigned phases                = 1 << (resamp->phase_bits + resamp->subphase_bits);
+
+   uint32_t ratio                 = phases / data->ratio;
+   const float *input             = data->data_in;
+   float *output                  = data->data_out;
+   size_t frames                  = data->input_frames;
+   size_t out_frames              = 0;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = resamp->taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + resamp->taps] =
+            resamp->buffer_l[resamp->ptr]                = *input++;
+
+         resamp->buffer_r[resamp->ptr + resamp->taps] =
+            resamp->buffer_r[resamp->ptr]                = *input++;
+
+         resamp->time                                -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l    = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r    = resamp->buffer_r + resamp->ptr;
+         unsigned taps            = resamp->taps;
+         while (resamp->time < phases)
+         {
+            unsigned i;
+            unsigned phase           = resamp->time >> resamp->subphase_bits;
+            const float *phase_table = resamp->phase_table + phase * taps;
+
+            __m256 sum_l             = _mm256_setzero_ps();
+            __m256 sum_r             = _mm256_setzero_ps();
+
+            for (i = 0; i < taps; i += 8)
+            {
+               __m256 sinc   = _mm256_load_ps(phase_table + i);
+
+               sum_l         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_l + i), sinc, sum_l);
+               sum_r         = _mm256_fmadd_ps(
+                     _mm256_loadu_ps(buffer_r + i), sinc, sum_r);
+            }
+
+            resampler_sinc_store_avx2(output, sum_l, sum_r);
+
+            output += 2;
+            out_frames++;
+            resamp->time += ratio;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+#endif
+
 #if defined(__SSE__)
 static void resampler_sinc_process_sse_kaiser(void *re_, struct resampler_data *data)
 {
@@ -770,6 +962,8 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    size_t elems                   = 0;
    unsigned sidelobes             = 0;
    unsigned enable_avx            = 0;
+   bool use_avx2                  = false;
+   bool use_avx                   = false;
    enum sinc_window window_type   = SINC_WINDOW_NONE;
    rarch_sinc_resampler_t *re     = (rarch_sinc_resampler_t*)
       calloc(1, sizeof(*re));
@@ -835,12 +1029,28 @@ static void *resampler_sinc_new(const struct resampler_config *config,
       re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
    }
 
+#if defined(SINC_HAVE_AVX2)
+   /* The kernel uses FMA3 as well, which has a CPUID bit of
+    * its own. Below 16 taps the horizontal adds eat up what
+    * the wider vectors gain. */
+   use_avx2 = (mask & RESAMPLER_SIMD_AVX2) && (mask & RESAMPLER_SIMD_AVX)
+      && (mask & RESAMPLER_SIMD_FMA3) && re->taps >= 16;
+#endif
+   /* For the little amount of taps we're using,
+    * SSE1 is faster than AVX for some reason.
+    * AVX code is kept here though as by increasing number
+    * of sinc taps, the AVX code is clearly faster than SSE1.
+    */
+   use_avx  = !use_avx2 && (mask & RESAMPLER_SIMD_AVX) && enable_avx;
+#if !defined(__AVX__)
+   /* Not built in, fall through to SSE */
+   use_avx  = false;
+#endif
+
    /* Be SIMD-friendly. */
-#if defined(__AVX__)
-   if (enable_avx)
-      re->taps  = (re->taps + 7) & ~7;
+   if (use_avx2 || use_avx)
+      re->taps     = (re->taps + 7) & ~7;
    else
-#endif
    {
 #if defined(WANT_NEON)
       re->taps     = (re->taps + 7) & ~7;
@@ -882,7 +1092,15 @@ static void *resampler_sinc_new(const struct resampler_config *config,
    if (window_type == SINC_WINDOW_KAISER)
       sinc_resampler.process    = resampler_sinc_process_c_kaiser;
 
-   if (mask & RESAMPLER_SIMD_AVX && enable_avx)
+   if (use_avx2)
+   {
+#if defined(SINC_HAVE_AVX2)
+      sinc_resampler.process    = resampler_sinc_process_avx2;
+      if (window_type == SINC_WINDOW_KAISER)
+         sinc_resampler.process = resampler_sinc_process_avx2_kaiser;
+#endif
+   }
+   else if (use_avx)
    {
 #if defined(__AVX__)
       sinc_resampler.process    = resampler_sinc_process_avx;
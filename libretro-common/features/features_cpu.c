@@ -652,6 +652,10 @@ uint64_t cpu_features_get(void)
    if (sysctlbyname("hw.optional.avx2_0", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_AVX2;
 
+   len            = sizeof(size_t);
+   if (sysctlbyname("hw.optional.fma", NULL, &len, NULL, 0) == 0)
+      cpu |= RETRO_SIMD_FMA3;
+
    len            = sizeof(size_t);
    if (sysctlbyname("hw.optional.altivec", NULL, &len, NULL, 0) == 0)
       cpu |= RETRO_SIMD_VMX;
@@ -743,7 +747,13 @@ uint64_t cpu_features_get(void)
          && ((xgetbv_x86(0) & 0x6) == 0x6))
       cpu |= RETRO_SIMD_AVX;
 
-   if (max_flag >= 7)
+   /* FMA3 works on the YMM registers too, and is a flag of its
+    * own - hypervisors and emulators may expose AVX2 without it */
+   if ((cpu & RETRO_SIMD_AVX) && (flags[2] & (1 << 12)))
+      cpu |= RETRO_SIMD_FMA3;
+
+   /* AVX2 is no use either if the OS doesn't save the YMM registers */
+   if ((cpu & RETRO_SIMD_AVX) && max_flag >= 7)
    {
       x86_cpuid(7, flags);
       if (flags[1] & (1 << 5))
@@ -43,16 +43,121 @@
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Smallest block that is allocated once the
+ * one sized for the file being read is full */
+#define CONFIG_FILE_BLOCK_SIZE 4096
+
 struct config_include_list
 {
    char *path;
    struct config_include_list *next;
 };
 
+struct config_file_block
+{
+   struct config_file_block *next;
+   size_t size;
+   size_t used;
+   /* Followed by 'size' bytes of storage */
+};
+
 /* Forward declaration */
 static bool config_file_parse_line(config_file_t *conf,
       struct config_entry_list *list, char *line, config_file_cb_t *cb);
 
+static bool config_file_add_block(config_file_t *conf, size_t size)
+{
+   struct config_file_block *block = (struct config_file_block*)
+      malloc(sizeof(*block) + size);
+
+   if (!block)
+      return false;
+
+   block->next  = conf->blocks;
+   block->size  = size;
+   block->used  = 0;
+   conf->blocks = block;
+   return true;
+}
+
+/* Bump allocates from the current block. Entries
+ * are aligned for their pointers, strings are not. */
+static void *config_file_alloc(config_file_t *conf, size_t len, bool align)
+{
+   struct config_file_block *block = conf->blocks;
+   size_t used                     = 0;
+
+   if (block)
+   {
+      used = block->used;
+      if (align)
+         used = (used + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+   }
+
+   if (!block || used + len > block->size)
+   {
+      if (!config_file_add_block(conf,
+               (len > CONFIG_FILE_BLOCK_SIZE) ? len : CONFIG_FILE_BLOCK_SIZE))
+         return NULL;
+      block = conf->blocks;
+      used  = 0;
+   }
+
+   block->used = used + len;
+   return (char*)(block + 1) + used;
+}
+
+static char *config_file_strdup(config_file_t *conf,
+      const char *str, size_t len)
+{
+   char *s = (char*)config_file_alloc(conf, len + 1, false);
+   if (!s)
+      return NULL;
+   memcpy(s, str, len);
+   s[len] = '\0';
+   return s;
+}
+
+/* Whether 'ptr' was carved out of one of the blocks
+ * of 'conf', as opposed to being allocated on its own
+ * by a setter - only the latter may be freed */
+static bool config_file_owns(const config_file_t *conf, const void *ptr)
+{
+   const struct config_file_block *block = conf->blocks;
+
+   for (; block; block = block->next)
+   {
+      const char *data = (const char*)(block + 1);
+      if ((const char*)ptr >= data && (const char*)ptr < data + block->size)
+         return true;
+   }
+
+   return false;
+}
+
+/* Hands the blocks of 'child' over to 'conf', once
+ * its entries have been moved there. The current
+ * block of 'conf' stays the one allocated from. */
+static void config_file_take_blocks(config_file_t *conf, config_file_t *child)
+{
+   struct config_file_block *tail = child->blocks;
+
+   if (!tail)
+      return;
+
+   if (conf->blocks)
+   {
+      while (tail->next)
+         tail = tail->next;
+      tail->next         = conf->blocks->next;
+      conf->blocks->next = child->blocks;
+   }
+   else
+      conf->blocks       = child->blocks;
+
+   child->blocks         = NULL;
+}
+
 static int config_file_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
 {
@@ -205,6 +310,7 @@ static char *config_file_strip_comment(char *str)
    return NULL;
 }
 
+/* Returns the value in 'line', terminated in place */
 static char *config_file_extract_value(char *line, bool is_value)
 {
    size_t idx  = 0;
@@ -227,8 +333,8 @@ static char *config_file_extract_value(char *line, bool is_value)
       line++;
 
    /* Note: From this point on, an empty value
-    * string is valid - and in this case, strdup("")
-    * will be returned
+    * string is valid - and in this case, an empty
+    * string will be returned
     * > If we instead return NULL, the the entry
     *   is ignored completely - which means we cannot
     *   track *changes* in entry value */
@@ -242,7 +348,10 @@ static char *config_file_extract_value(char *line, bool is_value)
 
       /* If this a ("), then value string is empty */
       if (*line == '"')
-         return strdup("");
+      {
+         *line = '\0';
+         return line;
+      }
 
       /* Find the next (") character */
       while (line[idx] && (line[idx] != '\"'))
@@ -264,10 +373,10 @@ static char *config_file_extract_value(char *line, bool is_value)
       value     = line;
    }
 
-   if (value && *value)
-      return strdup(value);
+   if (value)
+      return value;
 
-   return strdup("");
+   return line;
 }
 
 /* Move semantics? */
@@ -355,6 +464,7 @@ static void config_file_add_child_list(config_file_t *parent, config_file_t *chi
    }
 
    child->entries = NULL;
+   config_file_take_blocks(parent, child);
 }
 
 static void config_file_get_realpath(char *s, size_t len,
@@ -412,62 +522,61 @@ static void config_file_add_sub_conf(config_file_t *conf, char *path,
          conf->path);
 }
 
-static int config_file_load_internal(
-      struct config_file *conf,
-      const char *path, unsigned depth, config_file_cb_t *cb)
+/* Parses every line of 'lines', which is modified.
+ * Entries, keys and values all go into one block
+ * sized for the whole string, so that a config
+ * file costs a single allocation rather than
+ * three per line. */
+static int config_file_parse_string(config_file_t *conf,
+      char *lines, size_t len, config_file_cb_t *cb)
 {
-   RFILE         *file = NULL;
-   char      *new_path = strdup(path);
-   if (!new_path)
-      return 1;
+   size_t count   = 1;
+   char *save_ptr = NULL;
+   char *line     = NULL;
+   const char *s  = lines;
 
-   conf->path          = new_path;
-   conf->include_depth = depth;
-   file                = filestream_open(path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-   if (!file)
+   while ((s = (const char*)memchr(s, '\n', len - (size_t)(s - lines))))
    {
-      free(conf->path);
-      return 1;
+      count++;
+      s++;
    }
 
-   while (!filestream_eof(file))
-   {
-      char *line                     = NULL;
-      struct config_entry_list *list = (struct config_entry_list*)
-         malloc(sizeof(*list));
+   if (!config_file_add_block(conf,
+            len + 1 + count * (sizeof(struct config_entry_list)
+            + sizeof(void*))))
+      return -1;
 
-      if (!list)
-      {
-         filestream_close(file);
-         return -1;
-      }
+   /* Get first line of config file */
+   line = strtok_r(lines, "\n", &save_ptr);
 
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
+   while (line)
+   {
+      struct config_entry_list entry;
 
-      line            = filestream_getline(file);
+      entry.readonly  = false;
+      entry.key       = NULL;
+      entry.value     = NULL;
+      entry.next      = NULL;
 
-      if (!line)
+      /* Parse current line */
+      if (
+              !string_is_empty(line)
+            && config_file_parse_line(conf, &entry, line, cb))
       {
-         free(list);
-         continue;
-      }
+         struct config_entry_list *list = (struct config_entry_list*)
+            config_file_alloc(conf, sizeof(*list), true);
+
+         if (!list)
+            return -1;
+
+         *list = entry;
 
-      if ( 
-              !string_is_empty(line) 
-            && config_file_parse_line(conf, list, line, cb))
-      {
          if (conf->entries)
             conf->tail->next = list;
          else
             conf->entries    = list;
 
-         conf->tail = list;
+         conf->tail          = list;
 
          if (list->key)
          {
@@ -486,24 +595,49 @@ static int config_file_load_internal(
          }
       }
 
-      free(line);
+      /* Get next line of config file */
+      line = strtok_r(NULL, "\n", &save_ptr);
+   }
+
+   return 0;
+}
+
+static int config_file_load_internal(
+      struct config_file *conf,
+      const char *path, unsigned depth, config_file_cb_t *cb)
+{
+   int ret             = 0;
+   int64_t length      = 0;
+   void *buf           = NULL;
+   char      *new_path = strdup(path);
+   if (!new_path)
+      return 1;
+
+   conf->path          = new_path;
+   conf->include_depth = depth;
 
-      if (list != conf->tail)
-         free(list);
+   /* Read the whole file at once, rather
+    * than line by line */
+   if (!filestream_read_file(path, &buf, &length) || !buf)
+   {
+      free(conf->path);
+      conf->path       = NULL;
+      return 1;
    }
 
-   filestream_close(file);
+   ret                 = config_file_parse_string(conf,
+         (char*)buf, (size_t)length, cb);
+   free(buf);
 
-   return 0;
+   return ret;
 }
 
 static bool config_file_parse_line(config_file_t *conf,
       struct config_entry_list *list, char *line, config_file_cb_t *cb)
 {
-   size_t cur_size       = 32;
-   size_t idx            = 0;
    char *key             = NULL;
-   char *key_tmp         = NULL;
+   char *value           = NULL;
+   size_t key_len        = 0;
    /* Remove any comment text */
    char *comment         = config_file_strip_comment(line);
 
@@ -539,15 +673,9 @@ static bool config_file_parse_line(config_file_t *conf,
 
          path = config_file_extract_value(include_line, false);
 
-         if (!path)
-            return false;
-
          if (     string_is_empty(path)
                || conf->include_depth >= MAX_INCLUDE_DEPTH)
-         {
-            free(path);
             return false;
-         }
 
          real_path[0]         = '\0';
          config_file_add_sub_conf(conf, path,
@@ -582,16 +710,9 @@ static bool config_file_parse_line(config_file_t *conf,
 
          path = config_file_extract_value(reference_line, false);
 
-         if (!path)
-            return false;
-
          config_file_set_reference_path(conf, path);
-
-         if (!path)
-            return false;
       }
 
-      free(path);
       return true;
    }
 
@@ -599,44 +720,28 @@ static bool config_file_parse_line(config_file_t *conf,
    while (ISSPACE((int)*line))
       line++;
 
-   /* Allocate storage for key */
-   key = (char*)malloc(cur_size + 1);
-   if (!key)
-      return false;
-
-   /* Copy line contents into key until we
-    * reach the next space character */
+   /* Key runs until the next space character */
+   key = line;
    while (isgraph((int)*line))
-   {
-      /* If current key storage is too small,
-       * double its size */
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp   = (char*)realloc(key, cur_size + 1);
-
-         if (!key_tmp)
-         {
-            free(key);
-            return false;
-         }
-
-         key = key_tmp;
-      }
+      line++;
+   key_len       = (size_t)(line - key);
 
-      key[idx++] = *line++;
+   /* An entry without a value is invalid */
+   if (ISSPACE((int)*line))
+   {
+      *line++ = '\0';
+      value   = config_file_extract_value(line, true);
    }
-   key[idx]      = '\0';
 
-   /* Add key and value entries to list */
-   list->key     = key;
-   list->value   = config_file_extract_value(line, true);
+   if (!value)
+      return false;
 
-   /* An entry without a value is invalid */
-   if (!list->value)
+   /* Add key and value entries to list */
+   if (!(list->key = config_file_strdup(conf, key, key_len)))
+      return false;
+   if (!(list->value = config_file_strdup(conf, value, strlen(value))))
    {
       list->key = NULL;
-      free(key);
       return false;
    }
 
@@ -648,62 +753,13 @@ static int config_file_from_string_internal(
       char *from_string,
       const char *path)
 {
-   char *lines                    = from_string;
-   char *save_ptr                 = NULL;
-   char *line                     = NULL;
-
    if (!string_is_empty(path))
       conf->path                  = strdup(path);
-   if (string_is_empty(lines))
+   if (string_is_empty(from_string))
       return 0;
 
-   /* Get first line of config file */
-   line = strtok_r(lines, "\n", &save_ptr);
-
-   while (line)
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-            malloc(sizeof(*list));
-
-      if (!list)
-         return -1;
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      /* Parse current line */
-      if (
-              !string_is_empty(line)
-            && config_file_parse_line(conf, list, line, NULL))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries    = list;
-
-         conf->tail          = list;
-
-         if (list->key)
-         {
-            /* Only add entry to the map if an entry
-             * with the specified value does not
-             * already exist */
-            uint32_t hash = rhmap_hash_string(list->key);
-            if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
-               RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
-
-      /* Get next line of config file */
-      line = strtok_r(NULL, "\n", &save_ptr);
-   }
-   
-   return 0;
+   return config_file_parse_string(conf, from_string,
+         strlen(from_string), NULL);
 }
 
 void config_file_set_reference_path(config_file_t *conf, char *path)
@@ -739,9 +795,9 @@ bool config_file_deinitialize(config_file_t *conf)
    while (tmp)
    {
       struct config_entry_list *hold = NULL;
-      if (tmp->key)
+      if (tmp->key && !config_file_owns(conf, tmp->key))
          free(tmp->key);
-      if (tmp->value)
+      if (tmp->value && !config_file_owns(conf, tmp->value))
          free(tmp->value);
 
       tmp->value = NULL;
@@ -750,10 +806,17 @@ bool config_file_deinitialize(config_file_t *conf)
       hold       = tmp;
       tmp        = tmp->next;
 
-      if (hold)
+      if (!config_file_owns(conf, hold))
          free(hold);
    }
 
+   while (conf->blocks)
+   {
+      struct config_file_block *hold = conf->blocks;
+      conf->blocks                   = hold->next;
+      free(hold);
+   }
+
    inc_tmp = (struct config_include_list*)conf->includes;
    while (inc_tmp)
    {
@@ -815,6 +878,8 @@ bool config_append_file(config_file_t *conf, const char *path)
       new_conf->entries    = NULL;
    }
 
+   config_file_take_blocks(conf, new_conf);
+
    config_file_free(new_conf);
    return true;
 }
@@ -911,6 +976,7 @@ void config_file_initialize(struct config_file *conf)
    conf->last                     = NULL;
    conf->reference                = NULL;
    conf->includes                 = NULL;
+   conf->blocks                   = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false;
    conf->modified                 = false;
@@ -1192,8 +1258,11 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
                return;
 
             /* Value is to be updated
-             * > Free existing */
-            free(entry->value);
+             * > Free existing, unless it was read
+             *   from the file - the block it lives
+             *   in is freed along with the config */
+            if (!config_file_owns(conf, entry->value))
+               free(entry->value);
          }
 
          /* Update value
@@ -1244,10 +1313,10 @@ void config_unset(config_file_t *conf, const char *key)
 
    (void)RHMAP_DEL_STR(conf->entries_map, entry->key);
 
-   if (entry->key)
+   if (entry->key && !config_file_owns(conf, entry->key))
       free(entry->key);
 
-   if (entry->value)
+   if (entry->value && !config_file_owns(conf, entry->value))
       free(entry->value);
 
    entry->key     = NULL;
@@ -20,7 +20,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(RPNG_TEST)
 #include <stdio.h>
 #endif
 #include <stdint.h>
@@ -31,7 +31,12 @@
 #include <malloc.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <boolean.h>
+#include <retro_inline.h>
 #include <formats/image.h>
 #include <formats/rpng.h>
 #include <streams/trans_stream.h>
@@ -555,72 +560,247 @@ error:
    return -1;
 }
 
-static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
-      struct rpng_process *pngp, unsigned filter)
+static void png_reverse_filter_line(uint8_t *decoded,
+      const uint8_t *in, const uint8_t *prev, unsigned filter,
+      unsigned bpp, unsigned pitch)
 {
    unsigned i;
 
    switch (filter)
    {
       case PNG_FILTER_NONE:
-         memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
+         memcpy(decoded, in, pitch);
          break;
       case PNG_FILTER_SUB:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
+         for (i = 0; i < bpp; i++)
+            decoded[i] = in[i];
+         for (i = bpp; i < pitch; i++)
+            decoded[i] = decoded[i - bpp] + in[i];
          break;
       case PNG_FILTER_UP:
-         for (i = 0; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+         for (i = 0; i < pitch; i++)
+            decoded[i] = prev[i] + in[i];
          break;
       case PNG_FILTER_AVERAGE:
-         for (i = 0; i < pngp->bpp; i++)
+         for (i = 0; i < bpp; i++)
          {
-            uint8_t avg = pngp->prev_scanline[i] >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
+            uint8_t avg = prev[i] >> 1;
+            decoded[i]  = avg + in[i];
          }
-         for (i = pngp->bpp; i < pngp->pitch; i++)
+         for (i = bpp; i < pitch; i++)
          {
-            uint8_t avg = (pngp->decoded_scanline[i - pngp->bpp] + pngp->prev_scanline[i]) >> 1;
-            pngp->decoded_scanline[i] = avg + pngp->inflate_buf[i];
+            uint8_t avg = (decoded[i - bpp] + prev[i]) >> 1;
+            decoded[i]  = avg + in[i];
          }
          break;
       case PNG_FILTER_PAETH:
-         for (i = 0; i < pngp->bpp; i++)
-            pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
-         for (i = pngp->bpp; i < pngp->pitch; i++)
-            pngp->decoded_scanline[i] = paeth(pngp->decoded_scanline[i - pngp->bpp],
-                  pngp->prev_scanline[i], pngp->prev_scanline[i - pngp->bpp]) + pngp->inflate_buf[i];
+         for (i = 0; i < bpp; i++)
+            decoded[i] = paeth(0, prev[i], 0) + in[i];
+         for (i = bpp; i < pitch; i++)
+            decoded[i] = paeth(decoded[i - bpp],
+                  prev[i], prev[i - bpp]) + in[i];
          break;
-
-      default:
-         return IMAGE_PROCESS_ERROR_END;
    }
+}
 
-   switch (ihdr->color_type)
+#if defined(__SSE2__)
+/* 8-bit RGB and RGBA lines are unfiltered a pixel at
+ * a time in the low lane of a vector, and each pixel
+ * is converted to ARGB as soon as it is decoded rather
+ * than in a second pass over the line.
+ *
+ * RGB pixels are moved 4 bytes at a time, the fourth
+ * one belonging to the next pixel: its lane is never
+ * used and what is stored there is overwritten by the
+ * next pixel. Only the last pixel of a line is moved
+ * byte by byte, so that the line is not overrun.
+ * The kernel is inlined into one function per pixel
+ * size, for those moves to have a constant size. */
+static INLINE __m128i png_load_pixel(const uint8_t *p,
+      unsigned bpp, bool last)
+{
+   uint32_t v = 0;
+   if (last)
+      memcpy(&v, p, bpp);
+   else
+      memcpy(&v, p, 4);
+   return _mm_cvtsi32_si128((int)v);
+}
+
+static INLINE void png_store_pixel(uint32_t *data, uint8_t *decoded,
+      __m128i x, unsigned bpp, bool last)
+{
+   uint32_t v = (uint32_t)_mm_cvtsi128_si32(x);
+   if (last)
+      memcpy(decoded, &v, bpp);
+   else
+      memcpy(decoded, &v, 4);
+   /* Bytes are R, G, B, A */
+   *data      = (v & 0xff00ff00) | ((v >> 16) & 0xff) | ((v & 0xff) << 16)
+      | (bpp == 3 ? (0xffu << 24) : 0);
+}
+
+static INLINE __m128i png_select(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static INLINE __m128i png_abs_epi16(__m128i x)
+{
+   return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+static INLINE __attribute__((always_inline))
+void png_reverse_filter_line_sse2(uint32_t *data,
+      uint8_t *decoded, const uint8_t *in, const uint8_t *prev,
+      unsigned filter, unsigned width, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   __m128i a          = zero;
+
+   switch (filter)
    {
-      case PNG_IHDR_COLOR_GRAY:
-         png_reverse_filter_copy_line_bw(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+      case PNG_FILTER_NONE:
+         for (i = 0; i < width; i++, in += bpp, decoded += bpp)
+         {
+            bool last = (i + 1 == width);
+            png_store_pixel(data++, decoded,
+                  png_load_pixel(in, bpp, last), bpp, last);
+         }
          break;
-      case PNG_IHDR_COLOR_RGB:
-         png_reverse_filter_copy_line_rgb(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+      case PNG_FILTER_SUB:
+         for (i = 0; i < width; i++, in += bpp, decoded += bpp)
+         {
+            bool last = (i + 1 == width);
+            a         = _mm_add_epi8(a, png_load_pixel(in, bpp, last));
+            png_store_pixel(data++, decoded, a, bpp, last);
+         }
          break;
-      case PNG_IHDR_COLOR_PLT:
-         png_reverse_filter_copy_line_plt(data, pngp->decoded_scanline, ihdr->width,
-               ihdr->depth, pngp->palette);
+      case PNG_FILTER_UP:
+         for (i = 0; i < width; i++, in += bpp, prev += bpp, decoded += bpp)
+         {
+            bool last = (i + 1 == width);
+            png_store_pixel(data++, decoded, _mm_add_epi8(
+                     png_load_pixel(in, bpp, last),
+                     png_load_pixel(prev, bpp, last)), bpp, last);
+         }
          break;
-      case PNG_IHDR_COLOR_GRAY_ALPHA:
-         png_reverse_filter_copy_line_gray_alpha(data, pngp->decoded_scanline, ihdr->width,
-               ihdr->depth);
+      case PNG_FILTER_AVERAGE:
+         {
+            /* _mm_avg_epu8() rounds up, the filter rounds down */
+            const __m128i one = _mm_set1_epi8(1);
+
+            for (i = 0; i < width; i++, in += bpp, prev += bpp, decoded += bpp)
+            {
+               bool last   = (i + 1 == width);
+               __m128i b   = png_load_pixel(prev, bpp, last);
+               __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                     _mm_and_si128(_mm_xor_si128(a, b), one));
+               a           = _mm_add_epi8(avg, png_load_pixel(in, bpp, last));
+               png_store_pixel(data++, decoded, a, bpp, last);
+            }
+         }
          break;
-      case PNG_IHDR_COLOR_RGBA:
-         png_reverse_filter_copy_line_rgba(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+      case PNG_FILTER_PAETH:
+         {
+            /* Left (a), up (b) and up-left (c)
+             * are widened to 16 bits */
+            __m128i c = zero;
+
+            for (i = 0; i < width; i++, in += bpp, prev += bpp, decoded += bpp)
+            {
+               bool last        = (i + 1 == width);
+               __m128i b        = _mm_unpacklo_epi8(
+                     png_load_pixel(prev, bpp, last), zero);
+               __m128i pa       = _mm_sub_epi16(b, c);
+               __m128i pb       = _mm_sub_epi16(a, c);
+               __m128i pc       = png_abs_epi16(_mm_add_epi16(pa, pb));
+               __m128i smallest;
+               __m128i nearest;
+
+               pa               = png_abs_epi16(pa);
+               pb               = png_abs_epi16(pb);
+               smallest         = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+               /* Ties go to a, then b */
+               nearest          = png_select(_mm_cmpeq_epi16(smallest, pa), a,
+                     png_select(_mm_cmpeq_epi16(smallest, pb), b, c));
+
+               a                = _mm_add_epi8(png_load_pixel(in, bpp, last),
+                     _mm_packus_epi16(nearest, nearest));
+               png_store_pixel(data++, decoded, a, bpp, last);
+               a                = _mm_unpacklo_epi8(a, zero);
+               c                = b;
+            }
+         }
          break;
    }
+}
+
+static void png_reverse_filter_line_rgb_sse2(uint32_t *data,
+      uint8_t *decoded, const uint8_t *in, const uint8_t *prev,
+      unsigned filter, unsigned width)
+{
+   png_reverse_filter_line_sse2(data, decoded, in, prev, filter, width, 3);
+}
+
+static void png_reverse_filter_line_rgba_sse2(uint32_t *data,
+      uint8_t *decoded, const uint8_t *in, const uint8_t *prev,
+      unsigned filter, unsigned width)
+{
+   png_reverse_filter_line_sse2(data, decoded, in, prev, filter, width, 4);
+}
+#endif
+
+static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *ihdr,
+      struct rpng_process *pngp, unsigned filter)
+{
+   uint8_t *tmp = NULL;
+
+   if (filter > PNG_FILTER_PAETH)
+      return IMAGE_PROCESS_ERROR_END;
+
+#if defined(__SSE2__)
+   if (ihdr->depth == 8 && ihdr->color_type == PNG_IHDR_COLOR_RGB)
+      png_reverse_filter_line_rgb_sse2(data, pngp->decoded_scanline,
+            pngp->inflate_buf, pngp->prev_scanline, filter, ihdr->width);
+   else if (ihdr->depth == 8 && ihdr->color_type == PNG_IHDR_COLOR_RGBA)
+      png_reverse_filter_line_rgba_sse2(data, pngp->decoded_scanline,
+            pngp->inflate_buf, pngp->prev_scanline, filter, ihdr->width);
+   else
+#endif
+   {
+      png_reverse_filter_line(pngp->decoded_scanline, pngp->inflate_buf,
+            pngp->prev_scanline, filter, pngp->bpp, pngp->pitch);
+
+      switch (ihdr->color_type)
+      {
+         case PNG_IHDR_COLOR_GRAY:
+            png_reverse_filter_copy_line_bw(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+            break;
+         case PNG_IHDR_COLOR_RGB:
+            png_reverse_filter_copy_line_rgb(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+            break;
+         case PNG_IHDR_COLOR_PLT:
+            png_reverse_filter_copy_line_plt(data, pngp->decoded_scanline, ihdr->width,
+                  ihdr->depth, pngp->palette);
+            break;
+         case PNG_IHDR_COLOR_GRAY_ALPHA:
+            png_reverse_filter_copy_line_gray_alpha(data, pngp->decoded_scanline, ihdr->width,
+                  ihdr->depth);
+            break;
+         case PNG_IHDR_COLOR_RGBA:
+            png_reverse_filter_copy_line_rgba(data, pngp->decoded_scanline, ihdr->width, ihdr->depth);
+            break;
+      }
+   }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* The line just decoded is the previous
+    * one of the next line */
+   tmp                    = pngp->prev_scanline;
+   pngp->prev_scanline    = pngp->decoded_scanline;
+   pngp->decoded_scanline = tmp;
 
    return IMAGE_PROCESS_NEXT;
 }
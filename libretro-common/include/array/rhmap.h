@@ -244,14 +244,19 @@ RHMAP__UNUSED static ptrdiff_t rhmap__idx(struct rhmap__hdr* hdr, uint32_t key,
             hdr->keys[i] = 0;
             free(hdr->key_strs[i]);
             hdr->key_strs[i] = NULL;
+            /* Move the rest of the probe run up, each entry
+             * keeping its own key string */
             while ((key = hdr->keys[i = (i + 1) & hdr->maxlen]) != 0)
             {
-               if ((key = (uint32_t)rhmap__idx(hdr, key, str, 1, 0)) == i) continue;
-               hdr->len--;
+               uint32_t j;
+               char *key_str = hdr->key_strs[i];
                hdr->keys[i] = 0;
-               free(hdr->key_strs[i]);
                hdr->key_strs[i] = NULL;
-               memcpy(((char*)(hdr + 1)) + (key + 1) * del,
+               for (j = key; hdr->keys[j &= hdr->maxlen]; j++) { }
+               hdr->keys[j] = key;
+               hdr->key_strs[j] = key_str;
+               if (j == i) continue;
+               memcpy(((char*)(hdr + 1)) + (j + 1) * del,
                      ((char*)(hdr + 1)) + (i + 1) * del, del);
             }
          }
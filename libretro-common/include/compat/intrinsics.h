@@ -94,6 +94,19 @@ static INLINE int compat_ctz(unsigned x)
 #endif
 }
 
+/* Count set bits */
+static INLINE unsigned compat_popcount(uint32_t x)
+{
+#if defined(__GNUC__) && !defined(RARCH_CONSOLE)
+   return __builtin_popcount(x);
+#else
+   x = x - ((x >> 1) & 0x55555555);
+   x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+   x = (x + (x >> 4)) & 0x0f0f0f0f;
+   return (x * 0x01010101) >> 24;
+#endif
+}
+
 RETRO_END_DECLS
 
 #endif
@@ -60,6 +60,10 @@ struct config_file
    struct config_entry_list *tail;
    struct config_entry_list *last;
    struct config_include_list *includes;
+   /* Entries read from a file, along with their keys
+    * and values, are carved out of these blocks rather
+    * than allocated one by one */
+   struct config_file_block *blocks;
    unsigned include_depth;
    bool guaranteed_no_duplicates;
    bool modified;
@@ -122,6 +126,10 @@ bool config_append_file(config_file_t *conf, const char *path);
 
 bool config_entry_exists(config_file_t *conf, const char *entry);
 
+/* Keys and values of entries read from a file live in
+ * the blocks of the config file they were read into, and
+ * are only valid for as long as that config file is.
+ * Use strdup() to keep one. */
 struct config_entry_list
 {
    char *key;
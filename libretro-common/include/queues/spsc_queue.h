@@ -0,0 +1,130 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+#define SPSC_QUEUE_CACHELINE_SIZE 64
+
+/* Lock-free byte ring for exactly one producer thread
+ * and one consumer thread, e.g. an emulation thread feeding
+ * an audio callback. Neither side ever blocks the other.
+ *
+ * Each side only writes its own index, and only reads the
+ * other side's index when its cached copy says the ring is
+ * full (or empty); the indices are kept on separate cache lines
+ * so the two threads don't keep stealing them from each other. */
+struct spsc_queue
+{
+   uint8_t *buffer;
+   size_t size;
+   uint8_t pad0[SPSC_QUEUE_CACHELINE_SIZE];
+
+   /* Producer side */
+   size_t end;
+   size_t first_cache;
+   uint8_t pad1[SPSC_QUEUE_CACHELINE_SIZE];
+
+   /* Consumer side */
+   size_t first;
+   size_t end_cache;
+   uint8_t pad2[SPSC_QUEUE_CACHELINE_SIZE];
+};
+
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * spsc_queue_new:
+ * @size                 : number of bytes the queue can hold
+ *
+ * Returns: new queue, or NULL on allocation failure.
+ **/
+spsc_queue_t *spsc_queue_new(size_t size);
+
+void spsc_queue_free(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_clear:
+ *
+ * Empties the queue. Only safe while neither
+ * the producer nor the consumer is using it.
+ **/
+void spsc_queue_clear(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_write:
+ *
+ * Producer only. Copies as much of @in_buf into the
+ * queue as there is room for.
+ *
+ * Returns: number of bytes written.
+ **/
+size_t spsc_queue_write(spsc_queue_t *queue,
+      const void *in_buf, size_t size);
+
+/**
+ * spsc_queue_read:
+ *
+ * Consumer only. Copies up to @size bytes out of the queue.
+ *
+ * Returns: number of bytes read.
+ **/
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size);
+
+/**
+ * spsc_queue_read_regions:
+ *
+ * Consumer only. Points @first and @second at the (up to two)
+ * contiguous stretches of readable data, without consuming them;
+ * follow up with spsc_queue_read_advance().
+ *
+ * Returns: total number of readable bytes.
+ **/
+size_t spsc_queue_read_regions(spsc_queue_t *queue,
+      const uint8_t **first, size_t *first_len,
+      const uint8_t **second, size_t *second_len);
+
+/**
+ * spsc_queue_read_advance:
+ *
+ * Consumer only. Drops @size bytes, which must not be more
+ * than spsc_queue_read_regions() reported.
+ **/
+void spsc_queue_read_advance(spsc_queue_t *queue, size_t size);
+
+/* Either side; the result is only a snapshot, the other side
+ * may have made more room or data available since. */
+size_t spsc_queue_read_avail(spsc_queue_t *queue);
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue);
+
+RETRO_END_DECLS
+
+#endif
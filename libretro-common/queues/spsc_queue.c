@@ -0,0 +1,235 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+
+#include <queues/spsc_queue.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* An index is published with release semantics after the bytes
+ * it covers were written (or read), and picked up with acquire
+ * semantics before touching those bytes. */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define SPSC_LOAD_ACQUIRE(ptr)       __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#else
+#if defined(__GNUC__)
+#define SPSC_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER) && (defined(_M_ARM) || defined(_M_ARM64))
+#define SPSC_BARRIER() __dmb(0xB) /* inner shareable */
+#elif defined(_MSC_VER)
+/* x86 doesn't reorder loads with loads or stores with stores,
+ * only the compiler has to be kept from doing so. */
+#define SPSC_BARRIER() _ReadWriteBarrier()
+#else
+/* Unknown compiler; volatile alone only works on single core,
+ * or strongly ordered, machines. */
+#define SPSC_BARRIER()
+#endif
+
+static INLINE size_t SPSC_LOAD_ACQUIRE(const size_t *ptr)
+{
+   size_t val = *(const volatile size_t*)ptr;
+   SPSC_BARRIER();
+   return val;
+}
+
+#define SPSC_STORE_RELEASE(ptr, val) \
+   do \
+   { \
+      SPSC_BARRIER(); \
+      *(volatile size_t*)(ptr) = (val); \
+   } while (0)
+#endif
+
+/* Both indices run from 0 to twice the size, so a full queue can
+ * be told from an empty one without giving up a byte of it, and
+ * the storage wraps exactly where a whole number of samples or
+ * frames ends, if the size is a multiple of those. */
+static INLINE size_t spsc_queue_used(const spsc_queue_t *queue,
+      size_t first, size_t end)
+{
+   return (end >= first) ? end - first : end + 2 * queue->size - first;
+}
+
+static INLINE size_t spsc_queue_advance(const spsc_queue_t *queue,
+      size_t index, size_t count)
+{
+   index += count;
+   if (index >= 2 * queue->size)
+      index -= 2 * queue->size;
+   return index;
+}
+
+static INLINE size_t spsc_queue_pos(const spsc_queue_t *queue,
+      size_t index)
+{
+   return (index >= queue->size) ? index - queue->size : index;
+}
+
+spsc_queue_t *spsc_queue_new(size_t size)
+{
+   spsc_queue_t *queue = NULL;
+
+   if (!size)
+      return NULL;
+
+   if (!(queue = (spsc_queue_t*)calloc(1, sizeof(*queue))))
+      return NULL;
+
+   if (!(queue->buffer = (uint8_t*)calloc(1, size)))
+   {
+      free(queue);
+      return NULL;
+   }
+
+   queue->size = size;
+
+   return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+   free(queue->buffer);
+   free(queue);
+}
+
+void spsc_queue_clear(spsc_queue_t *queue)
+{
+   queue->first       = 0;
+   queue->end         = 0;
+   queue->first_cache = 0;
+   queue->end_cache   = 0;
+}
+
+size_t spsc_queue_write(spsc_queue_t *queue,
+      const void *in_buf, size_t size)
+{
+   size_t pos, first_write;
+   size_t end   = queue->end;
+   size_t avail = queue->size -
+      spsc_queue_used(queue, queue->first_cache, end);
+
+   if (avail < size)
+   {
+      queue->first_cache = SPSC_LOAD_ACQUIRE(&queue->first);
+      avail              = queue->size -
+         spsc_queue_used(queue, queue->first_cache, end);
+      if (avail < size)
+         size            = avail;
+   }
+
+   if (!size)
+      return 0;
+
+   pos         = spsc_queue_pos(queue, end);
+   first_write = queue->size - pos;
+   if (first_write > size)
+      first_write = size;
+
+   memcpy(queue->buffer + pos, in_buf, first_write);
+   memcpy(queue->buffer, (const uint8_t*)in_buf + first_write,
+         size - first_write);
+
+   SPSC_STORE_RELEASE(&queue->end, spsc_queue_advance(queue, end, size));
+
+   return size;
+}
+
+size_t spsc_queue_read_regions(spsc_queue_t *queue,
+      const uint8_t **first, size_t *first_len,
+      const uint8_t **second, size_t *second_len)
+{
+   size_t avail;
+   size_t pos       = spsc_queue_pos(queue, queue->first);
+
+   queue->end_cache = SPSC_LOAD_ACQUIRE(&queue->end);
+   avail            = spsc_queue_used(queue, queue->first, queue->end_cache);
+
+   *first           = queue->buffer + pos;
+   *first_len       = queue->size - pos;
+   if (*first_len > avail)
+      *first_len    = avail;
+
+   *second          = queue->buffer;
+   *second_len      = avail - *first_len;
+
+   return avail;
+}
+
+void spsc_queue_read_advance(spsc_queue_t *queue, size_t size)
+{
+   SPSC_STORE_RELEASE(&queue->first,
+         spsc_queue_advance(queue, queue->first, size));
+}
+
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size)
+{
+   size_t pos, first_read;
+   size_t start = queue->first;
+   size_t avail = spsc_queue_used(queue, start, queue->end_cache);
+
+   if (avail < size)
+   {
+      queue->end_cache = SPSC_LOAD_ACQUIRE(&queue->end);
+      avail            = spsc_queue_used(queue, start, queue->end_cache);
+      if (avail < size)
+         size          = avail;
+   }
+
+   if (!size)
+      return 0;
+
+   pos        = spsc_queue_pos(queue, start);
+   first_read = queue->size - pos;
+   if (first_read > size)
+      first_read = size;
+
+   memcpy(out_buf, queue->buffer + pos, first_read);
+   memcpy((uint8_t*)out_buf + first_read, queue->buffer,
+         size - first_read);
+
+   spsc_queue_read_advance(queue, size);
+
+   return size;
+}
+
+size_t spsc_queue_read_avail(spsc_queue_t *queue)
+{
+   return spsc_queue_used(queue,
+         SPSC_LOAD_ACQUIRE(&queue->first),
+         SPSC_LOAD_ACQUIRE(&queue->end));
+}
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue)
+{
+   return queue->size - spsc_queue_read_avail(queue);
+}
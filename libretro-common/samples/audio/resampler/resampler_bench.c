@@ -0,0 +1,182 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (resampler_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Sinc resampler throughput, per quality level and per kernel
+ * the CPU (and the build) can run, upsampling 44.1 kHz stereo
+ * to 48 kHz in chunks about the size of one video frame.
+ * Every kernel's output is also checked against the C one.
+ *
+ * A row shows the widest kernel allowed; the resampler may still
+ * pick a narrower one for a quality level with few taps. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <audio/audio_resampler.h>
+#include <features/features_cpu.h>
+#include <libretro.h>
+
+#define BENCH_IN_RATE  44100
+#define BENCH_OUT_RATE 48000
+#define BENCH_SECONDS  10
+#define BENCH_CHUNK    735
+
+struct bench_kernel
+{
+   const char *name;
+   resampler_simd_mask_t mask;
+};
+
+static const struct bench_kernel bench_kernels[] = {
+   { "C",        0 },
+#if defined(__SSE__)
+   { "SSE",      RESAMPLER_SIMD_SSE },
+#endif
+#if defined(__AVX__)
+   { "AVX",      RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX },
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+   { "AVX2/FMA", RESAMPLER_SIMD_SSE | RESAMPLER_SIMD_AVX | RESAMPLER_SIMD_AVX2
+                 | RESAMPLER_SIMD_FMA3 },
+#endif
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+   { "NEON",     RESAMPLER_SIMD_NEON },
+#endif
+};
+
+static const char *bench_quality_names[] = {
+   "dontcare", "lowest", "lower", "normal", "higher", "highest"
+};
+
+static const struct resampler_config bench_config = { 0 };
+
+/* Returns microseconds spent, output frames in @out_frames. */
+static retro_time_t bench_run(enum resampler_quality quality,
+      resampler_simd_mask_t mask, const float *in, size_t in_frames,
+      float *out, size_t *out_frames)
+{
+   size_t i;
+   retro_time_t start;
+   double ratio = (double)BENCH_OUT_RATE / BENCH_IN_RATE;
+   void *re     = sinc_resampler.init(&bench_config, ratio, quality, mask);
+
+   if (!re)
+      return 0;
+
+   *out_frames  = 0;
+   start        = cpu_features_get_time_usec();
+
+   for (i = 0; i + BENCH_CHUNK <= in_frames; i += BENCH_CHUNK)
+   {
+      struct resampler_data data;
+
+      data.data_in       = in + i * 2;
+      data.data_out      = out + *out_frames * 2;
+      data.input_frames  = BENCH_CHUNK;
+      data.output_frames = 0;
+      data.ratio         = ratio;
+
+      sinc_resampler.process(re, &data);
+      *out_frames       += data.output_frames;
+   }
+
+   start = cpu_features_get_time_usec() - start;
+   sinc_resampler.free(re);
+
+   return start;
+}
+
+int main(void)
+{
+   unsigned q, k;
+   size_t i;
+   size_t in_frames           = BENCH_IN_RATE * BENCH_SECONDS;
+   size_t max_out_frames      = in_frames * 2;
+   float *in                  = (float*)malloc(in_frames * 2 * sizeof(float));
+   float *out_ref             = (float*)malloc(max_out_frames * 2 * sizeof(float));
+   float *out                 = (float*)malloc(max_out_frames * 2 * sizeof(float));
+   resampler_simd_mask_t cpu  = (resampler_simd_mask_t)cpu_features_get();
+
+   if (!in || !out_ref || !out)
+      return 1;
+
+   /* Two tones and a little noise */
+   srand(1);
+   for (i = 0; i < in_frames; i++)
+   {
+      double t      = (double)i / BENCH_IN_RATE;
+      float noise   = (float)rand() / RAND_MAX - 0.5f;
+      in[i * 2 + 0] = 0.5f * (float)sin(2.0 * M_PI * 440.0 * t)  + 0.05f * noise;
+      in[i * 2 + 1] = 0.5f * (float)sin(2.0 * M_PI * 3520.0 * t) - 0.05f * noise;
+   }
+
+   printf("%-8s %-9s %12s %10s %12s\n",
+         "quality", "kernel", "Mframes/s", "realtime", "max error");
+
+   for (q = RESAMPLER_QUALITY_LOWEST; q <= RESAMPLER_QUALITY_HIGHEST; q++)
+   {
+      size_t ref_frames = 0;
+
+      for (k = 0; k < sizeof(bench_kernels) / sizeof(bench_kernels[0]); k++)
+      {
+         retro_time_t usec;
+         size_t out_frames = 0;
+         float max_err     = 0.0f;
+         float *dst        = k ? out : out_ref;
+
+         if ((bench_kernels[k].mask & cpu) != bench_kernels[k].mask)
+            continue;
+
+         usec = bench_run((enum resampler_quality)q, bench_kernels[k].mask,
+               in, in_frames, dst, &out_frames);
+
+         if (!k)
+            ref_frames = out_frames;
+         else
+         {
+            if (out_frames != ref_frames)
+               max_err = INFINITY;
+            else
+               for (i = 0; i < out_frames * 2; i++)
+               {
+                  float err = fabsf(out[i] - out_ref[i]);
+                  if (err > max_err)
+                     max_err = err;
+               }
+         }
+
+         printf("%-8s %-9s %12.2f %9.0fx %12g\n",
+               bench_quality_names[q], bench_kernels[k].name,
+               usec ? out_frames / (double)usec : 0.0,
+               usec ? BENCH_SECONDS * 1000000.0 / usec : 0.0,
+               max_err);
+      }
+   }
+
+   free(in);
+   free(out_ref);
+   free(out);
+
+   return 0;
+}
@@ -0,0 +1,257 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rpng_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* PNG decoding benchmark.
+ *
+ * Decodes every .png under a directory (a thumbnails
+ * directory, say), or a generated set of thumbnail
+ * sized images if none is given, first on this thread
+ * and then spread over a thread pool, the way the
+ * image task decodes them.
+ *
+ * Prints a checksum of all decoded pixels, which must
+ * not change when the decoder does.
+ *
+ * Usage: rpng_bench [directory] [threads] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+#include <formats/image.h>
+#include <formats/rpng.h>
+#include <lists/dir_list.h>
+#include <lists/string_list.h>
+#include <rthreads/tpool.h>
+#include <streams/file_stream.h>
+
+#define BENCH_DIR    "rpng_bench_data"
+#define BENCH_IMAGES 48
+#define BENCH_RUNS   5
+
+struct bench_image
+{
+   void *file;
+   int64_t file_len;
+   uint32_t crc;
+   bool ok;
+};
+
+/* Set for the untimed run that checksums the pixels */
+static bool bench_verify = false;
+
+static void bench_decode(void *arg)
+{
+   int retval;
+   unsigned width           = 0;
+   unsigned height          = 0;
+   uint32_t *data           = NULL;
+   struct bench_image *img  = (struct bench_image*)arg;
+   rpng_t *rpng             = rpng_alloc();
+
+   img->ok                  = false;
+
+   if (!rpng)
+      return;
+
+   if (     !rpng_set_buf_ptr(rpng, img->file, (size_t)img->file_len)
+         || !rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      retval = rpng_process_image(rpng, (void**)&data,
+            (size_t)img->file_len, &width, &height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   if (     retval != IMAGE_PROCESS_ERROR
+         && retval != IMAGE_PROCESS_ERROR_END
+         && data)
+   {
+      if (bench_verify)
+         img->crc = encoding_crc32(0, (const uint8_t*)data,
+               (size_t)width * height * sizeof(uint32_t));
+      img->ok     = true;
+   }
+
+end:
+   free(data);
+   rpng_free(rpng);
+}
+
+/* Boxart-like pictures: smooth gradients with
+ * some noise, flat areas and hard edges, so
+ * that the encoder picks every filter */
+static void bench_make_images(void)
+{
+   unsigned i;
+   uint32_t seed = 1;
+
+   path_mkdir(BENCH_DIR);
+
+   for (i = 0; i < BENCH_IMAGES; i++)
+   {
+      unsigned x, y;
+      char path[PATH_MAX_LENGTH];
+      unsigned width   = 512;
+      unsigned height  = (i & 1) ? 512 : 384;
+      uint32_t *argb   = (uint32_t*)malloc(width * height * sizeof(uint32_t));
+      uint8_t *bgr     = (uint8_t*)malloc(width * height * 3);
+
+      for (y = 0; y < height; y++)
+      {
+         for (x = 0; x < width; x++)
+         {
+            uint32_t r, g, b, a;
+
+            seed = seed * 1103515245u + 12345u;
+
+            if (y > height / 2 && x < width / 3)
+               r = g = b = 0x20;
+            else
+            {
+               unsigned noise = (seed >> 16) & 0x0f;
+               r = ((x * 255) / width + noise + i * 7) & 0xff;
+               g = ((y * 255) / height + noise) & 0xff;
+               b = (((x ^ y) >> 3) * 9 + noise) & 0xff;
+            }
+            a = (x < 16 || y < 16) ? (x + y) * 8 : 0xff;
+
+            argb[y * width + x]        = (a << 24) | (r << 16) | (g << 8) | b;
+            bgr[(y * width + x) * 3 + 0] = b;
+            bgr[(y * width + x) * 3 + 1] = g;
+            bgr[(y * width + x) * 3 + 2] = r;
+         }
+      }
+
+      snprintf(path, sizeof(path), BENCH_DIR "/%02u.png", i);
+
+      /* Most thumbnails have no alpha channel */
+      if (i % 4 == 3)
+         rpng_save_image_argb(path, argb, width, height,
+               width * sizeof(uint32_t));
+      else
+         rpng_save_image_bgr24(path, bgr, width, height, width * 3);
+
+      free(argb);
+      free(bgr);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   unsigned run;
+   struct string_list *list = NULL;
+   struct bench_image *imgs = NULL;
+   const char *dir          = (argc > 1) ? argv[1] : BENCH_DIR;
+   unsigned threads         = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 0)
+      : cpu_features_get_core_amount();
+   size_t bytes             = 0;
+   unsigned failed          = 0;
+   uint32_t crc             = 0;
+   retro_time_t serial      = 0;
+   retro_time_t pooled      = 0;
+   tpool_t *pool            = NULL;
+
+   if (argc <= 1)
+      bench_make_images();
+
+   if (!(list = dir_list_new(dir, "png", false, false, false, true)))
+   {
+      fprintf(stderr, "No images in %s\n", dir);
+      return 1;
+   }
+
+   if (!(imgs = (struct bench_image*)calloc(list->size, sizeof(*imgs))))
+      return 1;
+
+   for (i = 0; i < list->size; i++)
+   {
+      filestream_read_file(list->elems[i].data,
+            &imgs[i].file, &imgs[i].file_len);
+      bytes += (size_t)imgs[i].file_len;
+   }
+
+   bench_verify = true;
+   for (i = 0; i < list->size; i++)
+      bench_decode(&imgs[i]);
+   bench_verify = false;
+
+   for (i = 0; i < list->size; i++)
+   {
+      if (imgs[i].ok)
+         crc = encoding_crc32(crc, (const uint8_t*)&imgs[i].crc,
+               sizeof(imgs[i].crc));
+      else
+         failed++;
+   }
+
+   /* The fastest of a few runs is the least noisy */
+   for (run = 0; run < BENCH_RUNS; run++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      for (i = 0; i < list->size; i++)
+         bench_decode(&imgs[i]);
+      start              = cpu_features_get_time_usec() - start;
+      if (!serial || start < serial)
+         serial          = start;
+   }
+
+   if (threads < 1)
+      threads = 1;
+   pool = tpool_create(threads);
+
+   for (run = 0; run < BENCH_RUNS; run++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      for (i = 0; i < list->size; i++)
+         tpool_add_work(pool, bench_decode, &imgs[i]);
+      tpool_wait(pool);
+      start              = cpu_features_get_time_usec() - start;
+      if (!pooled || start < pooled)
+         pooled          = start;
+   }
+
+   tpool_destroy(pool);
+
+   printf("%u images, %.2f MB of PNG, %u failed to decode, checksum %08x\n",
+         (unsigned)list->size, bytes / (1024.0 * 1024.0), failed, crc);
+   printf("  1 thread:   %9.2f ms\n", serial / 1000.0);
+   printf("  %u threads: %9.2f ms\n", threads, pooled / 1000.0);
+
+   for (i = 0; i < list->size; i++)
+      free(imgs[i].file);
+   free(imgs);
+   string_list_free(list);
+
+   return 0;
+}
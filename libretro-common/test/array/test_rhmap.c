@@ -0,0 +1,120 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_rhmap.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <array/rhmap.h>
+
+#define SUITE_NAME "rhmap"
+
+#define MAP_KEYS 2000
+
+START_TEST (test_rhmap_str)
+{
+   int *map = NULL;
+
+   ck_assert(!RHMAP_HAS_STR(map, "foo"));
+   RHMAP_SET_STR(map, "foo", 1);
+   RHMAP_SET_STR(map, "bar", 2);
+   ck_assert_uint_eq(RHMAP_LEN(map), 2);
+   ck_assert_int_eq(RHMAP_GET_STR(map, "foo"), 1);
+   ck_assert_int_eq(RHMAP_GET_STR(map, "bar"), 2);
+   ck_assert(RHMAP_DEL_STR(map, "foo"));
+   ck_assert(!RHMAP_DEL_STR(map, "foo"));
+   ck_assert(!RHMAP_HAS_STR(map, "foo"));
+   ck_assert_uint_eq(RHMAP_LEN(map), 1);
+   RHMAP_FREE(map);
+   ck_assert_ptr_null(map);
+}
+END_TEST
+
+START_TEST (test_rhmap_str_delete)
+{
+   unsigned i;
+   char key[32];
+   int *map = NULL;
+
+   for (i = 0; i < MAP_KEYS; i++)
+   {
+      snprintf(key, sizeof(key), "key %u", i);
+      RHMAP_SET_STR(map, key, (int)i);
+   }
+
+   /* Deleting moves other entries of the same probe
+    * run, which have to keep their own keys */
+   for (i = 0; i < MAP_KEYS; i += 3)
+   {
+      snprintf(key, sizeof(key), "key %u", i);
+      ck_assert(RHMAP_DEL_STR(map, key));
+   }
+
+   ck_assert_uint_eq(RHMAP_LEN(map), MAP_KEYS - (MAP_KEYS + 2) / 3);
+
+   for (i = 0; i < MAP_KEYS; i++)
+   {
+      snprintf(key, sizeof(key), "key %u", i);
+      if (i % 3)
+      {
+         ck_assert(RHMAP_HAS_STR(map, key));
+         ck_assert_int_eq(RHMAP_GET_STR(map, key), (int)i);
+      }
+      else
+         ck_assert(!RHMAP_HAS_STR(map, key));
+   }
+
+   for (i = 0; i < RHMAP_CAP(map); i++)
+   {
+      if (!RHMAP_KEY(map, i))
+         continue;
+      ck_assert_ptr_nonnull(RHMAP_KEY_STR(map, i));
+      snprintf(key, sizeof(key), "key %d", map[i]);
+      ck_assert_str_eq(RHMAP_KEY_STR(map, i), key);
+   }
+
+   RHMAP_FREE(map);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_rhmap_str);
+   tcase_add_test(tc_core, test_rhmap_str_delete);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,265 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_config_file.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <file/config_file.h>
+#include <streams/file_stream.h>
+#include <features/features_cpu.h>
+
+#define SUITE_NAME "Config File"
+
+#define PARSE_ENTRIES 20000
+#define PARSE_RUNS    10
+
+static void write_file(const char *path, const char *data)
+{
+   FILE *fd = fopen(path, "wb");
+   ck_assert(fd != NULL);
+   fwrite(data, 1, strlen(data), fd);
+   fclose(fd);
+}
+
+static void assert_value(config_file_t *conf, const char *key,
+      const char *value)
+{
+   struct config_entry_list *entry = config_get_entry(conf, key);
+   if (value)
+   {
+      ck_assert_ptr_nonnull(entry);
+      ck_assert_str_eq(entry->value, value);
+   }
+   else
+      ck_assert(!entry || !entry->value);
+}
+
+START_TEST (test_config_file_parse)
+{
+   int tmp_int   = 0;
+   bool tmp_bool = false;
+   char str[]    =
+      "# A comment\n"
+      "a = 1\n"
+      "b=\"no spaces\"\n"
+      "  c   =   \"with # hash\"   # trailing comment\n"
+      "d = \"\"\n"
+      "e = bare value\n"
+      "\r\n"
+      "invalid\n"
+      "invalid=1\n"
+      "f = true\r\n"
+      "a = 2\n";
+   config_file_t *conf = config_file_new_from_string(str, NULL);
+
+   ck_assert_ptr_nonnull(conf);
+   /* The first entry for a key wins */
+   ck_assert(config_get_int(conf, "a", &tmp_int));
+   ck_assert_int_eq(tmp_int, 1);
+   assert_value(conf, "b",       NULL);
+   assert_value(conf, "b=\"no",  NULL);
+   assert_value(conf, "c",       "with # hash");
+   assert_value(conf, "d",       "");
+   assert_value(conf, "e",       "bare");
+   assert_value(conf, "invalid", NULL);
+   ck_assert(config_get_bool(conf, "f", &tmp_bool));
+   ck_assert(tmp_bool);
+   config_file_free(conf);
+}
+END_TEST
+
+START_TEST (test_config_file_include)
+{
+   char main_path[512];
+   char sub_path[512];
+   char data[1024];
+   config_file_t *conf = NULL;
+   struct config_entry_list *entry = NULL;
+
+   tmpnam(main_path);
+   tmpnam(sub_path);
+   write_file(sub_path, "x = \"from sub\"\ny = sub\n");
+   snprintf(data, sizeof(data),
+         "y = main\n#include \"%s\"\nz = \"after\"\n", sub_path);
+   write_file(main_path, data);
+
+   conf = config_file_new(main_path);
+   ck_assert_ptr_nonnull(conf);
+   assert_value(conf, "x", "from sub");
+   assert_value(conf, "y", "main");
+   assert_value(conf, "z", "after");
+
+   /* Entries from an include are read-only
+    * until they are set */
+   entry = config_get_entry(conf, "x");
+   ck_assert(entry->readonly);
+   config_set_string(conf, "x", "changed");
+   assert_value(conf, "x", "changed");
+   ck_assert(!entry->readonly);
+   config_file_free(conf);
+
+   remove(main_path);
+   remove(sub_path);
+}
+END_TEST
+
+/* Entries that were read from a file are set,
+ * unset and added to, then the config is written
+ * and read back */
+START_TEST (test_config_file_set)
+{
+   unsigned i;
+   char path[512];
+   char str[] = "a = \"1\"\nb = \"2\"\nc = \"3\"\n";
+   config_file_t *conf = config_file_new_from_string(str, NULL);
+
+   ck_assert_ptr_nonnull(conf);
+
+   /* Setting the same value changes nothing */
+   config_set_string(conf, "b", "2");
+   ck_assert(!conf->modified);
+
+   for (i = 0; i < 3; i++)
+   {
+      config_set_string(conf, "a", "changed");
+      config_set_string(conf, "a", "changed again");
+   }
+   config_unset(conf, "c");
+   config_set_string(conf, "d", "new");
+   config_set_int(conf, "e", 5);
+   ck_assert(conf->modified);
+
+   assert_value(conf, "a", "changed again");
+   assert_value(conf, "b", "2");
+   assert_value(conf, "c", NULL);
+   assert_value(conf, "d", "new");
+
+   tmpnam(path);
+   ck_assert(config_file_write(conf, path, true));
+   config_file_free(conf);
+
+   conf = config_file_new(path);
+   ck_assert_ptr_nonnull(conf);
+   assert_value(conf, "a", "changed again");
+   assert_value(conf, "b", "2");
+   assert_value(conf, "c", NULL);
+   assert_value(conf, "d", "new");
+   assert_value(conf, "e", "5");
+   config_unset(conf, "a");
+   config_unset(conf, "d");
+   config_file_free(conf);
+
+   remove(path);
+}
+END_TEST
+
+START_TEST (test_config_file_append)
+{
+   char path[512];
+   char str[] = "a = \"1\"\nb = \"2\"\n";
+   config_file_t *conf = config_file_new_from_string(str, NULL);
+
+   tmpnam(path);
+   write_file(path, "b = \"appended\"\nc = \"3\"\n");
+   ck_assert(config_append_file(conf, path));
+   assert_value(conf, "a", "1");
+   assert_value(conf, "b", "appended");
+   assert_value(conf, "c", "3");
+   config_set_string(conf, "c", "changed");
+   assert_value(conf, "c", "changed");
+   config_file_free(conf);
+
+   remove(path);
+}
+END_TEST
+
+/* Times reading a config the size of a
+ * few retroarch.cfg files */
+START_TEST (test_config_file_parse_time)
+{
+   unsigned i;
+   unsigned run;
+   char path[512];
+   char key[64];
+   char value[64];
+   size_t len          = 0;
+   char *data          = (char*)malloc(PARSE_ENTRIES * 96);
+   retro_time_t usec   = 0;
+   config_file_t *conf = NULL;
+
+   ck_assert_ptr_nonnull(data);
+   data[0] = '\0';
+   for (i = 0; i < PARSE_ENTRIES; i++)
+      len += snprintf(data + len, PARSE_ENTRIES * 96 - len,
+            "some_setting_%05u = \"value %u\"\n", i, i * 7);
+
+   tmpnam(path);
+   write_file(path, data);
+
+   for (run = 0; run < PARSE_RUNS; run++)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      conf               = config_file_new(path);
+      usec              += cpu_features_get_time_usec() - start;
+
+      ck_assert_ptr_nonnull(conf);
+      snprintf(key,   sizeof(key),   "some_setting_%05u", PARSE_ENTRIES - 1);
+      snprintf(value, sizeof(value), "value %u", (PARSE_ENTRIES - 1) * 7);
+      assert_value(conf, key, value);
+      config_file_free(conf);
+   }
+
+   printf("Parsed %u entries in %.3f ms\n", PARSE_ENTRIES,
+         usec / 1000.0 / PARSE_RUNS);
+
+   free(data);
+   remove(path);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_config_file_parse);
+   tcase_add_test(tc_core, test_config_file_include);
+   tcase_add_test(tc_core, test_config_file_set);
+   tcase_add_test(tc_core, test_config_file_append);
+   tcase_add_test(tc_core, test_config_file_parse_time);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
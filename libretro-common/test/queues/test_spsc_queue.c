@@ -0,0 +1,175 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/spsc_queue.h>
+#include <rthreads/rthreads.h>
+
+#define SUITE_NAME "SPSC Queue"
+
+#define STREAM_BYTES (4 * 1024 * 1024)
+
+START_TEST (test_spsc_queue_create)
+{
+   spsc_queue_t *queue = spsc_queue_new(16);
+   ck_assert_ptr_nonnull(queue);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 0);
+   ck_assert_uint_eq(spsc_queue_write_avail(queue), 16);
+   spsc_queue_free(queue);
+   spsc_queue_free(NULL);
+   ck_assert_ptr_null(spsc_queue_new(0));
+}
+END_TEST
+
+START_TEST (test_spsc_queue_full_empty)
+{
+   uint8_t in[20], out[20];
+   unsigned i;
+   spsc_queue_t *queue = spsc_queue_new(16);
+
+   for (i = 0; i < sizeof(in); i++)
+      in[i] = (uint8_t)i;
+
+   /* Only as much as fits goes in */
+   ck_assert_uint_eq(spsc_queue_write(queue, in, sizeof(in)), 16);
+   ck_assert_uint_eq(spsc_queue_write_avail(queue), 0);
+   ck_assert_uint_eq(spsc_queue_write(queue, in, 1), 0);
+
+   ck_assert_uint_eq(spsc_queue_read(queue, out, sizeof(out)), 16);
+   ck_assert_int_eq(memcmp(in, out, 16), 0);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 0);
+   ck_assert_uint_eq(spsc_queue_read(queue, out, 1), 0);
+
+   spsc_queue_free(queue);
+}
+END_TEST
+
+START_TEST (test_spsc_queue_wrap)
+{
+   uint8_t in[10], out[10];
+   const uint8_t *first, *second;
+   size_t first_len, second_len;
+   unsigned i;
+   spsc_queue_t *queue = spsc_queue_new(16);
+
+   for (i = 0; i < sizeof(in); i++)
+      in[i] = (uint8_t)(i + 100);
+
+   /* Move both ends near the end of the storage */
+   ck_assert_uint_eq(spsc_queue_write(queue, in, 10), 10);
+   ck_assert_uint_eq(spsc_queue_read(queue, out, 10), 10);
+
+   ck_assert_uint_eq(spsc_queue_write(queue, in, 10), 10);
+
+   ck_assert_uint_eq(spsc_queue_read_regions(queue,
+            &first, &first_len, &second, &second_len), 10);
+   ck_assert_uint_eq(first_len, 6);
+   ck_assert_uint_eq(second_len, 4);
+   ck_assert_int_eq(memcmp(first, in, 6), 0);
+   ck_assert_int_eq(memcmp(second, in + 6, 4), 0);
+
+   spsc_queue_read_advance(queue, 3);
+   ck_assert_uint_eq(spsc_queue_read(queue, out, 7), 7);
+   ck_assert_int_eq(memcmp(out, in + 3, 7), 0);
+
+   spsc_queue_clear(queue);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 0);
+
+   spsc_queue_free(queue);
+}
+END_TEST
+
+static void producer_thread(void *data)
+{
+   uint8_t chunk[97];
+   size_t sent         = 0;
+   spsc_queue_t *queue = (spsc_queue_t*)data;
+
+   while (sent < STREAM_BYTES)
+   {
+      size_t i, len = sizeof(chunk);
+      if (len > STREAM_BYTES - sent)
+         len = STREAM_BYTES - sent;
+      for (i = 0; i < len; i++)
+         chunk[i] = (uint8_t)((sent + i) * 7);
+      for (i = 0; i < len; )
+         i += spsc_queue_write(queue, chunk + i, len - i);
+      sent += len;
+   }
+}
+
+START_TEST (test_spsc_queue_threaded)
+{
+   uint8_t chunk[61];
+   size_t received     = 0;
+   unsigned errors     = 0;
+   spsc_queue_t *queue = spsc_queue_new(1000);
+   sthread_t *thread   = sthread_create(producer_thread, queue);
+
+   ck_assert_ptr_nonnull(thread);
+
+   while (received < STREAM_BYTES)
+   {
+      size_t i;
+      size_t len = spsc_queue_read(queue, chunk, sizeof(chunk));
+      for (i = 0; i < len; i++)
+         if (chunk[i] != (uint8_t)((received + i) * 7))
+            errors++;
+      received += len;
+   }
+
+   sthread_join(thread);
+
+   ck_assert_uint_eq(errors, 0);
+   ck_assert_uint_eq(spsc_queue_read_avail(queue), 0);
+
+   spsc_queue_free(queue);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_spsc_queue_create);
+   tcase_add_test(tc_core, test_spsc_queue_full_empty);
+   tcase_add_test(tc_core, test_spsc_queue_wrap);
+   tcase_add_test(tc_core, test_spsc_queue_threaded);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
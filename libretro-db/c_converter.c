@@ -743,6 +743,25 @@ static int dat_converter_value_provider(
    return 0;
 }
 
+/* Indexes the fields the frontend looks entries up by
+ * when scanning content, so it needn't read them all */
+static void dat_converter_create_indices(const char *rdb_path)
+{
+   libretrodb_t *db = libretrodb_new();
+
+   if (!db)
+      return;
+
+   if (libretrodb_open(rdb_path, db) == 0)
+   {
+      libretrodb_create_index(db, "crc", "crc");
+      libretrodb_create_index(db, "serial", "serial");
+      libretrodb_close(db);
+   }
+
+   libretrodb_free(db);
+}
+
 int main(int argc, char** argv)
 {
    const char* rdb_path;
@@ -832,6 +851,8 @@ int main(int argc, char** argv)
 
    filestream_close(rdb_file);
 
+   dat_converter_create_indices(rdb_path);
+
    dat_converter_list_free(dat_parser_list);
 
    while (dat_count--)
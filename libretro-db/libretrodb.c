@@ -31,6 +31,14 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#ifdef HAVE_MMAP
+#include <memmap.h>
+#ifdef HAVE_MMAN
+#include <fcntl.h>
+#endif
+#endif
+
+#include <boolean.h>
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -39,22 +47,40 @@
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 #include "rmsgpack.h"
-#include "bintree.h"
 #include "query.h"
 #include "libretrodb.h"
 
 #define MAGIC_NUMBER "RARCHDB"
 
-struct node_iter_ctx
+/* How much cursors read at a time when going
+ * through entries, and when looking them up */
+#define CURSOR_READ_SIZE        65536
+#define CURSOR_LOOKUP_READ_SIZE 4096
+
+/* Size of the keys of hashed indices */
+#define HASHED_KEY_SIZE 8
+
+/* An index, kept in memory once looked up. Items are
+ * the key followed by the offset of its entry, sorted
+ * by key, then by offset. Keys of hashed indices are
+ * libretrodb_hash_key() of the value. */
+struct libretrodb_loaded_index
 {
-	libretrodb_t *db;
-	libretrodb_index_t *idx;
+   char name[50];
+   uint8_t *items;
+   void *map;          /* Mapping holding the items, if mapped */
+   size_t map_len;
+   uint64_t count;
+   uint64_t key_size;  /* 0 if the database has no such index */
+   bool hashed;
 };
 
 struct libretrodb
 {
 	RFILE *fd;
    char *path;
+   struct libretrodb_loaded_index *indices;
+   size_t num_indices;
 	uint64_t root;
 	uint64_t count;
 	uint64_t first_index_offset;
@@ -65,6 +91,7 @@ struct libretrodb_index
 	char name[50];
 	uint64_t key_size;
 	uint64_t next;
+	bool hashed;
 };
 
 typedef struct libretrodb_metadata
@@ -83,6 +110,14 @@ struct libretrodb_cursor
    RFILE *fd;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   uint8_t *buff;      /* Entries read ahead, undecoded */
+   size_t buff_cap;
+   size_t buff_len;
+   size_t buff_pos;    /* Next entry in buff */
+   uint64_t buff_offset;
+   uint64_t *offsets;  /* Entries found with an index, if any */
+   size_t num_offsets;
+   size_t next_offset;
 	int is_valid;
 	int eof;
 };
@@ -180,28 +215,131 @@ clean:
    return rv;
 }
 
+static struct rmsgpack_dom_value *libretrodb_header_value(
+      struct rmsgpack_dom_value *header, const char *name)
+{
+   struct rmsgpack_dom_value key;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(name);
+   key.val.string.buff = (char*)name;
+
+   return rmsgpack_dom_value_map_value(header, &key);
+}
+
+/* Positive fixints are read as signed */
+static bool libretrodb_header_uint(const struct rmsgpack_dom_value *value,
+      uint64_t *out)
+{
+   if (value->type == RDT_UINT)
+      *out = value->val.uint_;
+   else if (value->type == RDT_INT && value->val.int_ >= 0)
+      *out = (uint64_t)value->val.int_;
+   else
+      return false;
+   return true;
+}
+
 static int libretrodb_read_index_header(RFILE *fd, libretrodb_index_t *idx)
 {
-   uint64_t name_len = 50;
-   return rmsgpack_dom_read_into(fd,
-         "name", idx->name, &name_len,
-         "key_size", &idx->key_size,
-         "next", &idx->next, NULL);
+   struct rmsgpack_dom_value header;
+   struct rmsgpack_dom_value *name     = NULL;
+   struct rmsgpack_dom_value *key_size = NULL;
+   struct rmsgpack_dom_value *next     = NULL;
+   struct rmsgpack_dom_value *hashed   = NULL;
+   int rv                              = rmsgpack_dom_read(fd, &header);
+
+   if (rv < 0)
+      return rv;
+
+   /* "hashed" is only written for hashed indices */
+   if (     header.type != RDT_MAP
+         || !(name      = libretrodb_header_value(&header, "name"))
+         || !(key_size  = libretrodb_header_value(&header, "key_size"))
+         || !(next      = libretrodb_header_value(&header, "next"))
+         || name->type != RDT_STRING
+         || !libretrodb_header_uint(key_size, &idx->key_size)
+         || !libretrodb_header_uint(next, &idx->next))
+   {
+      rmsgpack_dom_value_free(&header);
+      return -EINVAL;
+   }
+
+   hashed        = libretrodb_header_value(&header, "hashed");
+
+   strlcpy(idx->name, name->val.string.buff, sizeof(idx->name));
+   idx->hashed   = hashed && hashed->type == RDT_BOOL && hashed->val.bool_;
+
+   rmsgpack_dom_value_free(&header);
+   return 0;
 }
 
 static void libretrodb_write_index_header(RFILE *fd, libretrodb_index_t *idx)
 {
-   rmsgpack_write_map_header(fd, 3);
+   rmsgpack_write_map_header(fd, idx->hashed ? 4 : 3);
    rmsgpack_write_string(fd, "name", STRLEN_CONST("name"));
    rmsgpack_write_string(fd, idx->name, (uint32_t)strlen(idx->name));
    rmsgpack_write_string(fd, "key_size", (uint32_t)STRLEN_CONST("key_size"));
    rmsgpack_write_uint(fd, idx->key_size);
    rmsgpack_write_string(fd, "next", STRLEN_CONST("next"));
    rmsgpack_write_uint(fd, idx->next);
+   if (idx->hashed)
+   {
+      rmsgpack_write_string(fd, "hashed", STRLEN_CONST("hashed"));
+      rmsgpack_write_bool(fd, 1);
+   }
+}
+
+/* Hashes string and binary values for hashed indices,
+ * the kind of value included */
+static void libretrodb_hash_key(const struct rmsgpack_dom_value *value,
+      uint8_t *key)
+{
+   int i;
+   uint32_t j;
+   uint64_t hash     = UINT64_C(0xcbf29ce484222325);
+   const uint8_t *s  = (const uint8_t*)value->val.string.buff;
+   uint32_t len      = value->val.string.len;
+
+   if (value->type == RDT_BINARY)
+   {
+      s   = (const uint8_t*)value->val.binary.buff;
+      len = value->val.binary.len;
+   }
+
+   /* FNV-1a */
+   hash = (hash ^ (uint8_t)value->type) * UINT64_C(0x100000001b3);
+   for (j = 0; j < len; j++)
+      hash = (hash ^ s[j]) * UINT64_C(0x100000001b3);
+
+   for (i = HASHED_KEY_SIZE - 1; i >= 0; i--, hash >>= 8)
+      key[i] = (uint8_t)hash;
+}
+
+static void libretrodb_free_indices(libretrodb_t *db)
+{
+   size_t i;
+
+   for (i = 0; i < db->num_indices; i++)
+   {
+      struct libretrodb_loaded_index *index = &db->indices[i];
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+      if (index->map)
+         munmap(index->map, index->map_len);
+      else
+#endif
+         free(index->items);
+   }
+
+   free(db->indices);
+   db->indices     = NULL;
+   db->num_indices = 0;
 }
 
 void libretrodb_close(libretrodb_t *db)
 {
+   libretrodb_free_indices(db);
    if (db->fd)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
@@ -272,9 +410,10 @@ static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
    /* TODO: this should use filestream_eof instead */
    while (offset < eof)
    {
-      libretrodb_read_index_header(db->fd, idx);
+      if (libretrodb_read_index_header(db->fd, idx) < 0)
+         return -1;
 
-      if (strncmp(index_name, idx->name, strlen(idx->name)) == 0)
+      if (string_is_equal(index_name, idx->name))
          return 0;
 
       filestream_seek(db->fd, (ssize_t)idx->next,
@@ -285,71 +424,282 @@ static int libretrodb_find_index(libretrodb_t *db, const char *index_name,
    return -1;
 }
 
-static int binsearch(const void *buff, const void *item,
-      uint64_t count, uint8_t field_size, uint64_t *offset)
+/* Maps @len bytes at @offset of the database file,
+ * which is quicker than reading them if only a few
+ * pages end up being used */
+static uint8_t *libretrodb_map(libretrodb_t *db,
+      struct libretrodb_loaded_index *index,
+      uint64_t offset, uint64_t len)
 {
-   int mid            = (int)(count / 2);
-   int item_size      = field_size + sizeof(uint64_t);
-   uint64_t *current  = (uint64_t *)buff + (mid * item_size);
-   int rv             = memcmp(current, item, field_size);
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   void *map;
+   uint64_t start;
+   long page_size = sysconf(_SC_PAGESIZE);
+   int fd         = open(db->path, O_RDONLY);
 
-   if (rv == 0)
-   {
-      *offset = *(uint64_t *)(current + field_size);
-      return 0;
-   }
+   if (fd < 0)
+      return NULL;
 
-   if (count == 0)
-      return -1;
+   if (page_size <= 0)
+      page_size = 4096;
 
-   if (rv > 0)
-      return binsearch(buff, item, mid, field_size, offset);
+   /* Mappings start at page boundaries */
+   start = offset - offset % (uint64_t)page_size;
+   map   = mmap(NULL, (size_t)(offset - start + len), PROT_READ,
+         MAP_PRIVATE, fd, (off_t)start);
+   close(fd);
+
+   if (map == MAP_FAILED)
+      return NULL;
 
-   return binsearch(current + item_size, item,
-         count - mid, field_size, offset);
+   index->map     = map;
+   index->map_len = (size_t)(offset - start + len);
+   return (uint8_t*)map + (offset - start);
+#else
+   return NULL;
+#endif
 }
 
-int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
-      const void *key, struct rmsgpack_dom_value *out)
+static int libretrodb_load_index(libretrodb_t *db,
+      const char *index_name, struct libretrodb_loaded_index *index)
 {
    libretrodb_index_t idx;
-   int rv;
-   void *buff;
-   uint64_t offset;
-   ssize_t bufflen, nread = 0;
+   uint64_t item_size;
+   int64_t offset;
+   uint64_t nread = 0;
 
    if (libretrodb_find_index(db, index_name, &idx) < 0)
-      return -1;
+      return 0;
 
-   bufflen = idx.next;
-   buff    = malloc(bufflen);
+   item_size = idx.key_size + sizeof(uint64_t);
 
-   if (!buff)
+   /* Keys are compared with a uint8_t length */
+   if (     idx.key_size == 0
+         || idx.key_size > 255
+         || (idx.hashed && idx.key_size != HASHED_KEY_SIZE)
+         || idx.next % item_size)
+      return -EINVAL;
+
+   index->key_size = idx.key_size;
+   index->hashed   = idx.hashed;
+   index->count    = idx.next / item_size;
+
+   if (index->count == 0)
+      return 0;
+
+   offset = filestream_tell(db->fd);
+
+   if ((index->items = libretrodb_map(db, index, offset, idx.next)))
+      return 0;
+
+   if (!(index->items = (uint8_t*)malloc((size_t)idx.next)))
       return -ENOMEM;
 
-   while (nread < bufflen)
+   while (nread < idx.next)
    {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv          = (int)filestream_read(db->fd, buff_, bufflen - nread);
+      int64_t rv = filestream_read(db->fd,
+            index->items + nread, idx.next - nread);
 
       if (rv <= 0)
       {
-         free(buff);
-         return -errno;
+         free(index->items);
+         index->items = NULL;
+         return -EIO;
       }
       nread += rv;
    }
 
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   return 0;
+}
 
-   if (rv == 0)
-      filestream_seek(db->fd, (ssize_t)offset,
-            RETRO_VFS_SEEK_POSITION_START);
+/* Gets the index @index_name, reading it (or mapping it)
+ * the first time it is asked for. Returns NULL if the
+ * database has no such index. */
+static struct libretrodb_loaded_index *libretrodb_get_index(
+      libretrodb_t *db, const char *index_name, int *rv)
+{
+   size_t i;
+   struct libretrodb_loaded_index *indices = NULL;
+   struct libretrodb_loaded_index *index   = NULL;
+
+   *rv = 0;
+
+   for (i = 0; i < db->num_indices; i++)
+   {
+      if (string_is_equal(db->indices[i].name, index_name))
+      {
+         index = &db->indices[i];
+         return index->key_size ? index : NULL;
+      }
+   }
+
+   if (!(indices = (struct libretrodb_loaded_index*)realloc(db->indices,
+               (db->num_indices + 1) * sizeof(*indices))))
+   {
+      *rv = -ENOMEM;
+      return NULL;
+   }
+
+   db->indices = indices;
+   index       = &indices[db->num_indices];
+   memset(index, 0, sizeof(*index));
+   strlcpy(index->name, index_name, sizeof(index->name));
+
+   /* Indices that failed to load are remembered
+    * as missing, so they aren't tried again */
+   if ((*rv = libretrodb_load_index(db, index_name, index)) < 0)
+   {
+      index->key_size = 0;
+      index->count    = 0;
+   }
+
+   db->num_indices++;
+   return index->key_size ? index : NULL;
+}
+
+/* Returns the position of the first item with @key,
+ * or of where it would be */
+static uint64_t libretrodb_index_lower_bound(
+      const struct libretrodb_loaded_index *index, const void *key)
+{
+   uint64_t lo        = 0;
+   uint64_t hi        = index->count;
+   uint64_t item_size = index->key_size + sizeof(uint64_t);
+
+   while (lo < hi)
+   {
+      uint64_t mid = lo + (hi - lo) / 2;
+
+      if (memcmp(index->items + mid * item_size, key,
+               (size_t)index->key_size) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   return lo;
+}
+
+/* Gets the offset of the first entry with @key */
+static bool libretrodb_index_find(
+      const struct libretrodb_loaded_index *index,
+      const void *key, uint64_t *offset)
+{
+   uint64_t item_size = index->key_size + sizeof(uint64_t);
+   uint64_t i         = libretrodb_index_lower_bound(index, key);
+   const uint8_t *item;
+
+   if (i >= index->count)
+      return false;
+
+   item = index->items + i * item_size;
+
+   if (memcmp(item, key, (size_t)index->key_size) != 0)
+      return false;
+
+   memcpy(offset, item + index->key_size, sizeof(uint64_t));
+   return true;
+}
+
+int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
+      const void *key, struct rmsgpack_dom_value *out)
+{
+   int rv;
+   uint64_t offset;
+   struct libretrodb_loaded_index *index =
+      libretrodb_get_index(db, index_name, &rv);
+
+   if (!index)
+      return rv < 0 ? rv : -1;
+
+   /* Keys of hashed indices aren't the values */
+   if (index->hashed)
+      return -EINVAL;
+
+   if (!libretrodb_index_find(index, key, &offset))
+      return -1;
+
+   filestream_seek(db->fd, (int64_t)offset,
+         RETRO_VFS_SEEK_POSITION_START);
 
    return rmsgpack_dom_read(db->fd, out);
 }
 
+struct libretrodb_batch_item
+{
+   uint64_t offset;
+   size_t key;
+};
+
+static int libretrodb_batch_item_compare(const void *a, const void *b)
+{
+   const struct libretrodb_batch_item *item_a =
+      (const struct libretrodb_batch_item*)a;
+   const struct libretrodb_batch_item *item_b =
+      (const struct libretrodb_batch_item*)b;
+
+   if (item_a->offset != item_b->offset)
+      return item_a->offset < item_b->offset ? -1 : 1;
+   return 0;
+}
+
+int libretrodb_find_entries(libretrodb_t *db, const char *index_name,
+      const void **keys, size_t count, struct rmsgpack_dom_value *out)
+{
+   int rv;
+   size_t i;
+   size_t found                          = 0;
+   struct libretrodb_batch_item *batch   = NULL;
+   struct libretrodb_loaded_index *index = NULL;
+
+   for (i = 0; i < count; i++)
+      out[i].type = RDT_NULL;
+
+   if (!(index = libretrodb_get_index(db, index_name, &rv)))
+      return rv < 0 ? rv : -1;
+
+   if (index->hashed)
+      return -EINVAL;
+
+   if (count == 0)
+      return 0;
+
+   if (!(batch = (struct libretrodb_batch_item*)
+            malloc(count * sizeof(*batch))))
+      return -ENOMEM;
+
+   for (i = 0; i < count; i++)
+   {
+      if (!libretrodb_index_find(index, keys[i], &batch[found].offset))
+         continue;
+      batch[found++].key = i;
+   }
+
+   /* Read entries in the order they are stored in,
+    * instead of seeking back and forth */
+   qsort(batch, found, sizeof(*batch), libretrodb_batch_item_compare);
+
+   for (i = 0; i < found; i++)
+   {
+      filestream_seek(db->fd, (int64_t)batch[i].offset,
+            RETRO_VFS_SEEK_POSITION_START);
+
+      if ((rv = rmsgpack_dom_read(db->fd, &out[batch[i].key])) < 0)
+      {
+         free(batch);
+         for (i = 0; i < count; i++)
+         {
+            rmsgpack_dom_value_free(&out[i]);
+            out[i].type = RDT_NULL;
+         }
+         return rv;
+      }
+   }
+
+   free(batch);
+   return (int)found;
+}
+
 /**
  * libretrodb_cursor_reset:
  * @cursor              : Handle to database cursor.
@@ -360,41 +710,151 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
  **/
 int libretrodb_cursor_reset(libretrodb_cursor_t *cursor)
 {
-   cursor->eof = 0;
+   cursor->eof         = 0;
+   cursor->next_offset = 0;
+   cursor->buff_len    = 0;
+   cursor->buff_pos    = 0;
+   cursor->buff_offset = cursor->db->root + sizeof(libretrodb_header_t);
    return (int)filestream_seek(cursor->fd,
-         (ssize_t)(cursor->db->root + sizeof(libretrodb_header_t)),
+         (ssize_t)cursor->buff_offset,
          RETRO_VFS_SEEK_POSITION_START);
 }
 
-int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
-      struct rmsgpack_dom_value *out)
+/* Gets the next entry, undecoded, and where it is in
+ * the file. Entries are read a block at a time instead
+ * of a value at a time, so going through all of them
+ * doesn't take a read for every value. */
+static int libretrodb_cursor_next(libretrodb_cursor_t *cursor,
+      const uint8_t **entry, size_t *len, uint64_t *offset)
 {
-   int rv;
+   size_t read_size = CURSOR_READ_SIZE;
 
-   if (cursor->eof)
-      return EOF;
+   if (cursor->offsets)
+   {
+      uint64_t next;
 
-retry:
-   rv = rmsgpack_dom_read(cursor->fd, out);
-   if (rv < 0)
-      return rv;
+      if (cursor->next_offset >= cursor->num_offsets)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      /* Entries found are mostly far apart */
+      read_size = CURSOR_LOOKUP_READ_SIZE;
+      next      = cursor->offsets[cursor->next_offset++];
+
+      if (     next >= cursor->buff_offset
+            && next <  cursor->buff_offset + cursor->buff_len)
+         cursor->buff_pos    = (size_t)(next - cursor->buff_offset);
+      else
+      {
+         cursor->buff_offset = next;
+         cursor->buff_len    = 0;
+         cursor->buff_pos    = 0;
+         filestream_seek(cursor->fd, (int64_t)next,
+               RETRO_VFS_SEEK_POSITION_START);
+      }
+   }
 
-   if (out->type == RDT_NULL)
+   for (;;)
    {
-      cursor->eof = 1;
-      return EOF;
+      int64_t nread;
+      size_t pos = cursor->buff_pos;
+
+      if (     pos < cursor->buff_len
+            && rmsgpack_buf_skip(cursor->buff, cursor->buff_len, &pos) == 0)
+      {
+         *entry           = cursor->buff + cursor->buff_pos;
+         *len             = pos - cursor->buff_pos;
+         if (offset)
+            *offset       = cursor->buff_offset + cursor->buff_pos;
+         cursor->buff_pos = pos;
+         return 0;
+      }
+
+      /* The entry goes on past what was read so far */
+      if (cursor->buff_pos > 0)
+      {
+         memmove(cursor->buff, cursor->buff + cursor->buff_pos,
+               cursor->buff_len - cursor->buff_pos);
+         cursor->buff_offset += cursor->buff_pos;
+         cursor->buff_len    -= cursor->buff_pos;
+         cursor->buff_pos     = 0;
+      }
+
+      if (cursor->buff_cap - cursor->buff_len < read_size)
+      {
+         uint8_t *new_buff = (uint8_t*)realloc(cursor->buff,
+               cursor->buff_len + read_size);
+
+         if (!new_buff)
+            return -ENOMEM;
+
+         cursor->buff     = new_buff;
+         cursor->buff_cap = cursor->buff_len + read_size;
+      }
+
+      /* Anything left over at the end of the file is broken */
+      if ((nread = filestream_read(cursor->fd,
+                  cursor->buff + cursor->buff_len, read_size)) <= 0)
+         return -EINVAL;
+
+      cursor->buff_len += (size_t)nread;
    }
+}
 
-   if (cursor->query)
+static int libretrodb_cursor_read(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out, uint64_t *offset)
+{
+   int rv;
+
+   if (cursor->eof)
+      return EOF;
+
+   for (;;)
    {
-      if (!libretrodb_query_filter(cursor->query, out))
+      size_t len           = 0;
+      size_t pos           = 0;
+      const uint8_t *entry = NULL;
+
+      if ((rv = libretrodb_cursor_next(cursor, &entry, &len, offset)) != 0)
+         return rv;
+
+      /* Entries are only decoded once they are known to match */
+      if (cursor->query)
       {
-         rmsgpack_dom_value_free(out);
-         goto retry;
+         switch (libretrodb_query_filter_raw(cursor->query, entry, len))
+         {
+            case 0:
+               continue;
+            case 1:
+               return rmsgpack_dom_read_buf(entry, len, &pos, out);
+            default:
+               break;
+         }
       }
+
+      if ((rv = rmsgpack_dom_read_buf(entry, len, &pos, out)) < 0)
+         return rv;
+
+      /* The last entry is followed by nil */
+      if (out->type == RDT_NULL)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      if (!cursor->query || libretrodb_query_filter(cursor->query, out))
+         return 0;
+
+      rmsgpack_dom_value_free(out);
    }
+}
 
-   return 0;
+int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
+      struct rmsgpack_dom_value *out)
+{
+   return libretrodb_cursor_read(cursor, out, NULL);
 }
 
 /**
@@ -414,11 +874,126 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
-   cursor->is_valid = 0;
-   cursor->eof      = 1;
-   cursor->fd       = NULL;
-   cursor->db       = NULL;
-   cursor->query    = NULL;
+   free(cursor->buff);
+   free(cursor->offsets);
+
+   cursor->is_valid    = 0;
+   cursor->eof         = 1;
+   cursor->fd          = NULL;
+   cursor->db          = NULL;
+   cursor->query       = NULL;
+   cursor->buff        = NULL;
+   cursor->buff_cap    = 0;
+   cursor->buff_len    = 0;
+   cursor->buff_pos    = 0;
+   cursor->offsets     = NULL;
+   cursor->num_offsets = 0;
+   cursor->next_offset = 0;
+}
+
+static int libretrodb_offset_compare(const void *a, const void *b)
+{
+   uint64_t offset_a = *(const uint64_t*)a;
+   uint64_t offset_b = *(const uint64_t*)b;
+
+   if (offset_a != offset_b)
+      return offset_a < offset_b ? -1 : 1;
+   return 0;
+}
+
+/* Looks the values of the first field @q needs to be
+ * equal to one of up in the index of the same name, if
+ * there is one, so that only the entries found are read.
+ * Entries are still filtered, for the other fields and
+ * for keys of hashed indices that happen to be equal. */
+static int libretrodb_cursor_find_offsets(libretrodb_cursor_t *cursor,
+      libretrodb_query_t *q)
+{
+   unsigned n;
+   int num_values;
+   const char *field;
+   const struct rmsgpack_dom_value *values[QUERY_MAX_ARGS];
+
+   for (n = 0; (num_values = libretrodb_query_field_values(
+               q, n, &field, values)) >= 0; n++)
+   {
+      int i, rv;
+      size_t j;
+      size_t count                          = 0;
+      size_t cap                            = 16;
+      uint64_t *offsets                     = NULL;
+      struct libretrodb_loaded_index *index = NULL;
+
+      if (num_values == 0)
+         continue;
+
+      if (!(index = libretrodb_get_index(cursor->db, field, &rv)))
+      {
+         if (rv < 0)
+            return rv;
+         continue;
+      }
+
+      if (!(offsets = (uint64_t*)malloc(cap * sizeof(*offsets))))
+         return -ENOMEM;
+
+      for (i = 0; i < num_values; i++)
+      {
+         uint64_t k;
+         uint8_t hashed_key[HASHED_KEY_SIZE];
+         uint64_t item_size = index->key_size + sizeof(uint64_t);
+         const uint8_t *key = hashed_key;
+
+         if (index->hashed)
+            libretrodb_hash_key(values[i], hashed_key);
+         /* Exact indices hold every string and binary
+          * value of the field, so other values match nothing */
+         else if (values[i]->type == RDT_BINARY
+               && values[i]->val.binary.len == index->key_size)
+            key = (const uint8_t*)values[i]->val.binary.buff;
+         else
+            continue;
+
+         for (k = libretrodb_index_lower_bound(index, key);
+               k < index->count; k++)
+         {
+            const uint8_t *item = index->items + k * item_size;
+
+            if (memcmp(item, key, (size_t)index->key_size) != 0)
+               break;
+
+            if (count == cap)
+            {
+               uint64_t *new_offsets = (uint64_t*)realloc(offsets,
+                     cap * 2 * sizeof(*offsets));
+
+               if (!new_offsets)
+               {
+                  free(offsets);
+                  return -ENOMEM;
+               }
+
+               offsets = new_offsets;
+               cap    *= 2;
+            }
+
+            memcpy(&offsets[count++], item + index->key_size,
+                  sizeof(uint64_t));
+         }
+      }
+
+      /* Read entries in the order they are stored in, once */
+      qsort(offsets, count, sizeof(*offsets), libretrodb_offset_compare);
+
+      for (j = 0, cursor->num_offsets = 0; j < count; j++)
+         if (j == 0 || offsets[j] != offsets[j - 1])
+            offsets[cursor->num_offsets++] = offsets[j];
+
+      cursor->offsets = offsets;
+      return 0;
+   }
+
+   return 0;
 }
 
 /**
@@ -446,132 +1021,201 @@ int libretrodb_cursor_open(libretrodb_t *db,
    if (!fd)
       return -errno;
 
-   cursor->fd       = fd;
-   cursor->db       = db;
-   cursor->is_valid = 1;
+   cursor->fd          = fd;
+   cursor->db          = db;
+   cursor->buff        = NULL;
+   cursor->buff_cap    = 0;
+   cursor->offsets     = NULL;
+   cursor->num_offsets = 0;
+   cursor->is_valid    = 1;
    libretrodb_cursor_reset(cursor);
-   cursor->query    = q;
+   cursor->query       = q;
 
    if (q)
+   {
+      int rv;
+
       libretrodb_query_inc_ref(q);
 
+      if ((rv = libretrodb_cursor_find_offsets(cursor, q)) < 0)
+      {
+         libretrodb_cursor_close(cursor);
+         return rv;
+      }
+   }
+
    return 0;
 }
 
-static int node_iter(void *value, void *ctx)
+/* A value of the field being indexed, and the entry it is in */
+struct libretrodb_index_item
 {
-   struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
+   struct rmsgpack_dom_value value;
+   const uint8_t *key; /* NULL if hashed */
+   uint64_t offset;
+   uint64_t key_size;
+   uint8_t hash[HASHED_KEY_SIZE];
+};
 
-   if (filestream_write(nictx->db->fd, value,
-            (ssize_t)(nictx->idx->key_size + sizeof(uint64_t))) > 0)
-      return 0;
+#define INDEX_ITEM_KEY(item) ((item)->key ? (item)->key : (item)->hash)
 
-   return -1;
-}
-
-static uint64_t libretrodb_tell(libretrodb_t *db)
+/* Orders items by key, then by offset, so that
+ * several entries can have the same key */
+static int libretrodb_index_item_compare(const void *a, const void *b)
 {
-   return filestream_tell(db->fd);
-}
+   const struct libretrodb_index_item *item_a =
+      (const struct libretrodb_index_item*)a;
+   const struct libretrodb_index_item *item_b =
+      (const struct libretrodb_index_item*)b;
+   int rv = memcmp(INDEX_ITEM_KEY(item_a), INDEX_ITEM_KEY(item_b),
+         (size_t)item_a->key_size);
+
+   if (rv != 0)
+      return rv;
 
-static int node_compare(const void *a, const void *b, void *ctx)
-{
-   return memcmp(a, b, *(uint8_t *)ctx);
+   if (item_a->offset != item_b->offset)
+      return item_a->offset < item_b->offset ? -1 : 1;
+   return 0;
 }
 
 int libretrodb_create_index(libretrodb_t *db,
       const char *name, const char *field_name)
 {
-   struct node_iter_ctx nictx;
+   size_t i;
    struct rmsgpack_dom_value key;
    libretrodb_index_t idx;
    struct rmsgpack_dom_value item;
-   libretrodb_cursor_t cur          = {0};
-   struct rmsgpack_dom_value *field = NULL;
-   void *buff                       = NULL;
-   uint64_t *buff_u64               = NULL;
-   uint8_t field_size               = 0;
-   uint64_t item_loc                = libretrodb_tell(db);
-   bintree_t *tree                  = bintree_new(node_compare, &field_size);
-
-   item.type                        = RDT_NULL;
-
-   if (!tree || (libretrodb_cursor_open(db, &cur, NULL) != 0))
+   libretrodb_cursor_t cur                    = {0};
+   struct libretrodb_index_item *items        = NULL;
+   uint8_t *buff                              = NULL;
+   RFILE *fd                                  = NULL;
+   size_t item_count                          = 0;
+   size_t item_cap                            = 0;
+   uint64_t item_size                         = 0;
+   uint64_t item_loc                          = 0;
+
+   item.type                                  = RDT_NULL;
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
       goto clean;
 
    key.type            = RDT_STRING;
    key.val.string.len  = (uint32_t)strlen(field_name);
    key.val.string.buff = (char *) field_name;   /* We know we aren't going to change it */
 
-   while (libretrodb_cursor_read_item(&cur, &item) == 0)
+   while (libretrodb_cursor_read(&cur, &item, &item_loc) == 0)
    {
+      struct rmsgpack_dom_value *field = NULL;
+
       /* Only map keys are supported */
       if (item.type != RDT_MAP)
          goto clean;
 
       field = rmsgpack_dom_value_map_value(&item, &key);
 
-      /* Field not found in item */
-      if (!field)
-         goto clean;
-
-      /* Field is not binary */
-      if (field->type != RDT_BINARY)
-         goto clean;
-
-      /* Field is empty */
-      if (field->val.binary.len == 0)
-         goto clean;
+      /* Entries without the field, or with
+       * something other than a string or
+       * binary in it, are left out */
+      if (     field
+            && (field->type == RDT_STRING || field->type == RDT_BINARY))
+      {
+         if (item_count == item_cap)
+         {
+            size_t new_cap = item_cap ? item_cap * 2 : 1024;
+            struct libretrodb_index_item *new_items =
+               (struct libretrodb_index_item*)realloc(items,
+                     new_cap * sizeof(*items));
+
+            if (!new_items)
+               goto clean;
+
+            items    = new_items;
+            item_cap = new_cap;
+         }
+
+         /* The item takes the value over */
+         items[item_count].value  = *field;
+         items[item_count].offset = item_loc;
+         item_count++;
+         field->type              = RDT_NULL;
+      }
 
-      if (field_size == 0)
-         field_size = field->val.binary.len;
-      /* Field is not of correct size */
-      else if (field->val.binary.len != field_size) 
-         goto clean;
+      rmsgpack_dom_value_free(&item);
+   }
 
-      buff = malloc(field_size + sizeof(uint64_t));
-      if (!buff)
-         goto clean;
+   if (item_count == 0)
+      goto clean;
 
-      memcpy(buff, field->val.binary.buff, field_size);
+   /* Binaries all of the same size (checksums) are
+    * their own keys, anything else is hashed */
+   idx.hashed   = false;
+   idx.key_size = items[0].value.val.binary.len;
 
-      buff_u64 = (uint64_t *)buff + field_size;
+   for (i = 0; i < item_count && !idx.hashed; i++)
+      idx.hashed = items[i].value.type != RDT_BINARY
+         || items[i].value.val.binary.len != idx.key_size
+         || idx.key_size == 0
+         || idx.key_size > 255;
 
-      memcpy(buff_u64, &item_loc, sizeof(uint64_t));
+   if (idx.hashed)
+      idx.key_size = HASHED_KEY_SIZE;
 
-      /* Value is not unique? */
-      if (bintree_insert(tree, buff) != 0)
+   for (i = 0; i < item_count; i++)
+   {
+      items[i].key_size = idx.key_size;
+      if (idx.hashed)
       {
-         rmsgpack_dom_value_print(field);
-         goto clean;
+         libretrodb_hash_key(&items[i].value, items[i].hash);
+         items[i].key = NULL;
       }
-      buff     = NULL;
-      rmsgpack_dom_value_free(&item);
-      item_loc = libretrodb_tell(db);
+      else
+         items[i].key = (const uint8_t*)items[i].value.val.binary.buff;
    }
 
-   filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_END);
+   qsort(items, item_count, sizeof(*items), libretrodb_index_item_compare);
+
+   item_size = idx.key_size + sizeof(uint64_t);
+
+   if (!(buff = (uint8_t*)malloc((size_t)(item_count * item_size))))
+      goto clean;
+
+   for (i = 0; i < item_count; i++)
+   {
+      memcpy(buff + i * item_size, INDEX_ITEM_KEY(&items[i]),
+            (size_t)idx.key_size);
+      memcpy(buff + i * item_size + idx.key_size,
+            &items[i].offset, sizeof(uint64_t));
+   }
+
+   /* The database itself is only open for reading */
+   if (!(fd = filestream_open(db->path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      goto clean;
+
+   filestream_seek(fd, 0, RETRO_VFS_SEEK_POSITION_END);
 
    strncpy(idx.name, name, 50);
 
    idx.name[49] = '\0';
-   idx.key_size = field_size;
-   idx.next     = db->count * (field_size + sizeof(uint64_t));
-   libretrodb_write_index_header(db->fd, &idx);
+   idx.next     = item_count * item_size;
+   libretrodb_write_index_header(fd, &idx);
+   filestream_write(fd, buff, (int64_t)idx.next);
 
-   nictx.db     = db;
-   nictx.idx    = &idx;
-   bintree_iterate(tree, node_iter, &nictx);
+   /* An index of this name may have been looked up already */
+   libretrodb_free_indices(db);
 
 clean:
    rmsgpack_dom_value_free(&item);
-   if (buff)
-      free(buff);
+   for (i = 0; i < item_count; i++)
+      rmsgpack_dom_value_free(&items[i].value);
+   free(items);
+   free(buff);
+   if (fd)
+      filestream_close(fd);
    if (cur.is_valid)
       libretrodb_cursor_close(&cur);
-   if (tree)
-      bintree_free(tree);
-   free(tree);
    return 0;
 }
 
@@ -588,6 +1232,14 @@ libretrodb_cursor_t *libretrodb_cursor_new(void)
    dbc->eof                 = 0;
    dbc->query               = NULL;
    dbc->db                  = NULL;
+   dbc->buff                = NULL;
+   dbc->buff_cap            = 0;
+   dbc->buff_len            = 0;
+   dbc->buff_pos            = 0;
+   dbc->buff_offset         = 0;
+   dbc->offsets             = NULL;
+   dbc->num_offsets         = 0;
+   dbc->next_offset         = 0;
 
    return dbc;
 }
@@ -612,6 +1264,8 @@ libretrodb_t *libretrodb_new(void)
    db->count              = 0;
    db->first_index_offset = 0;
    db->path               = NULL;
+   db->indices            = NULL;
+   db->num_indices        = 0;
 
    return db;
 }
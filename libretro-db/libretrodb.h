@@ -54,9 +54,37 @@ int libretrodb_open(const char *path, libretrodb_t *db);
 int libretrodb_create_index(libretrodb_t *db, const char *name,
       const char *field_name);
 
+/**
+ * libretrodb_find_entry:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to search.
+ * @key                 : Key, as long as the keys of the index.
+ * @out                 : First entry with @key.
+ *
+ * The index is read (or mapped) the first time it is
+ * searched, and kept until the database is closed.
+ *
+ * Returns: 0 if found, otherwise negative.
+ **/
 int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
         const void *key, struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_find_entries:
+ * @db                  : Handle to database.
+ * @index_name          : Name of the index to search.
+ * @keys                : @count keys.
+ * @count               : Number of keys.
+ * @out                 : @count entries, RDT_NULL where not found.
+ *
+ * Same as calling libretrodb_find_entry() for each key, but
+ * reads the entries in the order they are stored in.
+ *
+ * Returns: number of entries found, otherwise negative.
+ **/
+int libretrodb_find_entries(libretrodb_t *db, const char *index_name,
+      const void **keys, size_t count, struct rmsgpack_dom_value *out);
+
 libretrodb_t *libretrodb_new(void);
 
 void libretrodb_free(libretrodb_t *db);
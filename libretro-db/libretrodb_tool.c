@@ -21,13 +21,264 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <string/stdstring.h>
+#include <features/features_cpu.h>
 
 #include "libretrodb.h"
 #include "rmsgpack_dom.h"
 
+/* Lookups done through queries */
+#define BENCH_QUERY_LOOKUPS 20
+#define BENCH_QUERY_RUNS    5
+
+static bool bench_check_entry(const struct rmsgpack_dom_value *entry,
+      const struct rmsgpack_dom_value *field_key, const uint8_t *key,
+      uint32_t key_size)
+{
+   const struct rmsgpack_dom_value *field = NULL;
+
+   if (entry->type != RDT_MAP)
+      return false;
+
+   field = rmsgpack_dom_value_map_value(entry, field_key);
+
+   return field
+      && field->type == RDT_BINARY
+      && field->val.binary.len == key_size
+      && !memcmp(field->val.binary.buff, key, key_size);
+}
+
+static void bench_report(const char *what, size_t count,
+      retro_time_t start)
+{
+   retro_time_t usec = cpu_features_get_time_usec() - start;
+
+   printf("%-24s %8u in %10.3f ms (%9.3f us each)\n",
+         what, (unsigned)count, usec / 1000.0,
+         count ? (double)usec / count : 0.0);
+}
+
+/* Looks up the @field_name of every entry
+ * with the index @index_name, checking what
+ * each lookup returns */
+static int bench_index(libretrodb_t *db, libretrodb_cursor_t *cur,
+      const char *index_name, const char *field_name)
+{
+   size_t i;
+   int rv;
+   retro_time_t start;
+   struct rmsgpack_dom_value item;
+   struct rmsgpack_dom_value field_key;
+   size_t count                     = 0;
+   size_t errors                    = 0;
+   uint32_t key_size                = 0;
+   uint8_t *keys                    = NULL;
+   const void **key_ptrs            = NULL;
+   struct rmsgpack_dom_value *found = NULL;
+
+   field_key.type                   = RDT_STRING;
+   field_key.val.string.len         = (uint32_t)strlen(field_name);
+   field_key.val.string.buff        = (char*)field_name;
+
+   if ((rv = libretrodb_cursor_open(db, cur, NULL)) != 0)
+   {
+      printf("Could not open cursor: %s\n", strerror(-rv));
+      return 1;
+   }
+
+   while (libretrodb_cursor_read_item(cur, &item) == 0)
+   {
+      const struct rmsgpack_dom_value *field = (item.type == RDT_MAP)
+         ? rmsgpack_dom_value_map_value(&item, &field_key) : NULL;
+
+      if (     field
+            && field->type == RDT_BINARY
+            && field->val.binary.len > 0
+            && (!key_size || field->val.binary.len == key_size))
+      {
+         uint8_t *new_keys;
+
+         key_size = field->val.binary.len;
+         if (!(new_keys = (uint8_t*)realloc(keys,
+                     (count + 1) * key_size)))
+         {
+            rmsgpack_dom_value_free(&item);
+            break;
+         }
+         keys = new_keys;
+         memcpy(keys + count++ * key_size,
+               field->val.binary.buff, key_size);
+      }
+
+      rmsgpack_dom_value_free(&item);
+   }
+
+   libretrodb_cursor_close(cur);
+
+   if (!count)
+   {
+      printf("No entries with a binary '%s'\n", field_name);
+      return 1;
+   }
+
+   /* A scan looks files up in no particular order */
+   srand(1);
+   for (i = count - 1; i > 0; i--)
+   {
+      uint8_t tmp[256];
+      size_t j = (size_t)rand() % (i + 1);
+
+      memcpy(tmp, keys + i * key_size, key_size);
+      memcpy(keys + i * key_size, keys + j * key_size, key_size);
+      memcpy(keys + j * key_size, tmp, key_size);
+   }
+
+   start = cpu_features_get_time_usec();
+   rv    = libretrodb_find_entry(db, index_name, keys, &item);
+   bench_report("first lookup", 1, start);
+
+   if (rv != 0)
+   {
+      printf("No index '%s'\n", index_name);
+      free(keys);
+      return 1;
+   }
+   rmsgpack_dom_value_free(&item);
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < count; i++)
+   {
+      if (     libretrodb_find_entry(db, index_name,
+                  keys + i * key_size, &item) != 0)
+      {
+         errors++;
+         continue;
+      }
+      if (!bench_check_entry(&item, &field_key,
+               keys + i * key_size, key_size))
+         errors++;
+      rmsgpack_dom_value_free(&item);
+   }
+   bench_report("lookup", count, start);
+
+   /* The same lookups as queries, for comparison */
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < count && i < BENCH_QUERY_LOOKUPS; i++)
+   {
+      unsigned j;
+      char hex[256 * 2 + 1];
+      char query_exp[1024];
+      const char *error     = NULL;
+      libretrodb_query_t *q = NULL;
+
+      for (j = 0; j < key_size; j++)
+         snprintf(hex + j * 2, 3, "%02X", keys[i * key_size + j]);
+      snprintf(query_exp, sizeof(query_exp), "{'%s':b'%s'}",
+            field_name, hex);
+
+      q = (libretrodb_query_t*)libretrodb_query_compile(db,
+            query_exp, strlen(query_exp), &error);
+
+      if (error || libretrodb_cursor_open(db, cur, q) != 0)
+      {
+         errors++;
+         if (q)
+            libretrodb_query_free(q);
+         continue;
+      }
+
+      if (libretrodb_cursor_read_item(cur, &item) == 0)
+         rmsgpack_dom_value_free(&item);
+      else
+         errors++;
+
+      libretrodb_cursor_close(cur);
+      libretrodb_query_free(q);
+   }
+   bench_report("query lookup", i, start);
+
+   key_ptrs = (const void**)malloc(count * sizeof(*key_ptrs));
+   found    = (struct rmsgpack_dom_value*)malloc(count * sizeof(*found));
+
+   if (key_ptrs && found)
+   {
+      for (i = 0; i < count; i++)
+         key_ptrs[i] = keys + i * key_size;
+
+      start = cpu_features_get_time_usec();
+      if (libretrodb_find_entries(db, index_name,
+               key_ptrs, count, found) != (int)count)
+         errors++;
+      bench_report("batch lookup", count, start);
+
+      for (i = 0; i < count; i++)
+      {
+         if (!bench_check_entry(&found[i], &field_key,
+                  keys + i * key_size, key_size))
+            errors++;
+         rmsgpack_dom_value_free(&found[i]);
+      }
+   }
+
+   free(key_ptrs);
+   free(found);
+   free(keys);
+
+   if (errors)
+   {
+      printf("%u lookups went wrong\n", (unsigned)errors);
+      return 1;
+   }
+
+   return 0;
+}
+
+/* Times whole runs of the query @query_exp, which
+ * only use an index if the database has one for it */
+static int bench_query(libretrodb_t *db, libretrodb_cursor_t *cur,
+      const char *query_exp)
+{
+   unsigned i;
+   int rv;
+   retro_time_t start;
+   struct rmsgpack_dom_value item;
+   size_t matches        = 0;
+   const char *error     = NULL;
+   libretrodb_query_t *q = (libretrodb_query_t*)libretrodb_query_compile(
+         db, query_exp, strlen(query_exp), &error);
+
+   if (error)
+   {
+      printf("%s\n", error);
+      return 1;
+   }
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < BENCH_QUERY_RUNS; i++)
+   {
+      if ((rv = libretrodb_cursor_open(db, cur, q)) != 0)
+      {
+         printf("Could not open cursor: %s\n", strerror(-rv));
+         libretrodb_query_free(q);
+         return 1;
+      }
+
+      for (matches = 0; libretrodb_cursor_read_item(cur, &item) == 0;
+            matches++)
+         rmsgpack_dom_value_free(&item);
+
+      libretrodb_cursor_close(cur);
+   }
+   bench_report("query", BENCH_QUERY_RUNS, start);
+
+   libretrodb_query_free(q);
+   printf("%u matches\n", (unsigned)matches);
+   return 0;
+}
+
 int main(int argc, char ** argv)
 {
    int rv;
@@ -48,6 +299,8 @@ int main(int argc, char ** argv)
       printf("\tcreate-index <index name> <field name>\n");
       printf("\tfind <query expression>\n");
       printf("\tget-names <query expression>\n");
+      printf("\tbench-index <index name> <field name>\n");
+      printf("\tbench-query <query expression>\n");
       return 1;
    }
 
@@ -159,6 +412,34 @@ int main(int argc, char ** argv)
          rmsgpack_dom_value_free(&item);
       }
    }
+   else if (memcmp(command, "bench-index", 11) == 0)
+   {
+      if (argc != 5)
+      {
+         printf("Usage: %s <db file> bench-index <index name> <field name>\n", argv[0]);
+         goto error;
+      }
+
+      rv = bench_index(db, cur, argv[3], argv[4]);
+      libretrodb_close(db);
+      libretrodb_free(db);
+      libretrodb_cursor_free(cur);
+      return rv;
+   }
+   else if (memcmp(command, "bench-query", 11) == 0)
+   {
+      if (argc != 4)
+      {
+         printf("Usage: %s <db file> bench-query <query expression>\n", argv[0]);
+         goto error;
+      }
+
+      rv = bench_query(db, cur, argv[3]);
+      libretrodb_close(db);
+      libretrodb_free(db);
+      libretrodb_cursor_free(cur);
+      return rv;
+   }
    else if (memcmp(command, "create-index", 12) == 0)
    {
       const char * index_name, * field_name;
@@ -40,7 +40,6 @@
 #include "rmsgpack_dom.h"
 
 #define MAX_ERROR_LEN   256
-#define QUERY_MAX_ARGS  50
 
 struct buffer
 {
@@ -999,3 +998,100 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+int libretrodb_query_filter_raw(libretrodb_query_t *q,
+      const uint8_t *buff, size_t len)
+{
+   unsigned i;
+   struct invocation inv = ((struct query *)q)->root;
+
+   /* Only tables know which fields they look at */
+   if (inv.func != query_func_all_map || inv.argc % 2 != 0)
+      return -1;
+
+   for (i = 0; i < inv.argc; i += 2)
+   {
+      int found;
+      struct rmsgpack_dom_value value;
+      struct rmsgpack_dom_value res;
+      const struct argument *arg = &inv.argv[i];
+
+      if (     arg->type         != AT_VALUE
+            || arg->a.value.type != RDT_STRING)
+         return -1;
+
+      /* Only the fields looked at are read, the
+       * rest of the entry is left as it is */
+      if ((found = rmsgpack_dom_buf_map_value(buff, len,
+                  arg->a.value.val.string.buff, &value)) < 0)
+         return -1;
+      if (!found) /* All missing fields are nil */
+         value.type = RDT_NULL;
+
+      arg = &inv.argv[i + 1];
+      if (arg->type == AT_VALUE)
+         res = func_equals(value, 1, arg);
+      else
+         res = query_func_is_true(arg->a.invocation.func(
+                  value,
+                  arg->a.invocation.argc,
+                  arg->a.invocation.argv
+                  ), 0, NULL);
+
+      rmsgpack_dom_value_free(&value);
+
+      if (!res.val.bool_)
+         return 0;
+   }
+
+   return 1;
+}
+
+static bool query_value_is_key(const struct argument *arg)
+{
+   return arg->type == AT_VALUE
+      && (     arg->a.value.type == RDT_STRING
+            || arg->a.value.type == RDT_BINARY);
+}
+
+int libretrodb_query_field_values(libretrodb_query_t *q, unsigned n,
+      const char **field, const struct rmsgpack_dom_value **values)
+{
+   unsigned i;
+   const struct argument *arg;
+   struct invocation inv = ((struct query *)q)->root;
+
+   if (     inv.func != query_func_all_map
+         || inv.argc % 2 != 0
+         || n >= inv.argc / 2)
+      return -1;
+
+   arg    = &inv.argv[n * 2];
+   *field = NULL;
+
+   if (arg->type != AT_VALUE || arg->a.value.type != RDT_STRING)
+      return 0;
+
+   *field = arg->a.value.val.string.buff;
+   arg    = &inv.argv[n * 2 + 1];
+
+   if (query_value_is_key(arg))
+   {
+      values[0] = &arg->a.value;
+      return 1;
+   }
+
+   if (     arg->type != AT_FUNCTION
+         || arg->a.invocation.func != query_func_operator_or)
+      return 0;
+
+   /* or() only of values */
+   for (i = 0; i < arg->a.invocation.argc; i++)
+   {
+      if (!query_value_is_key(&arg->a.invocation.argv[i]))
+         return 0;
+      values[i] = &arg->a.invocation.argv[i].a.value;
+   }
+
+   return (int)arg->a.invocation.argc;
+}
@@ -30,6 +30,8 @@
 
 RETRO_BEGIN_DECLS
 
+#define QUERY_MAX_ARGS  50
+
 typedef struct libretrodb_query libretrodb_query_t;
 
 void libretrodb_query_inc_ref(libretrodb_query_t *q);
@@ -38,6 +40,37 @@ void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/**
+ * libretrodb_query_filter_raw:
+ * @q                   : Query.
+ * @buff                : Entry, undecoded.
+ * @len                 : Length of @buff.
+ *
+ * Filters an entry without decoding more of it than
+ * the fields @q looks at.
+ *
+ * Returns: 1 if it matches, 0 if not, and -1 if @q isn't
+ * a table and the entry must be decoded to be filtered.
+ **/
+int libretrodb_query_filter_raw(libretrodb_query_t *q,
+      const uint8_t *buff, size_t len);
+
+/**
+ * libretrodb_query_field_values:
+ * @q                   : Query.
+ * @n                   : Field of the table.
+ * @field               : Name of the field.
+ * @values              : Values, at least QUERY_MAX_ARGS of them.
+ *
+ * Gets the string or binary values field @n of table query
+ * @q must be equal to one of for an entry to match.
+ *
+ * Returns: number of values, 0 if any value would
+ * do, and -1 if @q isn't a table or has no field @n.
+ **/
+int libretrodb_query_field_values(libretrodb_query_t *q, unsigned n,
+      const char **field, const struct rmsgpack_dom_value **values);
+
 RETRO_END_DECLS
 
 #endif
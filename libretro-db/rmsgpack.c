@@ -271,8 +271,7 @@ int rmsgpack_write_bool(RFILE *fd, int value)
       if (filestream_write(fd, &MPF_TRUE, sizeof(MPF_TRUE)) == -1)
          goto error;
    }
-
-   if (filestream_write(fd, &MPF_FALSE, sizeof(MPF_FALSE)) == -1)
+   else if (filestream_write(fd, &MPF_FALSE, sizeof(MPF_FALSE)) == -1)
       goto error;
 
    return sizeof(uint8_t);
@@ -658,3 +657,306 @@ int rmsgpack_read(RFILE *fd,
 error:
    return -errno;
 }
+
+/* Kinds of values, as far as reading them from a buffer goes */
+enum rmsgpack_buf_kind
+{
+   RMSGPACK_BUF_NIL = 0,
+   RMSGPACK_BUF_BOOL,
+   RMSGPACK_BUF_UINT,
+   RMSGPACK_BUF_INT,
+   RMSGPACK_BUF_STRING,
+   RMSGPACK_BUF_BINARY,
+   RMSGPACK_BUF_MAP,
+   RMSGPACK_BUF_ARRAY
+};
+
+/* Gets the number of bytes following the type byte @type
+ * up to the contents of the value (items of maps and arrays,
+ * data of strings and binaries), or -1 for types that are
+ * never written */
+static int rmsgpack_header_size(uint8_t type)
+{
+   if (type < MPF_NIL || type > MPF_MAP32)
+      return 0;
+
+   switch (type)
+   {
+      case _MPF_NIL:
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         return 0;
+      case _MPF_BIN8:
+      case _MPF_STR8:
+         return 1;
+      case _MPF_BIN16:
+      case _MPF_STR16:
+      case _MPF_ARRAY16:
+      case _MPF_MAP16:
+         return 2;
+      case _MPF_BIN32:
+      case _MPF_STR32:
+      case _MPF_ARRAY32:
+      case _MPF_MAP32:
+         return 4;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         return 1 << (type - _MPF_UINT8);
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         return 1 << (type - _MPF_INT8);
+   }
+
+   return -1;
+}
+
+static uint64_t rmsgpack_buf_uint(const uint8_t *buff, int size)
+{
+   int i;
+   uint64_t value = 0;
+
+   for (i = 0; i < size; i++)
+      value = (value << 8) | buff[i];
+
+   return value;
+}
+
+/* Reads the value at *@pos up to its contents. @arg is
+ * the value of integers and booleans, the length of
+ * strings and binaries, and the number of items of arrays
+ * and maps (pairs for maps). */
+static int rmsgpack_buf_read_header(const uint8_t *buff, size_t len,
+      size_t *pos, enum rmsgpack_buf_kind *kind, uint64_t *arg)
+{
+   uint8_t type;
+   int size;
+
+   if (*pos >= len)
+      return -EINVAL;
+
+   type = buff[(*pos)++];
+
+   if ((size = rmsgpack_header_size(type)) < 0 || len - *pos < (size_t)size)
+      return -EINVAL;
+
+   *arg  = rmsgpack_buf_uint(buff + *pos, size);
+   *pos += size;
+   *kind = RMSGPACK_BUF_NIL;
+
+   if (type < MPF_FIXMAP)
+   {
+      /* Positive fixints are read as signed */
+      *kind = RMSGPACK_BUF_INT;
+      *arg  = type;
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      *kind = RMSGPACK_BUF_MAP;
+      *arg  = type - MPF_FIXMAP;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      *kind = RMSGPACK_BUF_ARRAY;
+      *arg  = type - MPF_FIXARRAY;
+   }
+   else if (type < MPF_NIL)
+   {
+      *kind = RMSGPACK_BUF_STRING;
+      *arg  = type - MPF_FIXSTR;
+   }
+   else if (type > MPF_MAP32)
+   {
+      *kind = RMSGPACK_BUF_INT;
+      *arg  = (uint64_t)(int64_t)(int8_t)type;
+   }
+   else
+   {
+      switch (type)
+      {
+         case _MPF_NIL:
+            *kind = RMSGPACK_BUF_NIL;
+            break;
+         case _MPF_FALSE:
+         case _MPF_TRUE:
+            *kind = RMSGPACK_BUF_BOOL;
+            *arg  = (type == _MPF_TRUE);
+            break;
+         case _MPF_BIN8:
+         case _MPF_BIN16:
+         case _MPF_BIN32:
+            *kind = RMSGPACK_BUF_BINARY;
+            break;
+         case _MPF_STR8:
+         case _MPF_STR16:
+         case _MPF_STR32:
+            *kind = RMSGPACK_BUF_STRING;
+            break;
+         case _MPF_UINT8:
+         case _MPF_UINT16:
+         case _MPF_UINT32:
+         case _MPF_UINT64:
+            *kind = RMSGPACK_BUF_UINT;
+            break;
+         case _MPF_INT8:
+         case _MPF_INT16:
+         case _MPF_INT32:
+         case _MPF_INT64:
+            *kind = RMSGPACK_BUF_INT;
+            /* Sign extend */
+            if (size < 8 && (*arg >> (size * 8 - 1)))
+               *arg |= ~UINT64_C(0) << (size * 8);
+            break;
+         case _MPF_ARRAY16:
+         case _MPF_ARRAY32:
+            *kind = RMSGPACK_BUF_ARRAY;
+            break;
+         case _MPF_MAP16:
+         case _MPF_MAP32:
+            *kind = RMSGPACK_BUF_MAP;
+            break;
+      }
+   }
+
+   if (     (*kind == RMSGPACK_BUF_STRING || *kind == RMSGPACK_BUF_BINARY)
+         && len - *pos < *arg)
+      return -EINVAL;
+
+   return 0;
+}
+
+int rmsgpack_buf_read(const uint8_t *buff, size_t len, size_t *pos,
+      struct rmsgpack_read_callbacks *callbacks, void *data)
+{
+   int rv;
+   uint64_t i;
+   uint64_t arg;
+   char *copy;
+   enum rmsgpack_buf_kind kind;
+
+   if ((rv = rmsgpack_buf_read_header(buff, len, pos, &kind, &arg)) < 0)
+      return rv;
+
+   switch (kind)
+   {
+      case RMSGPACK_BUF_NIL:
+         if (callbacks->read_nil)
+            return callbacks->read_nil(data);
+         break;
+      case RMSGPACK_BUF_BOOL:
+         if (callbacks->read_bool)
+            return callbacks->read_bool((int)arg, data);
+         break;
+      case RMSGPACK_BUF_UINT:
+         if (callbacks->read_uint)
+            return callbacks->read_uint(arg, data);
+         break;
+      case RMSGPACK_BUF_INT:
+         if (callbacks->read_int)
+            return callbacks->read_int((int64_t)arg, data);
+         break;
+      case RMSGPACK_BUF_STRING:
+      case RMSGPACK_BUF_BINARY:
+         /* Callbacks own what they are given */
+         if (!(copy = (char*)malloc((size_t)arg + 1)))
+            return -ENOMEM;
+         memcpy(copy, buff + *pos, (size_t)arg);
+         copy[arg] = '\0';
+         *pos     += (size_t)arg;
+
+         if (kind == RMSGPACK_BUF_STRING && callbacks->read_string)
+            return callbacks->read_string(copy, (uint32_t)arg, data);
+         if (kind == RMSGPACK_BUF_BINARY && callbacks->read_bin)
+            return callbacks->read_bin(copy, (uint32_t)arg, data);
+         free(copy);
+         break;
+      case RMSGPACK_BUF_MAP:
+         if (callbacks->read_map_start &&
+               (rv = callbacks->read_map_start((uint32_t)arg, data)) < 0)
+            return rv;
+         arg *= 2;
+         /* fall-through */
+      case RMSGPACK_BUF_ARRAY:
+         if (     kind == RMSGPACK_BUF_ARRAY
+               && callbacks->read_array_start
+               && (rv = callbacks->read_array_start((uint32_t)arg, data)) < 0)
+            return rv;
+         for (i = 0; i < arg; i++)
+            if ((rv = rmsgpack_buf_read(buff, len, pos, callbacks, data)) < 0)
+               return rv;
+         break;
+   }
+
+   return 0;
+}
+
+int rmsgpack_buf_skip(const uint8_t *buff, size_t len, size_t *pos)
+{
+   int rv;
+   uint64_t arg;
+   enum rmsgpack_buf_kind kind;
+   uint64_t pending = 1;
+
+   while (pending)
+   {
+      pending--;
+
+      if ((rv = rmsgpack_buf_read_header(buff, len, pos, &kind, &arg)) < 0)
+         return rv;
+
+      switch (kind)
+      {
+         case RMSGPACK_BUF_STRING:
+         case RMSGPACK_BUF_BINARY:
+            *pos += (size_t)arg;
+            break;
+         case RMSGPACK_BUF_MAP:
+            pending += arg * 2;
+            break;
+         case RMSGPACK_BUF_ARRAY:
+            pending += arg;
+            break;
+         default:
+            break;
+      }
+   }
+
+   return 0;
+}
+
+int rmsgpack_buf_read_map_header(const uint8_t *buff, size_t len,
+      size_t *pos, uint32_t *map_len)
+{
+   int rv;
+   uint64_t arg;
+   enum rmsgpack_buf_kind kind;
+
+   if ((rv = rmsgpack_buf_read_header(buff, len, pos, &kind, &arg)) < 0)
+      return rv;
+   if (kind != RMSGPACK_BUF_MAP)
+      return -EINVAL;
+
+   *map_len = (uint32_t)arg;
+   return 0;
+}
+
+int rmsgpack_buf_read_string(const uint8_t *buff, size_t len,
+      size_t *pos, const char **s, uint32_t *s_len)
+{
+   int rv;
+   uint64_t arg;
+   enum rmsgpack_buf_kind kind;
+
+   if ((rv = rmsgpack_buf_read_header(buff, len, pos, &kind, &arg)) < 0)
+      return rv;
+   if (kind != RMSGPACK_BUF_STRING)
+      return -EINVAL;
+
+   *s     = (const char*)buff + *pos;
+   *s_len = (uint32_t)arg;
+   *pos  += (size_t)arg;
+   return 0;
+}
@@ -57,4 +57,19 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+/* The same as rmsgpack_read(), from values in memory.
+ * @pos is where to start reading, and is moved past
+ * what was read. */
+int rmsgpack_buf_read(const uint8_t *buff, size_t len, size_t *pos,
+      struct rmsgpack_read_callbacks *callbacks, void *data);
+
+int rmsgpack_buf_skip(const uint8_t *buff, size_t len, size_t *pos);
+
+int rmsgpack_buf_read_map_header(const uint8_t *buff, size_t len,
+      size_t *pos, uint32_t *map_len);
+
+/* @s points into @buff, and isn't NUL-terminated */
+int rmsgpack_buf_read_string(const uint8_t *buff, size_t len,
+      size_t *pos, const char **s, uint32_t *s_len);
+
 #endif
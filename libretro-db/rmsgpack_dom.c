@@ -423,6 +423,58 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
    return rv;
 }
 
+int rmsgpack_dom_read_buf(const uint8_t *buff, size_t len, size_t *pos,
+      struct rmsgpack_dom_value *out)
+{
+   struct dom_reader_state s;
+   int rv     = 0;
+
+   s.i        = 0;
+   s.stack[0] = out;
+
+   rv         = rmsgpack_buf_read(buff, len, pos, &dom_reader_callbacks, &s);
+
+   if (rv < 0)
+      rmsgpack_dom_value_free(out);
+
+   return rv;
+}
+
+int rmsgpack_dom_buf_map_value(const uint8_t *buff, size_t len,
+      const char *key, struct rmsgpack_dom_value *out)
+{
+   uint32_t i;
+   uint32_t map_len;
+   size_t pos      = 0;
+   size_t key_len  = strlen(key);
+
+   if (rmsgpack_buf_read_map_header(buff, len, &pos, &map_len) < 0)
+      return -EINVAL;
+
+   for (i = 0; i < map_len; i++)
+   {
+      const char *s  = NULL;
+      uint32_t s_len = 0;
+      size_t key_pos = pos;
+
+      /* Keys that aren't strings never match */
+      if (rmsgpack_buf_read_string(buff, len, &pos, &s, &s_len) < 0)
+      {
+         pos = key_pos;
+         if (rmsgpack_buf_skip(buff, len, &pos) < 0)
+            return -EINVAL;
+      }
+      else if (s_len == key_len && !memcmp(s, key, key_len))
+         return (rmsgpack_dom_read_buf(buff, len, &pos, out) < 0)
+            ? -EINVAL : 1;
+
+      if (rmsgpack_buf_skip(buff, len, &pos) < 0)
+         return -EINVAL;
+   }
+
+   return 0;
+}
+
 int rmsgpack_dom_read_into(RFILE *fd, ...)
 {
    int rv;
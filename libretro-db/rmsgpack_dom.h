@@ -91,6 +91,15 @@ struct rmsgpack_dom_value *rmsgpack_dom_value_map_value(
 
 int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out);
 
+int rmsgpack_dom_read_buf(const uint8_t *buff, size_t len, size_t *pos,
+      struct rmsgpack_dom_value *out);
+
+/* Reads the value of the string @key of the map in @buff
+ * without reading the rest of the map. Returns 1 if found,
+ * 0 if not and negative if @buff isn't a map. */
+int rmsgpack_dom_buf_map_value(const uint8_t *buff, size_t len,
+      const char *key, struct rmsgpack_dom_value *out);
+
 int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
@@ -1114,25 +1114,35 @@ static bool manual_content_scan_get_playlist_content_label(
 }
 
 /* Adds specified content to playlist, if not already
- * present */
-void manual_content_scan_add_content_to_playlist(
+ * present
+ * > If playlist_content_path is not NULL, the path
+ *   of the playlist entry is copied to it
+ * > Returns false if content is not in the playlist */
+bool manual_content_scan_add_content_to_playlist(
       manual_content_scan_task_config_t *task_config,
       playlist_t *playlist, const char *content_path,
-      int content_type, logiqx_dat_t *dat_file)
+      int content_type, logiqx_dat_t *dat_file,
+      char *playlist_content_path, size_t len)
 {
-   char playlist_content_path[PATH_MAX_LENGTH];
+   char content_path_buf[PATH_MAX_LENGTH];
+
+   content_path_buf[0] = '\0';
 
-   playlist_content_path[0] = '\0';
+   if (!playlist_content_path)
+   {
+      playlist_content_path = content_path_buf;
+      len                   = sizeof(content_path_buf);
+   }
 
    /* Sanity check */
    if (!task_config || !playlist)
-      return;
+      return false;
 
    /* Get 'actual' content path */
    if (!manual_content_scan_get_playlist_content_path(
          task_config, content_path, content_type,
-         playlist_content_path, sizeof(playlist_content_path)))
-      return;
+         playlist_content_path, len))
+      return false;
 
    /* Check whether content is already included
     * in playlist */
@@ -1148,7 +1158,7 @@ void manual_content_scan_add_content_to_playlist(
             playlist_content_path, dat_file,
             task_config->filter_dat_content,
             label, sizeof(label)))
-         return;
+         return false;
 
       /* Configure playlist entry
        * > The push function reads our entry as const,
@@ -1161,6 +1171,8 @@ void manual_content_scan_add_content_to_playlist(
       entry.db_name   = task_config->database_name;
 
       /* Add entry to playlist */
-      playlist_push(playlist, &entry);
+      return playlist_push(playlist, &entry);
    }
+
+   return true;
 }
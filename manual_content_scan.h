@@ -242,11 +242,15 @@ bool manual_content_scan_get_task_config(
 struct string_list *manual_content_scan_get_content_list(manual_content_scan_task_config_t *task_config);
 
 /* Adds specified content to playlist, if not already
- * present */
-void manual_content_scan_add_content_to_playlist(
+ * present
+ * > If playlist_content_path is not NULL, the path
+ *   of the playlist entry is copied to it
+ * > Returns false if content is not in the playlist */
+bool manual_content_scan_add_content_to_playlist(
       manual_content_scan_task_config_t *task_config,
       playlist_t *playlist, const char *content_path,
-      int content_type, logiqx_dat_t *dat_file);
+      int content_type, logiqx_dat_t *dat_file,
+      char *playlist_content_path, size_t len);
 
 RETRO_END_DECLS
 
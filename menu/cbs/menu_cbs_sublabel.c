@@ -509,6 +509,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_cheat_file_save_as,            MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_granularity,            MENU_ENUM_SUBLABEL_REWIND_GRANULARITY)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size,            MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_buffer_size_step,       MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_cold_buffer_size,       MENU_ENUM_SUBLABEL_REWIND_COLD_BUFFER_SIZE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_cold_buffer_to_disk,    MENU_ENUM_SUBLABEL_REWIND_COLD_BUFFER_TO_DISK)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_rewind_dirty_pages,            MENU_ENUM_SUBLABEL_REWIND_DIRTY_PAGES)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_libretro_log_level,            MENU_ENUM_SUBLABEL_LIBRETRO_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_frontend_log_level,            MENU_ENUM_SUBLABEL_FRONTEND_LOG_LEVEL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_perfcnt_enable,                MENU_ENUM_SUBLABEL_PERFCNT_ENABLE)
@@ -693,6 +696,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_thumbnails_directory,
 DEFAULT_SUBLABEL_MACRO(action_bind_rgui_config_directory,                          MENU_ENUM_SUBLABEL_RGUI_CONFIG_DIRECTORY)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_latency_frames,                  MENU_ENUM_SUBLABEL_NETPLAY_INPUT_LATENCY_FRAMES_MIN)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_latency_frames_range,            MENU_ENUM_SUBLABEL_NETPLAY_INPUT_LATENCY_FRAMES_RANGE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_netplay_replay_budget,                 MENU_ENUM_SUBLABEL_NETPLAY_REPLAY_BUDGET)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_disk_tray_eject,                       MENU_ENUM_SUBLABEL_DISK_TRAY_EJECT)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_disk_tray_insert,                      MENU_ENUM_SUBLABEL_DISK_TRAY_INSERT)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_disk_index,                            MENU_ENUM_SUBLABEL_DISK_INDEX)
@@ -935,6 +939,8 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_rgui_thumbnail_delay,
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_content_runtime_log,                           MENU_ENUM_SUBLABEL_CONTENT_RUNTIME_LOG)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_content_runtime_log_aggregate,                 MENU_ENUM_SUBLABEL_CONTENT_RUNTIME_LOG_AGGREGATE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_scan_without_core_match,                 MENU_ENUM_SUBLABEL_SCAN_WITHOUT_CORE_MATCH)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_scan_threads,                            MENU_ENUM_SUBLABEL_SCAN_THREADS)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_scan_cache_enable,                       MENU_ENUM_SUBLABEL_SCAN_CACHE_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_playlist_sublabel_runtime_type,                MENU_ENUM_SUBLABEL_PLAYLIST_SUBLABEL_RUNTIME_TYPE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_playlist_sublabel_last_played_style,           MENU_ENUM_SUBLABEL_PLAYLIST_SUBLABEL_LAST_PLAYED_STYLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_rgui_internal_upscale_level,              MENU_ENUM_SUBLABEL_MENU_RGUI_INTERNAL_UPSCALE_LEVEL)
@@ -2508,6 +2514,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_RANGE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_latency_frames_range);
             break;
+         case MENU_ENUM_LABEL_NETPLAY_REPLAY_BUDGET:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_netplay_replay_budget);
+            break;
          case MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_MIN:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_latency_frames);
             break;
@@ -3047,6 +3056,15 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_buffer_size_step);
             break;
+         case MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_cold_buffer_size);
+            break;
+         case MENU_ENUM_LABEL_REWIND_COLD_BUFFER_TO_DISK:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_cold_buffer_to_disk);
+            break;
+         case MENU_ENUM_LABEL_REWIND_DIRTY_PAGES:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_rewind_dirty_pages);
+            break;
          case MENU_ENUM_LABEL_CHEAT_IDX:
 #ifdef HAVE_CHEATS
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_cheat_idx);
@@ -4139,6 +4157,12 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_scan_without_core_match);
             break;
+         case MENU_ENUM_LABEL_SCAN_THREADS:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_scan_threads);
+            break;
+         case MENU_ENUM_LABEL_SCAN_CACHE_ENABLE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_scan_cache_enable);
+            break;
          case MENU_ENUM_LABEL_CONTENT_RUNTIME_LOG_AGGREGATE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_content_runtime_log_aggregate);
             break;
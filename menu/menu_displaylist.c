@@ -5377,6 +5377,8 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PLAYLIST_SUBLABEL_LAST_PLAYED_STYLE, PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_PLAYLIST_FUZZY_ARCHIVE_MATCH,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,             PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_SCAN_THREADS,                        PARSE_ONLY_UINT, true},
+               {MENU_ENUM_LABEL_SCAN_CACHE_ENABLE,                   PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_OZONE_TRUNCATE_PLAYLIST_NAME,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_OZONE_SORT_AFTER_TRUNCATE_PLAYLIST_NAME, PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_CONTENT_RUNTIME_LOG,                 PARSE_ONLY_BOOL, true},
@@ -7049,6 +7051,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_NETPLAY_CHECK_FRAMES,                                  PARSE_ONLY_INT,    true},
                {MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_MIN,                      PARSE_ONLY_INT,    true},
                {MENU_ENUM_LABEL_NETPLAY_INPUT_LATENCY_FRAMES_RANGE,                    PARSE_ONLY_INT,    true},
+               {MENU_ENUM_LABEL_NETPLAY_REPLAY_BUDGET,                                 PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_NETPLAY_NAT_TRAVERSAL,                                 PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_NETPLAY_SHARE_DIGITAL,                                 PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_NETPLAY_SHARE_ANALOG,                                  PARSE_ONLY_UINT,   true},
@@ -8976,6 +8979,9 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_REWIND_GRANULARITY,      PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,      PARSE_ONLY_SIZE, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP, PARSE_ONLY_UINT, false},
+               {MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE, PARSE_ONLY_SIZE, false},
+               {MENU_ENUM_LABEL_REWIND_COLD_BUFFER_TO_DISK, PARSE_ONLY_BOOL, false},
+               {MENU_ENUM_LABEL_REWIND_DIRTY_PAGES,      PARSE_ONLY_BOOL, false},
             };
 
             for (i = 0; i < ARRAY_SIZE(build_list); i++)
@@ -8985,6 +8991,9 @@ unsigned menu_displaylist_build_list(
                   case MENU_ENUM_LABEL_REWIND_GRANULARITY:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
+                  case MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE:
+                  case MENU_ENUM_LABEL_REWIND_COLD_BUFFER_TO_DISK:
+                  case MENU_ENUM_LABEL_REWIND_DIRTY_PAGES:
                      if (rewind_enable)
                         build_list[i].checked = true;
                      break;
@@ -7674,8 +7674,11 @@ static void general_write_handler(rarch_setting_t *setting)
       case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
          {
             rarch_setting_t *buffer_size_setting = menu_setting_find_enum(MENU_ENUM_LABEL_REWIND_BUFFER_SIZE);
+            rarch_setting_t *cold_size_setting   = menu_setting_find_enum(MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE);
             if (buffer_size_setting)
                buffer_size_setting->step = (*setting->value.target.unsigned_integer)*1024*1024;
+            if (cold_size_setting)
+               cold_size_setting->step   = (*setting->value.target.unsigned_integer)*1024*1024;
          }
          break;
       case MENU_ENUM_LABEL_CHEAT_MEMORY_SEARCH_SIZE:
@@ -9936,6 +9939,37 @@ static bool setting_append_list(
                   general_read_handler,
                   SD_FLAG_NONE);
 
+#ifdef HAVE_THREADS
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.scan_threads,
+                  MENU_ENUM_LABEL_SCAN_THREADS,
+                  MENU_ENUM_LABEL_VALUE_SCAN_THREADS,
+                  DEFAULT_SCAN_THREADS,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 16, 1, true, true);
+#endif
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.scan_cache_enable,
+                  MENU_ENUM_LABEL_SCAN_CACHE_ENABLE,
+                  MENU_ENUM_LABEL_VALUE_SCAN_CACHE_ENABLE,
+                  DEFAULT_SCAN_CACHE_ENABLE,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          }
@@ -10066,6 +10100,50 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+            CONFIG_SIZE(
+                  list, list_info,
+                  &settings->sizes.rewind_cold_buffer_size,
+                  MENU_ENUM_LABEL_REWIND_COLD_BUFFER_SIZE,
+                  MENU_ENUM_LABEL_VALUE_REWIND_COLD_BUFFER_SIZE,
+                  DEFAULT_REWIND_COLD_BUFFER_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  &setting_get_string_representation_size_in_mb);
+            menu_settings_list_current_add_range(list, list_info, 0, 1024*1024*1024, settings->uints.rewind_buffer_size_step*1024*1024, true, true);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_cold_buffer_to_disk,
+                  MENU_ENUM_LABEL_REWIND_COLD_BUFFER_TO_DISK,
+                  MENU_ENUM_LABEL_VALUE_REWIND_COLD_BUFFER_TO_DISK,
+                  DEFAULT_REWIND_COLD_BUFFER_TO_DISK,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_dirty_pages,
+                  MENU_ENUM_LABEL_REWIND_DIRTY_PAGES,
+                  MENU_ENUM_LABEL_VALUE_REWIND_DIRTY_PAGES,
+                  DEFAULT_REWIND_DIRTY_PAGES,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -18432,6 +18510,22 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
             menu_settings_list_current_add_range(list, list_info, 0, 15, 1, true, true);
 
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.netplay_replay_budget,
+                  MENU_ENUM_LABEL_NETPLAY_REPLAY_BUDGET,
+                  MENU_ENUM_LABEL_VALUE_NETPLAY_REPLAY_BUDGET,
+                  DEFAULT_NETPLAY_REPLAY_BUDGET,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].ui_type   = ST_UI_TYPE_UINT_SPINBOX;
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 100, 1, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.netplay_nat_traversal,
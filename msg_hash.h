@@ -496,6 +496,8 @@ enum msg_hash_enums
    MENU_LABEL(MENU_XMB_ANIMATION_MOVE_UP_DOWN),
    MENU_LABEL(MENU_XMB_ANIMATION_OPENING_MAIN_MENU),
    MENU_LABEL(SCAN_WITHOUT_CORE_MATCH),
+   MENU_LABEL(SCAN_THREADS),
+   MENU_LABEL(SCAN_CACHE_ENABLE),
    MENU_LABEL(STREAMING_TITLE),
    MENU_LABEL(STREAMING_MODE),
    MENU_LABEL(VIDEO_RECORD_QUALITY),
@@ -1756,6 +1758,9 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_COLD_BUFFER_SIZE),
+   MENU_LABEL(REWIND_COLD_BUFFER_TO_DISK),
+   MENU_LABEL(REWIND_DIRTY_PAGES),
    /* TODO/FIXME: INPUT_META_REWIND is incorrectly defined;
     * the LABEL/SUBLABEL enums should be entered 'manually',
     * like all the other hotkeys. Moreover, the resultant
@@ -1857,6 +1862,7 @@ enum msg_hash_enums
    MENU_LABEL(NETPLAY_CHECK_FRAMES),
    MENU_LABEL(NETPLAY_INPUT_LATENCY_FRAMES_MIN),
    MENU_LABEL(NETPLAY_INPUT_LATENCY_FRAMES_RANGE),
+   MENU_LABEL(NETPLAY_REPLAY_BUDGET),
    MENU_LABEL(NETPLAY_SPECTATOR_MODE_ENABLE),
    MENU_LABEL(NETPLAY_TCP_UDP_PORT),
    MENU_LABEL(NETPLAY_NAT_TRAVERSAL),
@@ -62,7 +62,41 @@ enum rarch_netplay_ctl_state
    RARCH_NETPLAY_CTL_DISCONNECT,
    RARCH_NETPLAY_CTL_FINISHED_NAT_TRAVERSAL,
    RARCH_NETPLAY_CTL_DESYNC_PUSH,
-   RARCH_NETPLAY_CTL_DESYNC_POP
+   RARCH_NETPLAY_CTL_DESYNC_POP,
+   RARCH_NETPLAY_CTL_GET_STATS
+};
+
+/* Timing of a netplay session, as filled by RARCH_NETPLAY_CTL_GET_STATS.
+ * The times are in microseconds. Those of the link are of the slowest
+ * peer. */
+struct netplay_stats
+{
+   /* Frames of input latency in use */
+   unsigned input_latency_frames;
+
+   /* How long after ours the peer's input arrives, and its jitter */
+   retro_time_t lag;
+   retro_time_t jitter;
+
+   /* Round-trip time to the peer and its jitter, 0 if unknown */
+   retro_time_t rtt;
+   retro_time_t rtt_var;
+
+   /* Frames the last replay went back, and the most any replay did */
+   unsigned replay_depth;
+   unsigned replay_depth_max;
+
+   /* Frames replayed over the last second */
+   unsigned replay_frames_per_second;
+
+   /* Frames a replay spread over several frames still has to go */
+   unsigned replay_behind;
+
+   /* Average time to serialize and run a replayed frame, and to load
+    * the state a replay starts from */
+   retro_time_t replay_serialize_time;
+   retro_time_t replay_run_time;
+   retro_time_t replay_unserialize_time;
 };
 
 /* Preferences for sharing digital devices */
@@ -391,6 +391,10 @@ bool netplay_handshake_init(netplay_t *netplay,
       connection->compression_supported = 0;
    }
 
+   /* Deltas are made of native endian words */
+   connection->savestate_delta = (compression & NETPLAY_COMPRESSION_DELTA) &&
+      !netplay_endian_mismatch(local_pmagic, remote_pmagic);
+
    if (!ctrans->decompression_backend)
       ctrans->decompression_backend = ctrans->compression_backend->reverse;
 
@@ -36,12 +36,17 @@
 #include "../../autosave.h"
 #include "../../configuration.h"
 #include "../../driver.h"
+#include "../../performance_counters.h"
 #include "../../retroarch.h"
 #include "../../command.h"
 #include "../../tasks/tasks_internal.h"
 
 #include "../../input/input_driver.h"
 
+#ifdef HAVE_REWIND
+#include "../../state_manager.h"
+#endif
+
 #if defined(AF_INET6) && !defined(HAVE_SOCKET_LEGACY) && !defined(_3DS)
 #define HAVE_INET6 1
 #endif
@@ -127,9 +132,10 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
          return false;
    }
 
-   delta->used  = true;
-   delta->frame = frame;
-   delta->crc   = 0;
+   delta->used       = true;
+   delta->frame      = frame;
+   delta->crc        = 0;
+   delta->input_time = 0;
 
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
@@ -1413,6 +1419,62 @@ process:
    return (netplay->stall != NETPLAY_STALL_NO_CONNECTION);
 }
 
+static struct retro_perf_counter netplay_replay_serialize;
+static struct retro_perf_counter netplay_replay_unserialize;
+static struct retro_perf_counter netplay_replay_run;
+
+static bool netplay_perfcnt_enabled(void)
+{
+   bool is_paused, is_idle, is_slowmotion, is_perfcnt_enable;
+   runloop_get_status(&is_paused, &is_idle, &is_slowmotion,
+         &is_perfcnt_enable);
+   return is_perfcnt_enable;
+}
+
+/**
+ * netplay_replay_account
+ * @netplay              : pointer to netplay object
+ * @frames               : frames just replayed
+ *
+ * Counts a replay into the replay statistics, which are worked out again
+ * about once a second. The depth of replays is shown with the netplay
+ * statistics; only timings go to the performance counters.
+ */
+static void netplay_replay_account(netplay_t *netplay, uint32_t frames)
+{
+   retro_time_t now     = cpu_features_get_time_usec();
+   retro_time_t elapsed = now - netplay->replay_window_start;
+
+   netplay->replay_depth = frames;
+   if (frames > netplay->replay_depth_max)
+      netplay->replay_depth_max = frames;
+
+   netplay->replay_window_frames += frames;
+   netplay->replay_window_replays++;
+
+   if (elapsed < 1000000)
+      return;
+
+   netplay->replay_frames_per_second = (uint32_t)(
+         (uint64_t)netplay->replay_window_frames * 1000000 / elapsed);
+   if (netplay->replay_window_frames)
+   {
+      netplay->replay_serialize_time = netplay->replay_window_serialize
+         / netplay->replay_window_frames;
+      netplay->replay_run_time       = netplay->replay_window_run
+         / netplay->replay_window_frames;
+   }
+   netplay->replay_unserialize_time  = netplay->replay_window_unserialize
+      / netplay->replay_window_replays;
+
+   netplay->replay_window_start       = now;
+   netplay->replay_window_serialize   = 0;
+   netplay->replay_window_unserialize = 0;
+   netplay->replay_window_run         = 0;
+   netplay->replay_window_frames      = 0;
+   netplay->replay_window_replays     = 0;
+}
+
 /**
  * netplay_sync_post_frame
  * @netplay              : pointer to netplay object
@@ -1468,6 +1530,15 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
    netplay->replay_ptr = netplay->other_ptr;
    netplay->replay_frame_count = netplay->other_frame_count;
 
+   /* A replay spread over several frames goes on where it stopped, as the
+    * states after that are still those we predicted */
+   if (netplay->replay_pending)
+   {
+      if (netplay->other_frame_count < netplay->run_frame_count)
+         netplay->force_rewind = true;
+      netplay->replay_pending  = false;
+   }
+
 #ifndef DEBUG_NONDETERMINISTIC_CORES
    if (!netplay->force_rewind)
    {
@@ -1512,6 +1583,33 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      retro_time_t replay_start = cpu_features_get_time_usec();
+      retro_time_t tm;
+      uint32_t replay_from      = netplay->replay_frame_count;
+      bool spread               = false;
+      bool perfcnt              = netplay_perfcnt_enabled();
+
+      if (perfcnt)
+      {
+         performance_counter_init(netplay_replay_serialize,
+               "netplay_replay_serialize");
+         performance_counter_init(netplay_replay_unserialize,
+               "netplay_replay_unserialize");
+         performance_counter_init(netplay_replay_run,
+               "netplay_replay_run");
+      }
+
+      /* If replaying all of it would take longer than we may spend on it,
+       * put the frame we're running aside and only replay part of it now */
+      if (netplay->replay_budget && netplay->replay_present_state &&
+          (netplay->run_frame_count - netplay->replay_frame_count) *
+          netplay->frame_run_time_avg > netplay->replay_budget)
+      {
+         serial_info.data       = netplay->replay_present_state;
+         serial_info.data_const = NULL;
+         serial_info.size       = netplay->state_size;
+         spread                 = core_serialize(&serial_info);
+      }
 
       /* Replay frames. */
       netplay->is_replay = true;
@@ -1542,14 +1640,18 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
       serial_info.data_const = netplay->buffer[netplay->replay_ptr].state;
       serial_info.size       = netplay->state_size;
 
+      tm = cpu_features_get_time_usec();
+      performance_counter_start_plus(perfcnt, netplay_replay_unserialize);
       if (!core_unserialize(&serial_info))
       {
          RARCH_ERR("Netplay savestate loading failed: Prepare for desync!\n");
       }
+      performance_counter_stop_plus(perfcnt, netplay_replay_unserialize);
+      netplay->replay_window_unserialize += cpu_features_get_time_usec() - tm;
 
       while (netplay->replay_frame_count < netplay->run_frame_count)
       {
-         retro_time_t start, tm;
+         retro_time_t start, serialized;
          struct delta_frame *ptr = &netplay->buffer[netplay->replay_ptr];
 
          serial_info.data        = ptr->state;
@@ -1558,15 +1660,27 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 
          start                   = cpu_features_get_time_usec();
 
+         /* Out of budget; go on from here next frame. Always replay two
+          * frames, so that we gain on the frame we're running. */
+         if (spread &&
+             netplay->replay_frame_count - replay_from >= 2 &&
+             start - replay_start >= netplay->replay_budget)
+            break;
+
          /* Remember the current state */
          memset(serial_info.data, 0, serial_info.size);
+         performance_counter_start_plus(perfcnt, netplay_replay_serialize);
          core_serialize(&serial_info);
+         performance_counter_stop_plus(perfcnt, netplay_replay_serialize);
+         serialized              = cpu_features_get_time_usec();
+         netplay->replay_window_serialize += serialized - start;
          if (netplay->replay_frame_count < netplay->unread_frame_count)
             netplay_handle_frame_hash(netplay, ptr);
 
          /* Re-simulate this frame's input */
          netplay_resolve_input(netplay, netplay->replay_ptr, true);
 
+         performance_counter_start_plus(perfcnt, netplay_replay_run);
 #ifdef HAVE_THREADS
          autosave_lock();
 #endif
@@ -1574,6 +1688,7 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 #ifdef HAVE_THREADS
          autosave_unlock();
 #endif
+         performance_counter_stop_plus(perfcnt, netplay_replay_run);
          netplay->replay_ptr = NEXT_PTR(netplay->replay_ptr);
          netplay->replay_frame_count++;
 
@@ -1594,7 +1709,9 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 #endif
 
          /* Get our time window */
-         tm = cpu_features_get_time_usec() - start;
+         tm = cpu_features_get_time_usec();
+         netplay->replay_window_run += tm - serialized;
+         tm -= start;
          netplay->frame_run_time_sum -= netplay->frame_run_time[netplay->frame_run_time_ptr];
          netplay->frame_run_time[netplay->frame_run_time_ptr] = tm;
          netplay->frame_run_time_sum += tm;
@@ -1606,15 +1723,51 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
       /* Average our time */
       netplay->frame_run_time_avg   = netplay->frame_run_time_sum / NETPLAY_FRAME_RUN_TIME_WINDOW;
 
-      if (netplay->unread_frame_count < netplay->run_frame_count)
+      netplay_replay_account(netplay,
+            netplay->replay_frame_count - replay_from);
+
+      if (netplay->replay_frame_count < netplay->run_frame_count)
       {
-         netplay->other_ptr         = netplay->unread_ptr;
-         netplay->other_frame_count = netplay->unread_frame_count;
+         /* Keep what we have replayed so far, and go back to the frame
+          * we're running */
+         serial_info.data           = netplay->buffer[netplay->replay_ptr].state;
+         serial_info.data_const     = NULL;
+         serial_info.size           = netplay->state_size;
+         memset(serial_info.data, 0, serial_info.size);
+         core_serialize(&serial_info);
+
+         serial_info.data           = NULL;
+         serial_info.data_const     = netplay->replay_present_state;
+         if (!core_unserialize(&serial_info))
+         {
+            RARCH_ERR("Netplay savestate loading failed: Prepare for desync!\n");
+         }
+
+         if (netplay->unread_frame_count < netplay->replay_frame_count)
+         {
+            netplay->other_ptr         = netplay->unread_ptr;
+            netplay->other_frame_count = netplay->unread_frame_count;
+         }
+         else
+         {
+            netplay->other_ptr         = netplay->replay_ptr;
+            netplay->other_frame_count = netplay->replay_frame_count;
+         }
+         netplay->replay_pending       = true;
       }
       else
       {
-         netplay->other_ptr         = netplay->run_ptr;
-         netplay->other_frame_count = netplay->run_frame_count;
+         if (netplay->unread_frame_count < netplay->run_frame_count)
+         {
+            netplay->other_ptr         = netplay->unread_ptr;
+            netplay->other_frame_count = netplay->unread_frame_count;
+         }
+         else
+         {
+            netplay->other_ptr         = netplay->run_ptr;
+            netplay->other_frame_count = netplay->run_frame_count;
+         }
+         netplay->replay_pending       = false;
       }
       netplay->is_replay            = false;
       netplay->force_rewind         = false;
@@ -1828,6 +1981,7 @@ void netplay_hangup(netplay_t *netplay,
    connection->active = false;
    netplay_deinit_socket_buffer(&connection->send_packet_buffer);
    netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
+   netplay_delta_base_free(connection);
 
    if (!netplay->is_server)
    {
@@ -2585,6 +2739,57 @@ static void handle_play_spectate(netplay_t *netplay, uint32_t client_num,
    }
 }
 
+/**
+ * netplay_load_savestate_delta
+ *
+ * Decompress a savestate delta and apply it to the last savestate exchanged
+ * over the connection, which becomes the base of the next delta. The result
+ * is copied to @state.
+ *
+ * Returns false if the delta was not made against our copy of the savestate,
+ * or does not yield the savestate the peer has. Our copy is lost in that case.
+ */
+static bool netplay_load_savestate_delta(netplay_t *netplay,
+   struct netplay_connection *connection,
+   struct compression_transcoder *ctrans, const uint32_t *digests,
+   void *state)
+{
+#ifdef HAVE_REWIND
+   uint32_t rd, wn;
+   uint64_t base_digest  = ((uint64_t)ntohl(digests[0]) << 32)
+      | ntohl(digests[1]);
+   uint64_t state_digest = ((uint64_t)ntohl(digests[2]) << 32)
+      | ntohl(digests[3]);
+
+   if (!connection->delta_base_valid || !netplay->delta_buffer ||
+       state_manager_delta_digest(connection->delta_base,
+          netplay->state_size) != base_digest)
+      return false;
+
+   ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+      netplay->delta_buffer, (uint32_t)netplay->delta_buffer_size);
+   if (!ctrans->decompression_backend->trans(ctrans->decompression_stream,
+         true, &rd, &wn, NULL))
+      return false;
+
+   if (!state_manager_delta_apply(netplay->delta_buffer, wn,
+         connection->delta_base, netplay->state_size))
+      return false;
+
+   if (state_manager_delta_digest(connection->delta_base,
+         netplay->state_size) != state_digest)
+      return false;
+
+   state_manager_delta_hash(connection->delta_base, netplay->state_size,
+      connection->delta_hashes);
+
+   memcpy(state, connection->delta_base, netplay->state_size);
+   return true;
+#else
+   return false;
+#endif
+}
+
 #undef RECV
 #define RECV(buf, sz) \
 recvd = netplay_recv(&connection->recv_packet_buffer, connection->fd, (buf), \
@@ -2738,6 +2943,13 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
             dframe->have_real[client_num] = true;
 
+            /* Time it against our own input for the frame, if any */
+            if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING)
+               netplay_latency_sample(&connection->latency,
+                     dframe->input_time
+                     ? cpu_features_get_time_usec() - dframe->input_time
+                     : 0);
+
             /* Slaves may go through several packets of data in the same frame
              * if latency is choppy, so we advance and send their data after
              * handling all network data this frame */
@@ -3239,6 +3451,10 @@ static bool netplay_get_cmd(netplay_t *netplay,
             break;
          }
 
+      case NETPLAY_CMD_REQUEST_FULL_SAVESTATE:
+         /* Our deltas no longer apply on their side */
+         connection->delta_base_valid  = false;
+         /* fallthrough */
       case NETPLAY_CMD_REQUEST_SAVESTATE:
          /* Delay until next frame so we don't send the savestate after the
           * input */
@@ -3246,6 +3462,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          {
             uint32_t frame;
@@ -3253,7 +3470,9 @@ static bool netplay_get_cmd(netplay_t *netplay,
             uint32_t rd, wn;
             uint32_t client;
             uint32_t load_frame_count;
+            uint32_t digests[4];
             size_t load_ptr;
+            size_t header_size = 2*sizeof(uint32_t);
             struct compression_transcoder *ctrans = NULL;
             uint32_t                   client_num = (uint32_t)
              (connection - netplay->connections + 1);
@@ -3300,9 +3519,14 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * gets loaded. This is just to avoid having reloading implemented in
              * too many places. */
 
+            /* Deltas carry digests of the state they apply to
+             * and of the result */
+            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               header_size += sizeof(digests);
+
             /* Check the payload size */
-            if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
-                 (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
+            if ((cmd != NETPLAY_CMD_RESET &&
+                 (cmd_size < header_size || cmd_size > netplay->zbuffer_size + header_size)) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
                RARCH_ERR("CMD_LOAD_SAVESTATE received an unexpected payload size.\n");
@@ -3340,7 +3564,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
 
             /* Now we switch based on whether we're loading a state or resetting */
-            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE)
+            if (cmd != NETPLAY_CMD_RESET)
             {
                RECV(&isize, sizeof(isize))
                {
@@ -3355,7 +3579,16 @@ static bool netplay_get_cmd(netplay_t *netplay,
                   return netplay_cmd_nak(netplay, connection);
                }
 
-               RECV(netplay->zbuffer, cmd_size - 2*sizeof(uint32_t))
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  RECV(digests, sizeof(digests))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive savestate digests.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+               }
+
+               RECV(netplay->zbuffer, cmd_size - header_size)
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive savestate.\n");
                   return netplay_cmd_nak(netplay, connection);
@@ -3371,12 +3604,33 @@ static bool netplay_get_cmd(netplay_t *netplay,
                      ctrans = &netplay->compress_nil;
                }
                ctrans->decompression_backend->set_in(ctrans->decompression_stream,
-                  netplay->zbuffer, cmd_size - 2*sizeof(uint32_t));
-               ctrans->decompression_backend->set_out(ctrans->decompression_stream,
-                  (uint8_t*)netplay->buffer[load_ptr].state,
-                  (unsigned)netplay->state_size);
-               ctrans->decompression_backend->trans(ctrans->decompression_stream,
-                  true, &rd, &wn, NULL);
+                  netplay->zbuffer, cmd_size - header_size);
+
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  if (!netplay_load_savestate_delta(netplay, connection,
+                           ctrans, digests,
+                           netplay->buffer[load_ptr].state))
+                  {
+                     /* Our copy of the base went astray, so start over */
+                     RARCH_WARN("[netplay] Savestate delta does not apply, requesting the full savestate.\n");
+                     connection->delta_base_valid = false;
+                     netplay_send_raw_cmd(netplay, connection,
+                           NETPLAY_CMD_REQUEST_FULL_SAVESTATE, NULL, 0);
+                     break;
+                  }
+               }
+               else
+               {
+                  ctrans->decompression_backend->set_out(ctrans->decompression_stream,
+                     (uint8_t*)netplay->buffer[load_ptr].state,
+                     (unsigned)netplay->state_size);
+                  ctrans->decompression_backend->trans(ctrans->decompression_stream,
+                     true, &rd, &wn, NULL);
+
+                  netplay_delta_base_set(netplay, connection,
+                        netplay->buffer[load_ptr].state, NULL);
+               }
 
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
@@ -3992,7 +4246,8 @@ static bool netplay_init_serialization(netplay_t *netplay)
 
    for (i = 0; i < netplay->buffer_size; i++)
    {
-      netplay->buffer[i].state = calloc(netplay->state_size, 1);
+      /* Padded to whole words, which savestate deltas work in */
+      netplay->buffer[i].state = calloc(netplay->state_size + 1, 1);
 
       if (!netplay->buffer[i].state)
       {
@@ -4001,6 +4256,9 @@ static bool netplay_init_serialization(netplay_t *netplay)
       }
    }
 
+   /* Without it, replays are never spread over several frames */
+   netplay->replay_present_state = malloc(netplay->state_size);
+
    netplay->zbuffer_size = netplay->state_size * 2;
    netplay->zbuffer = (uint8_t *) calloc(netplay->zbuffer_size, 1);
    if (!netplay->zbuffer)
@@ -4010,9 +4268,74 @@ static bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+#ifdef HAVE_REWIND
+   /* Without these, we just never send or take deltas */
+   netplay->delta_buffer_size = state_manager_delta_maxsize(
+         netplay->state_size);
+   netplay->delta_buffer      = (uint8_t*)malloc(netplay->delta_buffer_size);
+   netplay->delta_hashes      = (uint64_t*)malloc(
+         state_manager_delta_pages(netplay->state_size) * sizeof(uint64_t));
+   if (!netplay->delta_buffer || !netplay->delta_hashes)
+   {
+      free(netplay->delta_buffer);
+      free(netplay->delta_hashes);
+      netplay->delta_buffer      = NULL;
+      netplay->delta_hashes      = NULL;
+      netplay->delta_buffer_size = 0;
+   }
+#endif
+
    return true;
 }
 
+void netplay_delta_base_set(netplay_t *netplay,
+   struct netplay_connection *connection, const void *state,
+   const uint64_t *hashes)
+{
+#ifdef HAVE_REWIND
+   size_t num_pages;
+
+   connection->delta_base_valid = false;
+
+   if (!connection->savestate_delta || !netplay->delta_buffer)
+      return;
+
+   num_pages = state_manager_delta_pages(netplay->state_size);
+
+   if (!connection->delta_base)
+   {
+      connection->delta_base   = (uint8_t*)calloc(
+            netplay->state_size + 1, 1);
+      connection->delta_hashes = (uint64_t*)malloc(
+            num_pages * sizeof(uint64_t));
+      if (!connection->delta_base || !connection->delta_hashes)
+      {
+         netplay_delta_base_free(connection);
+         return;
+      }
+   }
+
+   memcpy(connection->delta_base, state, netplay->state_size);
+   if (hashes)
+      memcpy(connection->delta_hashes, hashes,
+            num_pages * sizeof(uint64_t));
+   else
+      state_manager_delta_hash(state, netplay->state_size,
+            connection->delta_hashes);
+
+   connection->delta_base_valid = true;
+#endif
+}
+
+void netplay_delta_base_free(struct netplay_connection *connection)
+{
+   free(connection->delta_base);
+   free(connection->delta_hashes);
+   connection->delta_base       = NULL;
+   connection->delta_hashes     = NULL;
+   connection->delta_base_valid = false;
+}
+
 /**
  * netplay_try_init_serialization
  *
@@ -4247,6 +4570,7 @@ void netplay_free(netplay_t *netplay)
          netplay_deinit_socket_buffer(&connection->send_packet_buffer);
          netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
       }
+      netplay_delta_base_free(connection);
    }
 
    if (netplay->connections && netplay->connections != &netplay->one_connection)
@@ -4266,6 +4590,10 @@ void netplay_free(netplay_t *netplay)
    if (netplay->zbuffer)
       free(netplay->zbuffer);
 
+   free(netplay->replay_present_state);
+   free(netplay->delta_buffer);
+   free(netplay->delta_hashes);
+
    if (netplay->compress_nil.compression_stream)
    {
       netplay->compress_nil.compression_backend->stream_free(netplay->compress_nil.compression_stream);
@@ -0,0 +1,100 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#include "netplay_latency.h"
+
+void netplay_latency_sample(struct netplay_latency *latency,
+      retro_time_t lag)
+{
+   /* Same smoothing as TCP uses for its round-trip time */
+   if (!latency->samples)
+   {
+      latency->lag     = lag;
+      latency->jitter  = lag / 2;
+   }
+   else
+   {
+      retro_time_t dev = lag > latency->lag
+         ? lag - latency->lag : latency->lag - lag;
+      latency->jitter += (dev - latency->jitter) / 4;
+      latency->lag    += (lag - latency->lag)    / 8;
+   }
+
+   latency->samples++;
+}
+
+bool netplay_latency_update_rtt(struct netplay_latency *latency, int fd)
+{
+#if defined(__linux__) && defined(TCP_INFO)
+   struct tcp_info info;
+   socklen_t len = sizeof(info);
+
+   if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0)
+   {
+      latency->rtt     = info.tcpi_rtt;
+      latency->rtt_var = info.tcpi_rttvar;
+      return true;
+   }
+#endif
+   return false;
+}
+
+bool netplay_latency_frames(const struct netplay_latency *latency,
+      retro_time_t frame_time, unsigned *frames)
+{
+   retro_time_t late;
+
+   if (!latency->samples || latency->rtt <= 0 || frame_time <= 0)
+      return false;
+
+   /* Leave room for the usual jitter, so that only spikes beyond it
+    * need a rollback */
+   late    = latency->rtt / 2 + 2 * latency->jitter;
+   *frames = (unsigned)((late + frame_time - 1) / frame_time);
+   return true;
+}
+
+int netplay_latency_adjust(int frames, int target, int min, int max,
+      unsigned *lower_frames)
+{
+   if (target > max)
+      target = max;
+   if (target < min)
+      target = min;
+
+   if (frames < target)
+   {
+      *lower_frames = 0;
+      return frames + 1;
+   }
+
+   if (frames > target)
+   {
+      if (frames > max || ++*lower_frames >= NETPLAY_LATENCY_LOWER_FRAMES)
+      {
+         *lower_frames = 0;
+         return frames - 1;
+      }
+      return frames;
+   }
+
+   *lower_frames = 0;
+   return frames;
+}
@@ -0,0 +1,107 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_NETPLAY_LATENCY_H
+#define __RARCH_NETPLAY_LATENCY_H
+
+#include <boolean.h>
+#include <libretro.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* How long the input latency must have been too high before we lower it */
+#define NETPLAY_LATENCY_LOWER_FRAMES 120
+
+/* Timing of a peer, as seen from the input it sends us and from the
+ * connection to it */
+struct netplay_latency
+{
+   /* How long after our own input for a frame the peer's input for it
+    * arrives, smoothed. This moves with the input latency of both sides,
+    * so it only serves to tell how steadily the input arrives. */
+   retro_time_t lag;
+
+   /* Mean deviation of the above, smoothed */
+   retro_time_t jitter;
+
+   /* Round-trip time and its mean deviation, as measured by the TCP stack.
+    * Only refreshed by netplay_latency_update_rtt, 0 if unknown */
+   retro_time_t rtt;
+   retro_time_t rtt_var;
+
+   /* Number of samples taken */
+   unsigned samples;
+};
+
+/**
+ * netplay_latency_sample
+ * @latency              : timing of the peer
+ * @lag                  : how long after ours the peer's input arrived,
+ *                         0 if it came first
+ *
+ * Feed one input arrival into the estimates.
+ */
+void netplay_latency_sample(struct netplay_latency *latency,
+      retro_time_t lag);
+
+/**
+ * netplay_latency_update_rtt
+ * @latency              : timing of the peer
+ * @fd                   : socket of the connection to the peer
+ *
+ * Refresh the round-trip time from the TCP stack, where it tells.
+ *
+ * Returns true if it did.
+ */
+bool netplay_latency_update_rtt(struct netplay_latency *latency, int fd);
+
+/**
+ * netplay_latency_frames
+ * @latency              : timing of the peer
+ * @frame_time           : length of a frame
+ * @frames               : frames of input latency wanted
+ *
+ * Works out how many frames of input latency it takes for nearly all of
+ * our input to reach the peer before it runs the frame, going by half the
+ * round-trip time plus room for the jitter of the input stream. The link
+ * is taken to be as fast both ways, so this is also what the peer should
+ * use for its input to reach us.
+ *
+ * Returns false if the round-trip time or the jitter is not known yet.
+ */
+bool netplay_latency_frames(const struct netplay_latency *latency,
+      retro_time_t frame_time, unsigned *frames);
+
+/**
+ * netplay_latency_adjust
+ * @frames               : frames of input latency in use
+ * @target               : frames of input latency wanted
+ * @min                  : fewest frames of input latency allowed
+ * @max                  : most frames of input latency allowed
+ * @lower_frames         : frames @target has been below @frames so far
+ *
+ * Move the input latency one frame towards the target, within the bounds.
+ * Raising it happens at once, lowering only once the target has stayed
+ * lower for NETPLAY_LATENCY_LOWER_FRAMES frames, so that a link that is
+ * only briefly good does not cost a rollback every time it gets bad again.
+ *
+ * Returns the new input latency.
+ */
+int netplay_latency_adjust(int frames, int target, int min, int max,
+      unsigned *lower_frames);
+
+RETRO_END_DECLS
+
+#endif
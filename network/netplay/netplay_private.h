@@ -28,6 +28,8 @@
 #include "../../msg_hash.h"
 #include "../../verbosity.h"
 
+#include "netplay_latency.h"
+
 #define NETPLAY_PROTOCOL_VERSION 5
 
 #define RARCH_DEFAULT_PORT 55435
@@ -89,11 +91,20 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+/* Savestates may be sent as deltas against the last one sent */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_ZLIB_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#else
+#define NETPLAY_COMPRESSION_ZLIB_SUPPORTED 0
+#endif
+#ifdef HAVE_REWIND
+#define NETPLAY_COMPRESSION_DELTA_SUPPORTED NETPLAY_COMPRESSION_DELTA
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_DELTA_SUPPORTED 0
 #endif
+#define NETPLAY_COMPRESSION_SUPPORTED \
+   (NETPLAY_COMPRESSION_ZLIB_SUPPORTED | NETPLAY_COMPRESSION_DELTA_SUPPORTED)
 
 enum netplay_cmd
 {
@@ -166,6 +177,15 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate as a delta against the last one either side sent
+    * on this connection. Only sent if both sides support
+    * NETPLAY_COMPRESSION_DELTA */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0048,
+
+   /* The last delta did not apply; forget the base of the deltas
+    * and send a full savestate */
+   NETPLAY_CMD_REQUEST_FULL_SAVESTATE = 0x0049,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -301,6 +321,9 @@ struct delta_frame
    /* The serialized state of the core at this frame, before input */
    void *state;
 
+   /* When we read our own input for this frame, or 0 */
+   retro_time_t input_time;
+
    uint32_t frame;
 
    /* The CRC-32 of the serialized state if we've calculated it, else 0 */
@@ -334,6 +357,9 @@ struct netplay_connection
    /* Is this connection stalling? */
    retro_time_t stall_time;
 
+   /* How late the peer's input arrives */
+   struct netplay_latency latency; /* retro_time_t alignment */
+
    /* Address of peer */
    struct sockaddr_storage addr;
 
@@ -351,6 +377,11 @@ struct netplay_connection
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
+   /* The last savestate sent either way on this connection and its page
+    * hashes, as the base of savestate deltas */
+   uint8_t *delta_base;
+   uint64_t *delta_hashes;
+
    /* For the server: When was the last time we requested this client to stall?
     * For the client: How many frames of stall do we have left? */
    uint32_t stall_frame;
@@ -375,6 +406,12 @@ struct netplay_connection
 
    /* Is this connection buffer in use? */
    bool active;
+
+   /* Does this peer take savestate deltas? */
+   bool savestate_delta;
+
+   /* Does delta_base hold the peer's copy of the last savestate? */
+   bool delta_base_valid;
 };
 
 /* Compression transcoder */
@@ -400,6 +437,25 @@ struct netplay
    retro_time_t frame_run_time[NETPLAY_FRAME_RUN_TIME_WINDOW];
    retro_time_t frame_run_time_sum, frame_run_time_avg;
 
+   /* How long a replay may take each frame, 0 for no limit. A replay that
+    * would take longer is spread over several frames. */
+   retro_time_t replay_budget;
+
+   /* Replay accounting since replay_window_start, published into the
+    * replay_* statistics below once a second */
+   retro_time_t replay_window_start;
+   retro_time_t replay_window_serialize;
+   retro_time_t replay_window_unserialize;
+   retro_time_t replay_window_run;
+   uint32_t replay_window_frames;
+   uint32_t replay_window_replays;
+
+   /* Average time to serialize and run a replayed frame, and to load the
+    * state a replay starts from */
+   retro_time_t replay_serialize_time;
+   retro_time_t replay_unserialize_time;
+   retro_time_t replay_run_time;
+
    struct netplay_connection one_connection; /* Client only */ /* retro_time_t alignment */
 
    /* TCP connection for listening (server only) */
@@ -455,6 +511,12 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* Savestate deltas are built and applied here, before and after
+    * compression, along with the page hashes of the new state */
+   uint8_t *delta_buffer;
+   size_t delta_buffer_size;
+   uint64_t *delta_hashes;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -491,6 +553,16 @@ struct netplay
    size_t replay_ptr;
    uint32_t replay_frame_count;
 
+   /* Frames replayed by the last replay and the most by any replay, and
+    * frames replayed over the last second */
+   uint32_t replay_depth;
+   uint32_t replay_depth_max;
+   uint32_t replay_frames_per_second;
+
+   /* The state of the frame we are running, put aside while a replay
+    * spread over several frames catches up */
+   void *replay_present_state;
+
    /* Our local socket info */
    struct addrinfo *addr;
 
@@ -502,6 +574,9 @@ struct netplay
    /* Latency frames; positive to hide network latency, negative to hide input latency */
    int input_latency_frames;
 
+   /* Frames our input latency has been higher than our peers need */
+   unsigned input_latency_lower_frames;
+
    /* Frequency with which to check CRCs */
    int check_frames;
 
@@ -542,6 +617,9 @@ struct netplay
     * events, such as restarting or savestate loading. */
    bool force_rewind;
 
+   /* A replay ran out of its budget and goes on from other_ptr next frame */
+   bool replay_pending;
+
    /* Force a reset */
    bool force_reset;
 
@@ -737,6 +815,27 @@ bool netplay_try_init_serialization(netplay_t *netplay);
  */
 bool netplay_wait_and_init_serialization(netplay_t *netplay);
 
+/**
+ * netplay_delta_base_set
+ * @netplay              : pointer to netplay object
+ * @connection           : connection the savestate went over
+ * @state                : the savestate
+ * @hashes               : its page hashes, or NULL to hash it here
+ *
+ * Remember a savestate sent or received over a connection as the base of
+ * the savestate deltas that follow. Does nothing if the peer does not
+ * take deltas.
+ */
+void netplay_delta_base_set(netplay_t *netplay,
+   struct netplay_connection *connection, const void *state,
+   const uint64_t *hashes);
+
+/**
+ * netplay_delta_base_free
+ * @connection           : connection to forget the savestate base of
+ */
+void netplay_delta_base_free(struct netplay_connection *connection);
+
 /**
  * netplay_new:
  * @direct_host          : Netplay host discovered from scanning.
@@ -31,6 +31,7 @@
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -56,6 +57,16 @@
 #define USING_POSIX_FILE_SYSTEM
 #endif
 
+/* Entries sharing a key in one of the
+ * hashed indices of a playlist */
+typedef struct playlist_index_item
+{
+   size_t count;
+   /* Position of the first of them, counted from the end
+    * of the playlist, so pushing to the top doesn't move it */
+   size_t rev_idx;
+} playlist_index_item_t;
+
 struct content_playlist
 {
    char *default_core_path;
@@ -64,6 +75,19 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Strings of the entries read from the playlist file,
+    * copied one after the other into a single allocation
+    * instead of being allocated one by one. They are only
+    * freed along with it (see playlist_free_string()) */
+   char *strings;
+   size_t strings_size;
+
+   /* Hashed indices, built on first use (RHMAP) */
+   playlist_index_item_t *path_index;    /* 'Real' entry path */
+   playlist_index_item_t *archive_index; /* Archive part of the path,
+                                            for fuzzy archive matching */
+   playlist_index_item_t *crc_index;     /* CRC32 value */
+
    playlist_config_t config;  /* size_t alignment */
 
    enum playlist_label_display_mode label_display_mode;
@@ -75,6 +99,7 @@ struct content_playlist
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool index_valid;
 };
 
 typedef struct
@@ -86,6 +111,7 @@ typedef struct
    enum playlist_thumbnail_mode *current_meta_thumbnail_mode_val;
    enum playlist_sort_mode *current_meta_sort_mode_val;
    playlist_t *playlist;
+   size_t strings_capacity;
 
    unsigned array_depth;
    unsigned object_depth;
@@ -352,6 +378,290 @@ static bool playlist_core_path_equal(const char *real_core_path, const char *ent
    return false;
 }
 
+static bool playlist_fuzzy_archive_match(const playlist_config_t *config)
+{
+#ifdef RARCH_INTERNAL
+   return config->fuzzy_archive_match;
+#else
+   return true;
+#endif
+}
+
+/* Turns a 'real' path into an index key, matching
+ * the comparisons of playlist_path_equal() */
+static void playlist_index_path_key(char *key)
+{
+#ifdef _WIN32
+   /* Handle case-insensitive operating systems*/
+   string_to_lower(key);
+#endif
+}
+
+/* Gets the key of an entry in the CRC index. Only actual CRCs
+ * are indexed, not placeholders like 'DETECT' or the zero
+ * CRC of manual scans, which would be shared by all entries. */
+static bool playlist_index_crc_key(const char *crc32)
+{
+   return   !string_is_empty(crc32)
+         &&  string_ends_with(crc32, "|crc")
+         && !string_starts_with(crc32, "00000000|");
+}
+
+static void playlist_index_insert(playlist_index_item_t **index,
+      const char *key, size_t rev_idx)
+{
+   playlist_index_item_t *item = NULL;
+
+   if (RHMAP_HAS_STR((*index), key))
+   {
+      item          = RHMAP_PTR_STR((*index), key);
+      item->count++;
+      if (rev_idx > item->rev_idx)
+         item->rev_idx = rev_idx;
+      return;
+   }
+
+   if (!RHMAP_TRYFIT((*index), RHMAP_LEN((*index)) + 1))
+      return;
+
+   item          = RHMAP_PTR_STR((*index), key);
+   item->count   = 1;
+   item->rev_idx = rev_idx;
+}
+
+enum playlist_index_op
+{
+   PLAYLIST_INDEX_INSERT = 0,
+   PLAYLIST_INDEX_ERASE,
+   /* Entry moved to the top, keeping its keys
+    * (possibly gaining some) */
+   PLAYLIST_INDEX_BUMP
+};
+
+/* Returns false if the index has to be rebuilt */
+static bool playlist_index_erase(playlist_index_item_t **index,
+      const char *key, size_t rev_idx)
+{
+   playlist_index_item_t *item = NULL;
+
+   if (!RHMAP_HAS_STR((*index), key))
+      return false;
+
+   item = RHMAP_PTR_STR((*index), key);
+
+   if (--item->count == 0)
+   {
+      (void)RHMAP_DEL_STR((*index), key);
+      return true;
+   }
+
+   /* Which of the others is now the first
+    * can't be told without a full scan */
+   return item->rev_idx != rev_idx;
+}
+
+/* Returns false if the index has to be rebuilt */
+static bool playlist_index_apply(playlist_index_item_t **index,
+      const char *key, size_t rev_idx, enum playlist_index_op op)
+{
+   switch (op)
+   {
+      case PLAYLIST_INDEX_ERASE:
+         return playlist_index_erase(index, key, rev_idx);
+      case PLAYLIST_INDEX_BUMP:
+         if (RHMAP_HAS_STR((*index), key))
+         {
+            RHMAP_PTR_STR((*index), key)->rev_idx = rev_idx;
+            break;
+         }
+         /* fall-through */
+      case PLAYLIST_INDEX_INSERT:
+         playlist_index_insert(index, key, rev_idx);
+         break;
+   }
+
+   return true;
+}
+
+/* Applies @op to the keys of the entry
+ * @rev_idx entries from the end */
+static void playlist_index_update_entry(playlist_t *playlist,
+      const struct playlist_entry *entry, size_t rev_idx,
+      enum playlist_index_op op)
+{
+   bool valid = true;
+
+   if (!playlist->index_valid)
+      return;
+
+   if (!string_is_empty(entry->path))
+   {
+      char key[PATH_MAX_LENGTH];
+      const char *delim = NULL;
+
+      strlcpy(key, entry->path, sizeof(key));
+      path_resolve_realpath(key, sizeof(key), true);
+      playlist_index_path_key(key);
+
+      if (!string_is_empty(key))
+      {
+         valid = playlist_index_apply(&playlist->path_index,
+               key, rev_idx, op) && valid;
+
+         if (     !path_is_compressed_file(key)
+               && (delim = path_get_archive_delim(key)))
+         {
+            key[delim - key] = '\0';
+            valid = playlist_index_apply(&playlist->archive_index,
+                  key, rev_idx, op) && valid;
+         }
+      }
+   }
+
+   if (playlist_index_crc_key(entry->crc32))
+      valid = playlist_index_apply(&playlist->crc_index,
+            entry->crc32, rev_idx, op) && valid;
+
+   playlist->index_valid = valid;
+}
+
+/* Accounts for the removal of the entry @rev_idx
+ * entries from the end, once its keys are erased,
+ * or for its move to the top */
+static void playlist_index_shift(playlist_t *playlist, size_t rev_idx)
+{
+   size_t i;
+   playlist_index_item_t *indices[3];
+
+   if (!playlist->index_valid)
+      return;
+
+   indices[0] = playlist->path_index;
+   indices[1] = playlist->archive_index;
+   indices[2] = playlist->crc_index;
+
+   for (i = 0; i < ARRAY_SIZE(indices); i++)
+   {
+      size_t j;
+      playlist_index_item_t *index = indices[i];
+
+      for (j = 0; j < RHMAP_CAP(index); j++)
+         if (RHMAP_KEY(index, j) && index[j].rev_idx > rev_idx)
+            index[j].rev_idx--;
+   }
+}
+
+/* Accounts for the entry @idx moving to the top,
+ * once it did */
+static void playlist_index_bump(playlist_t *playlist, size_t idx)
+{
+   size_t len = RBUF_LEN(playlist->entries);
+
+   playlist_index_shift(playlist, len - 1 - idx);
+   playlist_index_update_entry(playlist, &playlist->entries[0],
+         len - 1, PLAYLIST_INDEX_BUMP);
+}
+
+/* Accounts for the removal of the last entry,
+ * before it is freed */
+static void playlist_index_evict(playlist_t *playlist)
+{
+   playlist_index_update_entry(playlist,
+         &playlist->entries[RBUF_LEN(playlist->entries) - 1],
+         0, PLAYLIST_INDEX_ERASE);
+   playlist_index_shift(playlist, 0);
+}
+
+static void playlist_index_clear(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->path_index);
+   RHMAP_FREE(playlist->archive_index);
+   RHMAP_FREE(playlist->crc_index);
+   playlist->index_valid = false;
+}
+
+static void playlist_index_build(playlist_t *playlist)
+{
+   size_t i;
+   size_t len = RBUF_LEN(playlist->entries);
+
+   playlist_index_clear(playlist);
+   playlist->index_valid = true;
+
+   for (i = 0; i < len; i++)
+      playlist_index_update_entry(playlist,
+            &playlist->entries[i], len - 1 - i, PLAYLIST_INDEX_INSERT);
+}
+
+/* Looks @key up in @index, keeping the first match in @idx */
+static bool playlist_index_find_key(playlist_t *playlist,
+      playlist_index_item_t *index, const char *key, size_t *idx)
+{
+   size_t len = RBUF_LEN(playlist->entries);
+   ptrdiff_t i;
+
+   if ((i = RHMAP_IDX_STR(index, key)) < 0)
+      return false;
+
+   if (*idx > len - 1 - index[i].rev_idx)
+      *idx = len - 1 - index[i].rev_idx;
+
+   return true;
+}
+
+/**
+ * playlist_index_find_path:
+ * @real_path           : 'Real' search path, generated by path_resolve_realpath()
+ * @idx                 : Index of the first matching entry
+ *
+ * Same as comparing real_path to every entry
+ * with playlist_path_equal(), without the loop.
+ *
+ * Returns 'true' if any entry matches.
+ **/
+static bool playlist_index_find_path(playlist_t *playlist,
+      const char *real_path, size_t *idx)
+{
+   char key[PATH_MAX_LENGTH];
+   bool found = false;
+
+   *idx       = RBUF_LEN(playlist->entries);
+
+   if (string_is_empty(real_path))
+      return false;
+
+   if (!playlist->index_valid)
+      playlist_index_build(playlist);
+
+   strlcpy(key, real_path, sizeof(key));
+   playlist_index_path_key(key);
+
+   found = playlist_index_find_key(playlist,
+         playlist->path_index, key, idx);
+
+   if (!playlist_fuzzy_archive_match(&playlist->config))
+      return found;
+
+   /* [archive_path] matches [archive_path][delimiter][rom_file]
+    * ...and vice versa */
+   if (path_is_compressed_file(key))
+      found = playlist_index_find_key(playlist,
+            playlist->archive_index, key, idx) || found;
+   else
+   {
+      const char *delim = path_get_archive_delim(key);
+
+      if (delim)
+      {
+         key[delim - key] = '\0';
+         found = playlist_index_find_key(playlist,
+               playlist->path_index, key, idx) || found;
+      }
+   }
+
+   return found;
+}
+
 uint32_t playlist_get_size(playlist_t *playlist)
 {
    if (!playlist)
@@ -366,6 +676,84 @@ char *playlist_get_conf_path(playlist_t *playlist)
    return playlist->config.path;
 }
 
+/* Copies a string read from the playlist file
+ * into the string block, if there is room left */
+static char *playlist_strings_add(playlist_t *playlist,
+      size_t capacity, const char *str, size_t len)
+{
+   char *copy;
+
+   if (playlist->strings_size + len + 1 > capacity)
+      return strdup(str);
+
+   copy = playlist->strings + playlist->strings_size;
+   memcpy(copy, str, len);
+   copy[len] = '\0';
+   playlist->strings_size += len + 1;
+   return copy;
+}
+
+static void playlist_free_string(playlist_t *playlist, char *str)
+{
+   if (     str
+         && !(   (str >= playlist->strings)
+              && (str <  playlist->strings + playlist->strings_size)))
+      free(str);
+}
+
+/* Gives back the part of the string block
+ * reading the playlist file didn't use */
+static void playlist_strings_shrink(playlist_t *playlist)
+{
+   size_t i, len;
+   uintptr_t old_start;
+   char *strings = NULL;
+
+   if (!playlist->strings)
+      return;
+
+   if (!playlist->strings_size)
+   {
+      free(playlist->strings);
+      playlist->strings = NULL;
+      return;
+   }
+
+   old_start = (uintptr_t)playlist->strings;
+
+   if (!(strings = (char*)realloc(playlist->strings,
+               playlist->strings_size)))
+      return;
+
+   playlist->strings = strings;
+
+   if ((uintptr_t)strings == old_start)
+      return;
+
+   /* Block moved - point entries at the new one */
+   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   {
+      struct playlist_entry *entry = &playlist->entries[i];
+      char **fields[]              = {
+         &entry->path,            &entry->label,
+         &entry->core_path,       &entry->core_name,
+         &entry->db_name,         &entry->crc32,
+         &entry->subsystem_ident, &entry->subsystem_name,
+         &entry->runtime_str,     &entry->last_played_str
+      };
+      size_t j;
+
+      for (j = 0; j < ARRAY_SIZE(fields); j++)
+      {
+         uintptr_t field = (uintptr_t)*fields[j];
+
+         if (     (field >= old_start)
+               && (field <  old_start + playlist->strings_size))
+            *fields[j] = strings + (field - old_start);
+      }
+   }
+}
+
 /**
  * playlist_get_index:
  * @playlist            : Playlist handle.
@@ -388,35 +776,27 @@ void playlist_get_index(playlist_t *playlist,
 
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
-   if (entry->path)
-      free(entry->path);
-   if (entry->label)
-      free(entry->label);
-   if (entry->core_path)
-      free(entry->core_path);
-   if (entry->core_name)
-      free(entry->core_name);
-   if (entry->db_name)
-      free(entry->db_name);
-   if (entry->crc32)
-      free(entry->crc32);
-   if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
-   if (entry->subsystem_name)
-      free(entry->subsystem_name);
-   if (entry->runtime_str)
-      free(entry->runtime_str);
-   if (entry->last_played_str)
-      free(entry->last_played_str);
+   playlist_free_string(playlist, entry->path);
+   playlist_free_string(playlist, entry->label);
+   playlist_free_string(playlist, entry->core_path);
+   playlist_free_string(playlist, entry->core_name);
+   playlist_free_string(playlist, entry->db_name);
+   playlist_free_string(playlist, entry->crc32);
+   playlist_free_string(playlist, entry->subsystem_ident);
+   playlist_free_string(playlist, entry->subsystem_name);
+   playlist_free_string(playlist, entry->runtime_str);
+   playlist_free_string(playlist, entry->last_played_str);
    if (entry->subsystem_roms)
       string_list_free(entry->subsystem_roms);
 
@@ -466,7 +846,12 @@ void playlist_delete_index(playlist_t *playlist,
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+   {
+      playlist_index_update_entry(playlist, entry_to_delete,
+            len - 1 - idx, PLAYLIST_INDEX_ERASE);
+      playlist_index_shift(playlist, len - 1 - idx);
+      playlist_free_entry(playlist, entry_to_delete);
+   }
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -500,20 +885,10 @@ void playlist_delete_by_path(playlist_t *playlist,
    strlcpy(real_search_path, search_path, sizeof(real_search_path));
    path_resolve_realpath(real_search_path, sizeof(real_search_path), true);
 
-   while (i < RBUF_LEN(playlist->entries))
+   while (playlist_index_find_path(playlist, real_search_path, &i))
    {
-      if (!playlist_path_equal(real_search_path, playlist->entries[i].path,
-            &playlist->config))
-      {
-         i++;
-         continue;
-      }
-
       /* Paths are equal - delete entry */
       playlist_delete_index(playlist, i);
-
-      /* Entries are shifted up by the delete
-       * operation - *do not* increment i */
    }
 }
 
@@ -521,7 +896,7 @@ void playlist_get_index_by_path(playlist_t *playlist,
       const char *search_path,
       const struct playlist_entry **entry)
 {
-   size_t i, len;
+   size_t i;
    char real_search_path[PATH_MAX_LENGTH];
 
    real_search_path[0] = '\0';
@@ -533,22 +908,39 @@ void playlist_get_index_by_path(playlist_t *playlist,
    strlcpy(real_search_path, search_path, sizeof(real_search_path));
    path_resolve_realpath(real_search_path, sizeof(real_search_path), true);
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (!playlist_path_equal(real_search_path, playlist->entries[i].path,
-               &playlist->config))
-         continue;
-
+   if (playlist_index_find_path(playlist, real_search_path, &i))
       *entry = &playlist->entries[i];
+}
 
-      break;
-   }
+/**
+ * playlist_get_index_by_crc32:
+ * @playlist            : Playlist handle.
+ * @crc32               : CRC32 value, as stored in playlist
+ *                        entries (e.g. "1A2B3C4D|crc").
+ * @entry               : First entry with this CRC32, if any.
+ **/
+void playlist_get_index_by_crc32(playlist_t *playlist,
+      const char *crc32,
+      const struct playlist_entry **entry)
+{
+   size_t i;
+
+   if (!playlist || !entry || !playlist_index_crc_key(crc32))
+      return;
+
+   if (!playlist->index_valid)
+      playlist_index_build(playlist);
+
+   i = RBUF_LEN(playlist->entries);
+
+   if (playlist_index_find_key(playlist, playlist->crc_index, crc32, &i))
+      *entry = &playlist->entries[i];
 }
 
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path)
 {
-   size_t i, len;
+   size_t i;
    char real_search_path[PATH_MAX_LENGTH];
 
    real_search_path[0] = '\0';
@@ -560,14 +952,7 @@ bool playlist_entry_exists(playlist_t *playlist,
    strlcpy(real_search_path, path, sizeof(real_search_path));
    path_resolve_realpath(real_search_path, sizeof(real_search_path), true);
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
-   {
-      if (playlist_path_equal(real_search_path, playlist->entries[i].path,
-               &playlist->config))
-         return true;
-   }
-
-   return false;
+   return playlist_index_find_path(playlist, real_search_path, &i);
 }
 
 void playlist_update(playlist_t *playlist, size_t idx,
@@ -580,26 +965,27 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    entry            = &playlist->entries[idx];
 
+   if (     (update_entry->path  && (update_entry->path  != entry->path))
+         || (update_entry->crc32 && (update_entry->crc32 != entry->crc32)))
+      playlist->index_valid = false;
+
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_free_string(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
       playlist->modified = true;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
-      if (entry->label)
-         free(entry->label);
+      playlist_free_string(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
       playlist->modified = true;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = true;
@@ -607,24 +993,21 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
-      if (entry->core_name)
-         free(entry->core_name);
+      playlist_free_string(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
       playlist->modified = true;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
-      if (entry->db_name)
-         free(entry->db_name);
+      playlist_free_string(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
       playlist->modified = true;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
-      if (entry->crc32)
-         free(entry->crc32);
+      playlist_free_string(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->modified = true;
    }
@@ -643,8 +1026,8 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist->index_valid = false;
+      playlist_free_string(playlist, entry->path);
       entry->path        = NULL;
       entry->path        = strdup(update_entry->path);
       playlist->modified = playlist->modified || register_update;
@@ -652,8 +1035,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_free_string(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
@@ -721,8 +1103,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->runtime_str && (update_entry->runtime_str != entry->runtime_str))
    {
-      if (entry->runtime_str)
-         free(entry->runtime_str);
+      playlist_free_string(playlist, entry->runtime_str);
       entry->runtime_str = NULL;
       entry->runtime_str = strdup(update_entry->runtime_str);
       playlist->modified = playlist->modified || register_update;
@@ -730,8 +1111,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->last_played_str && (update_entry->last_played_str != entry->last_played_str))
    {
-      if (entry->last_played_str)
-         free(entry->last_played_str);
+      playlist_free_string(playlist, entry->last_played_str);
       entry->last_played_str = NULL;
       entry->last_played_str = strdup(update_entry->last_played_str);
       playlist->modified = playlist->modified || register_update;
@@ -778,7 +1158,13 @@ bool playlist_push_runtime(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+
+   /* Skip to the first entry with an equal path */
+   i   = 0;
+   if (!string_is_empty(real_path))
+      playlist_index_find_path(playlist, real_path, &i);
+
+   for (; i < len; i++)
    {
       struct playlist_entry tmp;
       const char *entry_path = playlist->entries[i].path;
@@ -804,6 +1190,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
       playlist->entries[0] = tmp;
+      playlist_index_bump(playlist, i);
 
       goto success;
    }
@@ -814,7 +1201,8 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_index_evict(playlist);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -856,6 +1244,9 @@ bool playlist_push_runtime(playlist_t *playlist,
          playlist->entries[0].runtime_str     = strdup(entry->runtime_str);
       if (!string_is_empty(entry->last_played_str))
          playlist->entries[0].last_played_str = strdup(entry->last_played_str);
+
+      playlist_index_update_entry(playlist, &playlist->entries[0],
+            len, PLAYLIST_INDEX_INSERT);
    }
 
 success:
@@ -982,7 +1373,13 @@ bool playlist_push(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+
+   /* Skip to the first entry with an equal path */
+   i   = 0;
+   if (!string_is_empty(real_path))
+      playlist_index_find_path(playlist, real_path, &i);
+
+   for (; i < len; i++)
    {
       struct playlist_entry tmp;
       const char *entry_path = playlist->entries[i].path;
@@ -1082,7 +1479,10 @@ bool playlist_push(playlist_t *playlist,
       if (i == 0)
       {
          if (entry_updated)
+         {
+            playlist_index_bump(playlist, 0);
             goto success;
+         }
 
          return false;
       }
@@ -1092,6 +1492,7 @@ bool playlist_push(playlist_t *playlist,
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
       playlist->entries[0] = tmp;
+      playlist_index_bump(playlist, i);
 
       goto success;
    }
@@ -1102,7 +1503,8 @@ bool playlist_push(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_index_evict(playlist);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1165,6 +1567,9 @@ bool playlist_push(playlist_t *playlist,
          for (i = 0; i < entry->subsystem_roms->size; i++)
             string_list_append(playlist->entries[0].subsystem_roms, entry->subsystem_roms->elems[i].data, attributes);
       }
+
+      playlist_index_update_entry(playlist, &playlist->entries[0],
+            len, PLAYLIST_INDEX_INSERT);
    }
 
 success:
@@ -1674,12 +2079,15 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   free(playlist->strings);
+   playlist_index_clear(playlist);
+
    free(playlist);
 }
 
@@ -1700,9 +2108,15 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+
+   free(playlist->strings);
+   playlist->strings      = NULL;
+   playlist->strings_size = 0;
+
+   playlist_index_clear(playlist);
 }
 
 /**
@@ -1845,9 +2259,9 @@ static bool JSONStringHandler(void *context, const char *pValue, size_t length)
       {
          if (pCtx->current_string_val && length && !string_is_empty(pValue))
          {
-            if (*pCtx->current_string_val)
-                free(*pCtx->current_string_val);
-             *pCtx->current_string_val = strdup(pValue);
+            playlist_free_string(pCtx->playlist, *pCtx->current_string_val);
+            *pCtx->current_string_val = playlist_strings_add(pCtx->playlist,
+                  pCtx->strings_capacity, pValue, length);
          }
       }
    }
@@ -2046,7 +2460,9 @@ static bool playlist_read_file(playlist_t *playlist)
 {
    unsigned i;
    int test_char;
-   bool res = true;
+   int64_t file_size;
+   size_t strings_capacity = 0;
+   bool res                = true;
 
 #if defined(HAVE_ZLIB)
       /* Always use RZIP interface when reading playlists
@@ -2069,6 +2485,16 @@ static bool playlist_read_file(playlist_t *playlist)
 
    playlist->compressed = intfstream_is_compressed(file);
 
+   /* Strings take up less than the (uncompressed) file
+    * they are read from, so a block that size fits them
+    * all. Whatever is left over is freed afterwards */
+   file_size = intfstream_get_size(file);
+
+   if (     (file_size > 0)
+         && ((uint64_t)file_size < SIZE_MAX)
+         && (playlist->strings = (char*)malloc((size_t)file_size + 1)))
+      strings_capacity = (size_t)file_size + 1;
+
    /* Detect format of playlist
     * > Read file until we find the first printable
     *   non-whitespace ASCII character */
@@ -2103,8 +2529,9 @@ static bool playlist_read_file(playlist_t *playlist)
    if (!playlist->old_format)
    {
       rjson_t* parser;
-      JSONContext context = {0};
-      context.playlist    = playlist;
+      JSONContext context      = {0};
+      context.playlist         = playlist;
+      context.strings_capacity = strings_capacity;
 
       parser = rjson_open_stream(file);
       if (!parser)
@@ -2200,27 +2627,33 @@ static bool playlist_read_file(playlist_t *playlist)
 
             /* path */
             if (!string_is_empty(line_buf[0]))
-               entry->path      = strdup(line_buf[0]);
+               entry->path      = playlist_strings_add(playlist,
+                     strings_capacity, line_buf[0], strlen(line_buf[0]));
 
             /* label */
             if (!string_is_empty(line_buf[1]))
-               entry->label     = strdup(line_buf[1]);
+               entry->label     = playlist_strings_add(playlist,
+                     strings_capacity, line_buf[1], strlen(line_buf[1]));
 
             /* core_path */
             if (!string_is_empty(line_buf[2]))
-               entry->core_path = strdup(line_buf[2]);
+               entry->core_path = playlist_strings_add(playlist,
+                     strings_capacity, line_buf[2], strlen(line_buf[2]));
 
             /* core_name */
             if (!string_is_empty(line_buf[3]))
-               entry->core_name = strdup(line_buf[3]);
+               entry->core_name = playlist_strings_add(playlist,
+                     strings_capacity, line_buf[3], strlen(line_buf[3]));
 
             /* crc32 */
             if (!string_is_empty(line_buf[4]))
-               entry->crc32     = strdup(line_buf[4]);
+               entry->crc32     = playlist_strings_add(playlist,
+                     strings_capacity, line_buf[4], strlen(line_buf[4]));
 
             /* db_name */
             if (!string_is_empty(line_buf[5]))
-               entry->db_name   = strdup(line_buf[5]);
+               entry->db_name   = playlist_strings_add(playlist,
+                     strings_capacity, line_buf[5], strlen(line_buf[5]));
          }
          /* If fewer than 'PLAYLIST_ENTRIES' lines were
           * read, then this is metadata */
@@ -2346,6 +2779,7 @@ static bool playlist_read_file(playlist_t *playlist)
    }
 
 end:
+   playlist_strings_shrink(playlist);
    intfstream_close(file);
    free(file);
    return res;
@@ -2408,6 +2842,12 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
    playlist->entries                = NULL;
+   playlist->strings                = NULL;
+   playlist->strings_size           = 0;
+   playlist->path_index             = NULL;
+   playlist->archive_index          = NULL;
+   playlist->crc_index              = NULL;
+   playlist->index_valid            = false;
    playlist->label_display_mode     = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode   = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode    = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2444,7 +2884,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
                playlist->base_content_directory, playlist->config.base_content_directory,
                sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_string(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
             /* Fix subsystem roms paths*/
@@ -2585,6 +3025,9 @@ void playlist_qsort(playlist_t *playlist)
    qsort(playlist->entries, RBUF_LEN(playlist->entries),
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+
+   /* Positions are all different now */
+   playlist_index_clear(playlist);
 }
 
 void command_playlist_push_write(
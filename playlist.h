@@ -267,6 +267,10 @@ void playlist_get_index_by_path(playlist_t *playlist,
 bool playlist_entry_exists(playlist_t *playlist,
       const char *path);
 
+void playlist_get_index_by_crc32(playlist_t *playlist,
+      const char *crc32,
+      const struct playlist_entry **entry);
+
 char *playlist_get_conf_path(playlist_t *playlist);
 
 uint32_t playlist_get_size(playlist_t *playlist);
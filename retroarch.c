@@ -7079,6 +7079,7 @@ static bool get_self_input_state(
    }
 
    ptr->have_local = true;
+   ptr->input_time = cpu_features_get_time_usec();
    if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING)
    {
       ptr->have_real[netplay->self_client_num] = true;
@@ -7118,6 +7119,96 @@ static bool init_netplay_deferred(
    return p_rarch->netplay_client_deferred;
 }
 
+/**
+ * netplay_get_stats:
+ * @netplay              : pointer to netplay object
+ * @stats                : filled with the timing of the session
+ *
+ * Reports the input latency in use, the timing of the slowest peer and
+ * what replays have cost of late.
+ **/
+static void netplay_get_stats(netplay_t *netplay, struct netplay_stats *stats)
+{
+   size_t i;
+   retro_time_t late = -1;
+
+   memset(stats, 0, sizeof(*stats));
+   stats->input_latency_frames     = netplay->input_latency_frames;
+   stats->replay_depth             = netplay->replay_depth;
+   stats->replay_depth_max         = netplay->replay_depth_max;
+   stats->replay_frames_per_second = netplay->replay_frames_per_second;
+   stats->replay_serialize_time    = netplay->replay_serialize_time;
+   stats->replay_run_time          = netplay->replay_run_time;
+   stats->replay_unserialize_time  = netplay->replay_unserialize_time;
+   if (netplay->replay_pending)
+      stats->replay_behind         = netplay->run_frame_count
+         - netplay->other_frame_count;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active ||
+          connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      netplay_latency_update_rtt(&connection->latency, connection->fd);
+
+      if (connection->latency.rtt / 2 + 2 * connection->latency.jitter
+            <= late)
+         continue;
+
+      late             = connection->latency.rtt / 2
+         + 2 * connection->latency.jitter;
+      stats->lag       = connection->latency.lag;
+      stats->jitter    = connection->latency.jitter;
+      stats->rtt       = connection->latency.rtt;
+      stats->rtt_var   = connection->latency.rtt_var;
+   }
+}
+
+/**
+ * netplay_latency_target:
+ * @netplay              : pointer to netplay object
+ * @target               : frames of input latency our peers need
+ *
+ * Works out the input latency it takes for our input to reach all peers
+ * before they run its frame, as far as the timing of the links is known.
+ *
+ * Returns: true if it is known for at least one peer.
+ **/
+static bool netplay_latency_target(netplay_t *netplay, int *target)
+{
+   size_t i;
+   bool known                           = false;
+   struct retro_system_av_info *av_info = video_viewport_get_system_av_info();
+   double fps                           = (av_info && av_info->timing.fps > 0)
+      ? av_info->timing.fps : 60.0;
+   retro_time_t frame_time              = (retro_time_t)(1000000.0 / fps);
+
+   *target = 0;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      unsigned frames;
+      struct netplay_connection *connection = &netplay->connections[i];
+
+      if (!connection->active ||
+          connection->mode < NETPLAY_CONNECTION_CONNECTED)
+         continue;
+
+      netplay_latency_update_rtt(&connection->latency, connection->fd);
+      if (!netplay_latency_frames(&connection->latency, frame_time, &frames))
+         continue;
+
+      if ((int)frames > *target)
+         *target = (int)frames;
+      known    = true;
+   }
+
+   return known;
+}
+
 /**
  * netplay_poll:
  * @netplay              : pointer to netplay object
@@ -7165,6 +7256,9 @@ static bool netplay_poll(
 
    netplay_update_unread_ptr(netplay);
 
+   netplay->replay_budget = (retro_time_t)
+      settings->uints.netplay_replay_budget * 1000;
+
    /* Figure out how many frames of input latency we should be using to hide
     * network latency */
    if (netplay->frame_run_time_avg || netplay->stateless_mode)
@@ -7179,6 +7273,7 @@ static bool netplay_poll(
       int input_latency_frames_min = settings->uints.netplay_input_latency_frames_min -
             (settings->bools.run_ahead_enabled ? settings->uints.run_ahead_frames : 0);
       int input_latency_frames_max = input_latency_frames_min + settings->uints.netplay_input_latency_frames_range;
+      int target                   = 0;
 
       /* Assume we need a couple frames worth of time to actually run the
        * current frame */
@@ -7201,6 +7296,15 @@ static bool netplay_poll(
                 netplay->input_latency_frames > input_latency_frames_min))
             netplay->input_latency_frames--;
       }
+      else if (netplay_latency_target(netplay, &target))
+      {
+         /* Enough latency for our input to reach the slowest peer in
+          * time, save for the odd spike */
+         netplay->input_latency_frames = netplay_latency_adjust(
+               netplay->input_latency_frames, target,
+               input_latency_frames_min, input_latency_frames_max,
+               &netplay->input_latency_lower_frames);
+      }
       else if (netplay->input_latency_frames < input_latency_frames_min ||
                (frames_per_frame < frames_ahead &&
                 netplay->input_latency_frames < input_latency_frames_max))
@@ -8002,43 +8106,99 @@ static void netplay_force_future(netplay_t *netplay)
    }
 }
 
+#ifdef HAVE_REWIND
 /**
- * netplay_send_savestate
+ * netplay_send_savestate_delta
  * @netplay              : pointer to netplay object
+ * @connection           : peer to send the savestate to
  * @serial_info          : the savestate being loaded
- * @cx                   : compression type
  * @z                    : compression backend to use
  *
- * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * Send a loaded savestate to a peer as a delta against the last savestate
+ * exchanged with it. Leaves the page hashes of the savestate in
+ * netplay->delta_hashes.
+ *
+ * Returns true if sent, false if a full savestate must be sent instead.
  */
-static void netplay_send_savestate(netplay_t *netplay,
-   retro_ctx_serialize_info_t *serial_info, uint32_t cx,
+static bool netplay_send_savestate_delta(netplay_t *netplay,
+   struct netplay_connection *connection,
+   retro_ctx_serialize_info_t *serial_info,
    struct compression_transcoder *z)
 {
-   uint32_t header[4];
+   uint32_t header[8];
    uint32_t rd, wn;
-   size_t i;
+   size_t patch_size;
+   uint64_t base_digest, state_digest;
+   /* Our own copy of the savestate, which unlike serial_info
+    * is padded to whole words */
+   const uint8_t *state = (const uint8_t*)
+      netplay->buffer[netplay->run_ptr].state;
+
+   if (!connection->delta_base_valid || !netplay->delta_buffer ||
+       serial_info->size != netplay->state_size)
+      return false;
+
+   patch_size = state_manager_delta_compress(connection->delta_base,
+      state, netplay->state_size, netplay->delta_buffer,
+      connection->delta_hashes, netplay->delta_hashes);
+
+   /* Not worth it if most of the savestate changed */
+   if (patch_size >= netplay->state_size / 2)
+      return false;
 
-   /* Compress it */
    z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
+      netplay->delta_buffer, (uint32_t)patch_size);
    z->compression_backend->set_out(z->compression_stream,
       netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
    if (!z->compression_backend->trans(z->compression_stream, true, &rd,
          &wn, NULL))
-   {
-      /* Catastrophe! */
-      for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
-   }
+      return false;
+
+   base_digest  = state_manager_delta_digest(connection->delta_base,
+      netplay->state_size);
+   state_digest = state_manager_delta_digest(state, netplay->state_size);
 
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
+   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+   header[1] = htonl(wn + 6*sizeof(uint32_t));
    header[2] = htonl(netplay->run_frame_count);
    header[3] = htonl(serial_info->size);
+   header[4] = htonl((uint32_t)(base_digest >> 32));
+   header[5] = htonl((uint32_t)base_digest);
+   header[6] = htonl((uint32_t)(state_digest >> 32));
+   header[7] = htonl((uint32_t)state_digest);
+
+   if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
+         sizeof(header)) ||
+       !netplay_send(&connection->send_packet_buffer, connection->fd,
+         netplay->zbuffer, wn))
+   {
+      netplay_hangup(netplay, connection);
+      return true;
+   }
+
+   netplay_delta_base_set(netplay, connection, state, netplay->delta_hashes);
+   return true;
+}
+#endif
+
+/**
+ * netplay_send_savestate
+ * @netplay              : pointer to netplay object
+ * @serial_info          : the savestate being loaded
+ * @cx                   : compression type
+ * @z                    : compression backend to use
+ *
+ * Send a loaded savestate to those connected peers using the given compression
+ * scheme, as a delta to those that have an earlier one.
+ */
+static void netplay_send_savestate(netplay_t *netplay,
+   retro_ctx_serialize_info_t *serial_info, uint32_t cx,
+   struct compression_transcoder *z)
+{
+   uint32_t header[4];
+   uint32_t rd, wn;
+   size_t i;
+   bool compressed = false;
 
    for (i = 0; i < netplay->connections_size; i++)
    {
@@ -8047,11 +8207,49 @@ static void netplay_send_savestate(netplay_t *netplay,
           connection->mode < NETPLAY_CONNECTION_CONNECTED ||
           connection->compression_supported != cx) continue;
 
+#ifdef HAVE_REWIND
+      if (netplay_send_savestate_delta(netplay, connection, serial_info, z))
+         continue;
+#endif
+
+      if (!compressed)
+      {
+         /* Compress it */
+         z->compression_backend->set_in(z->compression_stream,
+            (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
+         z->compression_backend->set_out(z->compression_stream,
+            netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+         if (!z->compression_backend->trans(z->compression_stream, true, &rd,
+               &wn, NULL))
+         {
+            /* Catastrophe! */
+            for (i = 0; i < netplay->connections_size; i++)
+               netplay_hangup(netplay, &netplay->connections[i]);
+            return;
+         }
+
+         header[0]  = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+         header[1]  = htonl(wn + 2*sizeof(uint32_t));
+         header[2]  = htonl(netplay->run_frame_count);
+         header[3]  = htonl(serial_info->size);
+         compressed = true;
+      }
+
+      /* Send it to this peer */
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
             sizeof(header)) ||
           !netplay_send(&connection->send_packet_buffer, connection->fd,
             netplay->zbuffer, wn))
+      {
          netplay_hangup(netplay, connection);
+         continue;
+      }
+
+      if (serial_info->size == netplay->state_size)
+         netplay_delta_base_set(netplay, connection,
+               serial_info->data_const, NULL);
+      else
+         connection->delta_base_valid = false;
    }
 }
 
@@ -8337,6 +8535,7 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
 
          case RARCH_NETPLAY_CTL_IS_REPLAYING:
          case RARCH_NETPLAY_CTL_IS_DATA_INITED:
+         case RARCH_NETPLAY_CTL_GET_STATS:
             ret = false;
             goto done;
 
@@ -8423,6 +8622,9 @@ bool netplay_driver_ctl(enum rarch_netplay_ctl_state state, void *data)
                netplay_load_savestate(netplay, NULL, true);
          }
          break;
+      case RARCH_NETPLAY_CTL_GET_STATS:
+         netplay_get_stats(netplay, (struct netplay_stats*)data);
+         goto done;
       default:
       case RARCH_NETPLAY_CTL_NONE:
          ret = false;
@@ -13899,6 +14101,16 @@ bool command_event(enum event_command cmd, void *data)
          {
             bool rewind_enable        = settings->bools.rewind_enable;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
+            size_t rewind_cold_size   = settings->sizes.rewind_cold_buffer_size;
+            const char *dir_cache     = settings->paths.directory_cache;
+            char rewind_cold_path[PATH_MAX_LENGTH];
+
+            rewind_cold_path[0]       = '\0';
+
+            if (     settings->bools.rewind_cold_buffer_to_disk
+                  && !string_is_empty(dir_cache))
+               fill_pathname_join(rewind_cold_path, dir_cache,
+                     "rewind.tmp", sizeof(rewind_cold_path));
 #ifdef HAVE_CHEEVOS
             if (rcheevos_hardcore_active())
                return false;
@@ -13913,7 +14125,10 @@ bool command_event(enum event_command cmd, void *data)
 #endif
                {
                   state_manager_event_init(&p_rarch->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size,
+                        cpu_features_get_core_amount(),
+                        rewind_cold_size, rewind_cold_path,
+                        settings->bools.rewind_dirty_pages);
                }
             }
          }
@@ -15421,6 +15636,7 @@ void main_exit(void *args)
    rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+   task_image_pool_deinit();
 
    if (p_rarch->configuration_settings)
       free(p_rarch->configuration_settings);
@@ -28140,6 +28356,10 @@ static bool audio_driver_deinit_internal(struct rarch_state *p_rarch,
       memalign_free(p_rarch->audio_driver_output_samples_buf);
    p_rarch->audio_driver_output_samples_buf = NULL;
 
+   if (p_rarch->audio_driver_output_block_buf)
+      memalign_free(p_rarch->audio_driver_output_block_buf);
+   p_rarch->audio_driver_output_block_buf   = NULL;
+
 #ifdef HAVE_DSP_FILTER
    audio_driver_dsp_filter_free();
 #endif
@@ -28219,6 +28439,7 @@ static bool audio_driver_init_internal(
 {
    unsigned new_rate       = 0;
    float  *samples_buf     = NULL;
+   float  *block_buf       = NULL;
    size_t max_bufsamples   = AUDIO_CHUNK_SIZE_NONBLOCKING * 2;
    bool audio_enable       = settings->bools.audio_enable;
    bool audio_sync         = settings->bools.audio_sync;
@@ -28231,8 +28452,10 @@ static bool audio_driver_init_internal(
 #endif
    /* Accomodate rewind since at some point we might have two full buffers. */
    size_t outsamples_max   = AUDIO_CHUNK_SIZE_NONBLOCKING * 2 * AUDIO_MAX_RATIO * slowmotion_ratio;
+   /* Same headroom for what one block resamples to */
+   size_t blocksamples_max = AUDIO_BLOCK_FRAMES * 4 * AUDIO_MAX_RATIO * slowmotion_ratio;
    int16_t *conv_buf       = (int16_t*)memalign_alloc(64, outsamples_max * sizeof(int16_t));
-   float *audio_buf        = (float*)memalign_alloc(64, AUDIO_CHUNK_SIZE_NONBLOCKING * 2 * sizeof(float));
+   float *audio_buf        = (float*)memalign_alloc(64, AUDIO_BLOCK_FRAMES * 2 * sizeof(float));
    bool verbosity_enabled  = verbosity_is_enabled();
 
    convert_s16_to_float_init_simd();
@@ -28245,7 +28468,7 @@ static bool audio_driver_init_internal(
    if (!conv_buf || !audio_buf)
       goto error;
 
-   memset(audio_buf, 0, AUDIO_CHUNK_SIZE_NONBLOCKING * 2 * sizeof(float));
+   memset(audio_buf, 0, AUDIO_BLOCK_FRAMES * 2 * sizeof(float));
 
    p_rarch->audio_driver_input_data              = audio_buf;
    p_rarch->audio_driver_output_samples_conv_buf = conv_buf;
@@ -28370,13 +28593,20 @@ static bool audio_driver_init_internal(
          p_rarch->audio_driver_input * AUDIO_MAX_RATIO);
 
    samples_buf = (float*)memalign_alloc(64, outsamples_max * sizeof(float));
+   block_buf   = (float*)memalign_alloc(64, blocksamples_max * sizeof(float));
 
    retro_assert(samples_buf != NULL);
+   retro_assert(block_buf != NULL);
 
-   if (!samples_buf)
+   if (!samples_buf || !block_buf)
+   {
+      memalign_free(samples_buf);
+      memalign_free(block_buf);
       goto error;
+   }
 
    p_rarch->audio_driver_output_samples_buf = (float*)samples_buf;
+   p_rarch->audio_driver_output_block_buf   = block_buf;
    p_rarch->audio_driver_control            = false;
 
    if (
@@ -28427,6 +28657,10 @@ error:
  *
  * Writes audio samples to audio driver. Will first
  * perform DSP processing (if enabled) and resampling.
+ *
+ * Each block of AUDIO_BLOCK_FRAMES is taken through every
+ * stage before the next one is converted, so the intermediate
+ * float samples never leave the cache.
  **/
 static void audio_driver_flush(
       struct rarch_state *p_rarch,
@@ -28435,45 +28669,29 @@ static void audio_driver_flush(
       const int16_t *data, size_t samples,
       bool is_slowmotion, bool is_fastmotion)
 {
+   size_t i;
    struct resampler_data src_data;
+   size_t output_frames              = 0;
+   size_t block_frames               = 0;
+   float *output_buf                 = p_rarch->audio_driver_output_samples_buf;
+   float *block_buf                  = p_rarch->audio_driver_output_block_buf;
+   bool use_float                    = p_rarch->audio_driver_use_float;
    float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
          (audio_fastforward_mute && is_fastmotion)) ?
                0.0f : p_rarch->audio_driver_volume_gain;
+#ifdef HAVE_AUDIOMIXER
+   bool mixer_override               = true;
+   float mixer_gain                  = 0.0f;
 
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
-
-   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = p_rarch->audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
-
-#ifdef HAVE_DSP_FILTER
-   if (p_rarch->audio_driver_dsp)
+   if (!p_rarch->audio_driver_mixer_mute_enable)
    {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = p_rarch->audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
+      if (p_rarch->audio_driver_mixer_volume_gain == 1.0f)
+         mixer_override              = false;
+      mixer_gain                     =
+         p_rarch->audio_driver_mixer_volume_gain;
    }
 #endif
 
-   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
-
    if (p_rarch->audio_driver_control)
    {
       /* Readjust the audio input rate. */
@@ -28530,50 +28748,105 @@ static void audio_driver_flush(
     * trying to do anything. Just leave the ratio as-is,
     * and hope for the best... */
 
-   p_rarch->audio_driver_resampler->process(
-         p_rarch->audio_driver_resampler_data, &src_data);
-
-#ifdef HAVE_AUDIOMIXER
-   if (p_rarch->audio_mixer_active)
+   /* Only the final samples make it to the (large) output
+    * buffer, already in the format the driver takes. */
+   for (i = 0; i < samples; i += AUDIO_BLOCK_FRAMES * 2)
    {
-      bool override                       = true;
-      float mixer_gain                    = 0.0f;
-      bool audio_driver_mixer_mute_enable =
-         p_rarch->audio_driver_mixer_mute_enable;
+      size_t block_samples          = samples - i;
+      const float *in               = p_rarch->audio_driver_input_data;
+      size_t in_frames;
+
+      if (block_samples > AUDIO_BLOCK_FRAMES * 2)
+         block_samples              = AUDIO_BLOCK_FRAMES * 2;
+      in_frames                     = block_samples >> 1;
 
-      if (!audio_driver_mixer_mute_enable)
+      convert_s16_to_float(p_rarch->audio_driver_input_data,
+            data + i, block_samples, audio_volume_gain);
+
+#ifdef HAVE_DSP_FILTER
+      if (p_rarch->audio_driver_dsp)
       {
-         if (p_rarch->audio_driver_mixer_volume_gain == 1.0f)
-            override                      = false;
-         mixer_gain                       =
-            p_rarch->audio_driver_mixer_volume_gain;
+         struct retro_dsp_data dsp_data;
+
+         dsp_data.input             = p_rarch->audio_driver_input_data;
+         dsp_data.input_frames      = (unsigned)in_frames;
+         dsp_data.output            = NULL;
+         dsp_data.output_frames     = 0;
+
+         retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            in                      = dsp_data.output;
+            in_frames               = dsp_data.output_frames;
+         }
       }
-      audio_mixer_mix(
-            p_rarch->audio_driver_output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
-   }
 #endif
 
-   {
-      const void *output_data = p_rarch->audio_driver_output_samples_buf;
-      unsigned output_frames  = (unsigned)src_data.output_frames;
-
-      if (p_rarch->audio_driver_use_float)
-         output_frames       *= sizeof(float);
-      else
+      /* A filter may hand back more than one block's worth
+       * if it buffers internally; keep the resampler's output
+       * within the block buffer regardless. */
+      while (in_frames)
       {
-         convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
+         size_t frames              = in_frames;
+         float *out                 = use_float
+            ? output_buf + output_frames * 2
+            : block_buf  + block_frames  * 2;
+
+         if (frames > AUDIO_BLOCK_FRAMES)
+            frames                  = AUDIO_BLOCK_FRAMES;
 
-         output_data          = p_rarch->audio_driver_output_samples_conv_buf;
-         output_frames       *= sizeof(int16_t);
+         src_data.data_in           = in;
+         src_data.input_frames      = frames;
+         src_data.data_out          = out;
+         src_data.output_frames     = 0;
+
+         p_rarch->audio_driver_resampler->process(
+               p_rarch->audio_driver_resampler_data, &src_data);
+
+#ifdef HAVE_AUDIOMIXER
+         if (p_rarch->audio_mixer_active)
+            audio_mixer_mix(out, src_data.output_frames,
+                  mixer_gain, mixer_override);
+#endif
+
+         if (use_float)
+            output_frames          += src_data.output_frames;
+         else
+         {
+            /* Whole groups of four frames only, so that both
+             * ends of every conversion stay 16-byte aligned
+             * (which some of the SIMD paths rely on); the rest
+             * is converted along with the next block. */
+            size_t ready            = (block_frames +
+                  src_data.output_frames) & ~(size_t)3;
+
+            convert_float_to_s16((int16_t*)output_buf + output_frames * 2,
+                  block_buf, ready * 2);
+
+            block_frames           += src_data.output_frames - ready;
+            memmove(block_buf, block_buf + ready * 2,
+                  block_frames * 2 * sizeof(float));
+            output_frames          += ready;
+         }
+
+         in                        += frames * 2;
+         in_frames                 -= frames;
       }
+   }
 
-      if (p_rarch->current_audio->write(
-               p_rarch->audio_driver_context_audio_data,
-               output_data, output_frames * 2) < 0)
-         p_rarch->audio_driver_active = false;
+   if (block_frames)
+   {
+      convert_float_to_s16((int16_t*)output_buf + output_frames * 2,
+            block_buf, block_frames * 2);
+      output_frames                += block_frames;
    }
+
+   if (p_rarch->current_audio->write(
+            p_rarch->audio_driver_context_audio_data,
+            output_buf, output_frames * 2 *
+            (use_float ? sizeof(float) : sizeof(int16_t))) < 0)
+      p_rarch->audio_driver_active = false;
 }
 
 /**
@@ -31943,6 +32216,46 @@ static void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+#ifdef HAVE_NETWORKING
+      if (p_rarch->netplay_data)
+      {
+         struct netplay_stats netplay_stats;
+         size_t _len = strlen(video_info.stat_text);
+
+         netplay_get_stats(p_rarch->netplay_data, &netplay_stats);
+         snprintf(video_info.stat_text + _len,
+               sizeof(video_info.stat_text) - _len,
+               "Netplay Statistics:\n -Input latency: %u frames\n -Ping: %.1f ms\n"
+               " -Replay depth: %u (max %u)\n -Replayed frames: %u fps\n -Replay behind: %u frames\n"
+               " -Replay frame: %.2f ms run, %.2f ms save\n -Replay load: %.2f ms\n",
+               netplay_stats.input_latency_frames,
+               netplay_stats.rtt / 1000.0f,
+               netplay_stats.replay_depth,
+               netplay_stats.replay_depth_max,
+               netplay_stats.replay_frames_per_second,
+               netplay_stats.replay_behind,
+               netplay_stats.replay_run_time / 1000.0f,
+               netplay_stats.replay_serialize_time / 1000.0f,
+               netplay_stats.replay_unserialize_time / 1000.0f);
+      }
+#endif
+
+#ifdef HAVE_RUNAHEAD
+      if (     p_rarch->runahead_state_frames
+            && p_rarch->configuration_settings->bools.run_ahead_enabled)
+      {
+         size_t _len = strlen(video_info.stat_text);
+
+         snprintf(video_info.stat_text + _len,
+               sizeof(video_info.stat_text) - _len,
+               "Runahead Statistics:\n -Savestate size: %u bytes\n"
+               " -State bytes moved: %u per frame\n",
+               (unsigned)p_rarch->runahead_save_state_size,
+               (unsigned)(p_rarch->runahead_state_bytes
+                  / p_rarch->runahead_state_frames));
+      }
+#endif
+
       /* TODO/FIXME - add OSD chat text here */
    }
 
@@ -33971,48 +34284,42 @@ static void remove_input_state_hook(struct rarch_state *p_rarch)
    }
 }
 
-static void *runahead_save_state_alloc(void)
+/* The runahead savestate is one cache line aligned buffer the core
+ * serializes into and loads from in place - the frontend never
+ * copies the state. A failed save turns runahead off altogether,
+ * so there is never an older state worth keeping next to it. */
+static void runahead_save_state_buf_free(struct rarch_state *p_rarch)
 {
-   struct rarch_state *p_rarch           = &rarch_st;
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)
-      malloc(sizeof(retro_ctx_serialize_info_t));
-
-   if (!savestate)
-      return NULL;
-
-   savestate->data          = NULL;
-   savestate->data_const    = NULL;
-   savestate->size          = 0;
-
-   if (  (p_rarch->runahead_save_state_size > 0) &&
-         p_rarch->runahead_save_state_size_known)
+   if (p_rarch->runahead_save_state_buf)
    {
-      savestate->data       = malloc(p_rarch->runahead_save_state_size);
-      savestate->data_const = savestate->data;
-      savestate->size       = p_rarch->runahead_save_state_size;
-   }
-
-   return savestate;
-}
+      memalign_free(p_rarch->runahead_save_state_buf);
 
-static void runahead_save_state_free(void *data)
-{
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)data;
-   if (!savestate)
-      return;
-   free(savestate->data);
-   free(savestate);
+      if (p_rarch->runahead_state_frames)
+         RARCH_LOG("[Runahead] Moved %u savestate bytes per frame"
+               " over %u frames.\n",
+               (unsigned)(p_rarch->runahead_state_bytes
+                  / p_rarch->runahead_state_frames),
+               (unsigned)p_rarch->runahead_state_frames);
+   }
+   p_rarch->runahead_save_state_buf = NULL;
+   p_rarch->runahead_state_bytes    = 0;
+   p_rarch->runahead_state_frames   = 0;
 }
 
-static void runahead_save_state_list_init(
+static void runahead_save_state_buf_init(
       struct rarch_state *p_rarch,
       size_t save_state_size)
 {
    p_rarch->runahead_save_state_size       = save_state_size;
    p_rarch->runahead_save_state_size_known = true;
 
-   mylist_create(&p_rarch->runahead_save_state_list, 16,
-         runahead_save_state_alloc, runahead_save_state_free);
+   runahead_save_state_buf_free(p_rarch);
+
+   if (save_state_size == 0)
+      return;
+
+   p_rarch->runahead_save_state_buf        = (uint8_t*)memalign_alloc(64,
+         (save_state_size + 63) & ~(size_t)63);
 }
 
 /* Hooks - Hooks to cleanup, and add dirty input hooks */
@@ -34034,7 +34341,7 @@ static void runahead_remove_hooks(struct rarch_state *p_rarch)
 
 static void runahead_destroy(struct rarch_state *p_rarch)
 {
-   mylist_destroy(&p_rarch->runahead_save_state_list);
+   runahead_save_state_buf_free(p_rarch);
    runahead_remove_hooks(p_rarch);
    runahead_clear_variables(p_rarch);
 }
@@ -34083,7 +34390,7 @@ static void runahead_add_hooks(struct rarch_state *p_rarch)
 static void runahead_error(struct rarch_state *p_rarch)
 {
    p_rarch->runahead_available             = false;
-   mylist_destroy(&p_rarch->runahead_save_state_list);
+   runahead_save_state_buf_free(p_rarch);
    runahead_remove_hooks(p_rarch);
    p_rarch->runahead_save_state_size       = 0;
    p_rarch->runahead_save_state_size_known = true;
@@ -34098,12 +34405,13 @@ static bool runahead_create(struct rarch_state *p_rarch)
    core_serialize_size(&info);
    p_rarch->request_fast_savestate          = false;
 
-   runahead_save_state_list_init(p_rarch, info.size);
+   runahead_save_state_buf_init(p_rarch, info.size);
    p_rarch->runahead_video_driver_is_active =
       p_rarch->video_driver_active;
 
    if (  (p_rarch->runahead_save_state_size == 0) ||
-         !p_rarch->runahead_save_state_size_known)
+         !p_rarch->runahead_save_state_size_known ||
+         !p_rarch->runahead_save_state_buf)
    {
       runahead_error(p_rarch);
       return false;
@@ -34111,28 +34419,30 @@ static bool runahead_create(struct rarch_state *p_rarch)
 
    runahead_add_hooks(p_rarch);
    p_rarch->runahead_force_input_dirty = true;
-   if (p_rarch->runahead_save_state_list)
-      mylist_resize(p_rarch->runahead_save_state_list, 1, true);
    return true;
 }
 
 static bool runahead_save_state(struct rarch_state *p_rarch)
 {
-   retro_ctx_serialize_info_t *serialize_info;
+   retro_ctx_serialize_info_t serialize_info;
    bool okay                       = false;
 
-   if (!p_rarch->runahead_save_state_list)
+   if (!p_rarch->runahead_save_state_buf)
       return false;
 
-   serialize_info                  =
-      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[0];
+   serialize_info.data             = p_rarch->runahead_save_state_buf;
+   serialize_info.data_const       = serialize_info.data;
+   serialize_info.size             = p_rarch->runahead_save_state_size;
 
    p_rarch->request_fast_savestate = true;
-   okay                            = core_serialize(serialize_info);
+   okay                            = core_serialize(&serialize_info);
    p_rarch->request_fast_savestate = false;
 
    if (okay)
+   {
+      p_rarch->runahead_state_bytes += serialize_info.size;
       return true;
+   }
 
    runahead_error(p_rarch);
    return false;
@@ -34141,8 +34451,6 @@ static bool runahead_save_state(struct rarch_state *p_rarch)
 static bool runahead_load_state(struct rarch_state *p_rarch)
 {
    bool okay                                  = false;
-   retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      p_rarch->runahead_save_state_list->data[0];
    bool last_dirty                            = p_rarch->input_is_dirty;
 
    p_rarch->request_fast_savestate            = true;
@@ -34150,28 +34458,32 @@ static bool runahead_load_state(struct rarch_state *p_rarch)
     * netplay (it triggers transmitting your save state)
       call retro_unserialize directly from the core instead */
    okay = p_rarch->current_core.retro_unserialize(
-         serialize_info->data_const, serialize_info->size);
+         p_rarch->runahead_save_state_buf,
+         p_rarch->runahead_save_state_size);
 
    p_rarch->request_fast_savestate            = false;
    p_rarch->input_is_dirty                    = last_dirty;
 
    if (!okay)
+   {
       runahead_error(p_rarch);
+      return false;
+   }
 
-   return okay;
+   p_rarch->runahead_state_bytes += p_rarch->runahead_save_state_size;
+   return true;
 }
 
 #if HAVE_DYNAMIC
 static bool runahead_load_state_secondary(struct rarch_state *p_rarch)
 {
    bool okay                                  = false;
-   retro_ctx_serialize_info_t *serialize_info =
-      (retro_ctx_serialize_info_t*)p_rarch->runahead_save_state_list->data[0];
 
    p_rarch->request_fast_savestate            = true;
    okay                                       = secondary_core_deserialize(
          p_rarch, p_rarch->configuration_settings,
-         serialize_info->data_const, (int)serialize_info->size);
+         p_rarch->runahead_save_state_buf,
+         (int)p_rarch->runahead_save_state_size);
    p_rarch->request_fast_savestate            = false;
 
    if (!okay)
@@ -34181,6 +34493,7 @@ static bool runahead_load_state_secondary(struct rarch_state *p_rarch)
       return false;
    }
 
+   p_rarch->runahead_state_bytes += p_rarch->runahead_save_state_size;
    return true;
 }
 #endif
@@ -34244,6 +34557,10 @@ static void do_runahead(
 
    p_rarch->runahead_last_frame_count     = frame_count;
 
+   /* Frames run ahead, for the state bytes moved per frame
+    * shown in the statistics */
+   p_rarch->runahead_state_frames++;
+
    if (     !use_secondary
          || !have_dynamic
          || !p_rarch->runahead_secondary_core_available)
@@ -36317,7 +36634,9 @@ void retroarch_init_task_queue(void)
 #endif
 
    task_queue_deinit();
+   task_image_pool_deinit();
    task_queue_init(threaded_enable, runloop_task_msg_queue_push);
+   task_image_pool_init();
 }
 
 bool rarch_ctl(enum rarch_ctl_state state, void *data)
@@ -36950,6 +37269,8 @@ int retroarch_get_capabilities(enum rarch_capabilities type,
                strlcat(s, " AVX", len);
             if (cpu & RETRO_SIMD_AVX2)
                strlcat(s, " AVX2", len);
+            if (cpu & RETRO_SIMD_FMA3)
+               strlcat(s, " FMA3", len);
             if (cpu & RETRO_SIMD_NEON)
                strlcat(s, " NEON", len);
             if (cpu & RETRO_SIMD_VFPV3)
@@ -1761,6 +1761,8 @@ struct rarch_state
 
 #ifdef HAVE_RUNAHEAD
    uint64_t runahead_last_frame_count;
+   uint64_t runahead_state_bytes;
+   uint64_t runahead_state_frames;
 #endif
 
    uint64_t video_driver_frame_time_count;
@@ -1782,6 +1784,7 @@ struct rarch_state
    uint8_t *midi_drv_output_buffer;
    bool    *load_no_content_hook;
    float   *audio_driver_output_samples_buf;
+   float   *audio_driver_output_block_buf;
    char    *osk_grid[45];
 #if defined(HAVE_RUNAHEAD)
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
@@ -1895,7 +1898,7 @@ struct rarch_state
 #endif
    frontend_ctx_driver_t *current_frontend_ctx;
 #ifdef HAVE_RUNAHEAD
-   my_list *runahead_save_state_list;
+   uint8_t *runahead_save_state_buf;
    my_list *input_state_list;
 #endif
 
@@ -0,0 +1,488 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Cheat search benchmark.
+ *
+ * Makes a synthetic memory map the size of a console's RAM
+ * (16 MB unless told otherwise), split into buffers of odd
+ * sizes, and hunts for a few counters in it with every search
+ * size and byte order. Between searches the counters go up or
+ * down and some of the rest of memory changes at random.
+ *
+ * The first search, which goes through all of memory, and the
+ * ones after it are timed. The matches of every search are
+ * checked against a plain search of the same memory.
+ *
+ * Usage: cheat_search_bench [megabytes] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <features/features_cpu.h>
+
+#include "../../cheat_manager.h"
+#include "../../core.h"
+#include "../../retroarch.h"
+#include "../../msg_hash.h"
+#include "../../configuration.h"
+#include "../../input/input_driver.h"
+
+#define BENCH_BUFFERS        3
+#define BENCH_COUNTERS       16
+/* Matches are compared one by one when
+ * there are no more than this many */
+#define BENCH_CHECK_MATCHES  256
+
+struct bench_step
+{
+   enum cheat_search_type type;
+   int counter_delta;
+   unsigned value;
+};
+
+/* What each search expects the counters to have done */
+static const struct bench_step bench_steps[] = {
+   { CHEAT_SEARCH_TYPE_EQ,       0, 0 },
+   { CHEAT_SEARCH_TYPE_GT,       1, 0 },
+   { CHEAT_SEARCH_TYPE_GTE,      0, 0 },
+   { CHEAT_SEARCH_TYPE_EQPLUS,   3, 3 },
+   { CHEAT_SEARCH_TYPE_LT,      -1, 0 },
+   { CHEAT_SEARCH_TYPE_EQMINUS, -2, 2 },
+   { CHEAT_SEARCH_TYPE_NEQ,      5, 0 },
+   { CHEAT_SEARCH_TYPE_LTE,      0, 0 },
+   { CHEAT_SEARCH_TYPE_EXACT,    0, 0 }
+};
+
+static rarch_system_info_t bench_system;
+static rarch_memory_descriptor_t bench_descriptors[BENCH_BUFFERS];
+static unsigned bench_counters[BENCH_COUNTERS];
+static uint8_t *bench_prev        = NULL;
+static uint8_t *bench_matches     = NULL;
+static unsigned bench_num_matches = 0;
+static unsigned bench_size        = 0;
+static unsigned bench_errors      = 0;
+static uint32_t bench_seed        = 1;
+
+/* Frontend stubs */
+rarch_system_info_t *runloop_get_system_info(void) { return &bench_system; }
+settings_t *config_get_ptr(void) { return NULL; }
+global_t *global_get_ptr(void) { return NULL; }
+bool core_get_memory(retro_ctx_memory_info_t *info) { return false; }
+bool core_get_system_info(struct retro_system_info *system) { return false; }
+bool core_set_cheat(retro_ctx_cheat_info_t *info) { return false; }
+bool core_reset_cheat(void) { return false; }
+bool input_driver_set_rumble_state(unsigned port,
+      enum retro_rumble_effect effect, uint16_t strength) { return false; }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return "%u"; }
+void runloop_msg_queue_push(const char *msg,
+      unsigned prio, unsigned duration,
+      bool flush,
+      char *title,
+      enum message_queue_icon icon, enum message_queue_category category) { }
+void RARCH_LOG(const char *fmt, ...) { }
+
+static uint32_t bench_rand(void)
+{
+   bench_seed ^= bench_seed << 13;
+   bench_seed ^= bench_seed >> 17;
+   bench_seed ^= bench_seed << 5;
+   return bench_seed;
+}
+
+static uint8_t *bench_byte(unsigned address)
+{
+   unsigned i;
+
+   for (i = 0; i < BENCH_BUFFERS; i++)
+   {
+      if (address < bench_descriptors[i].core.len)
+         return (uint8_t*)bench_descriptors[i].core.ptr + address;
+      address -= (unsigned)bench_descriptors[i].core.len;
+   }
+
+   return NULL;
+}
+
+static unsigned bench_value(const uint8_t *s, unsigned bytes,
+      bool big_endian)
+{
+   unsigned i;
+   unsigned value = 0;
+
+   for (i = 0; i < bytes; i++)
+      value |= (unsigned)s[i] << ((big_endian ? bytes - 1 - i : i) * 8);
+
+   return value;
+}
+
+/* Memory as one buffer */
+static void bench_read_memory(uint8_t *s)
+{
+   unsigned i;
+
+   for (i = 0; i < BENCH_BUFFERS; i++)
+   {
+      memcpy(s, bench_descriptors[i].core.ptr, bench_descriptors[i].core.len);
+      s += bench_descriptors[i].core.len;
+   }
+}
+
+static unsigned bench_item_value(const uint8_t *s, unsigned item,
+      unsigned bits, unsigned bytes, bool big_endian)
+{
+   if (bits < 8)
+   {
+      unsigned items_per_byte = 8 / bits;
+      return (s[item / items_per_byte] >> ((item % items_per_byte) * bits))
+         & ((1u << bits) - 1);
+   }
+
+   return bench_value(s + item * bytes, bytes, big_endian);
+}
+
+static unsigned bench_get_counter(unsigned i, unsigned bytes,
+      bool big_endian)
+{
+   unsigned j;
+   uint8_t s[4];
+
+   for (j = 0; j < bytes; j++)
+      s[j] = *bench_byte(bench_counters[i] + j);
+
+   return bench_value(s, bytes, big_endian);
+}
+
+static void bench_set_counter(unsigned i, unsigned value, unsigned bytes,
+      bool big_endian)
+{
+   unsigned j;
+
+   for (j = 0; j < bytes; j++)
+      *bench_byte(bench_counters[i] + j) = (uint8_t)(value
+            >> ((big_endian ? bytes - 1 - j : j) * 8));
+}
+
+static void bench_change_memory(int counter_delta, unsigned bytes,
+      bool big_endian)
+{
+   unsigned i;
+
+   /* Half a percent of memory changes at random */
+   for (i = 0; i < bench_size / 200; i++)
+      *bench_byte(bench_rand() % bench_size) = (uint8_t)bench_rand();
+
+   for (i = 0; i < BENCH_COUNTERS; i++)
+      bench_set_counter(i, bench_get_counter(i, bytes, big_endian)
+            + counter_delta, bytes, big_endian);
+}
+
+/* The search, one item at a time */
+static void bench_search(const struct bench_step *step, unsigned bits,
+      unsigned bytes, bool big_endian, uint8_t *curr)
+{
+   unsigned i;
+   unsigned num_items = (bits < 8)
+      ? bench_size * (8 / bits) : bench_size / bytes;
+
+   bench_read_memory(curr);
+
+   for (i = 0; i < num_items; i++)
+   {
+      bool match;
+      unsigned curr_val, prev_val;
+
+      if (!bench_matches[i])
+         continue;
+
+      curr_val = bench_item_value(curr,       i, bits, bytes, big_endian);
+      prev_val = bench_item_value(bench_prev, i, bits, bytes, big_endian);
+
+      switch (step->type)
+      {
+         case CHEAT_SEARCH_TYPE_EXACT:
+            match = (curr_val == cheat_manager_state.search_exact_value);
+            break;
+         case CHEAT_SEARCH_TYPE_LT:
+            match = (curr_val < prev_val);
+            break;
+         case CHEAT_SEARCH_TYPE_GT:
+            match = (curr_val > prev_val);
+            break;
+         case CHEAT_SEARCH_TYPE_LTE:
+            match = (curr_val <= prev_val);
+            break;
+         case CHEAT_SEARCH_TYPE_GTE:
+            match = (curr_val >= prev_val);
+            break;
+         case CHEAT_SEARCH_TYPE_EQ:
+            match = (curr_val == prev_val);
+            break;
+         case CHEAT_SEARCH_TYPE_NEQ:
+            match = (curr_val != prev_val);
+            break;
+         case CHEAT_SEARCH_TYPE_EQPLUS:
+            match = (curr_val == prev_val + step->value);
+            break;
+         case CHEAT_SEARCH_TYPE_EQMINUS:
+         default:
+            match = (curr_val == prev_val - step->value);
+            break;
+      }
+
+      if (!match)
+      {
+         bench_matches[i] = 0;
+         bench_num_matches--;
+      }
+   }
+
+   memcpy(bench_prev, curr, bench_size);
+}
+
+static void bench_check(unsigned bits, unsigned bytes, bool big_endian)
+{
+   unsigned i;
+   unsigned match     = 0;
+   unsigned num_items = (bits < 8)
+      ? bench_size * (8 / bits) : bench_size / bytes;
+
+   if (cheat_manager_state.num_matches != bench_num_matches)
+   {
+      if (!bench_errors)
+         fprintf(stderr, "%u matches instead of %u\n",
+               cheat_manager_state.num_matches, bench_num_matches);
+      bench_errors++;
+      return;
+   }
+
+   if (bench_num_matches > BENCH_CHECK_MATCHES)
+      return;
+
+   for (i = 0; i < num_items; i++)
+   {
+      unsigned address      = 0;
+      unsigned address_mask = 0;
+      unsigned prev_val     = 0;
+      unsigned curr_val     = 0;
+      unsigned expected_address;
+      unsigned expected_mask;
+
+      if (!bench_matches[i])
+         continue;
+
+      if (bits < 8)
+      {
+         expected_address = i / (8 / bits);
+         expected_mask    = ((1u << bits) - 1) << ((i % (8 / bits)) * bits);
+      }
+      else
+      {
+         expected_address = i * bytes;
+         expected_mask    = 0xFF;
+      }
+
+      cheat_manager_match_action(CHEAT_MATCH_ACTION_TYPE_VIEW, match++,
+            &address, &address_mask, &prev_val, &curr_val);
+
+      if (     address      != expected_address
+            || address_mask != expected_mask
+            || curr_val     != bench_value(bench_prev + expected_address,
+               (bits < 8) ? 1 : bytes, big_endian))
+      {
+         if (!bench_errors)
+            fprintf(stderr, "Match %u at %x/%x instead of %x/%x\n",
+                  match - 1, address, address_mask,
+                  expected_address, expected_mask);
+         bench_errors++;
+      }
+   }
+}
+
+static void bench_hunt(unsigned search_bit_size, bool big_endian)
+{
+   unsigned i;
+   rarch_setting_t *setting = (rarch_setting_t*)&bench_system;
+   unsigned bits            = (search_bit_size < 3) ? 1u << search_bit_size : 8;
+   unsigned bytes           = (search_bit_size > 3) ? 1u << (search_bit_size - 3) : 1;
+   unsigned num_items       = (bits < 8)
+      ? bench_size * (8 / bits) : bench_size / bytes;
+   uint8_t *curr            = (uint8_t*)malloc(bench_size);
+   retro_time_t first       = 0;
+   retro_time_t rest        = 0;
+
+   for (i = 0; i < BENCH_COUNTERS; i++)
+      bench_set_counter(i, 10 + i, bytes, big_endian);
+
+   cheat_manager_state.search_bit_size = search_bit_size;
+   cheat_manager_state.big_endian      = big_endian;
+   cheat_manager_initialize_memory(setting, 0, false);
+
+   bench_read_memory(bench_prev);
+   memset(bench_matches, 1, num_items);
+   bench_num_matches = num_items;
+
+   for (i = 0; i < sizeof(bench_steps) / sizeof(bench_steps[0]); i++)
+   {
+      retro_time_t start;
+      const struct bench_step *step = &bench_steps[i];
+
+      bench_change_memory(step->counter_delta, bytes, big_endian);
+
+      if (step->type == CHEAT_SEARCH_TYPE_EXACT)
+         cheat_manager_state.search_exact_value = bench_get_counter(0,
+               bytes, big_endian) & ((bits < 8) ? (1u << bits) - 1 : 0xFFFFFFFF);
+      else if (step->type == CHEAT_SEARCH_TYPE_EQPLUS)
+         cheat_manager_state.search_eqplus_value  = step->value;
+      else if (step->type == CHEAT_SEARCH_TYPE_EQMINUS)
+         cheat_manager_state.search_eqminus_value = step->value;
+
+      start = cpu_features_get_time_usec();
+      switch (step->type)
+      {
+         case CHEAT_SEARCH_TYPE_EXACT:
+            cheat_manager_search_exact(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_LT:
+            cheat_manager_search_lt(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_LTE:
+            cheat_manager_search_lte(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_GT:
+            cheat_manager_search_gt(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_GTE:
+            cheat_manager_search_gte(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_EQ:
+            cheat_manager_search_eq(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_NEQ:
+            cheat_manager_search_neq(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_EQPLUS:
+            cheat_manager_search_eqplus(NULL, 0, false);
+            break;
+         case CHEAT_SEARCH_TYPE_EQMINUS:
+            cheat_manager_search_eqminus(NULL, 0, false);
+            break;
+      }
+      start = cpu_features_get_time_usec() - start;
+
+      if (i == 0)
+         first  = start;
+      else
+         rest  += start;
+
+      bench_search(step, bits, bytes, big_endian, curr);
+      bench_check(bits, bytes, big_endian);
+   }
+
+   /* Deleting a match */
+   if (bench_num_matches > 0)
+   {
+      unsigned expected = cheat_manager_state.num_matches - 1;
+      cheat_manager_match_action(CHEAT_MATCH_ACTION_TYPE_DELETE, 0,
+            NULL, NULL, NULL, NULL);
+      if (cheat_manager_state.num_matches != expected)
+         bench_errors++;
+   }
+
+   printf("%2u-bit %s  first search %9.2f ms, next %u %9.2f ms, %u matches left\n",
+         (bits < 8) ? bits : bytes * 8,
+         big_endian ? "BE" : "LE",
+         first / 1000.0,
+         (unsigned)(sizeof(bench_steps) / sizeof(bench_steps[0])) - 1,
+         rest / 1000.0, bench_num_matches);
+
+   free(curr);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   unsigned megabytes = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : 16;
+
+   if (!megabytes)
+      return 1;
+
+   /* Main RAM, then two smaller buffers, none of
+    * which is a multiple of the item sizes */
+   bench_size                       = megabytes * 1024 * 1024;
+   bench_descriptors[0].core.len    = bench_size / 2 + 3;
+   bench_descriptors[1].core.len    = bench_size / 4 + 6;
+   bench_descriptors[2].core.len    = bench_size
+      - bench_descriptors[0].core.len - bench_descriptors[1].core.len;
+
+   for (i = 0; i < BENCH_BUFFERS; i++)
+   {
+      unsigned j;
+      uint8_t *ptr = (uint8_t*)malloc(bench_descriptors[i].core.len);
+
+      if (!ptr)
+         return 1;
+
+      /* Mostly zeroes and small numbers, as RAM is */
+      for (j = 0; j < bench_descriptors[i].core.len; j++)
+         ptr[j] = (bench_rand() % 4) ? 0 : (uint8_t)(bench_rand() % 16);
+
+      bench_descriptors[i].core.ptr   = ptr;
+      bench_descriptors[i].core.flags = RETRO_MEMDESC_SYSTEM_RAM;
+   }
+
+   bench_system.mmaps.descriptors     = bench_descriptors;
+   bench_system.mmaps.num_descriptors = BENCH_BUFFERS;
+
+   /* Aligned to 4, a few across buffers */
+   for (i = 0; i < BENCH_COUNTERS; i++)
+      bench_counters[i] = (bench_rand() % (bench_size - 4)) & ~3u;
+   bench_counters[1] = (unsigned)bench_descriptors[0].core.len - 1;
+   bench_counters[2] = (unsigned)(bench_descriptors[0].core.len
+         + bench_descriptors[1].core.len) - 2;
+
+   bench_prev    = (uint8_t*)malloc(bench_size);
+   /* One byte per item, as many as there are bits */
+   bench_matches = (uint8_t*)malloc((size_t)bench_size * 8);
+
+   if (!bench_prev || !bench_matches)
+      return 1;
+
+   cheat_manager_alloc_if_empty();
+
+   printf("%u MB of memory\n", megabytes);
+
+   for (i = 0; i <= 5; i++)
+   {
+      bench_hunt(i, false);
+      if (i > 3)
+         bench_hunt(i, true);
+   }
+
+   cheat_manager_state_free();
+
+   for (i = 0; i < BENCH_BUFFERS; i++)
+      free(bench_descriptors[i].core.ptr);
+   free(bench_prev);
+   free(bench_matches);
+
+   if (bench_errors)
+   {
+      printf("%u checks went wrong\n", bench_errors);
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,284 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Core info startup benchmark.
+ *
+ * Makes a cores directory with dummy cores and an info
+ * directory with a .info file for each, then times the
+ * core info list being built:
+ * - from the .info files alone (no cache),
+ * - cold (no cache file yet, so it is written),
+ * - warm (from the cache file),
+ * and how long it takes to look up every core of a warm
+ * list, which decodes the fields that were left in the
+ * cache. Every core read from the cache is checked
+ * against the same core read from its .info file.
+ *
+ * Usage: core_info_bench [core count] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#include "../../retroarch.h"
+#include "../../verbosity.h"
+#include "../../core_info.h"
+#include "../../file_path_special.h"
+
+#define BENCH_DIR       "core_info_bench_data"
+#define BENCH_CORES_DIR BENCH_DIR "/cores"
+#define BENCH_INFO_DIR  BENCH_DIR "/info"
+#define BENCH_WARM_RUNS 10
+
+static core_info_state_t bench_core_info_st;
+
+/* Frontend stubs */
+core_info_state_t *coreinfo_get_ptr(void) { return &bench_core_info_st; }
+enum gfx_ctx_api video_context_driver_get_api(void) { return GFX_CTX_NONE; }
+gfx_ctx_flags_t video_driver_get_flags_wrapper(void)
+{
+   gfx_ctx_flags_t flags = {0};
+   return flags;
+}
+const char *video_driver_get_gpu_api_version_string(void) { return NULL; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static bool bench_write_file(const char *path, const char *data)
+{
+   return filestream_write_file(path, data, strlen(data));
+}
+
+static bool bench_make_cores(unsigned count)
+{
+   unsigned i;
+   char path[PATH_MAX_LENGTH];
+   char info[4096];
+
+   path_mkdir(BENCH_CORES_DIR);
+   path_mkdir(BENCH_INFO_DIR);
+
+   for (i = 0; i < count; i++)
+   {
+      snprintf(path, sizeof(path), BENCH_CORES_DIR "/bench%04u_libretro.so", i);
+      if (!bench_write_file(path, "core"))
+         return false;
+
+      /* Roughly the size and shape of the
+       * .info files that ship with cores */
+      snprintf(info, sizeof(info),
+            "display_name = \"Bench System %u (Bench Core %u)\"\n"
+            "authors = \"Author A|Author B|Author C\"\n"
+            "supported_extensions = \"bin|rom|img%u|zip\"\n"
+            "corename = \"Bench Core %u\"\n"
+            "categories = \"Emulator\"\n"
+            "license = \"GPLv2|MAME Non-Commercial\"\n"
+            "permissions = \"\"\n"
+            "display_version = \"v1.%u\"\n"
+            "manufacturer = \"Bench Inc.\"\n"
+            "systemname = \"Bench System %u\"\n"
+            "systemid = \"bench_%u\"\n"
+            "database = \"Bench - System %u|Bench - System %u (Extra)\"\n"
+            "supports_no_game = \"false\"\n"
+            "firmware_count = 3\n"
+            "firmware0_desc = \"bios%u.bin (Bench BIOS)\"\n"
+            "firmware0_path = \"bench/bios%u.bin\"\n"
+            "firmware0_opt = \"false\"\n"
+            "firmware1_desc = \"bios%u_jp.bin (Bench BIOS, Japan)\"\n"
+            "firmware1_path = \"bench/bios%u_jp.bin\"\n"
+            "firmware1_opt = \"true\"\n"
+            "firmware2_desc = \"bios%u_eu.bin (Bench BIOS, Europe)\"\n"
+            "firmware2_path = \"bench/bios%u_eu.bin\"\n"
+            "firmware2_opt = \"true\"\n"
+            "notes = \"(!) bios%u.bin (md5): 0123456789abcdef0123456789abcdef|"
+            "(!) bios%u_jp.bin (md5): 0123456789abcdef0123456789abcdef|"
+            "(!) bios%u_eu.bin (md5): 0123456789abcdef0123456789abcdef\"\n"
+            "description = \"A port of an emulator for the Bench System %u. "
+            "It runs most of the library at full speed on modest hardware, "
+            "supports save states, rewind, netplay and run-ahead, and has "
+            "accurate timing for the few games that depend on it.\"\n",
+            i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i);
+
+      snprintf(path, sizeof(path), BENCH_INFO_DIR "/bench%04u_libretro.info", i);
+      if (!bench_write_file(path, info))
+         return false;
+   }
+
+   return true;
+}
+
+static void bench_delete_cache(void)
+{
+   char path[PATH_MAX_LENGTH];
+   fill_pathname_join(path, BENCH_INFO_DIR, FILE_PATH_CORE_INFO_CACHE,
+         sizeof(path));
+   filestream_delete(path);
+}
+
+static retro_time_t bench_init(bool enable_cache)
+{
+   retro_time_t start = cpu_features_get_time_usec();
+
+   if (!core_info_init_list(BENCH_INFO_DIR, BENCH_CORES_DIR, "so",
+            false, enable_cache))
+   {
+      fprintf(stderr, "Failed to read core info\n");
+      exit(1);
+   }
+
+   return cpu_features_get_time_usec() - start;
+}
+
+static void bench_append(char *s, size_t len, const char *str)
+{
+   strlcat(s, str ? str : "(null)", len);
+   strlcat(s, ";", len);
+}
+
+/* Everything about a core that ends up in
+ * the cache, as one string */
+static char *bench_core_string(core_info_t *info)
+{
+   size_t i;
+   char s[8192];
+
+   s[0] = '\0';
+   bench_append(s, sizeof(s), info->path);
+   bench_append(s, sizeof(s), info->display_name);
+   bench_append(s, sizeof(s), info->display_version);
+   bench_append(s, sizeof(s), info->core_name);
+   bench_append(s, sizeof(s), info->system_manufacturer);
+   bench_append(s, sizeof(s), info->systemname);
+   bench_append(s, sizeof(s), info->system_id);
+   bench_append(s, sizeof(s), info->supported_extensions);
+   bench_append(s, sizeof(s), info->authors);
+   bench_append(s, sizeof(s), info->permissions);
+   bench_append(s, sizeof(s), info->licenses);
+   bench_append(s, sizeof(s), info->categories);
+   bench_append(s, sizeof(s), info->databases);
+   bench_append(s, sizeof(s), info->notes);
+   bench_append(s, sizeof(s), info->required_hw_api);
+   bench_append(s, sizeof(s), info->description);
+   bench_append(s, sizeof(s), info->core_file_id.str);
+
+   for (i = 0; i < info->firmware_count; i++)
+   {
+      bench_append(s, sizeof(s), info->firmware[i].path);
+      bench_append(s, sizeof(s), info->firmware[i].desc);
+      bench_append(s, sizeof(s), info->firmware[i].optional ? "1" : "0");
+   }
+
+   snprintf(s + strlen(s), sizeof(s) - strlen(s), "%u%u%u%u%u",
+         info->has_info, info->supports_no_game,
+         info->database_match_archive_member, info->is_experimental,
+         (unsigned)(info->authors_list ? info->authors_list->size : 0));
+
+   return strdup(s);
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   unsigned count         = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : 500;
+   char **expected        = NULL;
+   core_info_list_t *list = NULL;
+   retro_time_t no_cache;
+   retro_time_t cold;
+   retro_time_t warm      = 0;
+   retro_time_t lookup;
+   unsigned mismatches    = 0;
+   unsigned run;
+
+   if (!count || !bench_make_cores(count))
+   {
+      fprintf(stderr, "Failed to make cores in " BENCH_DIR "\n");
+      return 1;
+   }
+
+   if (!(expected = (char**)calloc(count, sizeof(*expected))))
+      return 1;
+
+   /* Reference: every core straight from its .info file */
+   no_cache = bench_init(false);
+   core_info_get_list(&list);
+   for (i = 0; i < list->count; i++)
+      expected[i] = bench_core_string(core_info_get(list, i));
+   core_info_deinit_list();
+
+   bench_delete_cache();
+   cold = bench_init(true);
+   core_info_deinit_list();
+
+   for (run = 0; run < BENCH_WARM_RUNS; run++)
+   {
+      warm += bench_init(true);
+      core_info_deinit_list();
+   }
+   warm /= BENCH_WARM_RUNS;
+
+   /* Look up every core, as the menu does
+    * when showing core information */
+   bench_init(true);
+   core_info_get_list(&list);
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+      for (i = 0; i < list->count; i++)
+      {
+         core_info_t *info = NULL;
+         core_info_find(list->list[i].path, &info);
+      }
+      lookup = cpu_features_get_time_usec() - start;
+   }
+
+   for (i = 0; i < list->count && i < count; i++)
+   {
+      char *actual = bench_core_string(core_info_get(list, i));
+      if (!string_is_equal(actual, expected[i]))
+      {
+         if (!mismatches)
+            fprintf(stderr, "Mismatch:\n  %s\n  %s\n", expected[i], actual);
+         mismatches++;
+      }
+      free(actual);
+   }
+   core_info_deinit_list();
+
+   printf("%u cores\n", count);
+   printf("  no cache:        %8.2f ms\n", no_cache / 1000.0);
+   printf("  cold (writes):   %8.2f ms\n", cold     / 1000.0);
+   printf("  warm:            %8.2f ms\n", warm     / 1000.0);
+   printf("  look up all:     %8.2f ms\n", lookup   / 1000.0);
+   printf("  mismatches:      %u\n", mismatches);
+
+   for (i = 0; i < count; i++)
+      free(expected[i]);
+   free(expected);
+
+   return mismatches ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Netplay input latency benchmark.
+ *
+ * Two peers run a game at 60 frames a second over a simulated link
+ * that stands in for a lossy, laggy proxy between them: each message
+ * takes a base delay plus some jitter, now and then a spike, and the
+ * odd one is lost and only gets through after a TCP retransmission
+ * timeout. Like over TCP, nothing overtakes what was sent before it.
+ *
+ * Each peer sends its input for a frame as soon as it reads it, which
+ * is input latency frames before running it. Input that arrives after
+ * its frame ran costs a rollback, replaying every frame since.
+ *
+ * Every link is run once with the input latency fixed at a few values
+ * and once with it adjusted by the netplay latency estimates, within
+ * the bounds given. The time is virtual, so the runs are repeatable
+ * and take no time.
+ *
+ * Usage: netplay_latency_bench [seconds] [min frames] [range frames] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../network/netplay/netplay_latency.h"
+
+#define BENCH_FRAME_TIME 16667
+/* Smallest retransmission timeout of Linux */
+#define BENCH_RTO        200000
+
+struct bench_link
+{
+   const char *name;
+   /* One way, in microseconds */
+   retro_time_t delay;
+   retro_time_t jitter;
+   retro_time_t spike;
+   /* Per mille */
+   unsigned spike_rate;
+   unsigned loss_rate;
+};
+
+static const struct bench_link bench_links[] = {
+   { "lan",       500,    300,     0,  0,  0 },
+   { "wan",     35000,   2000,     0,  0,  0 },
+   { "jittery", 25000,   6000, 40000, 30,  0 },
+   { "lossy",   30000,   3000,     0,  0, 20 },
+};
+
+struct bench_peer
+{
+   struct netplay_latency latency;
+   /* Estimate of the round-trip time the way the TCP stack keeps it */
+   retro_time_t srtt;
+   retro_time_t rttvar;
+   /* When the peer read its own input for each frame, 0 if not yet */
+   retro_time_t *read_time;
+   /* When its input for each frame reaches the other peer */
+   retro_time_t *arrival;
+   retro_time_t last_arrival;
+   unsigned self_frame;
+   unsigned delivered;
+   unsigned lower_frames;
+   int input_latency;
+};
+
+struct bench_result
+{
+   unsigned long long latency_sum;
+   unsigned frames;
+   unsigned late;
+   unsigned rollbacks;
+   unsigned max_replay;
+};
+
+static unsigned bench_rand_state;
+
+static unsigned bench_rand(void)
+{
+   bench_rand_state ^= bench_rand_state << 13;
+   bench_rand_state ^= bench_rand_state >> 17;
+   bench_rand_state ^= bench_rand_state << 5;
+   return bench_rand_state;
+}
+
+static retro_time_t bench_delay(const struct bench_link *link, bool *lost)
+{
+   retro_time_t delay = link->delay;
+
+   if (link->jitter)
+      delay += bench_rand() % (2 * link->jitter + 1) - link->jitter;
+   if (link->spike_rate && bench_rand() % 1000 < link->spike_rate)
+      delay += link->spike;
+
+   *lost = link->loss_rate && bench_rand() % 1000 < link->loss_rate;
+   return delay > 0 ? delay : 0;
+}
+
+static void bench_send(struct bench_peer *peer,
+      const struct bench_link *link, unsigned frame, retro_time_t now)
+{
+   bool lost, ack_lost;
+   retro_time_t delay = bench_delay(link, &lost);
+   retro_time_t back  = bench_delay(link, &ack_lost);
+   retro_time_t arrival;
+
+   if (lost)
+      arrival = now + BENCH_RTO + delay;
+   else
+   {
+      /* Same smoothing as the TCP stack, which does not time
+       * retransmitted segments */
+      retro_time_t rtt = delay + back;
+      retro_time_t dev;
+
+      if (!peer->srtt)
+      {
+         peer->srtt   = rtt;
+         peer->rttvar = rtt / 2;
+      }
+      else
+      {
+         dev           = rtt > peer->srtt ? rtt - peer->srtt : peer->srtt - rtt;
+         peer->rttvar += (dev - peer->rttvar) / 4;
+         peer->srtt   += (rtt - peer->srtt)   / 8;
+      }
+      arrival = now + delay;
+   }
+
+   if (arrival < peer->last_arrival)
+      arrival = peer->last_arrival;
+   peer->last_arrival   = arrival;
+   peer->arrival[frame] = arrival;
+}
+
+static void bench_run(const struct bench_link *link, unsigned frames,
+      int min, int max, int fixed, struct bench_result *result)
+{
+   unsigned run, i;
+   struct bench_peer peers[2];
+   unsigned total = frames + max + 1;
+
+   memset(peers, 0, sizeof(peers));
+   memset(result, 0, sizeof(*result));
+   bench_rand_state = 0x9e3779b9;
+
+   for (i = 0; i < 2; i++)
+   {
+      peers[i].read_time     = (retro_time_t*)calloc(total, sizeof(retro_time_t));
+      peers[i].arrival       = (retro_time_t*)calloc(total, sizeof(retro_time_t));
+      peers[i].input_latency = fixed >= 0 ? fixed : min;
+   }
+
+   for (run = 0; run < frames; run++)
+   {
+      retro_time_t now = (retro_time_t)run * BENCH_FRAME_TIME;
+
+      for (i = 0; i < 2; i++)
+      {
+         struct bench_peer *self  = &peers[i];
+         struct bench_peer *other = &peers[i ^ 1];
+         unsigned replay          = 0;
+         unsigned target;
+
+         /* Take in what the other peer's input has arrived by now */
+         while (other->delivered < other->self_frame &&
+               other->arrival[other->delivered] <= now)
+         {
+            unsigned frame = other->delivered++;
+
+            netplay_latency_sample(&self->latency,
+                  self->read_time[frame]
+                  ? now - self->read_time[frame] : 0);
+
+            if (frame < run)
+            {
+               result->late++;
+               if (run - frame > replay)
+                  replay = run - frame;
+            }
+         }
+
+         if (replay)
+         {
+            result->rollbacks++;
+            if (replay > result->max_replay)
+               result->max_replay = replay;
+         }
+
+         if (fixed < 0)
+         {
+            self->latency.rtt     = self->srtt;
+            self->latency.rtt_var = self->rttvar;
+            if (netplay_latency_frames(&self->latency, BENCH_FRAME_TIME,
+                     &target))
+               self->input_latency = netplay_latency_adjust(
+                     self->input_latency, (int)target, min, max,
+                     &self->lower_frames);
+         }
+
+         /* Read and send our own input up to the input latency ahead */
+         while (self->self_frame <= run + self->input_latency &&
+               self->self_frame < total)
+         {
+            self->read_time[self->self_frame] = now;
+            bench_send(self, link, self->self_frame, now);
+            self->self_frame++;
+         }
+
+         result->latency_sum += self->input_latency;
+         result->frames++;
+      }
+   }
+
+   for (i = 0; i < 2; i++)
+   {
+      free(peers[i].read_time);
+      free(peers[i].arrival);
+   }
+}
+
+static void bench_print(const char *link, const char *mode,
+      const struct bench_result *result)
+{
+   printf("%-8s %-10s %6.2f %8.2f%% %10u %11u\n", link, mode,
+         (double)result->latency_sum / result->frames,
+         100.0 * result->late / result->frames,
+         result->rollbacks, result->max_replay);
+}
+
+int main(int argc, char *argv[])
+{
+   size_t l;
+   unsigned seconds = argc > 1 ? (unsigned)atoi(argv[1]) : 300;
+   int min          = argc > 2 ? atoi(argv[2]) : 0;
+   int range        = argc > 3 ? atoi(argv[3]) : 8;
+   unsigned frames  = seconds * 60;
+
+   if (!frames || min < 0 || range < 0)
+   {
+      fprintf(stderr, "Usage: %s [seconds] [min frames] [range frames]\n",
+            argv[0]);
+      return 1;
+   }
+
+   printf("%u frames a peer, input latency %d to %d frames\n\n",
+         frames, min, min + range);
+   printf("%-8s %-10s %6s %9s %10s %11s\n",
+         "link", "latency", "frames", "late", "rollbacks", "max replay");
+
+   for (l = 0; l < sizeof(bench_links) / sizeof(bench_links[0]); l++)
+   {
+      char mode[32];
+      int fixed;
+      struct bench_result result;
+
+      for (fixed = min; fixed <= min + range; fixed += range / 2 ? range / 2 : 1)
+      {
+         snprintf(mode, sizeof(mode), "fixed %d", fixed);
+         bench_run(&bench_links[l], frames, min, min + range, fixed, &result);
+         bench_print(bench_links[l].name, mode, &result);
+      }
+
+      bench_run(&bench_links[l], frames, min, min + range, -1, &result);
+      bench_print(bench_links[l].name, "adaptive", &result);
+   }
+
+   return 0;
+}
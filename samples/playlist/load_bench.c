@@ -0,0 +1,244 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Playlist loading benchmark.
+ *
+ * Writes a playlist of 50000 entries unless told otherwise,
+ * in the JSON format and in the old line-based one, plain
+ * and compressed, then times opening each of them and
+ * reports how much heap the opened playlist takes.
+ *
+ * Every entry read back is checked, and entries are then
+ * updated and deleted, which must not touch strings that
+ * were read from the file. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+#include <streams/file_stream.h>
+#include <features/features_cpu.h>
+
+#include "../../playlist.h"
+#include "../../core_info.h"
+
+#define BENCH_DEFAULT_ENTRIES 50000
+#define BENCH_RUNS            5
+#define BENCH_PATH            "playlist_load_bench.lpl"
+
+static unsigned bench_errors = 0;
+
+/* Frontend stubs */
+bool core_info_find(const char *core_path, core_info_t **core_info) { return false; }
+bool core_info_core_file_id_is_equal(const char *core_path_a,
+      const char *core_path_b) { return false; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static size_t bench_heap_used(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+   struct mallinfo2 info = mallinfo2();
+   return info.uordblks + info.hblkhd;
+#else
+   return 0;
+#endif
+}
+
+static void bench_path(char *s, size_t len, unsigned i)
+{
+   snprintf(s, len, "/bench/roms/Some System/dir%03u/Game %06u (USA) (Rev %u).zip#Game %06u (USA).bin",
+         i % 100, i, i % 3, i);
+}
+
+static void bench_label(char *s, size_t len, unsigned i)
+{
+   snprintf(s, len, "Game %06u (USA) (Rev %u)", i, i % 3);
+}
+
+static void bench_config(playlist_config_t *config, bool old_format,
+      bool compress)
+{
+   memset(config, 0, sizeof(*config));
+   playlist_config_set_path(config, BENCH_PATH);
+   playlist_config_set_base_content_directory(config, NULL);
+   config->capacity   = COLLECTION_SIZE;
+   config->old_format = old_format;
+   config->compress   = compress;
+}
+
+static bool bench_write(unsigned entries, bool old_format, bool compress)
+{
+   unsigned i;
+   playlist_config_t config;
+   playlist_t *playlist = NULL;
+
+   filestream_delete(BENCH_PATH);
+   bench_config(&config, old_format, compress);
+
+   if (!(playlist = playlist_init(&config)))
+      return false;
+
+   for (i = 0; i < entries; i++)
+   {
+      char path[PATH_MAX_LENGTH];
+      char label[64];
+      char crc[16];
+      struct playlist_entry entry = {0};
+
+      bench_path(path, sizeof(path), i);
+      bench_label(label, sizeof(label), i);
+      snprintf(crc, sizeof(crc), "%08X|crc", (i + 1) * 2654435761u);
+
+      entry.path      = path;
+      entry.label     = label;
+      entry.core_path = (char*)"/bench/cores/bench_libretro.so";
+      entry.core_name = (char*)"Bench";
+      entry.db_name   = (char*)"Some System.lpl";
+      entry.crc32     = crc;
+
+      /* Entries are pushed to the top */
+      playlist_push(playlist, &entry);
+   }
+
+   playlist_write_file(playlist);
+   playlist_free(playlist);
+   return true;
+}
+
+static void bench_check(playlist_t *playlist, unsigned entries)
+{
+   unsigned i;
+
+   if (playlist_size(playlist) != entries)
+   {
+      bench_errors++;
+      return;
+   }
+
+   for (i = 0; i < entries; i++)
+   {
+      char path[PATH_MAX_LENGTH];
+      char label[64];
+      const struct playlist_entry *entry = NULL;
+
+      bench_path(path, sizeof(path), entries - 1 - i);
+      bench_label(label, sizeof(label), entries - 1 - i);
+      playlist_get_index(playlist, i, &entry);
+
+      if (     !entry
+            || !string_is_equal(entry->path, path)
+            || !string_is_equal(entry->label, label)
+            || !string_is_equal(entry->core_name, "Bench"))
+         bench_errors++;
+   }
+}
+
+/* Replaces and deletes entries read from the file */
+static void bench_modify(playlist_t *playlist)
+{
+   size_t i;
+
+   for (i = 0; i < playlist_size(playlist); i += 10)
+   {
+      struct playlist_entry update = {0};
+      update.label     = (char*)"Renamed";
+      update.core_name = (char*)"Other";
+      playlist_update(playlist, i, &update);
+   }
+
+   for (i = 0; i < 100 && playlist_size(playlist) > 0; i++)
+      playlist_delete_index(playlist, (i * 7919u) % playlist_size(playlist));
+}
+
+static void bench_load(unsigned entries, bool old_format, bool compress)
+{
+   unsigned run;
+   playlist_config_t config;
+   retro_time_t usec    = 0;
+   size_t heap          = 0;
+   playlist_t *playlist = NULL;
+
+   if (!bench_write(entries, old_format, compress))
+   {
+      bench_errors++;
+      return;
+   }
+
+   bench_config(&config, old_format, compress);
+
+   for (run = 0; run < BENCH_RUNS; run++)
+   {
+      size_t heap_before = bench_heap_used();
+      retro_time_t start = cpu_features_get_time_usec();
+
+      if (!(playlist = playlist_init(&config)))
+      {
+         bench_errors++;
+         return;
+      }
+
+      usec += cpu_features_get_time_usec() - start;
+      heap  = bench_heap_used() - heap_before;
+
+      if (run == 0)
+      {
+         bench_check(playlist, entries);
+         bench_modify(playlist);
+      }
+
+      playlist_free(playlist);
+   }
+
+   printf("%-20s %8u entries in %9.3f ms, %7.2f MB of heap\n",
+         old_format
+            ? (compress ? "old format, rzip"  : "old format")
+            : (compress ? "JSON, rzip"        : "JSON"),
+         entries, usec / 1000.0 / BENCH_RUNS,
+         heap / (1024.0 * 1024.0));
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned entries = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0)
+      : BENCH_DEFAULT_ENTRIES;
+
+   bench_load(entries, false, false);
+   bench_load(entries, false, true);
+   bench_load(entries, true,  false);
+   bench_load(entries, true,  true);
+
+   filestream_delete(BENCH_PATH);
+
+   if (bench_errors)
+   {
+      printf("%u checks went wrong\n", bench_errors);
+      return 1;
+   }
+
+   return 0;
+}
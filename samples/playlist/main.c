@@ -0,0 +1,270 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Playlist lookup benchmark.
+ *
+ * Builds a playlist the way a content scan does (check whether
+ * each file is in it already, then push it), 50000 entries unless
+ * told otherwise, half of them files inside archives. Then times
+ * lookups by path, by archive path only (fuzzy archive matching),
+ * by CRC32 and of missing files, deletes some entries by path,
+ * sorts the playlist and looks everything up again.
+ *
+ * Every lookup is checked against the entry it should find. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#include "../../playlist.h"
+#include "../../core_info.h"
+
+#define BENCH_DEFAULT_ENTRIES 50000
+#define BENCH_DELETES         1000
+
+static unsigned bench_errors = 0;
+
+/* Frontend stubs */
+bool core_info_find(const char *core_path, core_info_t **core_info) { return false; }
+bool core_info_core_file_id_is_equal(const char *core_path_a,
+      const char *core_path_b) { return false; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static void bench_path(char *s, size_t len, unsigned i, bool archive_only)
+{
+   /* Odd entries are files inside archives */
+   if (!(i & 1))
+      snprintf(s, len, "/bench/roms/dir%03u/Game %06u.bin", i % 100, i);
+   else if (archive_only)
+      snprintf(s, len, "/bench/roms/dir%03u/Game %06u.zip", i % 100, i);
+   else
+      snprintf(s, len, "/bench/roms/dir%03u/Game %06u.zip#Game %06u.bin",
+            i % 100, i, i);
+}
+
+static void bench_crc(char *s, size_t len, unsigned i)
+{
+   snprintf(s, len, "%08X|crc", (i + 1) * 2654435761u);
+}
+
+static void bench_label(char *s, size_t len, unsigned i)
+{
+   /* Sorting reverses the order entries were pushed in */
+   snprintf(s, len, "Game %06u", 999999 - i);
+}
+
+static void bench_report(const char *what, unsigned count,
+      retro_time_t start)
+{
+   retro_time_t usec = cpu_features_get_time_usec() - start;
+
+   printf("%-28s %8u in %9.3f ms (%7.3f us each)\n",
+         what, count, usec / 1000.0,
+         count ? (double)usec / count : 0.0);
+}
+
+static void bench_check(playlist_t *playlist, unsigned i, bool deleted)
+{
+   char path[PATH_MAX_LENGTH];
+   char crc[16];
+   char label[32];
+   const struct playlist_entry *entry = NULL;
+
+   bench_path(path, sizeof(path), i, false);
+   bench_crc(crc, sizeof(crc), i);
+   bench_label(label, sizeof(label), i);
+
+   playlist_get_index_by_path(playlist, path, &entry);
+
+   if (deleted ? (entry != NULL) : (!entry || !string_is_equal(entry->label, label)))
+      bench_errors++;
+
+   entry = NULL;
+   playlist_get_index_by_crc32(playlist, crc, &entry);
+
+   if (deleted ? (entry != NULL) : (!entry || !string_is_equal(entry->label, label)))
+      bench_errors++;
+}
+
+static void bench_lookup(playlist_t *playlist, unsigned entries,
+      const bool *deleted, const char *when)
+{
+   unsigned i;
+   char what[64];
+   char path[PATH_MAX_LENGTH];
+   retro_time_t start;
+
+   snprintf(what, sizeof(what), "lookup by path %s", when);
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < entries; i++)
+   {
+      const struct playlist_entry *entry = NULL;
+      char label[32];
+
+      bench_path(path, sizeof(path), i, false);
+      bench_label(label, sizeof(label), i);
+      playlist_get_index_by_path(playlist, path, &entry);
+
+      if (deleted[i] ? (entry != NULL)
+            : (!entry || !string_is_equal(entry->label, label)))
+         bench_errors++;
+   }
+   bench_report(what, entries, start);
+
+   snprintf(what, sizeof(what), "lookup by archive %s", when);
+   start = cpu_features_get_time_usec();
+   for (i = 1; i < entries; i += 2)
+   {
+      bench_path(path, sizeof(path), i, true);
+      if (playlist_entry_exists(playlist, path) == deleted[i])
+         bench_errors++;
+   }
+   bench_report(what, entries / 2, start);
+
+   snprintf(what, sizeof(what), "lookup by CRC32 %s", when);
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < entries; i++)
+   {
+      const struct playlist_entry *entry = NULL;
+      char crc[16];
+
+      bench_crc(crc, sizeof(crc), i);
+      playlist_get_index_by_crc32(playlist, crc, &entry);
+
+      if (deleted[i] ? (entry != NULL) : !entry)
+         bench_errors++;
+   }
+   bench_report(what, entries, start);
+
+   snprintf(what, sizeof(what), "lookup of missing %s", when);
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < entries; i++)
+   {
+      snprintf(path, sizeof(path), "/bench/missing/Game %06u.bin", i);
+      if (playlist_entry_exists(playlist, path))
+         bench_errors++;
+   }
+   bench_report(what, entries, start);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   retro_time_t start;
+   playlist_config_t config;
+   char path[PATH_MAX_LENGTH];
+   unsigned entries     = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0)
+      : BENCH_DEFAULT_ENTRIES;
+   bool *deleted        = NULL;
+   playlist_t *playlist = NULL;
+
+   if (entries < 2)
+      entries = 2;
+
+   memset(&config, 0, sizeof(config));
+   /* No file, so the playlist starts out empty */
+   playlist_config_set_path(&config, "/bench/missing/playlist_bench.lpl");
+   playlist_config_set_base_content_directory(&config, NULL);
+   config.capacity            = COLLECTION_SIZE;
+   config.fuzzy_archive_match = true;
+
+   if (!(playlist = playlist_init(&config)))
+   {
+      fprintf(stderr, "Failed to create playlist\n");
+      return 1;
+   }
+
+   deleted = (bool*)calloc(entries, sizeof(*deleted));
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < entries; i++)
+   {
+      char crc[16];
+      char label[32];
+      struct playlist_entry entry = {0};
+
+      bench_path(path, sizeof(path), i, false);
+      bench_crc(crc, sizeof(crc), i);
+      bench_label(label, sizeof(label), i);
+
+      if (playlist_entry_exists(playlist, path))
+      {
+         bench_errors++;
+         continue;
+      }
+
+      entry.path      = path;
+      entry.label     = label;
+      entry.core_path = (char*)"DETECT";
+      entry.core_name = (char*)"DETECT";
+      entry.db_name   = (char*)"Bench.lpl";
+      entry.crc32     = crc;
+
+      if (!playlist_push(playlist, &entry))
+         bench_errors++;
+   }
+   bench_report("scan (exists + push)", entries, start);
+
+   if (playlist_size(playlist) != entries)
+      bench_errors++;
+
+   bench_lookup(playlist, entries, deleted, "");
+
+   start = cpu_features_get_time_usec();
+   for (i = 0; i < BENCH_DELETES && i < entries / 2; i++)
+   {
+      unsigned j = (i * 7919u) % entries;
+
+      if (deleted[j])
+         continue;
+
+      bench_path(path, sizeof(path), j, false);
+      playlist_delete_by_path(playlist, path);
+      deleted[j] = true;
+   }
+   bench_report("delete by path", i, start);
+
+   for (i = 0; i < entries; i += entries / 16)
+      bench_check(playlist, i, deleted[i]);
+
+   start = cpu_features_get_time_usec();
+   playlist_qsort(playlist);
+   bench_report("sort", 1, start);
+
+   bench_lookup(playlist, entries, deleted, "(sorted)");
+
+   playlist_free(playlist);
+   free(deleted);
+
+   if (bench_errors)
+   {
+      printf("%u lookups went wrong\n", bench_errors);
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,157 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Slang shader cache benchmark.
+ *
+ * Compiles every .slang file under a shaders directory
+ * twice, the way presets do when they are loaded: first
+ * with an empty cache, then with the cache the first run
+ * filled in. The SPIR-V from the cache is checked against
+ * the SPIR-V the compiler made.
+ *
+ * Usage: slang_cache_bench <shaders directory> [cache directory] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <vector>
+
+#include <retro_miscellaneous.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#include "../../configuration.h"
+#include "../../verbosity.h"
+#include "../../gfx/drivers_shader/glslang_cache.h"
+
+static settings_t bench_settings;
+
+/* Frontend stubs */
+settings_t *config_get_ptr(void) { return &bench_settings; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static void bench_clear_cache(void)
+{
+   size_t i;
+   char dir[PATH_MAX_LENGTH];
+   struct string_list *list = NULL;
+
+   if (!glslang_cache_dir(dir, sizeof(dir)))
+      return;
+
+   if (!(list = dir_list_new(dir, "spv", false, false, false, false)))
+      return;
+
+   for (i = 0; i < list->size; i++)
+      filestream_delete(list->elems[i].data);
+
+   string_list_free(list);
+}
+
+static retro_time_t bench_compile(const struct string_list *shaders,
+      std::vector<glslang_output> &outputs, unsigned *failed)
+{
+   size_t i;
+   retro_time_t start = cpu_features_get_time_usec();
+
+   *failed = 0;
+   outputs.clear();
+   outputs.resize(shaders->size);
+
+   for (i = 0; i < shaders->size; i++)
+      if (!glslang_compile_shader(shaders->elems[i].data, &outputs[i]))
+         (*failed)++;
+
+   return cpu_features_get_time_usec() - start;
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   unsigned cold_failed, warm_failed;
+   retro_time_t cold, warm;
+   std::vector<glslang_output> cold_outputs;
+   std::vector<glslang_output> warm_outputs;
+   unsigned mismatches         = 0;
+   struct string_list *shaders = NULL;
+
+   if (argc < 2)
+   {
+      fprintf(stderr,
+            "Usage: %s <shaders directory> [cache directory]\n", argv[0]);
+      return 1;
+   }
+
+   strlcpy(bench_settings.paths.directory_cache,
+         argc > 2 ? argv[2] : "slang_cache_bench.d",
+         sizeof(bench_settings.paths.directory_cache));
+
+   if (     !path_is_directory(bench_settings.paths.directory_cache)
+         && !path_mkdir(bench_settings.paths.directory_cache))
+   {
+      fprintf(stderr, "Could not create cache directory \"%s\"\n",
+            bench_settings.paths.directory_cache);
+      return 1;
+   }
+
+   if (!(shaders = dir_list_new(argv[1], "slang", false, false, false, true))
+         || shaders->size == 0)
+   {
+      fprintf(stderr, "No shaders found in \"%s\"\n", argv[1]);
+      string_list_free(shaders);
+      return 1;
+   }
+
+   bench_clear_cache();
+
+   cold = bench_compile(shaders, cold_outputs, &cold_failed);
+   warm = bench_compile(shaders, warm_outputs, &warm_failed);
+
+   for (i = 0; i < shaders->size; i++)
+   {
+      if (     cold_outputs[i].vertex   != warm_outputs[i].vertex
+            || cold_outputs[i].fragment != warm_outputs[i].fragment)
+      {
+         fprintf(stderr, "SPIR-V of \"%s\" differs from the cached one\n",
+               shaders->elems[i].data);
+         mismatches++;
+      }
+   }
+
+   printf("%-24s %6u shaders in %10.3f ms (%u failed)\n",
+         "compile (cold cache)", (unsigned)shaders->size,
+         cold / 1000.0, cold_failed);
+   printf("%-24s %6u shaders in %10.3f ms (%u failed)\n",
+         "compile (warm cache)", (unsigned)shaders->size,
+         warm / 1000.0, warm_failed);
+   if (warm > 0)
+      printf("%-24s %6.1fx\n", "speedup", (double)cold / warm);
+
+   string_list_free(shaders);
+
+   return (mismatches || cold_failed != warm_failed) ? 1 : 0;
+}
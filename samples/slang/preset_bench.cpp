@@ -0,0 +1,180 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Slang preset compile benchmark.
+ *
+ * Compiles all passes of each .slangp preset the way the
+ * Vulkan and GLCore filter chains do on preset load, with
+ * 1 up to N threads, and reports how long each took. The
+ * shader cache is left off so every run compiles for real.
+ *
+ * Only "shaders" and "shaderN" are read from presets;
+ * #reference presets are not followed.
+ *
+ * Usage: slang_preset_bench <preset or presets directory> [max threads] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <string>
+#include <vector>
+
+#include <retro_miscellaneous.h>
+#include <file/config_file.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
+#include <string/stdstring.h>
+#include <features/features_cpu.h>
+
+#include "../../configuration.h"
+#include "../../verbosity.h"
+#include "../../gfx/drivers_shader/glslang_util.h"
+#include "../../gfx/drivers_shader/glslang_util_cxx.h"
+
+static settings_t bench_settings;
+
+/* Frontend stubs */
+settings_t *config_get_ptr(void) { return &bench_settings; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static bool bench_read_preset(const char *path,
+      std::vector<std::string> &shaders)
+{
+   unsigned i;
+   unsigned passes      = 0;
+   config_file_t *conf  = config_file_new(path);
+
+   if (!conf)
+      return false;
+
+   if (!config_get_uint(conf, "shaders", &passes) || !passes)
+   {
+      config_file_free(conf);
+      return false;
+   }
+
+   for (i = 0; i < passes; i++)
+   {
+      char key[64];
+      char shader[PATH_MAX_LENGTH];
+      char resolved[PATH_MAX_LENGTH];
+
+      snprintf(key, sizeof(key), "shader%u", i);
+
+      if (!config_get_path(conf, key, shader, sizeof(shader)))
+      {
+         config_file_free(conf);
+         return false;
+      }
+
+      fill_pathname_resolve_relative(resolved, path, shader,
+            sizeof(resolved));
+      shaders.push_back(resolved);
+   }
+
+   config_file_free(conf);
+   return true;
+}
+
+static void bench_preset(const char *path, unsigned max_threads)
+{
+   unsigned threads;
+   std::vector<std::string> shaders;
+   std::vector<const char*> paths;
+
+   if (!bench_read_preset(path, shaders))
+   {
+      fprintf(stderr, "Could not read preset \"%s\"\n", path);
+      return;
+   }
+
+   for (auto &shader : shaders)
+      paths.push_back(shader.c_str());
+
+   printf("%s (%u passes)\n", path_basename(path), (unsigned)paths.size());
+
+   for (threads = 1; threads <= max_threads; threads++)
+   {
+      unsigned failed = 0;
+      std::vector<glslang_output> outputs(paths.size());
+      retro_time_t start  = cpu_features_get_time_usec();
+      bool ok             = glslang_compile_shaders(paths.data(),
+            outputs.data(), (unsigned)paths.size(), threads, &failed);
+      retro_time_t usec   = cpu_features_get_time_usec() - start;
+
+      if (!ok)
+      {
+         printf("   failed to compile \"%s\"\n", paths[failed]);
+         return;
+      }
+
+      printf("   %2u threads %10.3f ms\n", threads, usec / 1000.0);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   size_t i;
+   unsigned max_threads = (argc > 2)
+      ? (unsigned)strtoul(argv[2], NULL, 0)
+      : cpu_features_get_core_amount();
+
+   if (argc < 2)
+   {
+      fprintf(stderr,
+            "Usage: %s <preset or presets directory> [max threads]\n",
+            argv[0]);
+      return 1;
+   }
+
+   if (max_threads < 1)
+      max_threads = 1;
+
+   /* No cache directory, so nothing comes from the cache */
+   bench_settings.paths.directory_cache[0] = '\0';
+
+   if (path_is_directory(argv[1]))
+   {
+      struct string_list *presets = dir_list_new(argv[1], "slangp",
+            false, false, false, true);
+
+      if (!presets || presets->size == 0)
+      {
+         fprintf(stderr, "No presets found in \"%s\"\n", argv[1]);
+         string_list_free(presets);
+         return 1;
+      }
+
+      dir_list_sort(presets, true);
+
+      for (i = 0; i < presets->size; i++)
+         bench_preset(presets->elems[i].data, max_threads);
+
+      string_list_free(presets);
+   }
+   else
+      bench_preset(argv[1], max_threads);
+
+   return 0;
+}
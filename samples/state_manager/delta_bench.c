@@ -0,0 +1,493 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Netplay savestate resync benchmark.
+ *
+ * Two instances, a host and a client on its own thread, talk over a
+ * loopback TCP connection. Every few frames of a synthetic 'core', the
+ * host sends its savestate to the client the way netplay does, either
+ * always in full or as a delta against the last one sent, and times
+ * the resync until the client has loaded it and said so.
+ *
+ * The client checks the digests that come with each delta and asks for
+ * the full savestate if they do not match; one run damages its copy
+ * of the last savestate on purpose to go down that path.
+ *
+ * Every savestate the client ends up with is compared to the host's. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <streams/trans_stream.h>
+
+#include "../../state_manager.h"
+#include "../../msg_hash.h"
+#include "../../retroarch.h"
+#include "../../content.h"
+#include "../../core.h"
+#include "../../network/netplay/netplay_private.h"
+
+#define BENCH_RESYNCS       60
+#define BENCH_FRAMES        4
+/* Most cores touch a handful of pages of their state every frame */
+#define BENCH_PAGES_CHANGED 6
+
+struct bench_peer
+{
+   uint8_t  *state;
+   uint8_t  *base;
+   uint64_t *base_hashes;
+   uint64_t *hashes;
+   uint8_t  *patch;
+   uint8_t  *zbuffer;
+   size_t    patch_size;
+   size_t    zbuffer_size;
+   void     *deflate;
+   void     *inflate;
+   int       fd;
+   bool      base_valid;
+};
+
+static const struct trans_stream_backend *bench_zlib = NULL;
+static size_t   bench_state_size = 0;
+static uint32_t bench_seed       = 0;
+static uint64_t bench_wire_bytes = 0;
+static unsigned bench_fallbacks  = 0;
+static bool     bench_damage     = false;
+
+static uint32_t bench_rand(void)
+{
+   bench_seed = bench_seed * 1103515245u + 12345u;
+   return bench_seed >> 8;
+}
+
+/* Frontend stubs */
+size_t content_get_serialized_size(void) { return bench_state_size; }
+bool content_serialize_state(void *buffer, size_t buffer_size) { return false; }
+bool content_deserialize_state(const void *data, size_t size) { return false; }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return "rewind"; }
+bool audio_driver_has_callback(void) { return false; }
+void audio_driver_frame_is_reverse(void) { }
+void audio_driver_setup_rewind(void) { }
+bool core_set_rewind_callbacks(void) { return true; }
+bool rarch_ctl(enum rarch_ctl_state state, void *data) { return false; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static bool bench_send(int fd, const void *buf, size_t len)
+{
+   const uint8_t *data = (const uint8_t*)buf;
+   while (len)
+   {
+      ssize_t sent = send(fd, data, len, 0);
+      if (sent <= 0)
+         return false;
+      data += sent;
+      len  -= sent;
+   }
+   return true;
+}
+
+static bool bench_recv(int fd, void *buf, size_t len)
+{
+   uint8_t *data = (uint8_t*)buf;
+   while (len)
+   {
+      ssize_t recvd = recv(fd, data, len, 0);
+      if (recvd <= 0)
+         return false;
+      data += recvd;
+      len  -= recvd;
+   }
+   return true;
+}
+
+static bool bench_peer_init(struct bench_peer *peer, int fd)
+{
+   size_t num_pages   = state_manager_delta_pages(bench_state_size);
+
+   memset(peer, 0, sizeof(*peer));
+   peer->fd           = fd;
+   peer->patch_size   = state_manager_delta_maxsize(bench_state_size);
+   peer->zbuffer_size = bench_state_size * 2;
+   peer->state        = (uint8_t*)calloc(bench_state_size + 1, 1);
+   peer->base         = (uint8_t*)calloc(bench_state_size + 1, 1);
+   peer->base_hashes  = (uint64_t*)calloc(num_pages, sizeof(uint64_t));
+   peer->hashes       = (uint64_t*)calloc(num_pages, sizeof(uint64_t));
+   peer->patch        = (uint8_t*)malloc(peer->patch_size);
+   peer->zbuffer      = (uint8_t*)malloc(peer->zbuffer_size);
+   peer->deflate      = bench_zlib->stream_new();
+   peer->inflate      = bench_zlib->reverse->stream_new();
+
+   return peer->state && peer->base && peer->base_hashes && peer->hashes
+      && peer->patch && peer->zbuffer && peer->deflate && peer->inflate;
+}
+
+static void bench_peer_free(struct bench_peer *peer)
+{
+   free(peer->state);
+   free(peer->base);
+   free(peer->base_hashes);
+   free(peer->hashes);
+   free(peer->patch);
+   free(peer->zbuffer);
+   if (peer->deflate)
+      bench_zlib->stream_free(peer->deflate);
+   if (peer->inflate)
+      bench_zlib->reverse->stream_free(peer->inflate);
+   close(peer->fd);
+}
+
+static void bench_peer_set_base(struct bench_peer *peer,
+      const uint64_t *hashes)
+{
+   memcpy(peer->base, peer->state, bench_state_size);
+   if (hashes)
+      memcpy(peer->base_hashes, hashes,
+            state_manager_delta_pages(bench_state_size) * sizeof(uint64_t));
+   else
+      state_manager_delta_hash(peer->base, bench_state_size,
+            peer->base_hashes);
+   peer->base_valid = true;
+}
+
+static uint32_t bench_deflate(struct bench_peer *peer,
+      const void *data, size_t len)
+{
+   uint32_t rd, wn;
+   bench_zlib->set_in(peer->deflate, (const uint8_t*)data, (uint32_t)len);
+   bench_zlib->set_out(peer->deflate, peer->zbuffer,
+         (uint32_t)peer->zbuffer_size);
+   bench_zlib->trans(peer->deflate, true, &rd, &wn, NULL);
+   return wn;
+}
+
+static uint32_t bench_inflate(struct bench_peer *peer,
+      size_t in_len, void *data, size_t len)
+{
+   uint32_t rd, wn;
+   bench_zlib->reverse->set_in(peer->inflate, peer->zbuffer,
+         (uint32_t)in_len);
+   bench_zlib->reverse->set_out(peer->inflate, (uint8_t*)data,
+         (uint32_t)len);
+   bench_zlib->reverse->trans(peer->inflate, true, &rd, &wn, NULL);
+   return wn;
+}
+
+/* Host side of netplay_send_savestate: a delta if the client has
+ * the last savestate and not too much changed since, else in full */
+static bool bench_host_send(struct bench_peer *host, bool use_delta)
+{
+   uint32_t header[8];
+   uint32_t wn;
+   size_t header_size = 4 * sizeof(uint32_t);
+
+   header[2] = htonl(0);
+   header[3] = htonl((uint32_t)bench_state_size);
+
+   if (use_delta && host->base_valid)
+   {
+      size_t patch_size = state_manager_delta_compress(host->base,
+            host->state, bench_state_size, host->patch,
+            host->base_hashes, host->hashes);
+
+      if (patch_size < bench_state_size / 2)
+      {
+         uint64_t base_digest  = state_manager_delta_digest(
+               host->base, bench_state_size);
+         uint64_t state_digest = state_manager_delta_digest(
+               host->state, bench_state_size);
+
+         wn          = bench_deflate(host, host->patch, patch_size);
+         header[0]   = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+         header[4]   = htonl((uint32_t)(base_digest >> 32));
+         header[5]   = htonl((uint32_t)base_digest);
+         header[6]   = htonl((uint32_t)(state_digest >> 32));
+         header[7]   = htonl((uint32_t)state_digest);
+         header_size = sizeof(header);
+         header[1]   = htonl(wn + header_size - 2 * sizeof(uint32_t));
+
+         bench_peer_set_base(host, host->hashes);
+         bench_wire_bytes += header_size + wn;
+         return bench_send(host->fd, header, header_size)
+            && bench_send(host->fd, host->zbuffer, wn);
+      }
+   }
+
+   wn        = bench_deflate(host, host->state, bench_state_size);
+   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+   header[1] = htonl(wn + 2 * sizeof(uint32_t));
+
+   if (use_delta)
+      bench_peer_set_base(host, NULL);
+   bench_wire_bytes += header_size + wn;
+   return bench_send(host->fd, header, header_size)
+      && bench_send(host->fd, host->zbuffer, wn);
+}
+
+/* Client side of the NETPLAY_CMD_LOAD_SAVESTATE handler. Answers with
+ * an ACK once loaded, or NETPLAY_CMD_REQUEST_FULL_SAVESTATE. */
+static void bench_client_thread(void *data)
+{
+   struct bench_peer *client = (struct bench_peer*)data;
+
+   for (;;)
+   {
+      uint32_t header[4];
+      uint32_t digests[4];
+      uint32_t cmd, size, reply;
+      size_t header_size = 2 * sizeof(uint32_t);
+
+      if (!bench_recv(client->fd, header, sizeof(header)))
+         break;
+
+      cmd  = ntohl(header[0]);
+      size = ntohl(header[1]);
+      if (cmd == NETPLAY_CMD_DISCONNECT)
+         break;
+
+      if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+      {
+         header_size += sizeof(digests);
+         if (!bench_recv(client->fd, digests, sizeof(digests)))
+            break;
+      }
+
+      if (     size < header_size
+            || size - header_size > client->zbuffer_size
+            || !bench_recv(client->fd, client->zbuffer, size - header_size))
+         break;
+
+      reply = htonl(NETPLAY_CMD_ACK);
+
+      if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+      {
+         uint64_t base_digest  = ((uint64_t)ntohl(digests[0]) << 32)
+            | ntohl(digests[1]);
+         uint64_t state_digest = ((uint64_t)ntohl(digests[2]) << 32)
+            | ntohl(digests[3]);
+         bool ok               = false;
+
+         if (bench_damage)
+         {
+            /* Only top bits, 8 bytes apart, which a digest that
+             * doesn't mix its high bits down would miss */
+            size_t at = (bench_state_size / 3) | 7;
+            client->base[at]     ^= 0x80;
+            client->base[at + 8] ^= 0x80;
+            state_manager_delta_hash(client->base, bench_state_size,
+                  client->base_hashes);
+            bench_damage = false;
+         }
+
+         if (     client->base_valid
+               && state_manager_delta_digest(client->base,
+                  bench_state_size) == base_digest)
+         {
+            uint32_t wn = bench_inflate(client, size - header_size,
+                  client->patch, client->patch_size);
+
+            if (state_manager_delta_apply(client->patch, wn,
+                     client->base, bench_state_size))
+            {
+               ok = state_manager_delta_digest(client->base,
+                     bench_state_size) == state_digest;
+               state_manager_delta_hash(client->base, bench_state_size,
+                     client->base_hashes);
+            }
+         }
+
+         if (ok)
+            memcpy(client->state, client->base, bench_state_size);
+         else
+         {
+            client->base_valid = false;
+            reply              = htonl(NETPLAY_CMD_REQUEST_FULL_SAVESTATE);
+         }
+      }
+      else
+      {
+         bench_inflate(client, size - header_size,
+               client->state, bench_state_size);
+         bench_peer_set_base(client, NULL);
+      }
+
+      if (!bench_send(client->fd, &reply, sizeof(reply)))
+         break;
+   }
+}
+
+/* Runs the synthetic core: a frame counter, a few pages worth of
+ * 'RAM' written all over and a mostly static rest */
+static void bench_run_frame(uint8_t *state)
+{
+   unsigned i;
+   size_t num_pages = bench_state_size / 4096;
+
+   for (i = 0; i < BENCH_PAGES_CHANGED; i++)
+   {
+      size_t page = (i < 2) ? i : bench_rand() % num_pages;
+      unsigned j;
+      for (j = 0; j < 64; j++)
+         state[page * 4096 + (bench_rand() & 4095)] = (uint8_t)bench_rand();
+   }
+}
+
+static bool bench_connect(int *host_fd, int *client_fd)
+{
+   struct sockaddr_in addr;
+   socklen_t addr_len = sizeof(addr);
+   int one            = 1;
+   int listen_fd      = socket(AF_INET, SOCK_STREAM, 0);
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family      = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+   if (     listen_fd < 0
+         || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+         || listen(listen_fd, 1) < 0
+         || getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len) < 0)
+      return false;
+
+   *client_fd = socket(AF_INET, SOCK_STREAM, 0);
+   if (connect(*client_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+      return false;
+   *host_fd   = accept(listen_fd, NULL, NULL);
+   close(listen_fd);
+
+   /* Netplay turns Nagle off too */
+   setsockopt(*host_fd,   IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+   setsockopt(*client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+   return *host_fd >= 0;
+}
+
+static void bench_run(size_t state_size, bool use_delta, bool damage)
+{
+   unsigned i, f;
+   struct bench_peer host, client;
+   int host_fd, client_fd;
+   sthread_t *thread      = NULL;
+   retro_time_t total     = 0;
+   retro_time_t worst     = 0;
+   unsigned mismatches    = 0;
+   uint32_t disconnect[4] = { 0, 0, 0, 0 };
+
+   bench_state_size = state_size;
+   bench_seed       = 1;
+   bench_wire_bytes = 0;
+   bench_fallbacks  = 0;
+
+   if (     !bench_connect(&host_fd, &client_fd)
+         || !bench_peer_init(&host, host_fd)
+         || !bench_peer_init(&client, client_fd))
+   {
+      fprintf(stderr, "Could not set up the peers.\n");
+      exit(1);
+   }
+
+   /* A core's state is far from random */
+   for (i = 0; i < state_size; i++)
+      host.state[i] = (i % 3) ? (uint8_t)(i >> 10) : 0;
+
+   thread = sthread_create(bench_client_thread, &client);
+
+   for (i = 0; i <= BENCH_RESYNCS; i++)
+   {
+      uint32_t reply;
+      retro_time_t start;
+
+      for (f = 0; f < BENCH_FRAMES; f++)
+         bench_run_frame(host.state);
+
+      if (damage && i == BENCH_RESYNCS / 2)
+         bench_damage = true;
+
+      start = cpu_features_get_time_usec();
+      if (     !bench_host_send(&host, use_delta)
+            || !bench_recv(host.fd, &reply, sizeof(reply)))
+         break;
+
+      if (ntohl(reply) == NETPLAY_CMD_REQUEST_FULL_SAVESTATE)
+      {
+         bench_fallbacks++;
+         host.base_valid = false;
+         if (     !bench_host_send(&host, use_delta)
+               || !bench_recv(host.fd, &reply, sizeof(reply)))
+            break;
+      }
+      start = cpu_features_get_time_usec() - start;
+
+      if (memcmp(host.state, client.state, state_size))
+         mismatches++;
+
+      /* The first one is always in full */
+      if (!i)
+         continue;
+      total += start;
+      if (start > worst)
+         worst = start;
+   }
+
+   disconnect[0] = htonl(NETPLAY_CMD_DISCONNECT);
+   bench_send(host.fd, disconnect, sizeof(disconnect));
+   sthread_join(thread);
+
+   printf("%3u MB %-6s%-9s %8.3f ms avg %8.3f ms worst %10.1f KB/resync"
+         "  %u fallback(s), %u mismatch(es)\n",
+         (unsigned)(state_size >> 20),
+         use_delta ? "delta" : "full",
+         damage ? "(damaged)" : "",
+         total / 1000.0 / BENCH_RESYNCS, worst / 1000.0,
+         bench_wire_bytes / 1024.0 / (BENCH_RESYNCS + 1),
+         bench_fallbacks, mismatches);
+
+   bench_peer_free(&host);
+   bench_peer_free(&client);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned s;
+   static const unsigned sizes[] = { 1, 4, 16 };
+
+   if (!(bench_zlib = trans_stream_get_zlib_deflate_backend()))
+      return 1;
+
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+   {
+      bench_run((size_t)sizes[s] << 20, false, false);
+      bench_run((size_t)sizes[s] << 20, true,  false);
+   }
+
+   bench_run(4 << 20, true, true);
+
+   return 0;
+}
@@ -0,0 +1,402 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Rewind frame-time benchmark.
+ *
+ * Drives state_manager_check_rewind() with a synthetic 'core' whose
+ * savestate changes a little every frame, once with the deltas
+ * compressed on the calling thread and once per worker thread count,
+ * each with and without dirty page tracking, then rewinds all the way
+ * back and checks every popped state.
+ *
+ * What the core writes each frame depends on the joypad input, which
+ * is replayed from a BSV movie if one is given (16 polls per frame,
+ * one per button of port 1), or made up otherwise.
+ *
+ * The last runs use a rewind buffer too small to hold all frames,
+ * with and without the compressed buffer behind it.
+ *
+ * Before any of that, a small run checks that frames changing only
+ * the top bit of a few bytes still rewind exactly with dirty page
+ * tracking on; the program fails if they don't. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <features/features_cpu.h>
+
+#include "../../state_manager.h"
+#include "../../msg_hash.h"
+#include "../../retroarch.h"
+#include "../../content.h"
+#include "../../core.h"
+
+#define BENCH_FRAMES 240
+
+static uint8_t  *bench_state      = NULL;
+static size_t    bench_state_size = 0;
+static uint32_t  bench_seed       = 0;
+static uint32_t  bench_hashes[BENCH_FRAMES + 1];
+static unsigned  bench_frame      = 0;
+static unsigned  bench_mismatches = 0;
+static uint32_t  bench_loaded     = 0;
+static FILE     *bench_movie      = NULL;
+static long      bench_movie_pos  = 0;
+/* If set, every state loaded is copied here whole */
+static uint8_t  *bench_loaded_state = NULL;
+
+static uint32_t bench_rand(void)
+{
+   bench_seed = bench_seed * 1103515245u + 12345u;
+   return bench_seed >> 8;
+}
+
+static uint32_t bench_hash(const uint8_t *data, size_t len)
+{
+   size_t i;
+   uint32_t hash = 2166136261u;
+   for (i = 0; i < len; i += 61)
+      hash = (hash ^ data[i]) * 16777619u;
+   return hash;
+}
+
+static bool bench_movie_open(const char *path)
+{
+   uint32_t header[4];
+
+   if (!(bench_movie = fopen(path, "rb")))
+      return false;
+
+   /* Magic, serializer, CRC, then the size of the initial
+    * savestate following the header, little endian */
+   if (fread(header, sizeof(header), 1, bench_movie) != 1)
+      return false;
+
+   bench_movie_pos = (long)sizeof(header) +
+        (long)(((const uint8_t*)&header[3])[0]
+      | ((const uint8_t*)&header[3])[1] << 8
+      | ((const uint8_t*)&header[3])[2] << 16
+      | ((const uint8_t*)&header[3])[3] << 24);
+
+   return fseek(bench_movie, bench_movie_pos, SEEK_SET) == 0;
+}
+
+static uint16_t bench_input(void)
+{
+   unsigned i;
+   uint16_t input = 0;
+
+   if (!bench_movie)
+   {
+      /* Buttons are held for a while rather than mashed */
+      static uint16_t held = 0;
+      if (bench_rand() % 8 == 0)
+         held ^= 1 << (bench_rand() % 16);
+      return held;
+   }
+
+   for (i = 0; i < 16; i++)
+   {
+      int16_t value;
+
+      if (fread(&value, sizeof(value), 1, bench_movie) != 1)
+      {
+         /* Loop the movie */
+         fseek(bench_movie, bench_movie_pos, SEEK_SET);
+         if (fread(&value, sizeof(value), 1, bench_movie) != 1)
+            return 0;
+      }
+
+      if (value)
+         input |= 1 << i;
+   }
+
+   return input;
+}
+
+/* Roughly what a console does in a frame: scattered writes to
+ * work RAM, plus a few KB of VRAM/DMA updates for every button
+ * held, at offsets that depend on the input. */
+static void bench_run_frame(uint16_t input)
+{
+   unsigned i, b;
+   size_t wram  = bench_state_size / 16;
+   size_t pages = bench_state_size / 4096;
+
+   for (i = 0; i < 2048; i++)
+      bench_state[bench_rand() % wram] = (uint8_t)bench_rand();
+
+   for (b = 0; b < 16; b++)
+   {
+      size_t block;
+
+      if (!(input & (1 << b)))
+         continue;
+
+      block = ((bench_frame * 31 + b * 977) % pages) * 4096;
+      for (i = 0; i < 4096 && block + i < bench_state_size; i++)
+         bench_state[block + i] ^= (uint8_t)(i + bench_frame);
+   }
+
+   bench_frame++;
+}
+
+/* Frontend stubs */
+size_t content_get_serialized_size(void) { return bench_state_size; }
+
+bool content_serialize_state(void *buffer, size_t buffer_size)
+{
+   memcpy(buffer, bench_state, buffer_size);
+   return true;
+}
+
+bool content_deserialize_state(const void *data, size_t size)
+{
+   bench_loaded = bench_hash((const uint8_t*)data, size);
+   if (bench_loaded_state)
+      memcpy(bench_loaded_state, data, size);
+   return true;
+}
+
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return "rewind"; }
+bool audio_driver_has_callback(void) { return false; }
+void audio_driver_frame_is_reverse(void) { }
+void audio_driver_setup_rewind(void) { }
+bool core_set_rewind_callbacks(void) { return true; }
+bool rarch_ctl(enum rarch_ctl_state state, void *data) { return false; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+static void bench_run(size_t state_size, size_t buffer_size,
+      unsigned threads, size_t cold_size, bool dirty_pages)
+{
+   unsigned i;
+   char msg[128];
+   unsigned msg_time                       = 0;
+   retro_time_t total                      = 0;
+   retro_time_t worst                      = 0;
+   retro_time_t pop_total                  = 0;
+   retro_time_t pop_worst                  = 0;
+   unsigned pops                           = 0;
+   uint64_t touched                        = 0;
+   struct state_manager_rewind_state rewind_st;
+
+   memset(&rewind_st, 0, sizeof(rewind_st));
+
+   bench_state_size = state_size;
+   bench_state      = (uint8_t*)calloc(1, state_size);
+   bench_seed       = 1;
+   bench_frame      = 0;
+   bench_mismatches = 0;
+
+   if (bench_movie)
+      fseek(bench_movie, bench_movie_pos, SEEK_SET);
+
+   for (i = 0; i < state_size; i += 4)
+      bench_state[i] = (uint8_t)bench_rand();
+
+   /* The first call is swallowed by check_rewind */
+   state_manager_check_rewind(&rewind_st, false, 1, false,
+         msg, sizeof(msg), &msg_time);
+
+   state_manager_event_init(&rewind_st,
+         (unsigned)buffer_size, threads, cold_size, NULL, dirty_pages);
+   bench_hashes[0] = bench_hash(bench_state, state_size);
+
+   for (i = 0; i < BENCH_FRAMES; i++)
+   {
+      retro_time_t start, elapsed;
+
+      bench_run_frame(bench_input());
+      bench_hashes[bench_frame] = bench_hash(bench_state, state_size);
+
+      start   = cpu_features_get_time_usec();
+      state_manager_check_rewind(&rewind_st, false, 1, false,
+            msg, sizeof(msg), &msg_time);
+      elapsed = cpu_features_get_time_usec() - start;
+
+      total  += elapsed;
+      if (elapsed > worst)
+         worst = elapsed;
+   }
+
+   /* Walk back over whatever still fits in the buffer */
+   while (bench_frame > 0)
+   {
+      retro_time_t start, elapsed;
+
+      start   = cpu_features_get_time_usec();
+      state_manager_check_rewind(&rewind_st, true, 1, false,
+            msg, sizeof(msg), &msg_time);
+      elapsed = cpu_features_get_time_usec() - start;
+
+      if (!rewind_st.frame_is_reversed)
+         break;
+
+      if (bench_loaded != bench_hashes[bench_frame])
+         bench_mismatches++;
+
+      pop_total += elapsed;
+      if (elapsed > pop_worst)
+         pop_worst = elapsed;
+      pops++;
+      bench_frame--;
+   }
+
+   /* Popping waited for the last frame to be compressed */
+   touched = rewind_st.state->bytes_touched;
+
+   printf("%4u MB  %-6s %u thread(s)  %3u MB cold  %-5s: push avg %7.3f ms"
+         "  worst %7.3f ms  %7.2f MB touched/frame"
+         "  pop avg %7.3f ms  worst %7.3f ms"
+         "  (rewound to frame %u, %u mismatch(es))\n",
+         (unsigned)(state_size >> 20),
+         threads ? "async" : "sync",
+         threads ? threads : 1,
+         (unsigned)(cold_size >> 20),
+         dirty_pages ? "pages" : "full",
+         total / (double)BENCH_FRAMES / 1000.0,
+         worst / 1000.0,
+         touched / (double)BENCH_FRAMES / (1024.0 * 1024.0),
+         pops ? pop_total / (double)pops / 1000.0 : 0.0,
+         pop_worst / 1000.0,
+         bench_frame, bench_mismatches);
+
+   state_manager_event_deinit(&rewind_st);
+   free(bench_state);
+   bench_state = NULL;
+}
+
+/* Each frame flips the top bit of two bytes of one page, both at
+ * offsets of 7 mod 8 - the bits a weak page hash loses first -
+ * then the whole run is rewound and every state compared in full.
+ * Returns the number of states that didn't come back as saved. */
+static unsigned bench_check_high_bits(void)
+{
+   unsigned i;
+   char msg[128];
+   unsigned msg_time   = 0;
+   unsigned mismatches = 0;
+   size_t state_size   = 64 << 10;
+   size_t pages        = state_size / 4096;
+   uint8_t *states     = NULL;
+   struct state_manager_rewind_state rewind_st;
+
+   memset(&rewind_st, 0, sizeof(rewind_st));
+
+   bench_state_size   = state_size;
+   bench_state        = (uint8_t*)calloc(1, state_size);
+   bench_loaded_state = (uint8_t*)calloc(1, state_size);
+   states             = (uint8_t*)malloc(state_size * (BENCH_FRAMES + 1));
+   bench_seed         = 1;
+
+   for (i = 0; i < state_size; i++)
+      bench_state[i] = (uint8_t)bench_rand();
+
+   state_manager_check_rewind(&rewind_st, false, 1, false,
+         msg, sizeof(msg), &msg_time);
+   state_manager_event_init(&rewind_st, (unsigned)(state_size * 8),
+         0, 0, NULL, true);
+   memcpy(states, bench_state, state_size);
+
+   for (i = 1; i <= BENCH_FRAMES; i++)
+   {
+      size_t page  = (i * 7) % pages * 4096;
+      size_t first = (i * 8) % 4096 | 7;
+
+      bench_state[page + first]                 ^= 0x80;
+      bench_state[page + ((first + 8) & 4095)] ^= 0x80;
+      memcpy(states + i * state_size, bench_state, state_size);
+
+      state_manager_check_rewind(&rewind_st, false, 1, false,
+            msg, sizeof(msg), &msg_time);
+   }
+
+   for (i = BENCH_FRAMES; i > 0; i--)
+   {
+      state_manager_check_rewind(&rewind_st, true, 1, false,
+            msg, sizeof(msg), &msg_time);
+
+      if (     !rewind_st.frame_is_reversed
+            || memcmp(bench_loaded_state, states + i * state_size,
+               state_size))
+         mismatches++;
+   }
+
+   printf("high bit flips at offsets 7 mod 8: %u of %u frame(s)"
+         " rewound wrong\n", mismatches, BENCH_FRAMES);
+
+   state_manager_event_deinit(&rewind_st);
+   free(states);
+   free(bench_loaded_state);
+   free(bench_state);
+   bench_loaded_state = NULL;
+   bench_state        = NULL;
+
+   return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned s, d;
+   static const unsigned sizes[] = { 16, 32, 64 };
+   unsigned max_threads          = cpu_features_get_core_amount();
+
+   if (argc > 1)
+      max_threads = (unsigned)strtoul(argv[1], NULL, 10);
+
+   if (argc > 2 && !bench_movie_open(argv[2]))
+   {
+      fprintf(stderr, "Could not read movie \"%s\".\n", argv[2]);
+      return 1;
+   }
+
+   if (bench_check_high_bits())
+      return 1;
+
+   for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+   {
+      size_t state_size = (size_t)sizes[s] << 20;
+
+      for (d = 0; d < 2; d++)
+      {
+         unsigned threads;
+
+         bench_run(state_size, state_size * 8, 0, 0, d);
+         for (threads = 1; threads <= max_threads; threads *= 2)
+            bench_run(state_size, state_size * 8, threads, 0, d);
+      }
+   }
+
+   /* Room for a few dozen frames only */
+   bench_run(1 << 20, 3 << 20, 0, 0, false);
+   bench_run(1 << 20, 3 << 20, 0, 16 << 20, false);
+   bench_run(1 << 20, 3 << 20, 0, 16 << 20, true);
+   if (max_threads)
+      bench_run(1 << 20, 3 << 20, max_threads, 16 << 20, true);
+
+   if (bench_movie)
+      fclose(bench_movie);
+
+   return 0;
+}
@@ -0,0 +1,323 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* CPU video filter benchmark.
+ *
+ * Runs the heavier built-in softfilters through the same pipeline
+ * the frontend uses, on a made-up frame that looks like pixel art:
+ * flat areas, stripes, diagonals and dithering in a few colours,
+ * which takes every filter down all of its branches.
+ *
+ * Each filter is run in both pixel formats, with every set of
+ * kernels the CPU has (plain C, SSE2) and with 1 up to the
+ * given number of threads. cpu_features_get is stubbed below, so
+ * that a run can keep the filters from picking the faster kernels.
+ * The output of every run is checked against the one of plain C
+ * on a single thread.
+ *
+ * Usage: softfilter_bench [width] [height] [frames] [max threads] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libretro.h>
+#include <features/features_cpu.h>
+
+#include "../../gfx/video_filter.h"
+
+#define BENCH_FILTER_DIR "../../gfx/video_filters/"
+
+struct bench_simd
+{
+   const char *name;
+   uint64_t mask;
+};
+
+static const char *bench_filters[] = {
+   "Scale2x.filt",
+   "LQ2x.filt",
+   "2xSaI.filt",
+   "Super2xSaI.filt",
+   "SuperEagle.filt",
+};
+
+static const struct bench_simd bench_simds[] = {
+   { "c",    0 },
+   { "sse2", RETRO_SIMD_SSE | RETRO_SIMD_SSE2 },
+};
+
+/* What the filters are told the CPU has */
+static uint64_t bench_mask = 0;
+static uint32_t bench_seed = 1;
+
+/* Frontend stubs */
+uint64_t cpu_features_get(void) { return bench_mask; }
+unsigned cpu_features_get_core_amount(void) { return 1; }
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+
+static uint64_t bench_cpu_simd(void)
+{
+   uint64_t cpu = 0;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("sse2"))
+      cpu |= RETRO_SIMD_SSE | RETRO_SIMD_SSE2;
+#endif
+   return cpu;
+}
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t bench_rand(void)
+{
+   bench_seed ^= bench_seed << 13;
+   bench_seed ^= bench_seed >> 17;
+   bench_seed ^= bench_seed << 5;
+   return bench_seed;
+}
+
+static void bench_make_frame(uint32_t *frame, unsigned width, unsigned height)
+{
+   static const uint32_t palette[] = {
+      0x000000, 0xffffff, 0xd82800, 0x0058f8, 0xf8b800, 0x00a800,
+   };
+   unsigned tx, ty, x, y;
+
+   for (ty = 0; ty < height; ty += 8)
+   {
+      for (tx = 0; tx < width; tx += 8)
+      {
+         uint32_t c0  = palette[bench_rand() % 6];
+         uint32_t c1  = palette[bench_rand() % 6];
+         unsigned pat = bench_rand() % 5;
+
+         for (y = ty; y < ty + 8 && y < height; y++)
+         {
+            for (x = tx; x < tx + 8 && x < width; x++)
+            {
+               bool fg;
+
+               switch (pat)
+               {
+                  case 0:
+                     fg = false;
+                     break;
+                  case 1:
+                     fg = (x + y) % 8 < 2;
+                     break;
+                  case 2:
+                     fg = (x - y) % 8 < 3;
+                     break;
+                  case 3:
+                     fg = y % 4 == 0;
+                     break;
+                  default:
+                     fg = bench_rand() & 1;
+                     break;
+               }
+
+               frame[y * width + x] = fg ? c1 : c0;
+            }
+         }
+      }
+   }
+}
+
+static void *bench_convert(const uint32_t *frame, unsigned width,
+      unsigned height, enum retro_pixel_format fmt)
+{
+   unsigned i;
+   uint16_t *out;
+
+   if (fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+   {
+      uint32_t *copy = (uint32_t*)malloc(width * height * sizeof(uint32_t));
+      memcpy(copy, frame, width * height * sizeof(uint32_t));
+      return copy;
+   }
+
+   out = (uint16_t*)malloc(width * height * sizeof(uint16_t));
+   for (i = 0; i < width * height; i++)
+      out[i] = ((frame[i] >> 8) & 0xf800) | ((frame[i] >> 5) & 0x07e0) |
+         ((frame[i] >> 3) & 0x001f);
+   return out;
+}
+
+/* Runs a filter and returns the input megapixels it went through
+ * a second, 0 if it did not load. The output of the last frame is
+ * left in out. */
+static double bench_run(const char *filter, enum retro_pixel_format fmt,
+      unsigned threads, const void *in, unsigned width, unsigned height,
+      unsigned frames, uint8_t *out, size_t out_size, size_t *out_stride,
+      unsigned *out_width, unsigned *out_height)
+{
+   char path[256];
+   unsigned i, max_width, max_height;
+   double start;
+   size_t bpp                = fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+   rarch_softfilter_t *filt  = NULL;
+
+   snprintf(path, sizeof(path), "%s%s", BENCH_FILTER_DIR, filter);
+   if (!(filt = rarch_softfilter_new(path, threads, fmt, width, height)))
+      return 0;
+
+   rarch_softfilter_get_max_output_size(filt, &max_width, &max_height);
+   rarch_softfilter_get_output_size(filt, out_width, out_height,
+         width, height);
+   *out_stride = max_width * bpp;
+   if (*out_stride * max_height > out_size)
+   {
+      rarch_softfilter_free(filt);
+      return 0;
+   }
+
+   /* Once to get the threads going */
+   rarch_softfilter_process(filt, out, *out_stride, in, width, height,
+         width * bpp);
+
+   start = bench_time();
+   for (i = 0; i < frames; i++)
+      rarch_softfilter_process(filt, out, *out_stride, in, width, height,
+            width * bpp);
+
+   rarch_softfilter_free(filt);
+   return (double)width * height * frames / (bench_time() - start) / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned f, fmt_i, s, threads;
+   unsigned width       = argc > 1 ? (unsigned)atoi(argv[1]) : 320;
+   unsigned height      = argc > 2 ? (unsigned)atoi(argv[2]) : 240;
+   unsigned frames      = argc > 3 ? (unsigned)atoi(argv[3]) : 300;
+   unsigned max_threads = argc > 4 ? (unsigned)atoi(argv[4]) : 4;
+   uint64_t cpu         = bench_cpu_simd();
+   /* Room for 4x in both directions and 4 bytes a pixel */
+   size_t out_size      = (size_t)width * height * 16 * 4;
+   uint8_t *out         = NULL;
+   uint8_t *ref         = NULL;
+   uint32_t *frame      = NULL;
+   unsigned errors      = 0;
+   static const enum retro_pixel_format fmts[] = {
+      RETRO_PIXEL_FORMAT_RGB565, RETRO_PIXEL_FORMAT_XRGB8888
+   };
+
+   if (!width || !height || !frames || !max_threads)
+   {
+      fprintf(stderr,
+            "Usage: %s [width] [height] [frames] [max threads]\n", argv[0]);
+      return 1;
+   }
+
+   frame = (uint32_t*)malloc(width * height * sizeof(uint32_t));
+   out   = (uint8_t*)malloc(out_size);
+   ref   = (uint8_t*)malloc(out_size);
+   bench_make_frame(frame, width, height);
+
+   printf("%ux%u, %u frames\n\n", width, height, frames);
+   printf("%-12s %-8s %-5s %7s %8s %8s  %s\n",
+         "filter", "format", "simd", "threads", "Mpix/s", "speedup", "output");
+
+   for (f = 0; f < sizeof(bench_filters) / sizeof(bench_filters[0]); f++)
+   {
+      for (fmt_i = 0; fmt_i < 2; fmt_i++)
+      {
+         enum retro_pixel_format fmt = fmts[fmt_i];
+         void *in                    = bench_convert(frame, width, height, fmt);
+         size_t bpp                  = fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? 4 : 2;
+         double base                 = 0;
+         size_t ref_stride           = 0;
+         unsigned ref_width          = 0;
+         unsigned ref_height         = 0;
+
+         for (s = 0; s < sizeof(bench_simds) / sizeof(bench_simds[0]); s++)
+         {
+            if ((bench_simds[s].mask & cpu) != bench_simds[s].mask)
+               continue;
+            bench_mask = bench_simds[s].mask;
+
+            for (threads = 1; threads <= max_threads; threads *= 2)
+            {
+               size_t stride;
+               unsigned out_width, out_height, y;
+               const char *result = "reference";
+               double mpix        = bench_run(bench_filters[f], fmt,
+                     threads, in, width, height, frames, out, out_size,
+                     &stride, &out_width, &out_height);
+
+               if (!mpix)
+               {
+                  fprintf(stderr, "Could not run %s\n", bench_filters[f]);
+                  return 1;
+               }
+
+               if (!base)
+               {
+                  base       = mpix;
+                  ref_stride = stride;
+                  ref_width  = out_width;
+                  ref_height = out_height;
+                  memcpy(ref, out, out_size);
+               }
+               else
+               {
+                  result = "same";
+                  if (out_width != ref_width || out_height != ref_height)
+                     result = "DIFFERENT SIZE";
+                  else
+                  {
+                     for (y = 0; y < out_height; y++)
+                     {
+                        if (memcmp(out + y * stride, ref + y * ref_stride,
+                                 out_width * bpp))
+                        {
+                           result = "DIFFERENT";
+                           break;
+                        }
+                     }
+                  }
+                  if (strcmp(result, "same"))
+                     errors++;
+               }
+
+               printf("%-12.*s %-8s %-5s %7u %8.1f %7.2fx  %s\n",
+                     (int)(strlen(bench_filters[f]) - 5), bench_filters[f],
+                     fmt == RETRO_PIXEL_FORMAT_XRGB8888 ? "xrgb8888" : "rgb565",
+                     bench_simds[s].name, threads, mpix, mpix / base, result);
+            }
+         }
+
+         free(in);
+      }
+   }
+
+   free(frame);
+   free(out);
+   free(ref);
+
+   if (errors)
+   {
+      printf("\n%u runs did not match the reference\n", errors);
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,556 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <compat/strl.h>
+#include <string/stdstring.h>
+#include <file/file_path.h>
+#include <streams/interface_stream.h>
+#include <formats/rjson.h>
+#include <array/rhmap.h>
+
+#if defined(_WIN32) && !defined(_XBOX)
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef LEGACY_WIN32
+#include <encodings/utf.h>
+#endif
+#define SCAN_CACHE_HAVE_STAT
+#elif !defined(_WIN32) && !defined(VITA) && !defined(PSP) && !defined(ORBIS)
+#include <sys/types.h>
+#include <sys/stat.h>
+#define SCAN_CACHE_HAVE_STAT
+#endif
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "scan_cache.h"
+#include "file_path_special.h"
+#include "verbosity.h"
+
+/* TODO/FIXME: Apparently rzip compression is an issue on UWP */
+#if defined(HAVE_ZLIB) && !(defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP)
+#define SCAN_CACHE_COMPRESS
+#endif
+
+enum scan_cache_key
+{
+   SCAN_CACHE_KEY_NONE = 0,
+   SCAN_CACHE_KEY_PATH,
+   SCAN_CACHE_KEY_SIZE,
+   SCAN_CACHE_KEY_MTIME,
+   SCAN_CACHE_KEY_CRC,
+   SCAN_CACHE_KEY_ARCHIVE_CRC,
+   SCAN_CACHE_KEY_SERIAL,
+   SCAN_CACHE_KEY_DB_NAME,
+   SCAN_CACHE_KEY_LABEL,
+   SCAN_CACHE_KEY_DB_CRC,
+   SCAN_CACHE_KEY_PLAYLIST_PATH
+};
+
+static const char *scan_cache_keys[] = {
+   "",
+   "path",
+   "size",
+   "mtime",
+   "crc",
+   "archive_crc",
+   "serial",
+   "db_name",
+   "label",
+   "db_crc",
+   "playlist_path"
+};
+
+struct scan_cache
+{
+   scan_cache_entry_t *entries; /* RHMAP keyed by path */
+   char file_path[PATH_MAX_LENGTH];
+   bool modified;
+};
+
+static void scan_cache_entry_free(scan_cache_entry_t *entry)
+{
+   free(entry->serial);
+   free(entry->db_name);
+   free(entry->label);
+   free(entry->playlist_path);
+}
+
+/* Integers wider than rjson can convert */
+static int64_t scan_cache_parse_int64(const char *str)
+{
+   uint64_t val = 0;
+   bool neg     = (*str == '-');
+
+   if (neg)
+      str++;
+
+   while (*str >= '0' && *str <= '9')
+      val = val * 10 + (uint64_t)(*str++ - '0');
+
+   return neg ? -(int64_t)val : (int64_t)val;
+}
+
+static void scan_cache_read(scan_cache_t *cache)
+{
+   scan_cache_entry_t item;
+   char *item_path        = NULL;
+   enum scan_cache_key key = SCAN_CACHE_KEY_NONE;
+   rjson_t *parser        = NULL;
+   intfstream_t *file     = NULL;
+
+#if defined(HAVE_ZLIB)
+   file = intfstream_open_rzip_file(cache->file_path,
+         RETRO_VFS_FILE_ACCESS_READ);
+#else
+   file = intfstream_open_file(cache->file_path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+#endif
+
+   if (!file)
+      return;
+
+   if (!(parser = rjson_open_stream(file)))
+   {
+      RARCH_ERR("[Scan Cache] Failed to create JSON parser\n");
+      goto end;
+   }
+
+   memset(&item, 0, sizeof(item));
+
+   /* { "version": "1.0", "items": [ { "path": ... }, ... ] } */
+   for (;;)
+   {
+      const char *str      = NULL;
+      enum rjson_type type = rjson_next(parser);
+
+      if (type == RJSON_DONE || type == RJSON_ERROR)
+      {
+         if (type == RJSON_ERROR)
+         {
+            RARCH_WARN("[Scan Cache] Error: Invalid JSON at line %d, column %d - %s.\n",
+                  (int)rjson_get_source_line(parser),
+                  (int)rjson_get_source_column(parser),
+                  (*rjson_get_error(parser) ? rjson_get_error(parser) : "format error"));
+            RARCH_WARN("[Scan Cache] Keeping the %u entries read so far.\n",
+                  (unsigned)RHMAP_LEN(cache->entries));
+         }
+         break;
+      }
+
+      switch (type)
+      {
+         case RJSON_OBJECT_END:
+            /* End of an item */
+            if (rjson_check_context(parser, 2, RJSON_OBJECT, RJSON_ARRAY))
+            {
+               if (     !string_is_empty(item_path)
+                     && !RHMAP_HAS_STR(cache->entries, item_path)
+                     && RHMAP_TRYFIT(cache->entries,
+                        RHMAP_LEN(cache->entries) + 1))
+                  RHMAP_SET_STR(cache->entries, item_path, item);
+               else
+                  scan_cache_entry_free(&item);
+
+               free(item_path);
+               item_path = NULL;
+               memset(&item, 0, sizeof(item));
+            }
+            break;
+         case RJSON_STRING:
+         case RJSON_NUMBER:
+            if (!rjson_check_context(parser, 3,
+                     RJSON_OBJECT, RJSON_ARRAY, RJSON_OBJECT))
+               break;
+
+            str = rjson_get_string(parser, NULL);
+
+            /* Member name */
+            if (rjson_get_context_count(parser) & 1)
+            {
+               size_t i;
+               key = SCAN_CACHE_KEY_NONE;
+               for (i = 1; i < ARRAY_SIZE(scan_cache_keys); i++)
+               {
+                  if (string_is_equal(str, scan_cache_keys[i]))
+                  {
+                     key = (enum scan_cache_key)i;
+                     break;
+                  }
+               }
+               break;
+            }
+
+            switch (key)
+            {
+               case SCAN_CACHE_KEY_PATH:
+                  free(item_path);
+                  item_path        = strdup(str);
+                  break;
+               case SCAN_CACHE_KEY_SIZE:
+                  item.size        = (uint64_t)scan_cache_parse_int64(str);
+                  break;
+               case SCAN_CACHE_KEY_MTIME:
+                  item.mtime       = scan_cache_parse_int64(str);
+                  break;
+               case SCAN_CACHE_KEY_CRC:
+                  item.crc         = (uint32_t)scan_cache_parse_int64(str);
+                  break;
+               case SCAN_CACHE_KEY_ARCHIVE_CRC:
+                  item.archive_crc = (uint32_t)scan_cache_parse_int64(str);
+                  break;
+               case SCAN_CACHE_KEY_SERIAL:
+                  free(item.serial);
+                  item.serial      = strdup(str);
+                  break;
+               case SCAN_CACHE_KEY_DB_NAME:
+                  free(item.db_name);
+                  item.db_name     = strdup(str);
+                  break;
+               case SCAN_CACHE_KEY_LABEL:
+                  free(item.label);
+                  item.label       = strdup(str);
+                  break;
+               case SCAN_CACHE_KEY_DB_CRC:
+                  item.db_crc      = (uint32_t)scan_cache_parse_int64(str);
+                  break;
+               case SCAN_CACHE_KEY_PLAYLIST_PATH:
+                  free(item.playlist_path);
+                  item.playlist_path = strdup(str);
+                  break;
+               default:
+                  break;
+            }
+            key = SCAN_CACHE_KEY_NONE;
+            break;
+         default:
+            break;
+      }
+   }
+
+   /* Clean up leftovers in the event of
+    * a parsing error */
+   scan_cache_entry_free(&item);
+   free(item_path);
+
+   rjson_free(parser);
+
+end:
+   intfstream_close(file);
+   free(file);
+}
+
+scan_cache_t *scan_cache_init(const char *dir)
+{
+   scan_cache_t *cache = (scan_cache_t*)calloc(1, sizeof(*cache));
+
+   if (!cache)
+      return NULL;
+
+   if (string_is_empty(dir))
+      strlcpy(cache->file_path, FILE_PATH_CONTENT_SCAN_CACHE,
+            sizeof(cache->file_path));
+   else
+      fill_pathname_join(cache->file_path, dir,
+            FILE_PATH_CONTENT_SCAN_CACHE, sizeof(cache->file_path));
+
+   scan_cache_read(cache);
+
+   return cache;
+}
+
+void scan_cache_free(scan_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < RHMAP_CAP(cache->entries); i++)
+      if (RHMAP_KEY(cache->entries, i))
+         scan_cache_entry_free(&cache->entries[i]);
+
+   RHMAP_FREE(cache->entries);
+   free(cache);
+}
+
+static void scan_cache_write_string(rjsonwriter_t *writer,
+      const char *key, const char *value)
+{
+   if (string_is_empty(value))
+      return;
+
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, key);
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, value);
+}
+
+static void scan_cache_write_unsigned(rjsonwriter_t *writer,
+      const char *key, uint32_t value)
+{
+   if (!value)
+      return;
+
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, key);
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_unsigned(writer, value);
+}
+
+/* Whether @path is @root, or inside it */
+static bool scan_cache_path_in(const char *path,
+      const char *root, size_t root_len)
+{
+   if (strncmp(path, root, root_len))
+      return false;
+   return   !path[root_len]
+         || path[root_len] == '/'
+         || path[root_len] == '\\'
+         || (root_len && (root[root_len - 1] == '/'
+                       || root[root_len - 1] == '\\'));
+}
+
+void scan_cache_write(scan_cache_t *cache, const char *root)
+{
+   size_t i;
+   unsigned count        = 0;
+   unsigned dropped      = 0;
+   size_t root_len       = root ? strlen(root) : 0;
+   intfstream_t *file    = NULL;
+   rjsonwriter_t *writer = NULL;
+
+   if (!cache)
+      return;
+
+   if (root_len)
+      for (i = 0; i < RHMAP_CAP(cache->entries); i++)
+         if (     RHMAP_KEY(cache->entries, i)
+               && !cache->entries[i].seen
+               && scan_cache_path_in(RHMAP_KEY_STR(cache->entries, i),
+                  root, root_len))
+            dropped++;
+
+   if (!cache->modified && !dropped)
+      return;
+
+#if defined(SCAN_CACHE_COMPRESS)
+   file = intfstream_open_rzip_file(cache->file_path,
+         RETRO_VFS_FILE_ACCESS_WRITE);
+#else
+   file = intfstream_open_file(cache->file_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+#endif
+
+   if (!file)
+   {
+      RARCH_ERR("[Scan Cache] Failed to write to scan cache file: %s\n",
+            cache->file_path);
+      return;
+   }
+
+   if (!(writer = rjsonwriter_open_stream(file)))
+   {
+      RARCH_ERR("[Scan Cache] Failed to create JSON writer\n");
+      goto end;
+   }
+
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_string(writer, "version");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_string(writer, "1.0");
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_string(writer, "items");
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_start_array(writer);
+
+   for (i = 0; i < RHMAP_CAP(cache->entries); i++)
+   {
+      const char *path          = NULL;
+      scan_cache_entry_t *entry = &cache->entries[i];
+
+      if (!RHMAP_KEY(cache->entries, i))
+         continue;
+
+      path = RHMAP_KEY_STR(cache->entries, i);
+
+      if (     root_len
+            && !entry->seen
+            && scan_cache_path_in(path, root, root_len))
+         continue;
+
+      if (count++)
+         rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+
+      rjsonwriter_add_start_object(writer);
+      rjsonwriter_add_string(writer, "path");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_add_string(writer, path);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "size");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_rawf(writer, STRING_REP_UINT64, entry->size);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_string(writer, "mtime");
+      rjsonwriter_add_colon(writer);
+      rjsonwriter_rawf(writer, STRING_REP_INT64, entry->mtime);
+      scan_cache_write_unsigned(writer, "crc",           entry->crc);
+      scan_cache_write_unsigned(writer, "archive_crc",   entry->archive_crc);
+      scan_cache_write_string(writer,   "serial",        entry->serial);
+      scan_cache_write_string(writer,   "db_name",       entry->db_name);
+      scan_cache_write_string(writer,   "label",         entry->label);
+      scan_cache_write_unsigned(writer, "db_crc",        entry->db_crc);
+      scan_cache_write_string(writer,   "playlist_path", entry->playlist_path);
+      rjsonwriter_add_end_object(writer);
+   }
+
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_end_array(writer);
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_newline(writer);
+
+   if (!rjsonwriter_free(writer))
+      RARCH_ERR("[Scan Cache] Error writing scan cache file: %s\n",
+            cache->file_path);
+   else
+   {
+      cache->modified = false;
+      RARCH_LOG("[Scan Cache] Wrote %u entries to cache file: %s\n",
+            count, cache->file_path);
+   }
+
+end:
+   intfstream_close(file);
+   free(file);
+}
+
+bool scan_cache_stat(const char *path, uint64_t *size, int64_t *mtime)
+{
+#if defined(SCAN_CACHE_HAVE_STAT)
+#if defined(_WIN32)
+   struct _stat64 buf;
+#ifdef LEGACY_WIN32
+   if (_stat64(path, &buf) != 0)
+      return false;
+#else
+   int ret;
+   wchar_t *path_w = utf8_to_utf16_string_alloc(path);
+
+   if (!path_w)
+      return false;
+
+   ret = _wstat64(path_w, &buf);
+   free(path_w);
+
+   if (ret != 0)
+      return false;
+#endif
+#else
+   struct stat buf;
+
+   if (stat(path, &buf) != 0)
+      return false;
+#endif
+
+   *size  = (uint64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+
+   return true;
+#else
+   return false;
+#endif
+}
+
+scan_cache_entry_t *scan_cache_get(scan_cache_t *cache,
+      const char *path, uint64_t size, int64_t mtime)
+{
+   ptrdiff_t idx;
+   scan_cache_entry_t *entry = NULL;
+
+   if (!cache || string_is_empty(path))
+      return NULL;
+
+   if ((idx = RHMAP_IDX_STR(cache->entries, path)) < 0)
+      return NULL;
+
+   entry       = &cache->entries[idx];
+   entry->seen = true;
+
+   if (entry->size != size || entry->mtime != mtime)
+      return NULL;
+
+   return entry;
+}
+
+scan_cache_entry_t *scan_cache_set(scan_cache_t *cache,
+      const char *path, uint64_t size, int64_t mtime)
+{
+   ptrdiff_t idx;
+   scan_cache_entry_t *entry = NULL;
+
+   if (!cache || string_is_empty(path))
+      return NULL;
+
+   if ((idx = RHMAP_IDX_STR(cache->entries, path)) >= 0)
+   {
+      entry = &cache->entries[idx];
+
+      if (entry->size == size && entry->mtime == mtime)
+      {
+         entry->seen = true;
+         return entry;
+      }
+
+      scan_cache_entry_free(entry);
+   }
+   else
+   {
+      if (!RHMAP_TRYFIT(cache->entries, RHMAP_LEN(cache->entries) + 1))
+         return NULL;
+      entry = RHMAP_PTR_STR(cache->entries, path);
+   }
+
+   memset(entry, 0, sizeof(*entry));
+   entry->size     = size;
+   entry->mtime    = mtime;
+   entry->seen     = true;
+   cache->modified = true;
+
+   return entry;
+}
+
+void scan_cache_set_string(scan_cache_t *cache,
+      char **dst, const char *src)
+{
+   if (string_is_empty(src))
+      src = NULL;
+
+   if (src && *dst && string_is_equal(*dst, src))
+      return;
+   if (!src && !*dst)
+      return;
+
+   free(*dst);
+   *dst            = src ? strdup(src) : NULL;
+   cache->modified = true;
+}
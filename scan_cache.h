@@ -0,0 +1,104 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SCAN_CACHE_H
+#define __SCAN_CACHE_H
+
+#include <stdint.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+/* What a content scan found out about a file, valid for
+ * as long as the file keeps its size and modification time.
+ * Strings are NULL when unknown. */
+typedef struct scan_cache_entry
+{
+   char *serial;
+   char *db_name;       /* Database the file matched (file name) */
+   char *label;         /* Name of the matching database entry */
+   char *playlist_path; /* Path a manual scan added to the playlist */
+   uint64_t size;
+   int64_t mtime;
+   uint32_t crc;
+   uint32_t archive_crc;
+   uint32_t db_crc;     /* CRC of the matching database entry */
+   bool seen;
+} scan_cache_entry_t;
+
+typedef struct scan_cache scan_cache_t;
+
+/**
+ * scan_cache_init:
+ * @dir                 : Directory holding the cache file.
+ *
+ * Loads the scan cache, or starts an empty one if there
+ * is none yet or it can't be read.
+ *
+ * Returns: scan cache, or NULL on allocation failure.
+ **/
+scan_cache_t *scan_cache_init(const char *dir);
+
+void scan_cache_free(scan_cache_t *cache);
+
+/**
+ * scan_cache_write:
+ * @root                : Scanned file or directory, or NULL.
+ *
+ * Writes the cache back to disk, if anything changed.
+ * Entries of files in (or at) @root that weren't looked
+ * up since the cache was loaded are dropped, as those
+ * files are gone.
+ **/
+void scan_cache_write(scan_cache_t *cache, const char *root);
+
+/**
+ * scan_cache_stat:
+ *
+ * Gets what entries are keyed by. Returns false if the file
+ * doesn't exist, or the platform can't tell its modification
+ * time; such files should not be looked up.
+ **/
+bool scan_cache_stat(const char *path, uint64_t *size, int64_t *mtime);
+
+/**
+ * scan_cache_get:
+ *
+ * Returns: the entry for @path if the file still has
+ * @size and @mtime, otherwise NULL. The entry is only
+ * valid until the next scan_cache_set().
+ **/
+scan_cache_entry_t *scan_cache_get(scan_cache_t *cache,
+      const char *path, uint64_t size, int64_t mtime);
+
+/**
+ * scan_cache_set:
+ *
+ * Returns: the entry for @path to be filled in, cleared first
+ * if the file's size or modification time changed, or NULL on
+ * allocation failure. The entry is only valid until the next
+ * scan_cache_set().
+ **/
+scan_cache_entry_t *scan_cache_set(scan_cache_t *cache,
+      const char *path, uint64_t size, int64_t mtime);
+
+/* Replaces one of the strings of an entry */
+void scan_cache_set_string(scan_cache_t *cache,
+      char **dst, const char *src);
+
+RETRO_END_DECLS
+
+#endif
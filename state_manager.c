@@ -24,8 +24,17 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_endianness.h>
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
+#include <string/stdstring.h>
+#include <streams/trans_stream.h>
+
+#ifdef HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 #include "state_manager.h"
 #include "msg_hash.h"
@@ -34,6 +43,10 @@
 #include "verbosity.h"
 #include "content.h"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #ifdef HAVE_NETWORKING
 #include "network/netplay/netplay.h"
 #endif
@@ -50,19 +63,13 @@
 #define UINT32_MAX 0xffffffffu
 #endif
 
-#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__) || defined(_M_IX86) || defined(_M_AMD64) || defined(_M_X64)
-#define CPU_X86
-#endif
-
-/* Other arches SIGBUS (usually) on unaligned accesses. */
-#ifndef CPU_X86
-#define NO_UNALIGNED_MEM
-#endif
-
 #if __SSE2__
 #include <emmintrin.h>
 #endif
 
+/* Granularity of the dirty page tracking */
+#define STATE_MANAGER_PAGE_SIZE 4096
+
 /* Format per frame (pseudocode): */
 #if 0
 size nextstart;
@@ -84,103 +91,56 @@ size thisstart;
 #endif
 
 /* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
+ * std::mismatch exists, but it's not optimized at all.
+ * Returns 'len' if nothing changed within the first 'len' words. */
+static size_t find_change(const uint16_t *a, const uint16_t *b, size_t len)
 {
+   size_t i = 0;
 #if __SSE2__
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
-
-   for (;;)
+   for (; i + 8 <= len; i += 8)
    {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i v0    = _mm_loadu_si128((const __m128i*)(a + i));
+      __m128i v1    = _mm_loadu_si128((const __m128i*)(b + i));
       __m128i c     = _mm_cmpeq_epi8(v0, v1);
       uint32_t mask = _mm_movemask_epi8(c);
 
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         /* calculate the real offset to the differing byte */
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask)));
-
-         /* and convert that to the uint16_t offset */
-         return (ret >> 1);
-      }
-
-      a128++;
-      b128++;
+      /* Something has changed, figure out where,
+       * and convert that to the uint16_t offset. */
+      if (mask != 0xffff)
+         return i + (compat_ctz(~mask) >> 1);
    }
 #else
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a == *b)
-#endif
-   {
-      const size_t *a_big = (const size_t*)a;
-      const size_t *b_big = (const size_t*)b;
-
-      while (*a_big == *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
-
-      while (*a == *b)
-      {
-         a++;
-         b++;
-      }
-   }
-   return a - a_org;
+   /* memcmp is vectorized by pretty much every libc,
+    * let it skip over the large unchanged stretches. */
+   while (i + 32 <= len && !memcmp(a + i, b + i, 32 * sizeof(uint16_t)))
+      i += 32;
 #endif
+   while (i < len && a[i] == b[i])
+      i++;
+   return i;
 }
 
-static size_t find_same(const uint16_t *a, const uint16_t *b)
+static size_t find_same(const uint16_t *a, const uint16_t *b, size_t len)
 {
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
-   {
-      a++;
-      b++;
-   }
-   if (*a != *b)
-#endif
-   {
-      /* With this, it's random whether two consecutive identical
-       * words are caught.
-       *
-       * Luckily, compression rate is the same for both cases, and
-       * three is always caught.
-       *
-       * (We prefer to miss two-word blocks, anyways; fewer iterations
-       * of the outer loop, as well as in the decompressor.) */
-      const uint32_t *a_big = (const uint32_t*)a;
-      const uint32_t *b_big = (const uint32_t*)b;
-
-      while (*a_big != *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
+   /* With this, it's random whether two consecutive identical
+    * words are caught.
+    *
+    * Luckily, compression rate is the same for both cases, and
+    * three is always caught.
+    *
+    * (We prefer to miss two-word blocks, anyways; fewer iterations
+    * of the outer loop, as well as in the decompressor.) */
+   size_t i = 0;
 
-      if (a != a_org && a[-1] == b[-1])
-      {
-         a--;
-         b--;
-      }
-   }
-   return a - a_org;
+   while (i + 1 < len && (a[i] != b[i] || a[i + 1] != b[i + 1]))
+      i += 2;
+
+   if (i + 1 >= len)
+      return len;
+
+   if (i && a[i - 1] == b[i - 1])
+      i--;
+   return i;
 }
 
 /* Returns the maximum compressed size of a savestate.
@@ -197,6 +157,128 @@ static size_t state_manager_raw_maxsize(size_t uncomp)
       3; /* three u16 to end it */
 }
 
+#define STATE_MANAGER_HASH_PRIME1 0x9e3779b185ebca87ULL
+#define STATE_MANAGER_HASH_PRIME2 0xc2b2ae3d27d4eb4fULL
+#define STATE_MANAGER_HASH_PRIME3 0x165667b19e3779f9ULL
+#define STATE_MANAGER_HASH_PRIME4 0x85ebca77c2b2ae63ULL
+#define STATE_MANAGER_HASH_PRIME5 0x27d4eb2f165667c5ULL
+
+#define STATE_MANAGER_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static INLINE uint64_t state_manager_hash_round(uint64_t acc, uint64_t word)
+{
+   acc += word * STATE_MANAGER_HASH_PRIME2;
+   acc  = STATE_MANAGER_ROTL64(acc, 31);
+   return acc * STATE_MANAGER_HASH_PRIME1;
+}
+
+static INLINE uint64_t state_manager_hash_merge(uint64_t h, uint64_t acc)
+{
+   h ^= state_manager_hash_round(0, acc);
+   return h * STATE_MANAGER_HASH_PRIME1 + STATE_MANAGER_HASH_PRIME4;
+}
+
+/* XXH64 (seed 0) of 'data'. The rotates and the final avalanche
+ * carry every input bit into every output bit, so buffers differing
+ * anywhere - high bits included - are all but certain to hash
+ * differently. Words are read little endian, so that peers of
+ * either byte order agree on the hash of the same bytes. */
+static uint64_t state_manager_hash(const uint8_t *data, size_t len)
+{
+   size_t i = 0;
+   uint64_t h;
+
+   if (len >= 32)
+   {
+      uint64_t v[4] = {
+         STATE_MANAGER_HASH_PRIME1 + STATE_MANAGER_HASH_PRIME2,
+         STATE_MANAGER_HASH_PRIME2,
+         0,
+         0 - STATE_MANAGER_HASH_PRIME1 };
+
+      for (; i + 32 <= len; i += 32)
+      {
+         uint64_t w[4];
+         memcpy(w, data + i, sizeof(w));
+         v[0] = state_manager_hash_round(v[0], retro_le_to_cpu64(w[0]));
+         v[1] = state_manager_hash_round(v[1], retro_le_to_cpu64(w[1]));
+         v[2] = state_manager_hash_round(v[2], retro_le_to_cpu64(w[2]));
+         v[3] = state_manager_hash_round(v[3], retro_le_to_cpu64(w[3]));
+      }
+
+      h = STATE_MANAGER_ROTL64(v[0], 1)  + STATE_MANAGER_ROTL64(v[1], 7)
+        + STATE_MANAGER_ROTL64(v[2], 12) + STATE_MANAGER_ROTL64(v[3], 18);
+      h = state_manager_hash_merge(h, v[0]);
+      h = state_manager_hash_merge(h, v[1]);
+      h = state_manager_hash_merge(h, v[2]);
+      h = state_manager_hash_merge(h, v[3]);
+   }
+   else
+      h = STATE_MANAGER_HASH_PRIME5;
+
+   h += len;
+
+   for (; i + 8 <= len; i += 8)
+   {
+      uint64_t w;
+      memcpy(&w, data + i, sizeof(w));
+      h ^= state_manager_hash_round(0, retro_le_to_cpu64(w));
+      h  = STATE_MANAGER_ROTL64(h, 27) * STATE_MANAGER_HASH_PRIME1
+         + STATE_MANAGER_HASH_PRIME4;
+   }
+
+   if (i + 4 <= len)
+   {
+      uint32_t w;
+      memcpy(&w, data + i, sizeof(w));
+      h ^= (uint64_t)retro_le_to_cpu32(w) * STATE_MANAGER_HASH_PRIME1;
+      h  = STATE_MANAGER_ROTL64(h, 23) * STATE_MANAGER_HASH_PRIME2
+         + STATE_MANAGER_HASH_PRIME3;
+      i += 4;
+   }
+
+   for (; i < len; i++)
+   {
+      h ^= data[i] * STATE_MANAGER_HASH_PRIME5;
+      h  = STATE_MANAGER_ROTL64(h, 11) * STATE_MANAGER_HASH_PRIME1;
+   }
+
+   h ^= h >> 33;
+   h *= STATE_MANAGER_HASH_PRIME2;
+   h ^= h >> 29;
+   h *= STATE_MANAGER_HASH_PRIME3;
+   h ^= h >> 32;
+   return h;
+}
+
+/* Returns the maximum size of a patch from
+ * state_manager_raw_compress_pages. Every run of dirty or
+ * clean pages may cost an extra record header and skip. */
+static size_t state_manager_pages_maxsize(size_t uncomp)
+{
+   size_t num_pages = (uncomp + STATE_MANAGER_PAGE_SIZE - 1)
+      / STATE_MANAGER_PAGE_SIZE;
+   return state_manager_raw_maxsize(uncomp)
+      + num_pages * sizeof(uint16_t) * 5;
+}
+
+/* Writes records skipping 'num16s' unchanged words. */
+static uint16_t *state_manager_raw_skip(uint16_t *compressed16,
+      size_t num16s)
+{
+   while (num16s)
+   {
+      size_t skip     = num16s > UINT32_MAX ? UINT32_MAX : num16s;
+
+      *compressed16++ = 0;
+      *compressed16++ = skip;
+      *compressed16++ = skip >> 16;
+      num16s         -= skip;
+   }
+
+   return compressed16;
+}
+
 /*
  * See state_manager_raw_compress for information about this.
  * When you're done with it, send it to free().
@@ -229,9 +311,13 @@ static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
  *
  * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
  * Returns the number of bytes actually written to 'patch'.
+ *
+ * If 'more' is set, the patch is left unterminated and ends by
+ * skipping over the unchanged remainder of 'len' instead, so the
+ * patch for the range following this one can be appended to it.
  */
 static size_t state_manager_raw_compress(const void *src,
-      const void *dst, size_t len, void *patch)
+      const void *dst, size_t len, void *patch, bool more)
 {
    const uint16_t  *old16 = (const uint16_t*)src;
    const uint16_t  *new16 = (const uint16_t*)dst;
@@ -242,7 +328,7 @@ static size_t state_manager_raw_compress(const void *src,
    while (num16s)
    {
       size_t i, changed;
-      size_t skip = find_change(old16, new16);
+      size_t skip = find_change(old16, new16, num16s);
 
       if (skip >= num16s)
          break;
@@ -265,9 +351,8 @@ static size_t state_manager_raw_compress(const void *src,
          continue;
       }
 
-      changed         = find_same(old16, new16);
-      if (changed > UINT16_MAX)
-         changed = UINT16_MAX;
+      changed         = find_same(old16, new16,
+            num16s > UINT16_MAX ? UINT16_MAX : num16s);
 
       *compressed16++ = changed;
       *compressed16++ = skip;
@@ -281,11 +366,124 @@ static size_t state_manager_raw_compress(const void *src,
       compressed16 += changed;
    }
 
-   compressed16[0]  = 0;
-   compressed16[1]  = 0;
-   compressed16[2]  = 0;
+   if (more)
+      /* Whatever is left of num16s is unchanged */
+      compressed16    = state_manager_raw_skip(compressed16, num16s);
+   else
+   {
+      *compressed16++ = 0;
+      *compressed16++ = 0;
+      *compressed16++ = 0;
+   }
+
+   return (uint8_t*)compressed16 - (uint8_t*)patch;
+}
+
+/* Hashes the pages of 'dst' into 'newhashes', and only diffs the
+ * pages whose hash differs from the one in 'oldhashes' against 'src';
+ * the others are skipped without reading either side. 'oldhashes'
+ * may be NULL if the hashes of 'src' are unknown, which diffs every
+ * page.
+ *
+ * Otherwise the same as state_manager_raw_compress, except that
+ * 'patch' must be size 'state_manager_pages_maxsize(len)' or more,
+ * and that 'len' must be a multiple of the page size if 'more' is set.
+ * The number of savestate bytes read is added to 'touched'.
+ *
+ * If 'forward' is set, the patch carries the words of 'dst' rather
+ * than those of 'src', and turns 'src' into 'dst' instead. */
+static size_t state_manager_raw_compress_pages(const uint8_t *src,
+      const uint8_t *dst, size_t len, void *patch, bool more,
+      bool forward, const uint64_t *oldhashes, uint64_t *newhashes,
+      uint64_t *touched)
+{
+   size_t page;
+   size_t num_pages       = (len + STATE_MANAGER_PAGE_SIZE - 1)
+      / STATE_MANAGER_PAGE_SIZE;
+   size_t clean           = 0;
+   size_t dirty_start     = 0;
+   size_t dirty           = 0;
+   uint8_t *compressed    = (uint8_t*)patch;
+
+   *touched              += len;
+
+   for (page = 0; page <= num_pages; page++)
+   {
+      size_t offset       = page * STATE_MANAGER_PAGE_SIZE;
+      bool page_dirty     = false;
+
+      if (page < num_pages)
+      {
+         size_t page_len  = len - offset;
+         if (page_len > STATE_MANAGER_PAGE_SIZE)
+            page_len      = STATE_MANAGER_PAGE_SIZE;
+
+         newhashes[page]  = state_manager_hash(dst + offset, page_len);
+         page_dirty       = !oldhashes || oldhashes[page] != newhashes[page];
+
+         if (page_dirty)
+         {
+            if (!dirty)
+            {
+               compressed = (uint8_t*)state_manager_raw_skip(
+                     (uint16_t*)compressed, clean / sizeof(uint16_t));
+               clean       = 0;
+               dirty_start = offset;
+            }
+            dirty        += page_len;
+            continue;
+         }
+
+         clean           += page_len;
+      }
+
+      /* A run of dirty pages just ended */
+      if (dirty)
+      {
+         if (forward)
+            compressed   += state_manager_raw_compress(
+                  dst + dirty_start, src + dirty_start, dirty,
+                  compressed, true);
+         else
+            compressed   += state_manager_raw_compress(
+                  src + dirty_start, dst + dirty_start, dirty,
+                  compressed, true);
+         *touched        += dirty * 2;
+         dirty            = 0;
+      }
+   }
+
+   if (more)
+      compressed = (uint8_t*)state_manager_raw_skip(
+            (uint16_t*)compressed, clean / sizeof(uint16_t));
+   else
+   {
+      memset(compressed, 0, sizeof(uint16_t) * 3);
+      compressed += sizeof(uint16_t) * 3;
+   }
+
+   return compressed - (uint8_t*)patch;
+}
+
+/* Compresses 'len' bytes at 'offset' of the two savestates,
+ * tracking dirty pages if 'newhashes' is set. */
+static size_t state_manager_compress_range(const uint8_t *src,
+      const uint8_t *dst, size_t offset, size_t len, void *patch,
+      bool more, const uint64_t *oldhashes, uint64_t *newhashes,
+      uint64_t *touched)
+{
+   size_t page = offset / STATE_MANAGER_PAGE_SIZE;
+
+   if (!newhashes)
+   {
+      *touched += len * 2;
+      return state_manager_raw_compress(src + offset, dst + offset,
+            len, patch, more);
+   }
 
-   return (uint8_t*)(compressed16 + 3) - (uint8_t*)patch;
+   return state_manager_raw_compress_pages(src + offset, dst + offset,
+         len, patch, more, false, oldhashes ? oldhashes + page : NULL,
+         newhashes + page, touched);
 }
 
 /*
@@ -335,6 +533,99 @@ static void state_manager_raw_decompress(const void *patch,
    }
 }
 
+size_t state_manager_delta_pages(size_t len)
+{
+   return (len + STATE_MANAGER_PAGE_SIZE - 1) / STATE_MANAGER_PAGE_SIZE;
+}
+
+size_t state_manager_delta_maxsize(size_t len)
+{
+   return state_manager_pages_maxsize(len);
+}
+
+void state_manager_delta_hash(const void *data, size_t len,
+      uint64_t *hashes)
+{
+   size_t page;
+   size_t num_pages = state_manager_delta_pages(len);
+
+   for (page = 0; page < num_pages; page++)
+   {
+      size_t offset   = page * STATE_MANAGER_PAGE_SIZE;
+      size_t page_len = len - offset;
+      if (page_len > STATE_MANAGER_PAGE_SIZE)
+         page_len     = STATE_MANAGER_PAGE_SIZE;
+      hashes[page]    = state_manager_hash(
+            (const uint8_t*)data + offset, page_len);
+   }
+}
+
+uint64_t state_manager_delta_digest(const void *data, size_t len)
+{
+   return state_manager_hash((const uint8_t*)data, len);
+}
+
+size_t state_manager_delta_compress(const void *base, const void *data,
+      size_t len, void *patch, const uint64_t *basehashes,
+      uint64_t *hashes)
+{
+   uint64_t touched = 0;
+   return state_manager_raw_compress_pages((const uint8_t*)base,
+         (const uint8_t*)data, len, patch, false, true,
+         basehashes, hashes, &touched);
+}
+
+/* Unlike state_manager_raw_decompress, this may be handed anything,
+ * so every record is checked against both buffers. */
+bool state_manager_delta_apply(const void *patch, size_t patchlen,
+      void *data, size_t len)
+{
+   uint16_t         *out16 = (uint16_t*)data;
+   const uint16_t *patch16 = (const uint16_t*)patch;
+   const uint16_t   *end16 = patch16 + patchlen / sizeof(uint16_t);
+   size_t             left = (len + sizeof(uint16_t) - 1)
+      / sizeof(uint16_t);
+
+   /* Every record, the end included, is at least three words */
+   while (end16 - patch16 >= 3)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+      {
+         uint16_t skip     = *(patch16++);
+
+         if (     (size_t)(end16 - patch16) < numchanged
+               || skip > left
+               || numchanged > left - skip)
+            return false;
+
+         memcpy(out16 + skip, patch16, numchanged * sizeof(uint16_t));
+
+         patch16          += numchanged;
+         out16            += skip + numchanged;
+         left             -= skip + numchanged;
+      }
+      else
+      {
+         uint32_t numunchanged = patch16[0]
+            | ((uint32_t)patch16[1] << 16);
+
+         patch16          += 2;
+
+         if (!numunchanged)
+            return patch16 == end16;
+         if (numunchanged > left)
+            return false;
+
+         out16            += numunchanged;
+         left             -= numunchanged;
+      }
+   }
+
+   return false;
+}
+
 /* The start offsets point to 'nextstart' of any given compressed frame.
  * Each uint16 is stored native endian; anything that claims any other
  * endianness refers to the endianness of this specific item.
@@ -370,17 +661,729 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+/* Frames that no longer fit in the rewind buffer are collected
+ * (oldest first) in 'staging', and batch-compressed into 'store'
+ * once enough of them piled up, one batch per pushed frame at most;
+ * the rewind buffer drops frames in bursts when it wraps around.
+ * 'store' is used as a ring too, the oldest batches get overwritten
+ * once it is full.
+ *
+ * Once rewinding has emptied the rewind buffer, up to a batch worth
+ * of the newest frames is moved back into it, unpacking the newest
+ * batch first if 'staging' is empty. */
+
+/* Uncompressed size frames are gathered up to before compressing */
+#define STATE_MANAGER_COLD_BATCH_SIZE (128 * 1024)
+
+struct state_manager_cold_batch
+{
+   size_t offset;
+   size_t size;
+   size_t raw_size;
+   unsigned frames;
+};
+
+struct state_manager_cold
+{
+   const struct trans_stream_backend *deflate;
+   const struct trans_stream_backend *inflate;
+   void *deflate_stream;
+   void *inflate_stream;
+
+   /* Each frame is a size_t length followed by the patch */
+   uint8_t *staging;
+   size_t staging_size;
+   size_t staging_capacity;
+   unsigned staging_frames;
+
+   uint8_t *packed;
+   size_t packed_capacity;
+
+   struct state_manager_cold_batch *batches;
+   unsigned batch_first;
+   unsigned batch_count;
+   unsigned batch_capacity;
+
+   uint8_t *store;
+   size_t store_size;
+   size_t store_head;
+#ifdef HAVE_MMAP
+   bool store_mapped;
+#endif
+
+   /* Set while moving a batch back into the rewind buffer */
+   bool refilling;
+   bool lost;
+};
+
+/* Returns how many bytes state_manager_raw_decompress
+ * will read from 'patch'. */
+static size_t state_manager_raw_patch_size(const void *patch)
+{
+   const uint16_t *patch16 = (const uint16_t*)patch;
+
+   for (;;)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+         patch16 += numchanged + 1;
+      else
+      {
+         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
+
+         patch16 += 2;
+         if (!numunchanged)
+            break;
+      }
+   }
+
+   return (const uint8_t*)patch16 - (const uint8_t*)patch;
+}
+
+static bool state_manager_cold_grow(uint8_t **buf,
+      size_t *capacity, size_t size)
+{
+   uint8_t *tmp;
+
+   if (size <= *capacity)
+      return true;
+
+   if (!(tmp = (uint8_t*)realloc(*buf, size)))
+      return false;
+
+   *buf      = tmp;
+   *capacity = size;
+   return true;
+}
+
+static void state_manager_cold_clear(struct state_manager_cold *cold)
+{
+   cold->staging_size   = 0;
+   cold->staging_frames = 0;
+   cold->batch_first    = 0;
+   cold->batch_count    = 0;
+   cold->store_head     = 0;
+}
+
+static void state_manager_cold_free(struct state_manager_cold *cold)
+{
+   if (!cold)
+      return;
+
+   if (cold->deflate_stream)
+      cold->deflate->stream_free(cold->deflate_stream);
+   if (cold->inflate_stream)
+      cold->inflate->stream_free(cold->inflate_stream);
+
+#ifdef HAVE_MMAP
+   if (cold->store_mapped)
+      munmap(cold->store, cold->store_size);
+   else
+#endif
+   if (cold->store)
+      free(cold->store);
+
+   if (cold->staging)
+      free(cold->staging);
+   if (cold->packed)
+      free(cold->packed);
+   if (cold->batches)
+      free(cold->batches);
+   free(cold);
+}
+
+static struct state_manager_cold *state_manager_cold_new(
+      size_t size, const char *path)
+{
+   struct state_manager_cold *cold = (struct state_manager_cold*)
+      calloc(1, sizeof(*cold));
+
+   if (!cold)
+      return NULL;
+
+#ifdef HAVE_ZLIB
+   cold->deflate        = trans_stream_get_zlib_deflate_backend();
+#else
+   cold->deflate        = trans_stream_get_pipe_backend();
+#endif
+   cold->inflate        = cold->deflate->reverse;
+   cold->deflate_stream = cold->deflate->stream_new();
+   cold->inflate_stream = cold->inflate->stream_new();
+
+   if (!cold->deflate_stream || !cold->inflate_stream)
+      goto error;
+
+   /* This runs while the game does, favour speed */
+   if (cold->deflate->define)
+      cold->deflate->define(cold->deflate_stream, "level", 1);
+
+   cold->store_size     = size;
+
+#ifdef HAVE_MMAP
+   if (!string_is_empty(path))
+   {
+      int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+
+      if (fd >= 0)
+      {
+         if (ftruncate(fd, (off_t)size) == 0)
+         {
+            void *map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                  MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED)
+            {
+               cold->store        = (uint8_t*)map;
+               cold->store_mapped = true;
+            }
+         }
+         close(fd);
+         /* The mapping keeps it alive; this way it goes away
+          * on its own, even if we crash. */
+         unlink(path);
+      }
+
+      if (!cold->store_mapped)
+         RARCH_WARN("[Rewind]: Could not map \"%s\", "
+               "keeping the compressed buffer in memory.\n", path);
+   }
+#endif
+
+   if (!cold->store && !(cold->store = (uint8_t*)malloc(size)))
+      goto error;
+
+   return cold;
+
+error:
+   state_manager_cold_free(cold);
+   return NULL;
+}
+
+/* Compresses the oldest batch worth of frames waiting in
+ * 'staging', provided there is a whole one. */
+static void state_manager_cold_flush(struct state_manager_cold *cold)
+{
+   uint32_t rd, wn;
+   size_t pos, bound;
+   size_t len                  = 0;
+   unsigned frames             = 0;
+   struct state_manager_cold_batch *batch;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+   if (cold->staging_size < STATE_MANAGER_COLD_BATCH_SIZE)
+      return;
+
+   /* At least one frame, however large it is */
+   do
+   {
+      len += sizeof(size_t) + read_size_t(cold->staging + len);
+      frames++;
+   } while (len < cold->staging_size
+         && len + sizeof(size_t) + read_size_t(cold->staging + len)
+         <= STATE_MANAGER_COLD_BATCH_SIZE);
+
+   /* Comfortably above deflateBound() */
+   bound = len + (len >> 8) + 64;
+
+   if (!state_manager_cold_grow(&cold->packed,
+            &cold->packed_capacity, bound))
+      goto error;
+
+   cold->deflate->set_in(cold->deflate_stream,
+         cold->staging, (uint32_t)len);
+   cold->deflate->set_out(cold->deflate_stream,
+         cold->packed, (uint32_t)bound);
+   if (!cold->deflate->trans(cold->deflate_stream, true, &rd, &wn, &err)
+         || err != TRANS_STREAM_ERROR_NONE
+         || wn > cold->store_size)
+      goto error;
+
+   pos = cold->store_head;
+   if (pos + wn > cold->store_size)
+      pos = 0;
+
+   /* Overwrite the oldest batches */
+   while (cold->batch_count)
+   {
+      struct state_manager_cold_batch *oldest =
+         &cold->batches[cold->batch_first];
+
+      if (     oldest->offset >= pos + wn
+            || oldest->offset + oldest->size <= pos)
+         break;
+
+      cold->batch_first++;
+      cold->batch_count--;
+   }
+
+   if (!cold->batch_count)
+      cold->batch_first = 0;
+
+   if (cold->batch_first + cold->batch_count == cold->batch_capacity)
+   {
+      if (cold->batch_first)
+      {
+         memmove(cold->batches, cold->batches + cold->batch_first,
+               cold->batch_count * sizeof(*cold->batches));
+         cold->batch_first = 0;
+      }
+      else
+      {
+         unsigned capacity = cold->batch_capacity
+            ? cold->batch_capacity * 2 : 64;
+         struct state_manager_cold_batch *tmp =
+            (struct state_manager_cold_batch*)realloc(cold->batches,
+                  capacity * sizeof(*tmp));
+
+         if (!tmp)
+            goto error;
+
+         cold->batches        = tmp;
+         cold->batch_capacity = capacity;
+      }
+   }
+
+   memcpy(cold->store + pos, cold->packed, wn);
+
+   batch           = &cold->batches[cold->batch_first + cold->batch_count++];
+   batch->offset   = pos;
+   batch->size     = wn;
+   batch->raw_size = len;
+   batch->frames   = frames;
+
+   cold->store_head      = pos + wn;
+   cold->staging_size   -= len;
+   cold->staging_frames -= frames;
+   memmove(cold->staging, cold->staging + len, cold->staging_size);
+   return;
+
+error:
+   /* Everything older than the newest frame is useless without
+    * the ones in this batch */
+   RARCH_WARN("[Rewind]: Could not compress frames, "
+         "dropping the compressed rewind buffer.\n");
+   state_manager_cold_clear(cold);
+}
+
+/* Takes the frame at 'frame', which is about to be dropped
+ * from the rewind buffer. */
+static void state_manager_cold_push(struct state_manager_cold *cold,
+      const uint8_t *frame)
+{
+   const uint8_t *patch = frame + sizeof(size_t);
+   size_t len           = state_manager_raw_patch_size(patch);
+
+   if (cold->refilling)
+   {
+      cold->lost = true;
+      return;
+   }
+
+   if (!state_manager_cold_grow(&cold->staging, &cold->staging_capacity,
+            cold->staging_size + sizeof(size_t) + len))
+   {
+      RARCH_WARN("[Rewind]: Could not store frame, "
+            "dropping the compressed rewind buffer.\n");
+      state_manager_cold_clear(cold);
+      return;
+   }
+
+   write_size_t(cold->staging + cold->staging_size, len);
+   memcpy(cold->staging + cold->staging_size + sizeof(size_t), patch, len);
+   cold->staging_size += sizeof(size_t) + len;
+   cold->staging_frames++;
+}
+
+/* Unpacks the newest batch into 'staging'. */
+static bool state_manager_cold_unpack(struct state_manager_cold *cold)
+{
+   uint32_t rd, wn;
+   struct state_manager_cold_batch *batch;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+   if (!cold->batch_count)
+      return false;
+
+   batch = &cold->batches[cold->batch_first + --cold->batch_count];
+   cold->store_head = batch->offset;
+
+   if (!state_manager_cold_grow(&cold->staging, &cold->staging_capacity,
+            batch->raw_size))
+      goto error;
+
+   cold->inflate->set_in(cold->inflate_stream,
+         cold->store + batch->offset, (uint32_t)batch->size);
+   cold->inflate->set_out(cold->inflate_stream,
+         cold->staging, (uint32_t)batch->raw_size);
+   if (!cold->inflate->trans(cold->inflate_stream, true, &rd, &wn, &err)
+         || wn != batch->raw_size)
+      goto error;
+
+   cold->staging_size   = batch->raw_size;
+   cold->staging_frames = batch->frames;
+   return true;
+
+error:
+   state_manager_cold_clear(cold);
+   return false;
+}
+
+#ifdef HAVE_THREADS
+/* Savestates smaller than this are compressed on the calling thread,
+ * waking up the workers would cost more than it saves. */
+#define STATE_MANAGER_ASYNC_MIN_SIZE (1024 * 1024)
+#define STATE_MANAGER_MAX_THREADS    8
+
+/* Each worker compresses one range of the savestate straight into
+ * its own slice of the space reserved at the head of the buffer;
+ * whichever finishes last packs the slices together. */
+struct state_manager_chunk
+{
+   struct state_manager_async *async;
+   sthread_t *thread;
+   size_t offset;
+   size_t len;
+   size_t patch_offset;
+   size_t patch_size;
+   uint64_t touched;
+};
+
+struct state_manager_async
+{
+   state_manager_t *state;
+   struct state_manager_chunk *chunks;
+   slock_t *lock;
+   scond_t *job_cond;
+   scond_t *done_cond;
+
+   const uint8_t *oldb;
+   const uint8_t *newb;
+   const uint64_t *oldhashes;
+   uint64_t *newhashes;
+   uint8_t *compressed;
+
+   size_t maxcompsize;
+   unsigned num_chunks;
+   unsigned pending;
+   unsigned job;
+   bool busy;
+   bool quit;
+};
+#endif
+
+/* Makes room for one more compressed frame at the head of the buffer,
+ * discarding the oldest frames if needed, and returns where it goes. */
+static uint8_t *state_manager_push_reserve(state_manager_t *state)
+{
+   size_t headpos, tailpos, remaining;
+
+recheckcapacity:;
+   headpos   = state->head - state->data;
+   tailpos   = state->tail - state->data;
+   remaining = (tailpos + state->capacity -
+         sizeof(size_t) - headpos - 1) % state->capacity + 1;
+
+   if (remaining <= state->maxcompsize)
+   {
+      if (state->cold)
+         state_manager_cold_push(state->cold, state->tail);
+      state->tail = state->data + read_size_t(state->tail);
+      state->entries--;
+      goto recheckcapacity;
+   }
+
+   return state->head + sizeof(size_t);
+}
+
+/* Links a frame written to the space returned by
+ * state_manager_push_reserve in; 'compressed' points to its end. */
+static void state_manager_push_commit(state_manager_t *state,
+      uint8_t *compressed)
+{
+   if (compressed - state->data + state->maxcompsize > state->capacity)
+   {
+      compressed     = state->data;
+      if (state->tail == state->data + sizeof(size_t))
+      {
+         if (state->cold)
+            state_manager_cold_push(state->cold, state->tail);
+         state->tail = state->data + read_size_t(state->tail);
+      }
+   }
+   write_size_t(compressed, state->head-state->data);
+   compressed       += sizeof(size_t);
+   write_size_t(state->head, compressed-state->data);
+   state->head       = compressed;
+}
+
+/* Moves the newest frames from the compressed buffer
+ * back into the (empty) rewind buffer. */
+static bool state_manager_cold_refill(state_manager_t *state)
+{
+   size_t pos, start;
+   struct state_manager_cold *cold = state->cold;
+
+   if (!cold->staging_frames && !state_manager_cold_unpack(cold))
+      return false;
+
+   /* Keeps the time spent here bounded, should a lot
+    * of frames still be waiting to be compressed */
+   for (start = 0; ; )
+   {
+      size_t next = start + sizeof(size_t) + read_size_t(cold->staging + start);
+      if (     next >= cold->staging_size
+            || cold->staging_size - start <= STATE_MANAGER_COLD_BATCH_SIZE)
+         break;
+      start = next;
+   }
+
+   cold->refilling = true;
+   cold->lost      = false;
+
+   for (pos = start; pos < cold->staging_size; )
+   {
+      size_t len          = read_size_t(cold->staging + pos);
+      uint8_t *compressed = state_manager_push_reserve(state);
+
+      memcpy(compressed, cold->staging + pos + sizeof(size_t), len);
+      state_manager_push_commit(state, compressed + len);
+      state->entries++;
+      cold->staging_frames--;
+
+      pos += sizeof(size_t) + len;
+   }
+
+   cold->refilling      = false;
+   cold->staging_size   = start;
+
+   /* Only happens if a batch is larger than the rewind buffer;
+    * the oldest frames of it are gone, and so is the way back
+    * to anything before them. */
+   if (cold->lost)
+      state_manager_cold_clear(cold);
+
+   return true;
+}
+
+#ifdef HAVE_THREADS
+/* Called with the lock held, by the worker finishing last. */
+static void state_manager_async_finish(struct state_manager_async *async)
+{
+   unsigned i;
+   uint8_t *compressed = async->compressed + async->chunks[0].patch_size;
+
+   async->state->bytes_touched += async->chunks[0].touched;
+
+   for (i = 1; i < async->num_chunks; i++)
+   {
+      struct state_manager_chunk *chunk = &async->chunks[i];
+
+      memmove(compressed, async->compressed + chunk->patch_offset,
+            chunk->patch_size);
+      compressed += chunk->patch_size;
+      async->state->bytes_touched += chunk->touched;
+   }
+
+   state_manager_push_commit(async->state, compressed);
+}
+
+static void state_manager_async_thread(void *data)
+{
+   struct state_manager_chunk *chunk = (struct state_manager_chunk*)data;
+   struct state_manager_async *async = chunk->async;
+   bool last                         = (chunk ==
+         &async->chunks[async->num_chunks - 1]);
+   unsigned job                      = 0;
+
+   slock_lock(async->lock);
+
+   for (;;)
+   {
+      while (!async->quit && async->job == job)
+         scond_wait(async->job_cond, async->lock);
+
+      if (async->quit)
+         break;
+
+      job = async->job;
+      slock_unlock(async->lock);
+
+      chunk->touched    = 0;
+      chunk->patch_size = state_manager_compress_range(
+            async->oldb, async->newb,
+            chunk->offset, chunk->len,
+            async->compressed + chunk->patch_offset,
+            !last, async->oldhashes, async->newhashes,
+            &chunk->touched);
+
+      slock_lock(async->lock);
+
+      if (--async->pending == 0)
+      {
+         state_manager_async_finish(async);
+         async->busy = false;
+         scond_signal(async->done_cond);
+      }
+   }
+
+   slock_unlock(async->lock);
+}
+
+/* Blocks until the frame handed to the workers is in the buffer. */
+static void state_manager_async_wait(struct state_manager_async *async)
+{
+   slock_lock(async->lock);
+   while (async->busy)
+      scond_wait(async->done_cond, async->lock);
+   slock_unlock(async->lock);
+}
+
+static void state_manager_async_post(struct state_manager_async *async,
+      const uint8_t *oldb, const uint8_t *newb,
+      const uint64_t *oldhashes, uint64_t *newhashes,
+      uint8_t *compressed)
+{
+   slock_lock(async->lock);
+   async->oldb       = oldb;
+   async->newb       = newb;
+   async->oldhashes  = oldhashes;
+   async->newhashes  = newhashes;
+   async->compressed = compressed;
+   async->pending    = async->num_chunks;
+   async->busy       = true;
+   async->job++;
+   scond_broadcast(async->job_cond);
+   slock_unlock(async->lock);
+}
+
+static void state_manager_async_free(struct state_manager_async *async)
+{
+   unsigned i;
+
+   if (!async)
+      return;
+
+   if (async->lock)
+   {
+      slock_lock(async->lock);
+      async->quit = true;
+      if (async->job_cond)
+         scond_broadcast(async->job_cond);
+      slock_unlock(async->lock);
+   }
+
+   if (async->chunks)
+   {
+      for (i = 0; i < async->num_chunks; i++)
+         if (async->chunks[i].thread)
+            sthread_join(async->chunks[i].thread);
+      free(async->chunks);
+   }
+
+   if (async->job_cond)
+      scond_free(async->job_cond);
+   if (async->done_cond)
+      scond_free(async->done_cond);
+   if (async->lock)
+      slock_free(async->lock);
+   free(async);
+}
+
+static struct state_manager_async *state_manager_async_new(
+      state_manager_t *state, size_t block_size, unsigned threads,
+      bool dirty_pages)
+{
+   unsigned i;
+   size_t chunk_size;
+   size_t patch_offset               = 0;
+   struct state_manager_async *async = (struct state_manager_async*)
+      calloc(1, sizeof(*async));
+
+   if (!async)
+      return NULL;
+
+   if (threads > STATE_MANAGER_MAX_THREADS)
+      threads         = STATE_MANAGER_MAX_THREADS;
+
+   /* Keep the ranges page aligned, so the workers neither fight
+    * over the cachelines at the edges nor split a tracked page. */
+   chunk_size         = (block_size / threads)
+      & ~(size_t)(STATE_MANAGER_PAGE_SIZE - 1);
+   if (!chunk_size)
+   {
+      chunk_size      = block_size;
+      threads         = 1;
+   }
+
+   async->state       = state;
+   async->num_chunks  = threads;
+   async->chunks      = (struct state_manager_chunk*)
+      calloc(threads, sizeof(*async->chunks));
+   async->lock        = slock_new();
+   async->job_cond    = scond_new();
+   async->done_cond   = scond_new();
+
+   if (!async->chunks || !async->lock || !async->job_cond || !async->done_cond)
+      goto error;
+
+   for (i = 0; i < threads; i++)
+   {
+      struct state_manager_chunk *chunk = &async->chunks[i];
+
+      chunk->async        = async;
+      chunk->offset       = i * chunk_size;
+      chunk->len          = (i == threads - 1)
+         ? block_size - chunk->offset
+         : chunk_size;
+      chunk->patch_offset = patch_offset;
+      patch_offset       += dirty_pages
+         ? state_manager_pages_maxsize(chunk->len)
+         : state_manager_raw_maxsize(chunk->len);
+   }
+
+   async->maxcompsize = patch_offset;
+
+   for (i = 0; i < threads; i++)
+   {
+      async->chunks[i].thread = sthread_create(
+            state_manager_async_thread, &async->chunks[i]);
+      if (!async->chunks[i].thread)
+         goto error;
+   }
+
+   return async;
+
+error:
+   state_manager_async_free(async);
+   return NULL;
+}
+#endif
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   /* Workers may still be writing to the buffer */
+   state_manager_async_free(state->async);
+   state->async      = NULL;
+#endif
+
+   state_manager_cold_free(state->cold);
+   state->cold       = NULL;
+
    if (state->data)
       free(state->data);
    if (state->thisblock)
       free(state->thisblock);
    if (state->nextblock)
       free(state->nextblock);
+   if (state->spareblock)
+      free(state->spareblock);
+   free(state->thishashes);
+   free(state->nexthashes);
+   free(state->sparehashes);
 #if STRICT_BUF_SIZE
    if (state->debugblock)
       free(state->debugblock);
@@ -389,15 +1392,17 @@ static void state_manager_free(state_manager_t *state)
    state->data       = NULL;
    state->thisblock  = NULL;
    state->nextblock  = NULL;
+   state->spareblock = NULL;
+   state->thishashes  = NULL;
+   state->nexthashes  = NULL;
+   state->sparehashes = NULL;
 }
 
 static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
+      size_t state_size, size_t buffer_size, unsigned threads,
+      size_t cold_size, const char *cold_path, bool dirty_pages)
 {
-   size_t max_comp_size, block_size;
-   uint8_t *next_block    = NULL;
-   uint8_t *this_block    = NULL;
-   uint8_t *state_data    = NULL;
+   size_t max_comp_size, block_size, num_pages;
    state_manager_t *state = (state_manager_t*)calloc(1, sizeof(*state));
 
    if (!state)
@@ -406,22 +1411,57 @@ static state_manager_t *state_manager_new(
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
-   state_data         = (uint8_t*)malloc(buffer_size);
+   num_pages          = (block_size + STATE_MANAGER_PAGE_SIZE - 1)
+      / STATE_MANAGER_PAGE_SIZE;
+
+   state->data        = (uint8_t*)malloc(buffer_size);
+   state->thisblock   = (uint8_t*)state_manager_raw_alloc(state_size, 0);
+   state->nextblock   = (uint8_t*)state_manager_raw_alloc(state_size, 1);
 
-   if (!state_data)
+   if (!state->data || !state->thisblock || !state->nextblock)
       goto error;
 
-   this_block         = (uint8_t*)state_manager_raw_alloc(state_size, 0);
-   next_block         = (uint8_t*)state_manager_raw_alloc(state_size, 1);
+   if (dirty_pages)
+   {
+      state->thishashes  = (uint64_t*)malloc(num_pages * sizeof(uint64_t));
+      state->nexthashes  = (uint64_t*)malloc(num_pages * sizeof(uint64_t));
+      state->sparehashes = (uint64_t*)malloc(num_pages * sizeof(uint64_t));
+
+      if (!state->thishashes || !state->nexthashes || !state->sparehashes)
+         goto error;
 
-   if (!this_block || !next_block)
-      goto error;
+      max_comp_size      = state_manager_pages_maxsize(state_size)
+         + sizeof(size_t) * 2;
+   }
+
+#ifdef HAVE_THREADS
+   if (threads)
+   {
+      /* Fall back to compressing synchronously if this fails */
+      state->spareblock  = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+      if (state->spareblock)
+         state->async    = state_manager_async_new(state,
+               block_size, threads, dirty_pages);
+
+      if (state->async)
+         max_comp_size   = state->async->maxcompsize + sizeof(size_t) * 2;
+      else if (state->spareblock)
+      {
+         free(state->spareblock);
+         state->spareblock = NULL;
+      }
+   }
+#endif
+
+   if (cold_size)
+   {
+      state->cold     = state_manager_cold_new(cold_size, cold_path);
+      if (!state->cold)
+         RARCH_WARN("[Rewind]: Could not allocate the compressed buffer.\n");
+   }
 
    state->blocksize   = block_size;
    state->maxcompsize = max_comp_size;
-   state->data        = state_data;
-   state->thisblock   = this_block;
-   state->nextblock   = next_block;
    state->capacity    = buffer_size;
 
    state->head        = state->data + sizeof(size_t);
@@ -435,8 +1475,6 @@ static state_manager_t *state_manager_new(
    return state;
 
 error:
-   if (state_data)
-      free(state_data);
    state_manager_free(state);
    free(state);
 
@@ -451,6 +1489,11 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data                        = NULL;
 
+#ifdef HAVE_THREADS
+   if (state->async)
+      state_manager_async_wait(state->async);
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid    = false;
@@ -460,7 +1503,8 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
    }
 
    *data                        = state->thisblock;
-   if (state->head == state->tail)
+   if (     state->head == state->tail
+         && !(state->cold && state_manager_cold_refill(state)))
       return false;
 
    start                        = read_size_t(state->head - sizeof(size_t));
@@ -470,6 +1514,7 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    state_manager_raw_decompress(compressed,
          state->maxcompsize, out, state->blocksize);
+   state->thishashes_valid      = false;
 
    state->entries--;
    return true;
@@ -499,7 +1544,9 @@ static void state_manager_push_where(state_manager_t *state, void **data)
 
 static void state_manager_push_do(state_manager_t *state)
 {
-   uint8_t *swap = NULL;
+   uint8_t *swap       = NULL;
+   uint64_t *swaphash  = NULL;
+   const uint64_t *oldhashes;
 
 #if STRICT_BUF_SIZE
    memcpy(state->nextblock, state->debugblock, state->debugsize);
@@ -507,45 +1554,64 @@ static void state_manager_push_do(state_manager_t *state)
 
    if (state->thisblock_valid)
    {
-      const uint8_t *oldb, *newb;
       uint8_t *compressed;
-      size_t headpos, tailpos, remaining;
       if (state->capacity < sizeof(size_t) + state->maxcompsize)
          return;
 
-recheckcapacity:;
-      headpos   = state->head - state->data;
-      tailpos   = state->tail - state->data;
-      remaining = (tailpos + state->capacity -
-            sizeof(size_t) - headpos - 1) % state->capacity + 1;
+      oldhashes             = state->thishashes_valid
+         ? state->thishashes : NULL;
 
-      if (remaining <= state->maxcompsize)
+#ifdef HAVE_THREADS
+      if (state->async)
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
-         goto recheckcapacity;
-      }
+         state_manager_async_wait(state->async);
 
-      oldb              = state->thisblock;
-      newb              = state->nextblock;
-      compressed        = state->head + sizeof(size_t);
+         if (state->cold)
+            state_manager_cold_flush(state->cold);
 
-      compressed       += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
+         compressed         = state_manager_push_reserve(state);
+         state->entries++;
 
-      if (compressed - state->data + state->maxcompsize > state->capacity)
-      {
-         compressed     = state->data;
-         if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+         state_manager_async_post(state->async,
+               state->thisblock, state->nextblock,
+               oldhashes, state->nexthashes, compressed);
+
+         /* The workers keep reading from the current block until
+          * they are done; the next state goes to the spare one. */
+         swap               = state->thisblock;
+         state->thisblock   = state->nextblock;
+         state->nextblock   = state->spareblock;
+         state->spareblock  = swap;
+
+         swaphash           = state->thishashes;
+         state->thishashes  = state->nexthashes;
+         state->nexthashes  = state->sparehashes;
+         state->sparehashes = swaphash;
+         state->thishashes_valid = !!state->thishashes;
+         return;
       }
-      write_size_t(compressed, state->head-state->data);
-      compressed       += sizeof(size_t);
-      write_size_t(state->head, compressed-state->data);
-      state->head       = compressed;
+#endif
+
+      if (state->cold)
+         state_manager_cold_flush(state->cold);
+
+      compressed  = state_manager_push_reserve(state);
+      compressed += state_manager_compress_range(state->thisblock,
+            state->nextblock, 0, state->blocksize, compressed, false,
+            oldhashes, state->nexthashes, &state->bytes_touched);
+
+      state_manager_push_commit(state, compressed);
+
+      swaphash                = state->thishashes;
+      state->thishashes       = state->nexthashes;
+      state->nexthashes       = swaphash;
+      state->thishashes_valid = !!state->thishashes;
    }
    else
-      state->thisblock_valid = true;
+   {
+      state->thisblock_valid  = true;
+      state->thishashes_valid = false;
+   }
 
    swap                      = state->thisblock;
    state->thisblock          = state->nextblock;
@@ -574,7 +1640,9 @@ static void state_manager_capacity(state_manager_t *state,
 
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, unsigned rewind_threads,
+      size_t cold_buffer_size, const char *cold_buffer_path,
+      bool dirty_pages)
 {
    void *state          = NULL;
 
@@ -600,8 +1668,16 @@ void state_manager_event_init(
          msg_hash_to_str(MSG_REWIND_INIT),
          (unsigned)(rewind_buffer_size / 1000000));
 
+#ifdef HAVE_THREADS
+   if (rewind_st->size < STATE_MANAGER_ASYNC_MIN_SIZE)
+      rewind_threads = 0;
+#else
+   rewind_threads   = 0;
+#endif
+
    rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+         rewind_buffer_size, rewind_threads,
+         cold_buffer_size, cold_buffer_path, dirty_pages);
 
    if (!rewind_st->state)
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
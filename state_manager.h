@@ -26,6 +26,9 @@
 
 RETRO_BEGIN_DECLS
 
+struct state_manager_async;
+struct state_manager_cold;
+
 struct state_manager
 {
    uint8_t *data;
@@ -36,6 +39,9 @@ struct state_manager
 
    uint8_t *thisblock;
    uint8_t *nextblock;
+   /* Only used when compressing asynchronously; holds the
+    * block the worker threads are still reading from. */
+   uint8_t *spareblock;
 #if STRICT_BUF_SIZE
    uint8_t *debugblock;
    size_t debugsize;
@@ -49,8 +55,25 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+   /* Per-page hashes of the blocks above, if dirty page
+    * tracking is enabled; unchanged pages are never diffed. */
+   uint64_t *thishashes;
+   uint64_t *nexthashes;
+   uint64_t *sparehashes;
+
+   /* Savestate bytes read while building patches. */
+   uint64_t bytes_touched;
+
+#ifdef HAVE_THREADS
+   struct state_manager_async *async;
+#endif
+   /* Frames pushed out of the buffer above end up here, if enabled */
+   struct state_manager_cold *cold;
+
    unsigned entries;
    bool thisblock_valid;
+   /* False while thishashes do not match thisblock. */
+   bool thishashes_valid;
 };
 
 typedef struct state_manager state_manager_t;
@@ -63,13 +86,69 @@ struct state_manager_rewind_state
    bool frame_is_reversed;
 };
 
+/* Savestate deltas, for sending states to a peer that holds an
+ * earlier one. States are split into pages, and only pages whose
+ * hash differs from that of the same page in the base are diffed.
+ *
+ * Buffers holding states must have room for 'len' rounded up to a
+ * whole number of 16-bit words. */
+
+/* Returns the number of page hashes of a state of 'len' bytes. */
+size_t state_manager_delta_pages(size_t len);
+
+/* Returns the maximum size of a delta between states of 'len' bytes. */
+size_t state_manager_delta_maxsize(size_t len);
+
+/* Hashes the pages of 'data' into 'hashes'. */
+void state_manager_delta_hash(const void *data, size_t len,
+      uint64_t *hashes);
+
+/* Hashes a whole state into one value, for checking that two peers
+ * hold the same state. Unlike the page hashes, this reads every byte
+ * the peers compare, so it is what decides whether a delta applies. */
+uint64_t state_manager_delta_digest(const void *data, size_t len);
+
+/* Writes a delta that turns 'base' into 'data' to 'patch', which must
+ * be at least state_manager_delta_maxsize(len) bytes, and hashes the
+ * pages of 'data' into 'hashes'. 'basehashes' are those of 'base'.
+ * Returns the size of the delta. */
+size_t state_manager_delta_compress(const void *base, const void *data,
+      size_t len, void *patch, const uint64_t *basehashes,
+      uint64_t *hashes);
+
+/* Applies a delta to 'data' in place. Returns false if the delta is
+ * malformed or does not fit a state of 'len' bytes, in which case
+ * 'data' is left partially patched. */
+bool state_manager_delta_apply(const void *patch, size_t patchlen,
+      void *data, size_t len);
+
 bool state_manager_frame_is_reversed(void);
 
 void state_manager_event_deinit(
       struct state_manager_rewind_state *rewind_st);
 
+/**
+ * state_manager_event_init:
+ * @rewind_buffer_size   : size of the rewind buffer, in bytes
+ * @rewind_threads       : number of worker threads used to compress
+ *                         rewind frames; 0 compresses on the calling
+ *                         thread. Ignored for small savestates.
+ * @cold_buffer_size     : size of the compressed buffer holding frames
+ *                         too old for the rewind buffer, in bytes;
+ *                         0 disables it.
+ * @cold_buffer_path     : if set, the compressed buffer is a memory
+ *                         mapped scratch file at this path rather than
+ *                         heap memory.
+ * @dirty_pages          : hash each page of the savestate, and only
+ *                         diff the pages that changed since the
+ *                         previous frame.
+ *
+ * Allocates the rewind buffer and pushes the initial state.
+ **/
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, unsigned rewind_threads,
+      size_t cold_buffer_size, const char *cold_buffer_path,
+      bool dirty_pages);
 
 /**
  * check_rewind:
@@ -27,6 +27,11 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#ifdef HAVE_THREADS
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -35,6 +40,7 @@
 #include "../file_path_special.h"
 #include "../msg_hash.h"
 #include "../playlist.h"
+#include "../scan_cache.h"
 #ifdef RARCH_INTERNAL
 #include "../configuration.h"
 #include "../retroarch.h"
@@ -50,24 +56,89 @@ typedef struct database_state_handle
    uint8_t *buf;
    size_t list_index;
    size_t entry_index;
+   /* How the current file was looked up, if the outcome
+    * is to be remembered in the scan cache, otherwise
+    * DATABASE_TYPE_NONE */
+   enum database_type cache_type;
+   uint64_t file_size;
+   int64_t file_mtime;
    uint32_t crc;
    uint32_t archive_crc;
    char archive_name[511];
    char serial[4096];
 } database_state_handle_t;
 
+#ifdef HAVE_THREADS
+/* Files are read and hashed on a thread pool, up to
+ * DATABASE_SCAN_WINDOW entries ahead of the one being matched,
+ * and the databases are queried once per DATABASE_SCAN_BATCH_SIZE
+ * files instead of once per file. libretro-db queries take at
+ * most 50 arguments, so a batch holds 24 files with two CRCs each. */
+#define DATABASE_SCAN_BATCH_SIZE 24
+#define DATABASE_SCAN_WINDOW     (DATABASE_SCAN_BATCH_SIZE * 2)
+#define DATABASE_SCAN_MAX_AUTO_THREADS 4
+/* How long a task iteration waits for a worker before
+ * yielding, so the task stays responsive to cancelling */
+#define DATABASE_SCAN_WAIT_USEC  100000
+
+struct database_scan;
+
+typedef struct database_scan_job
+{
+   struct database_scan *scan;
+   char *path;
+   size_t index;
+   int ret;
+   enum database_type type;
+   uint64_t file_size;
+   int64_t file_mtime;
+   uint32_t crc;
+   uint32_t archive_crc;
+   bool queued;
+   bool done;
+   bool file_stat;
+   bool cache_match; /* Scan cache knows which entry it matches */
+   char serial[4096];
+} database_scan_job_t;
+
+/* Query results for the current batch,
+ * hung off each database's list entry */
+typedef struct database_scan_matches
+{
+   database_info_list_t *crc;
+   database_info_list_t *serial;
+} database_scan_matches_t;
+
+typedef struct database_scan
+{
+   tpool_t *pool;
+   slock_t *lock;
+   scond_t *cond;
+   size_t dispatch_ptr;
+   size_t batch_start;
+   size_t batch_end;
+   database_scan_job_t jobs[DATABASE_SCAN_WINDOW];
+} database_scan_t;
+#endif
+
 typedef struct db_handle
 {
    char *playlist_directory;
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+   scan_cache_t *cache;
+#ifdef HAVE_THREADS
+   database_scan_t *scan;
+#endif
    database_state_handle_t state;
    playlist_config_t playlist_config; /* size_t alignment */
    unsigned status;
+   unsigned scan_threads;
    bool is_directory;
    bool scan_started;
    bool scan_without_core_match;
+   bool scan_cache_enable;
    bool show_hidden_files;
 } db_handle_t;
 
@@ -455,7 +526,7 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 }
 
 static void task_database_cue_prune(database_info_handle_t *db,
-      const char *name)
+      size_t start, const char *name)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -469,7 +540,7 @@ static void task_database_cue_prune(database_info_handle_t *db,
 
    while (cue_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -485,7 +556,8 @@ static void task_database_cue_prune(database_info_handle_t *db,
    free(fd);
 }
 
-static void gdi_prune(database_info_handle_t *db, const char *name)
+static void gdi_prune(database_info_handle_t *db,
+      size_t start, const char *name)
 {
    size_t i;
    char path[PATH_MAX_LENGTH];
@@ -499,7 +571,7 @@ static void gdi_prune(database_info_handle_t *db, const char *name)
 
    while (gdi_next_file(fd, name, path, sizeof(path)))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && string_is_equal(path, db->list->elems[i].data))
@@ -557,74 +629,196 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/* Drops the files a cue or gdi sheet refers to from the
+ * entries from @start on, so they aren't scanned on their own. */
+static void task_database_prune(database_info_handle_t *db,
+      size_t start, const char *name)
+{
+   switch (extension_to_file_type(path_get_extension(name)))
+   {
+      case FILE_TYPE_CUE:
+         task_database_cue_prune(db, start, name);
+         break;
+      case FILE_TYPE_GDI:
+         gdi_prune(db, start, name);
+         break;
+      default:
+         break;
+   }
+}
+
+/* Works out how a file is to be looked up and reads its
+ * CRC or serial. Only touches the file and its arguments,
+ * so it can run on a worker thread.
+ *
+ * Returns 0 if the file should be skipped. */
+static int task_database_get_fingerprint(const char *name,
+      enum database_type *type, uint32_t *crc, uint32_t *archive_crc,
+      char *serial)
 {
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         db->type = DATABASE_TYPE_CRC_LOOKUP;
+         *type = DATABASE_TYPE_CRC_LOOKUP;
          /* first check crc of archive itself */
          return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
+               0, SIZE_MAX, archive_crc);
 #else
          break;
 #endif
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_cue_get_serial(name, serial))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_cue_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_cue_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
+         serial[0] = '\0';
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (0 && task_database_gdi_get_serial(name, serial))
+            *type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            *type = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_gdi_get_crc(name, crc);
          }
          break;
       /* Consider Wii WBFS files similar to ISO files. */
       case FILE_TYPE_WBFS:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         db->type            =  DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         intfstream_file_get_serial(name, 0, SIZE_MAX, serial);
+         *type     = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            db->type         = DATABASE_TYPE_SERIAL_LOOKUP;
+         serial[0] = '\0';
+         if (task_database_chd_get_serial(name, serial))
+            *type  = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type         = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_chd_get_crc(name, &db_state->crc);
+            *type  = DATABASE_TYPE_CRC_LOOKUP;
+            return task_database_chd_get_crc(name, crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         db->type            = DATABASE_TYPE_ITERATE_LUTRO;
+         *type     = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         *type     = DATABASE_TYPE_CRC_LOOKUP;
+         return intfstream_file_get_crc(name, 0, SIZE_MAX, crc);
    }
 
    return 1;
 }
 
+/* Same filter the CRC lookup of a file that
+ * isn't inside an archive applies */
+static bool task_database_scan_database_supports(db_handle_t *_db,
+      const char *database, const char *name)
+{
+   if (_db->scan_without_core_match)
+      return true;
+   if (!core_info_database_supports_content_path(database, name))
+      return false;
+   return !core_info_database_match_archive_member(database);
+}
+
+/* Returns the fingerprint a cache entry holds, or
+ * DATABASE_TYPE_NONE if it doesn't hold one. */
+static enum database_type task_database_cache_get_type(
+      const scan_cache_entry_t *entry)
+{
+   if (entry->crc || entry->archive_crc)
+      return DATABASE_TYPE_CRC_LOOKUP;
+   if (!string_is_empty(entry->serial))
+      return DATABASE_TYPE_SERIAL_LOOKUP;
+   return DATABASE_TYPE_NONE;
+}
+
+/* Returns the index of the database a cache entry matched in,
+ * or -1 if it didn't match or the match no longer applies
+ * (the database is gone, or the core that filtered it in). */
+static int task_database_cache_find_database(db_handle_t *_db,
+      database_state_handle_t *db_state,
+      const scan_cache_entry_t *entry, const char *name)
+{
+   size_t i;
+
+   if (string_is_empty(entry->db_name) || !db_state->list)
+      return -1;
+
+   for (i = 0; i < db_state->list->size; i++)
+   {
+      const char *database = db_state->list->elems[i].data;
+
+      if (!string_is_equal(path_basename(database), entry->db_name))
+         continue;
+
+      /* Serials are looked up in every database */
+      if (     task_database_cache_get_type(entry)
+               == DATABASE_TYPE_CRC_LOOKUP
+            && !task_database_scan_database_supports(_db, database, name))
+         return -1;
+
+      return (int)i;
+   }
+
+   return -1;
+}
+
+/* Remembers the fingerprint of the current file, and the
+ * database entry it matched if @db_info_entry is set. */
+static void task_database_cache_record(db_handle_t *_db,
+      database_state_handle_t *db_state, const char *name,
+      database_info_t *db_info_entry)
+{
+   scan_cache_entry_t *entry = NULL;
+   enum database_type type   = db_state->cache_type;
+
+   db_state->cache_type      = DATABASE_TYPE_NONE;
+
+   if (     type == DATABASE_TYPE_NONE
+         || !(entry = scan_cache_set(_db->cache, name,
+               db_state->file_size, db_state->file_mtime)))
+      return;
+
+   if (type == DATABASE_TYPE_CRC_LOOKUP)
+   {
+      entry->crc         = db_state->crc;
+      entry->archive_crc = db_state->archive_crc;
+      scan_cache_set_string(_db->cache, &entry->serial, NULL);
+   }
+   else
+   {
+      entry->crc         = 0;
+      entry->archive_crc = 0;
+      scan_cache_set_string(_db->cache, &entry->serial, db_state->serial);
+   }
+
+   if (db_info_entry)
+   {
+      entry->db_crc      = db_info_entry->crc32;
+      scan_cache_set_string(_db->cache, &entry->db_name,
+            path_basename(database_info_get_current_name(db_state)));
+      scan_cache_set_string(_db->cache, &entry->label,
+            db_info_entry->name);
+   }
+   else
+   {
+      entry->db_crc      = 0;
+      scan_cache_set_string(_db->cache, &entry->db_name, NULL);
+      scan_cache_set_string(_db->cache, &entry->label, NULL);
+   }
+}
+
 static int database_info_list_iterate_end_no_match(
+      db_handle_t *_db,
       database_info_handle_t *db,
       database_state_handle_t *db_state,
       const char *path,
@@ -633,6 +827,8 @@ static int database_info_list_iterate_end_no_match(
    /* Reached end of database list,
     * CRC match probably didn't succeed. */
 
+   task_database_cache_record(_db, db_state, path, NULL);
+
    /* If this was a compressed file and no match in the database
     * list was found then expand the search list to include the
     * archive's contents. */
@@ -705,6 +901,7 @@ static int database_info_list_iterate_found_match(
       db_handle_t *_db,
       database_state_handle_t *db_state,
       database_info_handle_t *db,
+      database_info_t *db_info_entry,
       const char *archive_name
       )
 {
@@ -723,8 +920,6 @@ static int database_info_list_iterate_found_match(
       database_info_get_current_name(db_state);
    const char         *entry_path =
       database_info_get_current_element_name(db);
-   database_info_t *db_info_entry =
-      &db_state->info->list[db_state->entry_index];
 
    db_crc[0]                      = '\0';
    db_playlist_path[0]            = '\0';
@@ -781,6 +976,8 @@ static int database_info_list_iterate_found_match(
    fprintf(stderr, "entry path str: %s\n", entry_path_str);
 #endif
 
+   task_database_cache_record(_db, db_state, entry_path, db_info_entry);
+
    if (!playlist_entry_exists(playlist, entry_path_str))
    {
       struct playlist_entry entry;
@@ -854,6 +1051,86 @@ static int database_info_list_iterate_next(
    return 1;
 }
 
+/* Adds the file to the playlist of the database entry
+ * the scan cache says it matches. */
+static int task_database_cache_found_match(db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db,
+      const scan_cache_entry_t *entry, int list_index)
+{
+   database_info_t db_info_entry;
+
+   memset(&db_info_entry, 0, sizeof(db_info_entry));
+   db_info_entry.name    = entry->label;
+   db_info_entry.crc32   = entry->db_crc;
+
+   db_state->list_index  = (size_t)list_index;
+   db_state->cache_type  = DATABASE_TYPE_NONE;
+
+   return database_info_list_iterate_found_match(_db,
+         db_state, db, &db_info_entry, NULL);
+}
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   int ret;
+
+   task_database_prune(db, db->list_ptr, name);
+
+   if (     _db->cache
+         && scan_cache_stat(name,
+            &db_state->file_size, &db_state->file_mtime))
+   {
+      scan_cache_entry_t *entry = scan_cache_get(_db->cache, name,
+            db_state->file_size, db_state->file_mtime);
+
+      if (entry)
+      {
+         int list_index = task_database_cache_find_database(
+               _db, db_state, entry, name);
+
+         if (list_index >= 0)
+            return task_database_cache_found_match(_db,
+                  db_state, db, entry, list_index);
+
+         /* Rerun the lookup, the databases may have changed,
+          * but skip reading the file */
+         switch ((db->type = task_database_cache_get_type(entry)))
+         {
+            case DATABASE_TYPE_CRC_LOOKUP:
+               db_state->crc         = entry->crc;
+               db_state->archive_crc = entry->archive_crc;
+               db_state->cache_type  = db->type;
+               return 1;
+            case DATABASE_TYPE_SERIAL_LOOKUP:
+               strlcpy(db_state->serial, entry->serial,
+                     sizeof(db_state->serial));
+               db_state->cache_type  = db->type;
+               return 1;
+            default:
+               db->type              = DATABASE_TYPE_ITERATE;
+               break;
+         }
+      }
+
+      ret = task_database_get_fingerprint(name, &db->type,
+            &db_state->crc, &db_state->archive_crc, db_state->serial);
+
+      if (     ret
+            && (  db->type == DATABASE_TYPE_CRC_LOOKUP
+               || db->type == DATABASE_TYPE_SERIAL_LOOKUP))
+         db_state->cache_type = db->type;
+
+      return ret;
+   }
+
+   return task_database_get_fingerprint(name, &db->type,
+         &db_state->crc, &db_state->archive_crc, db_state->serial);
+}
+
 static int task_database_iterate_crc_lookup(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -864,7 +1141,7 @@ static int task_database_iterate_crc_lookup(
 {
    if (!db_state->list ||
          (unsigned)db_state->list_index == (unsigned)db_state->list->size)
-      return database_info_list_iterate_end_no_match(db, db_state, name,
+      return database_info_list_iterate_end_no_match(_db, db, db_state, name,
             path_contains_compressed_file);
 
    /* Archive did not contain a CRC for this entry, 
@@ -923,11 +1200,11 @@ static int task_database_iterate_crc_lookup(
          if (db_state->archive_crc == db_info_entry->crc32)
             return database_info_list_iterate_found_match(
                   _db,
-                  db_state, db, NULL);
+                  db_state, db, db_info_entry, NULL);
          if (db_state->crc == db_info_entry->crc32)
             return database_info_list_iterate_found_match(
                   _db,
-                  db_state, db, archive_entry);
+                  db_state, db, db_info_entry, archive_entry);
       }
    }
 
@@ -1022,7 +1299,7 @@ static int task_database_iterate_serial_lookup(
          !db_state->list ||
          (unsigned)db_state->list_index == (unsigned)db_state->list->size
       )
-      return database_info_list_iterate_end_no_match(db, db_state, name,
+      return database_info_list_iterate_end_no_match(_db, db, db_state, name,
             path_contains_compressed_file);
 
    if (db_state->entry_index == 0)
@@ -1057,7 +1334,7 @@ static int task_database_iterate_serial_lookup(
 #endif
          if (string_is_equal(db_state->serial, db_info_entry->serial))
             return database_info_list_iterate_found_match(_db,
-                  db_state, db, NULL);
+                  db_state, db, db_info_entry, NULL);
       }
    }
 
@@ -1079,6 +1356,453 @@ static int task_database_iterate_serial_lookup(
    return 0;
 }
 
+#ifdef HAVE_THREADS
+static void task_database_scan_job_run(void *data)
+{
+   database_scan_job_t *job = (database_scan_job_t*)data;
+   database_scan_t *scan    = job->scan;
+   enum database_type type  = DATABASE_TYPE_NONE;
+   int ret                  = task_database_get_fingerprint(job->path,
+         &type, &job->crc, &job->archive_crc, job->serial);
+
+   /* Archive did not contain a CRC for its first entry,
+    * or the file is empty. */
+   if (ret && type == DATABASE_TYPE_CRC_LOOKUP && !job->crc)
+      job->crc = file_archive_get_file_crc32(job->path);
+
+   slock_lock(scan->lock);
+   job->type = type;
+   job->ret  = ret;
+   job->done = true;
+   scond_signal(scan->cond);
+   slock_unlock(scan->lock);
+}
+
+static void task_database_scan_free_matches(
+      database_state_handle_t *db_state)
+{
+   size_t i;
+
+   if (!db_state->list)
+      return;
+
+   for (i = 0; i < db_state->list->size; i++)
+   {
+      database_scan_matches_t *matches = (database_scan_matches_t*)
+         db_state->list->elems[i].userdata;
+
+      if (!matches)
+         continue;
+
+      database_info_list_free(matches->crc);
+      free(matches->crc);
+      database_info_list_free(matches->serial);
+      free(matches->serial);
+      free(matches);
+      db_state->list->elems[i].userdata = NULL;
+   }
+}
+
+static void task_database_scan_free(database_scan_t *scan)
+{
+   unsigned i;
+
+   if (!scan)
+      return;
+
+   /* Drops the jobs that haven't started
+    * and waits for the ones that have */
+   if (scan->pool)
+      tpool_destroy(scan->pool);
+   if (scan->cond)
+      scond_free(scan->cond);
+   if (scan->lock)
+      slock_free(scan->lock);
+
+   for (i = 0; i < DATABASE_SCAN_WINDOW; i++)
+      free(scan->jobs[i].path);
+
+   free(scan);
+}
+
+static database_scan_t *task_database_scan_new(unsigned threads)
+{
+   unsigned i;
+   database_scan_t *scan = (database_scan_t*)calloc(1, sizeof(*scan));
+
+   if (!scan)
+      return NULL;
+
+   scan->lock = slock_new();
+   scan->cond = scond_new();
+   scan->pool = tpool_create(threads);
+
+   if (!scan->lock || !scan->cond || !scan->pool)
+   {
+      task_database_scan_free(scan);
+      return NULL;
+   }
+
+   for (i = 0; i < DATABASE_SCAN_WINDOW; i++)
+      scan->jobs[i].scan = scan;
+
+   return scan;
+}
+
+/* Hands the entries up to DATABASE_SCAN_WINDOW ahead of the
+ * current one to the pool. */
+static void task_database_scan_dispatch(db_handle_t *_db,
+      database_info_handle_t *db)
+{
+   database_scan_t *scan = _db->scan;
+
+   while (     scan->dispatch_ptr < db->list->size
+            && scan->dispatch_ptr < db->list_ptr + DATABASE_SCAN_WINDOW)
+   {
+      bool busy;
+      size_t i                 = scan->dispatch_ptr;
+      database_scan_job_t *job = &scan->jobs[i % DATABASE_SCAN_WINDOW];
+      const char *name         = db->list->elems[i].data;
+
+      slock_lock(scan->lock);
+      busy = job->queued && !job->done;
+      slock_unlock(scan->lock);
+
+      if (busy)
+         break;
+
+      scan->dispatch_ptr++;
+      job->queued = false;
+
+      /* Pruned entries are skipped, and files inside
+       * archives are left to the task thread. */
+      if (!name || path_contains_compressed_file(name))
+         continue;
+
+      /* Pruning only drops entries after this one,
+       * none of which have been handed out yet. */
+      task_database_prune(db, i, name);
+
+      free(job->path);
+      job->path        = strdup(name);
+      job->index       = i;
+      job->crc         = 0;
+      job->archive_crc = 0;
+      job->serial[0]   = '\0';
+      job->done        = false;
+      job->cache_match = false;
+      job->file_stat   = _db->cache && scan_cache_stat(name,
+            &job->file_size, &job->file_mtime);
+
+      /* Files the scan cache knows are done right away */
+      if (job->path && job->file_stat)
+      {
+         scan_cache_entry_t *entry = scan_cache_get(_db->cache, name,
+               job->file_size, job->file_mtime);
+
+         if (entry)
+         {
+            job->type        = task_database_cache_get_type(entry);
+            job->crc         = entry->crc;
+            job->archive_crc = entry->archive_crc;
+            job->cache_match = !string_is_empty(entry->db_name);
+            if (entry->serial)
+               strlcpy(job->serial, entry->serial, sizeof(job->serial));
+            job->ret         = 1;
+            job->done        = true;
+            job->queued      = job->type != DATABASE_TYPE_NONE;
+            if (job->queued)
+               continue;
+            job->done        = false;
+         }
+      }
+
+      job->queued      = job->path && tpool_add_work(scan->pool,
+            task_database_scan_job_run, job);
+   }
+}
+
+static bool task_database_scan_wait(database_scan_t *scan,
+      database_scan_job_t *job)
+{
+   bool done;
+
+   slock_lock(scan->lock);
+   if (!job->done)
+      scond_wait_timeout(scan->cond, scan->lock, DATABASE_SCAN_WAIT_USEC);
+   done = job->done;
+   slock_unlock(scan->lock);
+
+   return done;
+}
+
+/* Returns the finished job for entry @i if it
+ * has something to look up, otherwise NULL. */
+static database_scan_job_t *task_database_scan_get_lookup(
+      database_scan_t *scan, size_t i)
+{
+   database_scan_job_t *job = &scan->jobs[i % DATABASE_SCAN_WINDOW];
+
+   if (!job->queued || job->index != i || !job->ret || job->cache_match)
+      return NULL;
+
+   switch (job->type)
+   {
+      case DATABASE_TYPE_CRC_LOOKUP:
+         if (job->crc)
+            return job;
+         break;
+      case DATABASE_TYPE_SERIAL_LOOKUP:
+         if (!string_is_empty(job->serial))
+            return job;
+         break;
+      default:
+         break;
+   }
+
+   return NULL;
+}
+
+/* Queries every database once for the CRCs and serials of
+ * the files from @start on, up to DATABASE_SCAN_BATCH_SIZE.
+ *
+ * Returns false if some of them are still being read. */
+static bool task_database_scan_batch(db_handle_t *_db,
+      database_state_handle_t *db_state, size_t start)
+{
+   size_t i, j;
+   database_scan_t *scan = _db->scan;
+   size_t end            = MIN(start + DATABASE_SCAN_BATCH_SIZE,
+         scan->dispatch_ptr);
+   size_t serial_len     = 0;
+   char *serial_query    = NULL;
+
+   for (i = start; i < end; i++)
+   {
+      database_scan_job_t *job = &scan->jobs[i % DATABASE_SCAN_WINDOW];
+      if (     job->queued
+            && job->index == i
+            && !task_database_scan_wait(scan, job))
+         return false;
+   }
+
+   task_database_scan_free_matches(db_state);
+   scan->batch_start = start;
+   scan->batch_end   = end;
+
+   if (!db_state->list)
+      return true;
+
+   /* Serials are looked up in every database,
+    * so one query serves them all. */
+   for (i = start; i < end; i++)
+   {
+      database_scan_job_t *job = task_database_scan_get_lookup(scan, i);
+      if (job && job->type == DATABASE_TYPE_SERIAL_LOOKUP)
+         serial_len += strlen(job->serial) * 2 + STRLEN_CONST("b'',");
+   }
+
+   if (serial_len
+         && (serial_query = (char*)malloc(serial_len
+               + STRLEN_CONST("{'serial':or()}") + 1)))
+   {
+      size_t len = strlcpy(serial_query, "{'serial':or(",
+            serial_len + STRLEN_CONST("{'serial':or()}") + 1);
+
+      for (i = start; i < end; i++)
+      {
+         char *serial_buf         = NULL;
+         database_scan_job_t *job = task_database_scan_get_lookup(scan, i);
+
+         if (!job || job->type != DATABASE_TYPE_SERIAL_LOOKUP)
+            continue;
+         if (!(serial_buf = bin_to_hex_alloc((uint8_t*)job->serial,
+                     strlen(job->serial) * sizeof(uint8_t))))
+            continue;
+
+         len += sprintf(serial_query + len, "b'%s',", serial_buf);
+         free(serial_buf);
+      }
+
+      if (serial_query[len - 1] == ',')
+         strcpy(serial_query + len - 1, ")}");
+      else
+      {
+         free(serial_query);
+         serial_query = NULL;
+      }
+   }
+
+   for (i = 0; i < db_state->list->size; i++)
+   {
+      char query[STRLEN_CONST("{crc:or()}")
+         + DATABASE_SCAN_BATCH_SIZE * 2 * STRLEN_CONST("b\"12345678\",")
+         + 1];
+      size_t len                       = 0;
+      const char *database             = db_state->list->elems[i].data;
+      database_scan_matches_t *matches = (database_scan_matches_t*)
+         calloc(1, sizeof(*matches));
+
+      if (!matches)
+         break;
+
+      len = strlcpy(query, "{crc:or(", sizeof(query));
+
+      for (j = start; j < end; j++)
+      {
+         database_scan_job_t *job = task_database_scan_get_lookup(scan, j);
+
+         if (     !job
+               || job->type != DATABASE_TYPE_CRC_LOOKUP
+               || !task_database_scan_database_supports(
+                  _db, database, job->path))
+            continue;
+
+         len += snprintf(query + len, sizeof(query) - len,
+               "b\"%08X\",b\"%08X\",", job->crc, job->archive_crc);
+      }
+
+      if (query[len - 1] == ',')
+      {
+         strcpy(query + len - 1, ")}");
+         matches->crc = database_info_list_new(database, query);
+      }
+
+      if (serial_query)
+         matches->serial = database_info_list_new(database, serial_query);
+
+      db_state->list->elems[i].userdata = matches;
+   }
+
+   free(serial_query);
+
+   return true;
+}
+
+/* Looks the file up in the results of its batch, going
+ * through the databases and their entries in the same order
+ * the lookup of the file on its own would. */
+static int task_database_scan_lookup(db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db,
+      const char *name,
+      database_scan_job_t *job)
+{
+   size_t i, j;
+
+   for (i = 0; db_state->list && i < db_state->list->size; i++)
+   {
+      database_info_list_t *info       = NULL;
+      database_scan_matches_t *matches = (database_scan_matches_t*)
+         db_state->list->elems[i].userdata;
+
+      if (!matches)
+         continue;
+
+      if (job->type == DATABASE_TYPE_SERIAL_LOOKUP)
+         info = matches->serial;
+      else if (task_database_scan_database_supports(_db,
+               db_state->list->elems[i].data, name))
+         info = matches->crc;
+
+      if (!info)
+         continue;
+
+      for (j = 0; j < info->count; j++)
+      {
+         database_info_t *db_info_entry = &info->list[j];
+
+         if (job->type == DATABASE_TYPE_SERIAL_LOOKUP)
+         {
+            if (     !db_info_entry->serial
+                  || !string_is_equal(job->serial, db_info_entry->serial))
+               continue;
+         }
+         else if (  !db_info_entry->crc32
+                  || (     db_info_entry->crc32 != job->archive_crc
+                        && db_info_entry->crc32 != job->crc))
+            continue;
+
+         db_state->list_index = i;
+         return database_info_list_iterate_found_match(_db,
+               db_state, db, db_info_entry, NULL);
+      }
+   }
+
+   return database_info_list_iterate_end_no_match(_db, db, db_state, name,
+         false);
+}
+
+static int task_database_scan_iterate(db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   database_scan_t *scan    = _db->scan;
+   size_t index             = db->list_ptr;
+   database_scan_job_t *job = &scan->jobs[index % DATABASE_SCAN_WINDOW];
+
+   task_database_scan_dispatch(_db, db);
+
+   /* Not handed to the pool */
+   if (!job->queued || job->index != index)
+      return task_database_iterate_playlist(_db, db_state, db, name);
+
+   if (!task_database_scan_wait(scan, job))
+      return 1;
+
+   if (!job->ret)
+      return 0;
+
+   if (job->cache_match)
+   {
+      scan_cache_entry_t *entry = scan_cache_get(_db->cache, name,
+            job->file_size, job->file_mtime);
+      int list_index            = entry
+         ? task_database_cache_find_database(_db, db_state, entry, name)
+         : -1;
+
+      if (list_index >= 0)
+         return task_database_cache_found_match(_db,
+               db_state, db, entry, list_index);
+
+      /* The match no longer applies, look the file up again */
+      job->cache_match = false;
+      scan->batch_end  = scan->batch_start;
+   }
+
+   switch (job->type)
+   {
+      case DATABASE_TYPE_CRC_LOOKUP:
+      case DATABASE_TYPE_SERIAL_LOOKUP:
+         if (job->file_stat)
+         {
+            db_state->cache_type  = job->type;
+            db_state->file_size   = job->file_size;
+            db_state->file_mtime  = job->file_mtime;
+            db_state->crc         = job->crc;
+            db_state->archive_crc = job->archive_crc;
+            strlcpy(db_state->serial, job->serial,
+                  sizeof(db_state->serial));
+         }
+         if (     index <  scan->batch_start
+               || index >= scan->batch_end)
+            if (!task_database_scan_batch(_db, db_state, index))
+               return 1;
+         if (task_database_scan_get_lookup(scan, index))
+            return task_database_scan_lookup(_db, db_state, db, name, job);
+         return database_info_list_iterate_end_no_match(_db, db, db_state,
+               name, false);
+      case DATABASE_TYPE_ITERATE_LUTRO:
+         db->type = DATABASE_TYPE_ITERATE_LUTRO;
+         return 1;
+      default:
+         break;
+   }
+
+   return 0;
+}
+#endif
+
 static int task_database_iterate(
       db_handle_t *_db,
       const char *name,
@@ -1089,7 +1813,11 @@ static int task_database_iterate(
    switch (db->type)
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+#ifdef HAVE_THREADS
+         if (_db->scan)
+            return task_database_scan_iterate(_db, db_state, db, name);
+#endif
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
 #ifdef HAVE_COMPRESSION
          return task_database_iterate_crc_lookup(
@@ -1158,6 +1886,14 @@ static void task_database_handler(retro_task_t *task)
 
       if (db->handle)
          db->handle->status = DATABASE_STATUS_ITERATE_BEGIN;
+
+      if (db->handle && db->scan_cache_enable)
+         db->cache = scan_cache_init(db->playlist_directory);
+
+#ifdef HAVE_THREADS
+      if (db->handle && db->scan_threads > 1)
+         db->scan = task_database_scan_new(db->scan_threads);
+#endif
    }
 
    dbinfo  = db->handle;
@@ -1225,6 +1961,7 @@ static void task_database_handler(retro_task_t *task)
          task_database_cleanup_state(dbstate);
          dbstate->list_index  = 0;
          dbstate->entry_index = 0;
+         dbstate->cache_type  = DATABASE_TYPE_NONE;
          task_database_iterate_start(task, dbinfo, name);
          break;
       case DATABASE_STATUS_ITERATE:
@@ -1285,6 +2022,25 @@ task_finished:
    if (task)
       task_set_finished(task, true);
 
+#ifdef HAVE_THREADS
+   if (db && db->scan)
+   {
+      task_database_scan_free(db->scan);
+      db->scan = NULL;
+   }
+   if (dbstate)
+      task_database_scan_free_matches(dbstate);
+#endif
+
+   if (db && db->cache)
+   {
+      /* Only a complete scan can tell which files are gone */
+      scan_cache_write(db->cache,
+            (task && !task_get_cancelled(task)) ? db->fullpath : NULL);
+      scan_cache_free(db->cache);
+      db->cache = NULL;
+   }
+
    if (dbstate)
    {
       if (dbstate->list)
@@ -1347,6 +2103,13 @@ bool task_push_dbscan(
 #ifdef RARCH_INTERNAL
    t->progress_cb                          = task_database_progress_cb;
    db->scan_without_core_match             = settings->bools.scan_without_core_match;
+   db->scan_cache_enable                   = settings->bools.scan_cache_enable;
+#ifdef HAVE_THREADS
+   db->scan_threads                        = settings->uints.scan_threads;
+   if (!db->scan_threads)
+      db->scan_threads                     = MIN(cpu_features_get_core_amount(),
+            DATABASE_SCAN_MAX_AUTO_THREADS);
+#endif
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = settings->bools.playlist_use_old_format;
    db->playlist_config.compress            = settings->bools.playlist_compression;
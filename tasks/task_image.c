@@ -24,6 +24,11 @@
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#include <queues/task_queue.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
@@ -36,13 +41,31 @@ enum image_status_enum
    IMAGE_STATUS_TRANSFER,
    IMAGE_STATUS_TRANSFER_PARSE,
    IMAGE_STATUS_PROCESS_TRANSFER,
-   IMAGE_STATUS_PROCESS_TRANSFER_PARSE
+   IMAGE_STATUS_PROCESS_TRANSFER_PARSE,
+   IMAGE_STATUS_DECODE
 };
 
+#ifdef HAVE_THREADS
+/* Images are decoded whole on a thread pool shared by
+ * all image tasks, so that the thumbnails of a menu
+ * decode at the same time instead of one after the
+ * other, a frame's worth of work at a time. */
+#define TASK_IMAGE_MAX_THREADS 4
+/* How long the task thread waits for a decode before
+ * moving on to its other tasks */
+#define TASK_IMAGE_WAIT_USEC   5000
+
+static tpool_t *task_image_pool = NULL;
+#endif
+
 struct nbio_image_handle
 {
    void *handle;
    transfer_cb_t  cb;
+#ifdef HAVE_THREADS
+   slock_t *lock;
+   scond_t *cond;
+#endif
    struct texture_image ti; /* ptr alignment */
    size_t size;
    int processing_final_state;
@@ -53,6 +76,10 @@ struct nbio_image_handle
    bool is_blocking;
    bool is_blocking_on_processing;
    bool is_finished;
+#ifdef HAVE_THREADS
+   bool is_queued;
+   bool is_decoded;
+#endif
 };
 
 static int cb_image_upload_generic(void *data, size_t len)
@@ -154,12 +181,87 @@ static int task_image_iterate_process_transfer(struct nbio_image_handle *image)
    return -1;
 }
 
+#ifdef HAVE_THREADS
+static void task_image_decode(void *data)
+{
+   int retval;
+   unsigned width                  = 0;
+   unsigned height                 = 0;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)data;
+
+   while (image_transfer_iterate(image->handle, image->type));
+
+   do
+   {
+      retval = task_image_process(image, &width, &height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   slock_lock(image->lock);
+   image->processing_final_state = retval;
+   image->is_decoded             = true;
+   scond_signal(image->cond);
+   slock_unlock(image->lock);
+}
+
+/* Returns true once the pool is done with the image */
+static bool task_image_wait(struct nbio_image_handle *image,
+      int64_t timeout_us)
+{
+   bool decoded;
+
+   slock_lock(image->lock);
+   if (!image->is_decoded)
+   {
+      if (timeout_us < 0)
+         while (!image->is_decoded)
+            scond_wait(image->cond, image->lock);
+      else if (timeout_us > 0)
+         scond_wait_timeout(image->cond, image->lock, timeout_us);
+   }
+   decoded = image->is_decoded;
+   slock_unlock(image->lock);
+
+   return decoded;
+}
+
+static bool task_image_queue_decode(struct nbio_image_handle *image)
+{
+   if (!task_image_pool)
+      return false;
+
+   image->lock = slock_new();
+   image->cond = scond_new();
+
+   if (!image->lock || !image->cond)
+      return false;
+
+   image->is_queued = tpool_add_work(task_image_pool,
+         task_image_decode, image);
+
+   return image->is_queued;
+}
+#endif
+
 static void task_image_cleanup(nbio_handle_t *nbio)
 {
    struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
 
    if (image)
    {
+#ifdef HAVE_THREADS
+      /* The pool may still be reading the file */
+      if (image->is_queued)
+      {
+         task_image_wait(image, -1);
+         image->is_queued = false;
+      }
+      if (image->cond)
+         scond_free(image->cond);
+      if (image->lock)
+         slock_free(image->lock);
+      image->cond                   = NULL;
+      image->lock                   = NULL;
+#endif
       image_transfer_free(image->handle, image->type);
 
       image->handle                 = NULL;
@@ -227,6 +329,11 @@ static int cb_nbio_image_thumbnail(void *data, size_t len)
    image->is_finished              = false;
    nbio->is_finished               = true;
 
+#ifdef HAVE_THREADS
+   if (task_image_queue_decode(image))
+      image->status                = IMAGE_STATUS_DECODE;
+#endif
+
    return 0;
 }
 
@@ -312,6 +419,16 @@ bool task_image_load_handler(retro_task_t *task)
                      < image->frame_duration);
             }
             break;
+         case IMAGE_STATUS_DECODE:
+#ifdef HAVE_THREADS
+            /* Tasks that run on the main thread don't wait */
+            if (!task_image_wait(image, task_queue_is_threaded()
+                     ? TASK_IMAGE_WAIT_USEC : 0))
+               return true;
+#endif
+            image->cb     = &cb_image_upload_generic;
+            image->status = IMAGE_STATUS_PROCESS_TRANSFER_PARSE;
+            /* fall-through */
          case IMAGE_STATUS_PROCESS_TRANSFER_PARSE:
             if (image->handle && image->cb)
             {
@@ -431,6 +548,12 @@ bool task_push_image_load(const char *fullpath,
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
    image->handle                     = NULL;
+#ifdef HAVE_THREADS
+   image->lock                       = NULL;
+   image->cond                       = NULL;
+   image->is_queued                  = false;
+   image->is_decoded                 = false;
+#endif
 
    image->ti.width                   = 0;
    image->ti.height                  = 0;
@@ -469,3 +592,28 @@ bool task_push_image_load(const char *fullpath,
 
    return true;
 }
+
+void task_image_pool_init(void)
+{
+#ifdef HAVE_THREADS
+   unsigned threads = cpu_features_get_core_amount();
+
+   if (!task_image_pool)
+      task_image_pool = tpool_create(
+            MIN(MAX(threads, 1), TASK_IMAGE_MAX_THREADS));
+#endif
+}
+
+void task_image_pool_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (!task_image_pool)
+      return;
+
+   /* Tasks left on hold by task_queue_deinit() may
+    * still have an image being decoded */
+   tpool_wait(task_image_pool);
+   tpool_destroy(task_image_pool);
+   task_image_pool = NULL;
+#endif
+}
@@ -35,6 +35,7 @@
 #include "../msg_hash.h"
 #include "../playlist.h"
 #include "../manual_content_scan.h"
+#include "../scan_cache.h"
 
 #ifdef RARCH_INTERNAL
 #ifdef HAVE_MENU
@@ -57,11 +58,14 @@ typedef struct manual_scan_handle
    struct string_list *content_list;
    logiqx_dat_t *dat_file;
    struct string_list *m3u_list;
+   scan_cache_t *scan_cache;
+   char *playlist_directory;
    playlist_config_t playlist_config; /* size_t alignment */
    size_t list_size;
    size_t list_index;
    size_t m3u_index;
    enum manual_scan_status status;
+   bool scan_cache_enable;
 } manual_scan_handle_t;
 
 /* Frees task handle + all constituent objects */
@@ -100,6 +104,18 @@ static void free_manual_content_scan_handle(manual_scan_handle_t *manual_scan)
       manual_scan->dat_file = NULL;
    }
 
+   if (manual_scan->scan_cache)
+   {
+      scan_cache_free(manual_scan->scan_cache);
+      manual_scan->scan_cache = NULL;
+   }
+
+   if (manual_scan->playlist_directory)
+   {
+      free(manual_scan->playlist_directory);
+      manual_scan->playlist_directory = NULL;
+   }
+
    free(manual_scan);
    manual_scan = NULL;
 }
@@ -180,6 +196,58 @@ static void task_manual_content_scan_free(retro_task_t *task)
    free_manual_content_scan_handle(manual_scan);
 }
 
+/* Adds content to playlist
+ * > Getting the playlist entry of an archive means
+ *   reading its file list, so the scan cache remembers
+ *   it for as long as the archive is not modified */
+static void task_manual_content_scan_add_content(
+      manual_scan_handle_t *manual_scan,
+      const char *content_path, int content_type)
+{
+   char playlist_content_path[PATH_MAX_LENGTH];
+   manual_content_scan_task_config_t *task_config =
+         manual_scan->task_config;
+   scan_cache_entry_t *entry                      = NULL;
+   uint64_t size                                  = 0;
+   int64_t mtime                                  = 0;
+   bool cacheable                                 =
+            manual_scan->scan_cache
+         && (content_type == RARCH_COMPRESSED_ARCHIVE)
+         && task_config->search_archives
+         && scan_cache_stat(content_path, &size, &mtime);
+
+   playlist_content_path[0] = '\0';
+
+   if (cacheable)
+   {
+      entry = scan_cache_get(manual_scan->scan_cache,
+            content_path, size, mtime);
+
+      /* Content is already in the playlist */
+      if (entry
+            && string_is_equal(entry->db_name, task_config->database_name)
+            && playlist_entry_exists(manual_scan->playlist,
+                  entry->playlist_path))
+         return;
+   }
+
+   if (!manual_content_scan_add_content_to_playlist(
+         task_config, manual_scan->playlist,
+         content_path, content_type, manual_scan->dat_file,
+         playlist_content_path, sizeof(playlist_content_path)))
+      return;
+
+   if (cacheable &&
+       (entry = scan_cache_set(manual_scan->scan_cache,
+            content_path, size, mtime)))
+   {
+      scan_cache_set_string(manual_scan->scan_cache,
+            &entry->playlist_path, playlist_content_path);
+      scan_cache_set_string(manual_scan->scan_cache,
+            &entry->db_name, task_config->database_name);
+   }
+}
+
 static void task_manual_content_scan_handler(retro_task_t *task)
 {
    manual_scan_handle_t *manual_scan = NULL;
@@ -236,6 +304,11 @@ static void task_manual_content_scan_handler(retro_task_t *task)
             if (!manual_scan->playlist)
                goto task_finished;
 
+            /* Load scan cache, if required */
+            if (manual_scan->scan_cache_enable)
+               manual_scan->scan_cache = scan_cache_init(
+                     manual_scan->playlist_directory);
+
             /* Reset playlist, if required */
             if (manual_scan->task_config->overwrite_playlist)
                playlist_clear(manual_scan->playlist);
@@ -281,9 +354,8 @@ static void task_manual_content_scan_handler(retro_task_t *task)
                task_set_progress(task, (manual_scan->list_index * 100) / manual_scan->list_size);
 
                /* Add content to playlist */
-               manual_content_scan_add_content_to_playlist(
-                     manual_scan->task_config, manual_scan->playlist,
-                     content_path, content_type, manual_scan->dat_file);
+               task_manual_content_scan_add_content(
+                     manual_scan, content_path, content_type);
 
                /* If this is an M3U file, add it to the
                 * M3U list for later processing */
@@ -381,6 +453,12 @@ static void task_manual_content_scan_handler(retro_task_t *task)
             /* Save playlist changes to disk */
             playlist_write_file(manual_scan->playlist);
 
+            /* Save scan cache changes to disk
+             * > Only archives are looked up here, so entries
+             *   of other files in the content directory
+             *   must not be dropped */
+            scan_cache_write(manual_scan->scan_cache, NULL);
+
             /* Update progress display */
             task_free_title(task);
 
@@ -452,8 +530,12 @@ bool task_push_manual_content_scan(
    manual_scan->m3u_list            = string_list_new();
    manual_scan->m3u_index           = 0;
    manual_scan->status              = MANUAL_SCAN_BEGIN;
+   manual_scan->scan_cache          = NULL;
+   manual_scan->playlist_directory  = strdup(playlist_directory);
+   manual_scan->scan_cache_enable   =
+         config_get_ptr()->bools.scan_cache_enable;
 
-   if (!manual_scan->m3u_list)
+   if (!manual_scan->m3u_list || !manual_scan->playlist_directory)
       goto error;
 
    /* > Get current manual content scan configuration */
@@ -265,6 +265,7 @@ static void task_netplay_crc_scan_handler(retro_task_t *task)
          playlist_t *playlist   = NULL;
          unsigned playlist_size = 0;
          const char *lpl_path   = state->lpl_list->elems[i].data;
+         const struct playlist_entry *crc_entry = NULL;
 
          /* skip files without .lpl file extension */
          if (!string_ends_with_size(lpl_path, ".lpl",
@@ -277,6 +278,12 @@ static void task_netplay_crc_scan_handler(retro_task_t *task)
          playlist      = playlist_init(&state->playlist_config);
          playlist_size = playlist_get_size(playlist);
 
+         /* Looked up once, but still only taken if no
+          * earlier entry matches by file name */
+         if (have_crc)
+            playlist_get_index_by_crc32(playlist,
+                  state->content_crc, &crc_entry);
+
          for (j = 0; j < playlist_size; j++)
          {
             const char *playlist_path     = NULL;
@@ -288,7 +295,7 @@ static void task_netplay_crc_scan_handler(retro_task_t *task)
             playlist_path = playlist_entry->path;
             playlist_crc32 = playlist_entry->crc32;
 
-            if (have_crc && string_is_equal(playlist_crc32, state->content_crc))
+            if (playlist_entry == crc_entry)
             {
                RARCH_LOG("[Lobby]: CRC match %s\n", playlist_crc32);
                strlcpy(state->content_path, playlist_path, sizeof(state->content_path));
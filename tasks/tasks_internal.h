@@ -158,6 +158,12 @@ bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Starts and stops the threads images are decoded on.
+ * Made to go along with task_queue_init() and
+ * task_queue_deinit(), before any image is loaded. */
+void task_image_pool_init(void);
+void task_image_pool_deinit(void);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,